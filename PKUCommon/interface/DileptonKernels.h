@@ -0,0 +1,78 @@
+#ifndef VAJets_PKUCommon_DileptonKernels_h
+#define VAJets_PKUCommon_DileptonKernels_h
+//
+// Package:    VAJets/PKUCommon
+//
+/**
+ Description: the choice of the dilepton pair of PKUZLepProducer, on the
+ four-momenta and charges of the leptons of one flavour held as one array
+ per variable.
+
+ Implementation:
+     Header-only and free of framework types, so that the producer fills
+     the arrays from the lepton View and the kernel benchmark
+     (PKUTreeMaker/bin/benchmarkKernels.cc) from generated events.  The
+     pair is returned in collection order, as CandViewCombiner ordered
+     the daughters of its candidates:
+
+       LeadingPt   the first opposite-sign pair of the (pt-ordered) input
+                   in (i, j > i) order, the candidate the combiner put first
+       MassWindow  the pair closest to targetMass
+       minMass, maxMass  pairs outside are not considered
+*/
+//
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace pku {
+
+  namespace dilepton {
+
+    struct Leptons {
+      std::vector<double> px, py, pz, e;
+      std::vector<int>    charge;
+
+      std::size_t size() const { return charge.size(); }
+      void resize(std::size_t n) {
+        px.resize(n); py.resize(n); pz.resize(n); e.resize(n); charge.resize(n);
+      }
+    };
+
+    enum Selection { LeadingPt, MassWindow };
+
+    struct Pairing {
+      Selection selection;
+      double targetMass, minMass, maxMass;
+
+      Pairing() : selection(LeadingPt), targetMass(91.1876), minMass(0.), maxMass(1e9) {}
+
+      // indices of the selected pair, first < second; false if none
+      bool bestPair(const Leptons& l, std::size_t& first, std::size_t& second) const {
+        const std::size_t n = l.size();
+        double best = -1.;
+        for (std::size_t i = 0; i < n; ++i) {
+          for (std::size_t j = i + 1; j < n; ++j) {
+            if (l.charge[i]*l.charge[j] >= 0) continue;
+            const double e = l.e[i] + l.e[j], px = l.px[i] + l.px[j], py = l.py[i] + l.py[j], pz = l.pz[i] + l.pz[j];
+            const double m2 = e*e - px*px - py*py - pz*pz;
+            const double m = m2 > 0. ? std::sqrt(m2) : 0.;
+            if (m < minMass || m > maxMass) continue;
+            if (selection == LeadingPt) {
+              first = i; second = j;
+              return true;
+            }
+            const double distance = std::fabs(m - targetMass);
+            if (best < 0. || distance < best) { best = distance; first = i; second = j; }
+          }
+        }
+        return best >= 0.;
+      }
+    };
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef VAJets_PKUCommon_LeptonIdKernels_h
+#define VAJets_PKUCommon_LeptonIdKernels_h
+//
+// Package:    VAJets/PKUCommon
+//
+/**
+ Description: the working-point evaluation of PATMuonIdSelector and
+ PATElectronIdSelector, on the ID variables of all the leptons of an
+ event held as one array per variable.
+
+ Implementation:
+     Header-only and free of framework types, so that the selectors fill
+     the arrays from pat objects and the kernel benchmark
+     (PKUTreeMaker/bin/benchmarkKernels.cc) from generated events.  The
+     result of evaluate() is one pku::wp bitmask per lepton.
+*/
+//
+
+#include "VAJets/PKUCommon/interface/LeptonWP.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace pku {
+
+  namespace muonId {
+
+    // the global-track variables are left failing for non-global muons
+    struct Variables {
+      std::vector<double>        pt, absEta, normalizedChi2;
+      std::vector<float>         isolation, d0, dz;
+      std::vector<int>           validMuonHits, matchedStations, validPixelHits, trackerLayers;
+      std::vector<unsigned char> isGlobal, isTracker, isPF;
+
+      std::size_t size() const { return pt.size(); }
+      void resize(std::size_t n) {
+        pt.resize(n); absEta.resize(n); normalizedChi2.resize(n);
+        isolation.resize(n); d0.resize(n); dz.resize(n);
+        validMuonHits.resize(n); matchedStations.resize(n); validPixelHits.resize(n); trackerLayers.resize(n);
+        isGlobal.resize(n); isTracker.resize(n); isPF.resize(n);
+      }
+    };
+
+    inline void evaluate(const Variables& v, std::vector<int>& masks) {
+      const std::size_t n = v.size();
+      masks.assign(n, 0);
+      for (std::size_t i = 0; i < n; i++) {
+        if (!(v.pt[i] > 20) || !(v.absEta[i] < 2.4) || !v.isPF[i]) continue;
+
+//https://twiki.cern.ch/twiki/bin/view/CMS/SWGuideMuonIdRun2#Muon_Isolation
+        const bool isTight = v.isGlobal[i] && v.normalizedChi2[i] < 10 && v.validMuonHits[i] > 0
+                          && v.matchedStations[i] > 1 && v.d0[i] < 0.2 && v.dz[i] < 0.5
+                          && v.validPixelHits[i] > 0 && v.trackerLayers[i] > 5 && v.isolation[i] < 0.15;
+        const bool isLoose = (v.isGlobal[i] || v.isTracker[i]) && v.isolation[i] < 0.25;
+
+        masks[i] = (isTight ? wp::MuTight : 0) | (isLoose ? wp::MuLoose : 0);
+      }
+    }
+
+  }
+
+  namespace electronId {
+
+    // one working point in one ECAL region
+    struct Cuts {
+      int    missingHits;
+      double isolation, sigmaIEtaIEta, dPhiIn, dEtaIn, hoe, ooemoop, d0, dz;
+    };
+
+    // 2016 data cut-based ID, [working point][EB, EE]; the working point
+    // index is the bit of pku::wp::Electron.  The Spring15 values are in the
+    // history of ElectronIdSelector.cc.
+    const int nWP = 4;
+    static const Cuts cuts2016[nWP][2] = {
+      // tight  (WP70)
+      { { 1, 0.0588, 0.00998, 0.0816, 0.00308, 0.0414, 0.0129, 0.05, 0.10 },
+        { 1, 0.0571, 0.0292,  0.0394, 0.00605, 0.0641, 0.0129, 0.10, 0.20 } },
+      // medium (WP80)
+      { { 1, 0.0695, 0.00998, 0.103,  0.00311, 0.253,  0.134,  0.05, 0.10 },
+        { 1, 0.0821, 0.0298,  0.045,  0.00609, 0.0878, 0.13,   0.10, 0.20 } },
+      // loose  (WP90)
+      { { 1, 0.0994, 0.011,   0.222,  0.00477, 0.298,  0.241,  0.05, 0.10 },
+        { 1, 0.107,  0.0314,  0.213,  0.00868, 0.101,  0.14,   0.10, 0.20 } },
+      // veto
+      { { 2, 0.175,  0.0115,  0.228,  0.00749, 0.356,  0.299,  0.05, 0.10 },
+        { 3, 0.159,  0.037,   0.213,  0.00895, 0.211,  0.15,   0.10, 0.20 } }
+    };
+
+    struct Variables {
+      std::vector<float>         pt, isolation, d0, dz;
+      std::vector<double>        sigmaIEtaIEta, dPhiIn, dEtaIn, hoe, ooemoop;
+      std::vector<int>           missingHits;
+      std::vector<unsigned char> region;           // 0 outside, 1 EB, 2 EE
+      std::vector<unsigned char> conversionVeto;
+
+      std::size_t size() const { return pt.size(); }
+      void resize(std::size_t n) {
+        pt.resize(n); isolation.resize(n); d0.resize(n); dz.resize(n);
+        sigmaIEtaIEta.resize(n); dPhiIn.resize(n); dEtaIn.resize(n); hoe.resize(n); ooemoop.resize(n);
+        missingHits.resize(n); region.resize(n); conversionVeto.resize(n);
+      }
+    };
+
+    inline void evaluate(const Variables& v, std::vector<int>& masks) {
+      const std::size_t n = v.size();
+      masks.assign(n, 0);
+      for (std::size_t i = 0; i < n; i++) {
+        const int region = v.region[i];
+        if (!region || !(v.pt[i] > 20.) || !v.conversionVeto[i]) continue;
+        int mask = 0;
+        for (int w = 0; w < nWP; w++) {
+          const Cuts& c = cuts2016[w][region-1];
+          const bool pass = v.missingHits[i] <= c.missingHits && v.isolation[i] < c.isolation
+                         && v.sigmaIEtaIEta[i] < c.sigmaIEtaIEta && v.dPhiIn[i] < c.dPhiIn && v.dEtaIn[i] < c.dEtaIn
+                         && v.hoe[i] < c.hoe && v.ooemoop[i] < c.ooemoop && v.d0[i] < c.d0 && v.dz[i] < c.dz;
+          mask |= pass << w;
+        }
+        masks[i] = mask;
+      }
+    }
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef VAJets_PKUCommon_LeptonWP_h
+#define VAJets_PKUCommon_LeptonWP_h
+//
+// Package:    VAJets/PKUCommon
+//
+/**
+ Description: bits of the "wpMask" products of PATElectronIdSelector and
+ PATMuonIdSelector, an edm::ValueMap<int> on the source collection whose
+ values fit in 8 bits, and the idLabel spellings the selectors accept.
+
+     edm::Handle<edm::ValueMap<int> > masks;
+     iEvent.getByToken(maskToken_, masks);
+     if ((*masks)[electrons->ptrAt(i)] & pku::wp::EleVeto) ...
+*/
+//
+
+#include <string>
+
+namespace pku {
+
+  namespace wp {
+
+    enum Electron { EleTight = 1<<0, EleMedium = 1<<1, EleLoose = 1<<2, EleVeto = 1<<3 };
+    enum Muon     { MuTight  = 1<<0, MuLoose   = 1<<1 };
+
+    // 0 for an unknown label
+    inline int electronBit(const std::string& label) {
+      if (label == "tight"  || label == "Tight"  || label == "TIGHT"  || label == "WP70" || label == "wp70") return EleTight;
+      if (label == "medium" || label == "Medium" || label == "MEDIUM" || label == "WP80" || label == "wp80") return EleMedium;
+      if (label == "loose"  || label == "Loose"  || label == "LOOSE"  || label == "WP90" || label == "wp90") return EleLoose;
+      if (label == "veto"   || label == "Veto"   || label == "VETO"   || label == "VETOid" || label == "VetoId") return EleVeto;
+      return 0;
+    }
+
+    inline int muonBit(const std::string& label) {
+      if (label == "tight" || label == "Tight" || label == "TIGHT" || label == "WP70" || label == "wp70") return MuTight;
+      if (label == "loose" || label == "Loose" || label == "LOOSE" || label == "WP90" || label == "wp90") return MuLoose;
+      return 0;
+    }
+
+  }
+
+}
+
+#endif
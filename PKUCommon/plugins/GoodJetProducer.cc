@@ -0,0 +1,303 @@
+
+/*****************************************************************************
+ * Project: CMS detector at the CERN
+ *
+ * Package: ElectroWeakAnalysis/VPlusJets
+ *
+ *
+ * Authors:
+ *
+ *   PKU
+ *
+ * Description:
+ *   - Prepares the AK4 jets of the tree makers in one pass over src
+ *     (slimmedJets): PF jet ID, overlap removal and JEC, written as a
+ *     single std::vector<pat::Jet> instead of the JetUserData ->
+ *     goodAK4Jets -> cleanAK4Jets chain of copies.
+ *   - Jet ID: the loose (or tight) RUNIISTARTUP cuts of
+ *     PFJetIDSelectionFunctor, the default of pfJetIDSelector_cfi.
+ *   - Overlaps: each checkOverlaps entry gives a collection (src, any
+ *     edm::View of reco::Candidate) and a deltaR.  The source PF candidates
+ *     of its objects are looked up among the jet constituents; an object
+ *     without one in the jets' PF collection falls back to deltaR.
+ *   - JEC: the payloads of jecAK4chsPayloadNames (and jecEras, see
+ *     JecRegistry.h) on the raw jet; the factor is stored as userFloat
+ *     "jetCorrFactor" and ptMin/etaMax apply to the corrected jet.  The jet
+ *     four-momentum keeps the MiniAOD correction so that correctedP4(0)
+ *     still gives the raw jet to the tree makers.
+ *   - Not a drop-in replacement: the pt cut is on the new-JEC pt (the chain
+ *     cuts pt > 20 on the MiniAOD pt), the leptons are matched by PF key
+ *     before deltaR < 0.4, and the jet ID is written out here rather than
+ *     taken from PFJetIDSelectionFunctor.  The production configs keep the
+ *     chain until pkuDiffNtuples shows the same ntuples.
+ *   - Timing: the optional "timing" PSet, see StageTimer.h.
+ * History:
+ *
+ *
+ *****************************************************************************/
+////////////////////////////////////////////////////////////////////////////////
+// Includes
+////////////////////////////////////////////////////////////////////////////////
+#include "FWCore/Framework/interface/EDProducer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "DataFormats/Common/interface/View.h"
+#include "DataFormats/Candidate/interface/Candidate.h"
+#include "DataFormats/Math/interface/deltaR.h"
+#include "DataFormats/PatCandidates/interface/Jet.h"
+#include "DataFormats/VertexReco/interface/Vertex.h"
+#include "DataFormats/VertexReco/interface/VertexFwd.h"
+#include "CondFormats/JetMETObjects/interface/FactorizedJetCorrector.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "VAJets/PKUTreeMaker/interface/JecRegistry.h"
+#include "VAJets/PKUTreeMaker/interface/StageTimer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <sstream>
+
+////////////////////////////////////////////////////////////////////////////////
+// class definition
+////////////////////////////////////////////////////////////////////////////////
+class GoodJetProducer : public edm::EDProducer
+{
+public:
+  // construction/destruction
+  GoodJetProducer(const edm::ParameterSet& iConfig);
+  virtual ~GoodJetProducer() {}
+
+  // member functions
+  void produce(edm::Event& iEvent,const edm::EventSetup& iSetup);
+  void endJob();
+
+private:
+  // an object without a source PF candidate among the jet constituents
+  struct Fallback {
+    float eta, phi, dR2;
+  };
+
+  bool passJetId(const pat::Jet& jet) const;
+  void collectOverlaps(edm::Event& iEvent, const edm::ProductID& pfProduct);
+  int  overlap(const pat::Jet& jet, const edm::ProductID& pfProduct) const;
+
+  // member data
+  std::string    moduleLabel_;
+  bool           tightId_;
+  double         ptMin_;
+  double         etaMax_;
+  pku::JecRegistry jecAK4chs_;
+
+  std::vector<edm::EDGetTokenT<edm::View<reco::Candidate> > > overlapTokens_;
+  std::vector<double> overlapDeltaR_;
+
+  std::vector<unsigned int> overlapKeys_;   // sorted, reused between events
+  std::vector<Fallback>     fallbacks_;
+
+  unsigned int nEvents_;
+  unsigned int nTot_;
+  unsigned int nFailId_;
+  unsigned int nOverlapKey_;
+  unsigned int nOverlapDR_;
+  unsigned int nPassed_;
+  pku::StageTimer timer_;   // "timing" PSet, see StageTimer.h
+  size_t       stageOverlaps_, stageJets_, stagePut_, countJets_;
+  edm::EDGetTokenT<std::vector<pat::Jet> > jetToken_;
+  edm::EDGetTokenT<double> rhoToken_;
+  edm::EDGetTokenT<reco::VertexCollection> vertexToken_;
+};
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// construction/destruction
+////////////////////////////////////////////////////////////////////////////////
+
+//______________________________________________________________________________
+GoodJetProducer::GoodJetProducer(const edm::ParameterSet& iConfig)
+  : moduleLabel_(iConfig.getParameter<std::string>   ("@module_label"))
+  , tightId_(false)
+  , ptMin_(iConfig.existsAs<double>("ptMin") ? iConfig.getParameter<double>("ptMin") : 20.)
+  , etaMax_(iConfig.existsAs<double>("etaMax") ? iConfig.getParameter<double>("etaMax") : 4.7)
+  , jecAK4chs_(iConfig, "jecAK4chsPayloadNames")
+  , nEvents_(0)
+  , nTot_(0)
+  , nFailId_(0)
+  , nOverlapKey_(0)
+  , nOverlapDR_(0)
+  , nPassed_(0)
+  , jetToken_ (consumes<std::vector<pat::Jet> > (iConfig.getParameter<edm::InputTag>( "src" ) ) )
+  , rhoToken_ (consumes<double> (iConfig.getParameter<edm::InputTag>( "rho" ) ) )
+  , vertexToken_ (consumes<reco::VertexCollection> (iConfig.getParameter<edm::InputTag>( "vertex" ) ) )
+{
+  std::string jetId = iConfig.existsAs<std::string>("jetId") ? iConfig.getParameter<std::string>("jetId") : "loose";
+  if (jetId == "tight") tightId_ = true;
+  else if (jetId != "loose")
+    throw cms::Exception("Configuration") << moduleLabel_ << ": unknown jetId " << jetId << " (loose|tight)";
+
+  if (iConfig.existsAs<std::vector<edm::ParameterSet> >("checkOverlaps")) {
+    const std::vector<edm::ParameterSet> overlaps = iConfig.getParameter<std::vector<edm::ParameterSet> >("checkOverlaps");
+    for (size_t i = 0; i < overlaps.size(); i++) {
+      overlapTokens_.push_back(consumes<edm::View<reco::Candidate> >(overlaps[i].getParameter<edm::InputTag>("src")));
+      overlapDeltaR_.push_back(overlaps[i].existsAs<double>("deltaR") ? overlaps[i].getParameter<double>("deltaR") : 0.4);
+    }
+  }
+
+  if (iConfig.existsAs<edm::ParameterSet>("timing"))
+    timer_ = pku::StageTimer(moduleLabel_, iConfig.getParameter<edm::ParameterSet>("timing"));
+  stageOverlaps_ = timer_.stage("overlaps");
+  stageJets_     = timer_.stage("jets");
+  stagePut_      = timer_.stage("put");
+  countJets_     = timer_.counter("jets");
+
+  produces<std::vector<pat::Jet> >();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// implementation of member functions
+////////////////////////////////////////////////////////////////////////////////
+
+//______________________________________________________________________________
+void GoodJetProducer::produce(edm::Event& iEvent,const edm::EventSetup& iSetup)
+{
+  edm::Handle<std::vector<pat::Jet> > jets;
+  iEvent.getByToken(jetToken_, jets);
+  edm::Handle<double> rho;
+  iEvent.getByToken(rhoToken_, rho);
+  edm::Handle<reco::VertexCollection> vertices;
+  iEvent.getByToken(vertexToken_, vertices);
+
+  timer_.enter(stageOverlaps_);
+  // the keys only mean something in the collection the jet constituents come from
+  edm::ProductID pfProduct;
+  for (size_t i = 0; i < jets->size() && !pfProduct.isValid(); i++)
+    if ((*jets)[i].numberOfDaughters() != 0) pfProduct = (*jets)[i].daughterPtr(0).id();
+  collectOverlaps(iEvent, pfProduct);
+
+  timer_.enter(stageJets_);
+  FactorizedJetCorrector* jecAK4 = jecAK4chs_.corrector(iEvent.id().run());
+
+  std::auto_ptr<std::vector<pat::Jet> > passing(new std::vector<pat::Jet>);
+  for (size_t i = 0; i < jets->size(); i++) {
+    const pat::Jet& jet = (*jets)[i];
+    if (!passJetId(jet)) { ++nFailId_; continue; }
+
+    const reco::Candidate::LorentzVector rawJetP4 = jet.correctedP4(0);
+    jecAK4->setJetEta( rawJetP4.eta() );
+    jecAK4->setJetPt ( rawJetP4.pt() );
+    jecAK4->setJetE  ( rawJetP4.energy() );
+    jecAK4->setJetPhi( rawJetP4.phi() );
+    jecAK4->setJetA  ( jet.jetArea() );
+    jecAK4->setRho   ( *rho );
+    jecAK4->setNPV   ( vertices->size() );
+    const double jetCorrFactor = jecAK4->getCorrection();
+    if (jetCorrFactor*rawJetP4.pt() <= ptMin_ || std::abs(rawJetP4.eta()) >= etaMax_) continue;
+
+    const int found = overlap(jet, pfProduct);
+    if (found == 1) { ++nOverlapKey_; continue; }
+    if (found == 2) { ++nOverlapDR_; continue; }
+
+    passing->push_back(jet);
+    passing->back().addUserFloat("jetCorrFactor", jetCorrFactor);
+  }
+
+  timer_.enter(stagePut_);
+  timer_.count(countJets_, jets->size());
+  ++nEvents_;
+  nTot_    += jets->size();
+  nPassed_ += passing->size();
+  iEvent.put(passing);
+  timer_.stop();
+}
+
+
+//______________________________________________________________________________
+bool GoodJetProducer::passJetId(const pat::Jet& jet) const
+{
+  // PFJetIDSelectionFunctor, version RUNIISTARTUP
+  const double absEta = std::abs(jet.eta());
+  const double maxNeutral = tightId_ ? 0.90 : 0.99;
+  if (absEta <= 3.0) {
+    if (jet.neutralHadronEnergyFraction() >= maxNeutral) return false;
+    if (jet.neutralEmEnergyFraction() >= maxNeutral) return false;
+    if (jet.numberOfDaughters() <= 1) return false;
+    if (absEta <= 2.4) {
+      if (jet.chargedHadronEnergyFraction() <= 0.) return false;
+      if (jet.chargedMultiplicity() <= 0) return false;
+      if (jet.chargedEmEnergyFraction() >= 0.99) return false;
+    }
+  } else {
+    if (jet.neutralEmEnergyFraction() >= 0.90) return false;
+    if (jet.neutralMultiplicity() <= 10) return false;
+  }
+  return true;
+}
+
+
+//______________________________________________________________________________
+void GoodJetProducer::collectOverlaps(edm::Event& iEvent, const edm::ProductID& pfProduct)
+{
+  overlapKeys_.clear();
+  fallbacks_.clear();
+  for (size_t t = 0; t < overlapTokens_.size(); t++) {
+    edm::Handle<edm::View<reco::Candidate> > objects;
+    iEvent.getByToken(overlapTokens_[t], objects);
+    for (size_t i = 0; i < objects->size(); i++) {
+      const reco::Candidate& object = (*objects)[i];
+      bool keyed = false;
+      for (size_t s = 0; s < object.numberOfSourceCandidatePtrs(); s++) {
+        const reco::CandidatePtr source = object.sourceCandidatePtr(s);
+        if (source.isNonnull() && source.id() == pfProduct) {
+          overlapKeys_.push_back(source.key());
+          keyed = true;
+        }
+      }
+      if (!keyed) {
+        const Fallback f = { float(object.eta()), float(object.phi()), float(overlapDeltaR_[t]*overlapDeltaR_[t]) };
+        fallbacks_.push_back(f);
+      }
+    }
+  }
+  std::sort(overlapKeys_.begin(), overlapKeys_.end());
+}
+
+
+//______________________________________________________________________________
+// 0: none, 1: a constituent is the PF candidate of an object, 2: an object
+// without PF candidate is within its deltaR
+int GoodJetProducer::overlap(const pat::Jet& jet, const edm::ProductID& pfProduct) const
+{
+  if (!overlapKeys_.empty()) {
+    for (size_t d = 0; d < jet.numberOfDaughters(); d++) {
+      const reco::CandidatePtr constituent = jet.daughterPtr(d);
+      if (constituent.id() == pfProduct && std::binary_search(overlapKeys_.begin(), overlapKeys_.end(), (unsigned int) constituent.key())) return 1;
+    }
+  }
+  for (size_t f = 0; f < fallbacks_.size(); f++)
+    if (reco::deltaR2(jet.eta(), jet.phi(), fallbacks_[f].eta, fallbacks_[f].phi) < fallbacks_[f].dR2) return 2;
+  return 0;
+}
+
+
+//______________________________________________________________________________
+void GoodJetProducer::endJob()
+{
+  std::stringstream ss;
+  ss<<"nTot="<<nTot_<<" nFailId="<<nFailId_<<" nOverlapKey="<<nOverlapKey_<<" nOverlapDR="<<nOverlapDR_
+    <<" nPassed="<<nPassed_<<" effPassed="<<(nTot_ ? 100.*(nPassed_/(double)nTot_) : 0.)<<"%\n";
+  jecAK4chs_.printSummary(ss);
+  timer_.printSummary(ss);
+  edm::LogInfo("GoodJetProducer")<<moduleLabel_<<" SUMMARY ("<<nEvents_<<" events):\n"<<ss.str();
+  timer_.writeReport();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// plugin definition
+////////////////////////////////////////////////////////////////////////////////
+#include "FWCore/Framework/interface/MakerMacros.h"
+DEFINE_FWK_MODULE(GoodJetProducer);
@@ -0,0 +1,188 @@
+
+/*****************************************************************************
+ * Project: CMS detector at the CERN
+ *
+ * Package: ElectroWeakAnalysis/VPlusJets
+ *
+ *
+ * Authors:
+ *
+ *   PKU
+ *
+ * Description:
+ *   - Removes the jets that contain a selected lepton, by PF-candidate key
+ *     instead of a deltaR cone.
+ *   - src are the jets of a JetUserData module, read together with its
+ *     "pfKeyOffsets"/"pfKeys" products (constituents = that module's label,
+ *     src by default); see VAJets/PKUTreeMaker/interface/JetConstituentKeys.h.
+ *   - The source PF candidates of the "leptons" (any edm::View of
+ *     reco::Candidate, e.g. goodMuons and goodElectrons) are collected once
+ *     per event; a jet is dropped if one of them is among its constituents.
+ *   - cut (optional) is applied to the jets before the lookup.
+ *   - Writes a std::vector<pat::Jet>.
+ *   - Timing: the optional "timing" PSet, see StageTimer.h.
+ * History:
+ *
+ *
+ *****************************************************************************/
+////////////////////////////////////////////////////////////////////////////////
+// Includes
+////////////////////////////////////////////////////////////////////////////////
+#include "FWCore/Framework/interface/EDProducer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "DataFormats/Common/interface/View.h"
+#include "DataFormats/Candidate/interface/Candidate.h"
+#include "DataFormats/PatCandidates/interface/Jet.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "CommonTools/Utils/interface/StringCutObjectSelector.h"
+#include "VAJets/PKUTreeMaker/interface/JetConstituentKeys.h"
+#include "VAJets/PKUTreeMaker/interface/StageTimer.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <sstream>
+
+////////////////////////////////////////////////////////////////////////////////
+// class definition
+////////////////////////////////////////////////////////////////////////////////
+class JetConstituentCleaner : public edm::EDProducer
+{
+public:
+  // construction/destruction
+  JetConstituentCleaner(const edm::ParameterSet& iConfig);
+  virtual ~JetConstituentCleaner() {}
+
+  // member functions
+  void produce(edm::Event& iEvent,const edm::EventSetup& iSetup);
+  void endJob();
+
+private:
+  // member data
+  std::string    moduleLabel_;
+  StringCutObjectSelector<pat::Jet> cut_;
+
+  std::vector<unsigned int> leptonKeys_;   // reused between events
+
+  unsigned int nEvents_;
+  unsigned int nTot_;
+  unsigned int nPassed_;
+  unsigned int nOverlap_;
+  pku::StageTimer timer_;   // "timing" PSet, see StageTimer.h
+  size_t       stageLeptons_, stageJets_, stagePut_, countJets_;
+  edm::EDGetTokenT<std::vector<pat::Jet> > jetToken_;
+  edm::EDGetTokenT<std::vector<unsigned int> > keyOffsetsToken_;
+  edm::EDGetTokenT<std::vector<unsigned int> > keysToken_;
+  std::vector<edm::EDGetTokenT<edm::View<reco::Candidate> > > leptonTokens_;
+};
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// construction/destruction
+////////////////////////////////////////////////////////////////////////////////
+
+//______________________________________________________________________________
+JetConstituentCleaner::JetConstituentCleaner(const edm::ParameterSet& iConfig)
+  : moduleLabel_(iConfig.getParameter<std::string>   ("@module_label"))
+  , cut_(iConfig.existsAs<std::string>("cut") ? iConfig.getParameter<std::string>("cut") : "", true)
+  , nEvents_(0)
+  , nTot_(0)
+  , nPassed_(0)
+  , nOverlap_(0)
+  , jetToken_ (consumes<std::vector<pat::Jet> > (iConfig.getParameter<edm::InputTag>( "src" ) ) )
+{
+  const edm::InputTag src = iConfig.getParameter<edm::InputTag>("src");
+  const edm::InputTag constituents = iConfig.existsAs<edm::InputTag>("constituents") ? iConfig.getParameter<edm::InputTag>("constituents") : src;
+  keyOffsetsToken_ = consumes<std::vector<unsigned int> >(edm::InputTag(constituents.label(), "pfKeyOffsets", constituents.process()));
+  keysToken_       = consumes<std::vector<unsigned int> >(edm::InputTag(constituents.label(), "pfKeys", constituents.process()));
+
+  const std::vector<edm::InputTag> leptons = iConfig.getParameter<std::vector<edm::InputTag> >("leptons");
+  for (size_t i = 0; i < leptons.size(); i++) leptonTokens_.push_back(consumes<edm::View<reco::Candidate> >(leptons[i]));
+
+  if (iConfig.existsAs<edm::ParameterSet>("timing"))
+    timer_ = pku::StageTimer(moduleLabel_, iConfig.getParameter<edm::ParameterSet>("timing"));
+  stageLeptons_ = timer_.stage("leptons");
+  stageJets_    = timer_.stage("jets");
+  stagePut_     = timer_.stage("put");
+  countJets_    = timer_.counter("jets");
+
+  produces<std::vector<pat::Jet> >();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// implementation of member functions
+////////////////////////////////////////////////////////////////////////////////
+
+//______________________________________________________________________________
+void JetConstituentCleaner::produce(edm::Event& iEvent,const edm::EventSetup& iSetup)
+{
+  edm::Handle<std::vector<pat::Jet> > jets;
+  iEvent.getByToken(jetToken_, jets);
+  edm::Handle<std::vector<unsigned int> > keyOffsets, keys;
+  iEvent.getByToken(keyOffsetsToken_, keyOffsets);
+  iEvent.getByToken(keysToken_, keys);
+
+  timer_.enter(stageLeptons_);
+  const pku::JetConstituentKeys constituents(*keyOffsets, *keys);
+  if (constituents.nJets() != jets->size())
+    throw cms::Exception("Configuration") << moduleLabel_ << ": keys of " << constituents.nJets() << " jets for "
+                                          << jets->size() << " src jets; src must be the jets of the constituents module";
+
+  // the keys only mean something in the collection the jet constituents come from
+  edm::ProductID pfProduct;
+  for (size_t i = 0; i < jets->size() && !pfProduct.isValid(); i++)
+    if ((*jets)[i].numberOfDaughters() != 0) pfProduct = (*jets)[i].daughterPtr(0).id();
+
+  leptonKeys_.clear();
+  for (size_t t = 0; t < leptonTokens_.size(); t++) {
+    edm::Handle<edm::View<reco::Candidate> > leptons;
+    iEvent.getByToken(leptonTokens_[t], leptons);
+    for (size_t i = 0; i < leptons->size(); i++) {
+      const reco::Candidate& lepton = (*leptons)[i];
+      for (size_t s = 0; s < lepton.numberOfSourceCandidatePtrs(); s++) {
+        const reco::CandidatePtr source = lepton.sourceCandidatePtr(s);
+        if (source.isNonnull() && source.id() == pfProduct) leptonKeys_.push_back(source.key());
+      }
+    }
+  }
+
+  timer_.enter(stageJets_);
+  std::auto_ptr<std::vector<pat::Jet> > passing(new std::vector<pat::Jet>);
+  for (size_t i = 0; i < jets->size(); i++) {
+    if (!cut_((*jets)[i])) continue;
+    if (constituents.overlaps(i, leptonKeys_.begin(), leptonKeys_.end())) { ++nOverlap_; continue; }
+    passing->push_back((*jets)[i]);
+  }
+
+  timer_.enter(stagePut_);
+  timer_.count(countJets_, jets->size());
+  ++nEvents_;
+  nTot_    += jets->size();
+  nPassed_ += passing->size();
+  iEvent.put(passing);
+  timer_.stop();
+}
+
+
+//______________________________________________________________________________
+void JetConstituentCleaner::endJob()
+{
+  std::stringstream ss;
+  ss<<"nTot="<<nTot_<<" nPassed="<<nPassed_<<" nOverlap="<<nOverlap_
+    <<" effPassed="<<(nTot_ ? 100.*(nPassed_/(double)nTot_) : 0.)<<"%\n";
+  timer_.printSummary(ss);
+  edm::LogInfo("JetConstituentCleaner")<<moduleLabel_<<" SUMMARY ("<<nEvents_<<" events):\n"<<ss.str();
+  timer_.writeReport();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// plugin definition
+////////////////////////////////////////////////////////////////////////////////
+#include "FWCore/Framework/interface/MakerMacros.h"
+DEFINE_FWK_MODULE(JetConstituentCleaner);
@@ -7,14 +7,30 @@
  *
  * Authors:
  *
- *   PKU 
+ *   PKU
  *
  * Description:
  *   - Selects "loose" and "tight" muons needed for V-boson analysis.
- *   - Saves collection of the reference vectors of muons passing the 
+ *   - Saves collection of the reference vectors of muons passing the
  *     required muon ID.
+ *   - The ID variables of all the muons are read once into one array per
+ *     variable, and the tight and loose working points are evaluated
+ *     together into a per-muon bitmask (pku::wp::Muon bits) by
+ *     pku::muonId::evaluate (LeptonIdKernels.h).
+ *   - idLabel = "tight" writes one collection with the muons of that
+ *     working point.  selections = cms.PSet(good = cms.string("tight"),
+ *     loose = cms.string("loose")) instead writes one collection per
+ *     entry, as product instances "good", "loose", ... of the same module.
+ *   - output = "copy" (default) writes a std::vector<pat::Muon>,
+ *     output = "refs" a pat::MuonRefVector into the source collection;
+ *     both are read as edm::View<pat::Muon> / edm::View<reco::Candidate>.
+ *   - wpMask = True also writes the bitmasks as an edm::ValueMap<int>
+ *     ("wpMask") on the source collection.
+ *   - lumiSummary = True writes a LumiSummary tree (LumiSummary.h) in the
+ *     TFileService directory of the module: per luminosity block the
+ *     events, the muons and the muons passing every output collection.
  * History:
- *   
+ *
  *
  *****************************************************************************/
 ////////////////////////////////////////////////////////////////////////////////
@@ -25,10 +41,22 @@
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/Utilities/interface/InputTag.h"
 #include "DataFormats/PatCandidates/interface/Muon.h"
+#include "DataFormats/PatCandidates/interface/MuonFwd.h"
+#include "DataFormats/Common/interface/RefVector.h"
 #include "DataFormats/Common/interface/View.h"
 #include "DataFormats/VertexReco/interface/Vertex.h"
 #include "DataFormats/VertexReco/interface/VertexFwd.h"
 #include "DataFormats/Common/interface/ValueMap.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "VAJets/PKUCommon/interface/LeptonIdKernels.h"
+#include "VAJets/PKUCommon/interface/LeptonWP.h"
+#include "VAJets/PKUTreeMaker/interface/LumiSummary.h"
+#include "VAJets/PKUTreeMaker/interface/StageTimer.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/Framework/interface/LuminosityBlock.h"
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "CommonTools/UtilAlgos/interface/TFileService.h"
+#include "TTree.h"
 
 #include <memory>
 #include <vector>
@@ -44,21 +72,41 @@ public:
   // construction/destruction
   MuonIdSelector(const edm::ParameterSet& iConfig);
   virtual ~MuonIdSelector();
-  
+
   // member functions
   void produce(edm::Event& iEvent,const edm::EventSetup& iSetup);
+  void endLuminosityBlock(edm::LuminosityBlock const& lumi, edm::EventSetup const& iSetup);
   void endJob();
 
-private:  
+private:
+  // an output collection and the working point it requires
+  struct Selection {
+    std::string  instance;
+    int          required;
+    unsigned int nPassed;
+    size_t       summaryPassed;
+  };
+
+  void fill(const pat::MuonCollection& muons, const reco::VertexCollection& vtxs);
+
   // member data
   // edm::InputTag  src_;
   std::string    moduleLabel_;
-  std::string    idLabel_;  
-  bool           applyTightID_;
-  bool           applyLooseID_;
+  bool           refs_;
+  bool           wpMask_;
+  std::vector<Selection> selections_;
+
+  pku::muonId::Variables vars_;   // reused between events
+  std::vector<int> masks_;
 
   unsigned int nTot_;
-  unsigned int nPassed_;
+  unsigned int nEvents_;
+  unsigned int nTight_;
+  unsigned int nLoose_;
+  pku::StageTimer timer_;   // "timing" PSet, see StageTimer.h
+  size_t       stageFill_, stageEvaluate_, stageWrite_, countCandidates_;
+  pku::LumiSummary summary_;   // "lumiSummary", see LumiSummary.h
+  size_t       summaryCandidates_;
   edm::EDGetTokenT<pat::MuonCollection> MuonToken_;
   edm::EDGetTokenT<reco::VertexCollection> VertexToken_;
 };
@@ -73,33 +121,59 @@ private:
 MuonIdSelector::MuonIdSelector(const edm::ParameterSet& iConfig)
 //  : src_    (iConfig.getParameter<edm::InputTag>     ("src"))
   : moduleLabel_(iConfig.getParameter<std::string>   ("@module_label"))
-  , idLabel_(iConfig.existsAs<std::string>("idLabel") ? iConfig.getParameter<std::string>("idLabel") : "loose")
+  , refs_(false)
+  , wpMask_(iConfig.existsAs<bool>("wpMask") ? iConfig.getParameter<bool>("wpMask") : false)
   , nTot_(0)
-  , nPassed_(0)
-  , MuonToken_ (consumes<pat::MuonCollection> (iConfig.getParameter<edm::InputTag>( "src" ) ) ) 
+  , nEvents_(0)
+  , nTight_(0)
+  , nLoose_(0)
+  , MuonToken_ (consumes<pat::MuonCollection> (iConfig.getParameter<edm::InputTag>( "src" ) ) )
   , VertexToken_ (consumes<reco::VertexCollection> (iConfig.getParameter<edm::InputTag>( "vertex" ) ) )
 
 {
-  produces<std::vector<pat::Muon> >();
+  std::string output = iConfig.existsAs<std::string>("output") ? iConfig.getParameter<std::string>("output") : "copy";
+  if (output == "refs") refs_ = true;
+  else if (output != "copy")
+    throw cms::Exception("Configuration") << moduleLabel_ << ": unknown output " << output << " (copy|refs)";
 
   /// ------- Decode the ID criteria --------
-  applyTightID_ = false;
-  applyLooseID_ = false;
-
-  if( (idLabel_.compare("tight")==0) || 
-      (idLabel_.compare("Tight")==0) || 
-      (idLabel_.compare("TIGHT")==0) ||
-      (idLabel_.compare("WP70")==0) ||
-      (idLabel_.compare("wp70")==0) )  
-    applyTightID_ = true;
-  else if( (idLabel_.compare("loose")==0) || 
-      (idLabel_.compare("Loose")==0) || 
-      (idLabel_.compare("LOOSE")==0) ||
-      (idLabel_.compare("WP90")==0) ||
-      (idLabel_.compare("wp90")==0) )  applyLooseID_ = true;
+  std::vector<std::pair<std::string, std::string> > labels;
+  if (iConfig.existsAs<edm::ParameterSet>("selections")) {
+    const edm::ParameterSet& selections = iConfig.getParameter<edm::ParameterSet>("selections");
+    const std::vector<std::string> names = selections.getParameterNamesForType<std::string>();
+    for (size_t i = 0; i < names.size(); i++) labels.push_back(std::make_pair(names[i], selections.getParameter<std::string>(names[i])));
+  } else {
+    labels.push_back(std::make_pair(std::string(), iConfig.existsAs<std::string>("idLabel") ? iConfig.getParameter<std::string>("idLabel") : "loose"));
+  }
+  for (size_t i = 0; i < labels.size(); i++) {
+    Selection sel;
+    sel.instance = labels[i].first;
+    sel.required = pku::wp::muonBit(labels[i].second);
+    sel.nPassed  = 0;
+    sel.summaryPassed = summary_.counter("pass_" + (sel.instance.empty() ? labels[i].second : sel.instance));
+    if (!sel.required)
+      throw cms::Exception("Configuration") << moduleLabel_ << ": unknown muon ID " << labels[i].second;
+    selections_.push_back(sel);
+    if (refs_) produces<pat::MuonRefVector>(sel.instance);
+    else produces<std::vector<pat::Muon> >(sel.instance);
+  }
+  if (wpMask_) produces<edm::ValueMap<int> >("wpMask");
+
+  if (iConfig.existsAs<edm::ParameterSet>("timing"))
+    timer_ = pku::StageTimer(moduleLabel_, iConfig.getParameter<edm::ParameterSet>("timing"));
+  stageFill_       = timer_.stage("fill");
+  stageEvaluate_   = timer_.stage("evaluate");
+  stageWrite_      = timer_.stage("write");
+  countCandidates_ = timer_.counter("muons");
+
+  summaryCandidates_ = summary_.counter("muons");
+  if (iConfig.existsAs<bool>("lumiSummary") && iConfig.getParameter<bool>("lumiSummary")) {
+    edm::Service<TFileService> fs;
+    summary_.attach(fs->make<TTree>(pku::LumiSummary::treeName(), pku::LumiSummary::treeTitle()));
+  }
 }
 
- 
+
 //______________________________________________________________________________
 MuonIdSelector::~MuonIdSelector(){}
 
@@ -107,103 +181,134 @@ MuonIdSelector::~MuonIdSelector(){}
 ////////////////////////////////////////////////////////////////////////////////
 // implementation of member functions
 ////////////////////////////////////////////////////////////////////////////////
- 
+
 //______________________________________________________________________________
-void MuonIdSelector::produce(edm::Event& iEvent,const edm::EventSetup& iSetup)
+void MuonIdSelector::fill(const pat::MuonCollection& muons, const reco::VertexCollection& vtxs)
 {
+  vars_.resize(muons.size());
+  for(unsigned int iMu=0; iMu<muons.size(); iMu++) {
 
-  /////// Pileup density "rho" in the event from fastJet pileup calculation /////
- 
-  edm::Handle<reco::VertexCollection> vtxs;
-  iEvent.getByToken(VertexToken_, vtxs);
-//  iEvent.getByLabel("offlineSlimmedPrimaryVertices", vtxs);
-
- 
-  std::auto_ptr<std::vector<pat::Muon> > passingMuons(new std::vector<pat::Muon >);
-
-  edm::Handle<pat::MuonCollection > muons;
-  iEvent.getByToken(MuonToken_, muons);  
+    const pat::Muon& mu1 = muons[iMu];
 
-  bool* isPassing = new bool[muons->size()];
+    vars_.pt[iMu]     = mu1.pt();
+    vars_.absEta[iMu] = fabs(mu1.eta());
+    vars_.isolation[iMu] = fabs((mu1.pfIsolationR04().sumChargedHadronPt+ std::max(0.0,mu1.pfIsolationR04().sumNeutralHadronEt+mu1.pfIsolationR04().sumPhotonEt-0.5*mu1.pfIsolationR04().sumPUPt))/mu1.pt());
 
-  for(unsigned int iMu=0; iMu<muons->size(); iMu++) { 
-
-    isPassing[iMu]=false;
-
-    const pat::Muon& mu1 = muons->at(iMu);
-
-  
- 
- 
-    float isolation = 100.;
-    isolation =  (mu1.pfIsolationR04().sumChargedHadronPt+ std::max(0.0,mu1.pfIsolationR04().sumNeutralHadronEt+mu1.pfIsolationR04().sumPhotonEt-0.5*mu1.pfIsolationR04().sumPUPt))/mu1.pt();;
- 
-  
     // impact parameter variables
     float d0vtx         = 0.0;
     float dzvtx         = 0.0;
-
-    if (vtxs->size() > 0) {
-        reco::VertexRef vtx(vtxs, 0);    
-        d0vtx = mu1.muonBestTrack()->dxy(vtx->position());
-        dzvtx = mu1.muonBestTrack()->dz(vtx->position());
+    if (vtxs.size() > 0) {
+        d0vtx = mu1.muonBestTrack()->dxy(vtxs[0].position());
+        dzvtx = mu1.muonBestTrack()->dz(vtxs[0].position());
     } else {
         d0vtx = mu1.muonBestTrack()->dxy();
         dzvtx = mu1.muonBestTrack()->dz();
     }
- 
- 
-
-    bool isTight  = false;  /////// <--- equivalent to WP70
-    bool isLoose  = false;  /////// <--- equivalent to WP90
-
-//https://twiki.cern.ch/twiki/bin/view/CMS/SWGuideMuonIdRun2#Muon_Isolation
-
-  if(mu1.pt()>20 && fabs(mu1.eta())<2.4 && mu1.isGlobalMuon() && mu1.isPFMuon() && (mu1.globalTrack()->normalizedChi2())<10 && (mu1.globalTrack()->hitPattern().numberOfValidMuonHits())>0 && (mu1.numberOfMatchedStations())>1 && fabs(d0vtx)<0.2 && fabs(dzvtx)<0.5 &&/* (mu1.numberOfMatchedStations())>1 && */ (mu1.innerTrack()->hitPattern().numberOfValidPixelHits()) > 0 && (mu1.innerTrack()->hitPattern().trackerLayersWithMeasurement())>5 && fabs(isolation)<0.15) { isTight = true;}
-
-//  if(mu1.pt()>20 && fabs(mu1.eta())<2.1 && mu1.isGlobalMuon() && mu1.isPFMuon() && (mu1.globalTrack()->normalizedChi2())<10 && (mu1.globalTrack()->hitPattern().numberOfValidMuonHits())>0 && (mu1.numberOfMatchedStations())>1 && fabs(d0vtx)<0.2 && fabs(dzvtx)<0.5 && (mu1.numberOfMatchedStations())>1 && (mu1.globalTrack()->hitPattern().trackerLayersWithMeasurement())>5 && fabs(isolation)<0.12) { isTight = true;}
- 
+    vars_.d0[iMu] = fabs(d0vtx);
+    vars_.dz[iMu] = fabs(dzvtx);
+
+    vars_.isGlobal[iMu]  = mu1.isGlobalMuon();
+    vars_.isTracker[iMu] = mu1.isTrackerMuon();
+    vars_.isPF[iMu]      = mu1.isPFMuon();
+    vars_.matchedStations[iMu] = mu1.numberOfMatchedStations();
+    if (mu1.isGlobalMuon()) {
+      vars_.normalizedChi2[iMu] = mu1.globalTrack()->normalizedChi2();
+      vars_.validMuonHits[iMu]  = mu1.globalTrack()->hitPattern().numberOfValidMuonHits();
+      vars_.validPixelHits[iMu] = mu1.innerTrack()->hitPattern().numberOfValidPixelHits();
+      vars_.trackerLayers[iMu]  = mu1.innerTrack()->hitPattern().trackerLayersWithMeasurement();
+    } else {
+      vars_.normalizedChi2[iMu] = 1e9;
+      vars_.validMuonHits[iMu]  = 0;
+      vars_.validPixelHits[iMu] = 0;
+      vars_.trackerLayers[iMu]  = 0;
+    }
+  }
+}
 
-  if(mu1.pt()>20 && fabs(mu1.eta())<2.4  && (mu1.isGlobalMuon() || mu1.isTrackerMuon()) && mu1.isPFMuon() && fabs(isolation)<0.25) { isLoose = true;}
+//______________________________________________________________________________
+void MuonIdSelector::produce(edm::Event& iEvent,const edm::EventSetup& iSetup)
+{
+  edm::Handle<reco::VertexCollection> vtxs;
+  iEvent.getByToken(VertexToken_, vtxs);
 
-    /// ------- Finally apply selection --------
-    if(applyTightID_ && isTight)   isPassing[iMu]= true;
-    if(applyLooseID_ && isLoose)   isPassing[iMu]= true;
- 
-    
- }
- 
+  edm::Handle<pat::MuonCollection > muons;
+  iEvent.getByToken(MuonToken_, muons);
+
+  timer_.enter(stageFill_);
+  fill(*muons, *vtxs);
+  timer_.enter(stageEvaluate_);
+  pku::muonId::evaluate(vars_, masks_);
+  timer_.enter(stageWrite_);
+
+  /// ------- Finally apply selection --------
+  for (size_t s = 0; s < selections_.size(); s++) {
+    Selection& sel = selections_[s];
+    if (refs_) {
+      std::auto_ptr<pat::MuonRefVector> passingMuons(new pat::MuonRefVector);
+      for (unsigned int iMuon = 0; iMuon < muons -> size(); iMuon ++)
+        if (masks_[iMuon] & sel.required) passingMuons->push_back( pat::MuonRef(muons, iMuon) );
+      sel.nPassed += passingMuons->size();
+      summary_.add(sel.summaryPassed, passingMuons->size());
+      iEvent.put(passingMuons, sel.instance);
+    } else {
+      std::auto_ptr<std::vector<pat::Muon> > passingMuons(new std::vector<pat::Muon >);
+      for (unsigned int iMuon = 0; iMuon < muons -> size(); iMuon ++)
+        if (masks_[iMuon] & sel.required) passingMuons->push_back( muons -> at(iMuon) );
+      sel.nPassed += passingMuons->size();
+      summary_.add(sel.summaryPassed, passingMuons->size());
+      iEvent.put(passingMuons, sel.instance);
+    }
+  }
 
- for (unsigned int iMuon = 0; iMuon < muons -> size(); iMuon ++)
-   {     if(isPassing[iMuon]) passingMuons->push_back( muons -> at(iMuon) );  
+  if (wpMask_) {
+    std::auto_ptr<edm::ValueMap<int> > wpMask(new edm::ValueMap<int>);
+    edm::ValueMap<int>::Filler filler(*wpMask);
+    filler.insert(muons, masks_.begin(), masks_.end());
+    filler.fill();
+    iEvent.put(wpMask, "wpMask");
   }
 
-  
-/*  unsigned int counter=0;
-  edm::View<pat::Muon>::const_iterator tIt, endcands = muons->end();
-  for (tIt = muons->begin(); tIt != endcands; ++tIt, ++counter) {
-    if(isPassing[counter]) passingMuons->push_back( *tIt );  
+  for (size_t i = 0; i < masks_.size(); i++) {
+    if (masks_[i] & pku::wp::MuTight) ++nTight_;
+    if (masks_[i] & pku::wp::MuLoose) ++nLoose_;
   }
-*/
   nTot_  +=muons->size();
-  nPassed_+=passingMuons->size();
+  ++nEvents_;
+  timer_.stop();
+  timer_.count(countCandidates_, muons->size());
+  summary_.event();
+  summary_.add(summaryCandidates_, muons->size());
+}
 
-  delete [] isPassing;  
-  iEvent.put(passingMuons);
 
+//______________________________________________________________________________
+void MuonIdSelector::endLuminosityBlock(edm::LuminosityBlock const& lumi, edm::EventSetup const&)
+{
+  summary_.endLumi(lumi.id().run(), lumi.id().luminosityBlock());
 }
 
- 
+
 //______________________________________________________________________________
 void MuonIdSelector::endJob()
 {
   std::stringstream ss;
-  ss<<"nTot="<<nTot_<<" nPassed="<<nPassed_
-    <<" effPassed="<<100.*(nPassed_/(double)nTot_)<<"%\n";
-  std::cout<<"++++++++++++++++++++++++++++++++++++++++++++++++++"
-	   <<"\n"<<moduleLabel_<<"(MuonIdSelector) SUMMARY:\n"<<ss.str()
-	   <<"++++++++++++++++++++++++++++++++++++++++++++++++++"
-	   << std::endl;
+  ss<<"nTot="<<nTot_<<"\n";
+  // every working point, to compare with single-WP instances of this module
+  ss<<"  tight: nPassed="<<nTight_<<" effPassed="<<100.*(nTight_/(double)nTot_)<<"%\n"
+    <<"  loose: nPassed="<<nLoose_<<" effPassed="<<100.*(nLoose_/(double)nTot_)<<"%\n";
+  unsigned int nPassed = 0;
+  for (size_t s = 0; s < selections_.size(); s++) {
+    if (!selections_[s].instance.empty()) ss<<"  output \""<<selections_[s].instance<<"\": nPassed="<<selections_[s].nPassed<<"\n";
+    nPassed += selections_[s].nPassed;
+  }
+  // shallow size of the selected collections: the copies also own their
+  // tracks, embedded objects and user data on the heap
+  const size_t bytes = refs_ ? sizeof(pat::MuonRef) : sizeof(pat::Muon);
+  ss<<"output="<<(refs_ ? "refs" : "copy")<<" bytes/event>="<<(nEvents_ ? bytes*(double)nPassed/nEvents_ : 0.)<<"\n";
+  timer_.printSummary(ss);
+  if (summary_.attached()) summary_.printSummary(ss);
+  edm::LogInfo("MuonIdSelector")<<moduleLabel_<<" SUMMARY:\n"<<ss.str();
+  timer_.writeReport();
 
 }
 
@@ -9,31 +9,61 @@ mediumEleIdLabel = "medium"
 looseEleIdLabel = "loose"
 vetoEleIdLabel = "veto"
 
-goodElectrons = cms.EDProducer("PATElectronIdSelector",
+# One pass of PATElectronIdSelector evaluates every working point and writes
+# the selected electrons, as references into src, plus the per-electron
+# bitmask ("wpMask", pku::wp::Electron bits).  electronIds writes the medium
+# ("good") electrons and follows the src the analysis config gives it
+# (calibratedPatElectrons in the Z configs); vetoElectronIds writes the veto
+# electrons and stays on slimmedElectrons, as vetoElectrons always was, so
+# that nlooseeles and the lepton cleaning do not change with the calibration.
+# The aliases keep the goodElectrons and vetoElectrons labels the jet
+# cleaning, the V producers and the tree makers read.  "copy" as output
+# restores std::vector<pat::Electron> collections (then alias type
+# "patElectrons").
+eleOutput = "refs"
+
+electronIds = cms.EDProducer("PATElectronIdSelector",
     src = cms.InputTag( "slimmedElectrons" ),
     vertex = cms.InputTag("offlineSlimmedPrimaryVertices"),
-    idLabel = cms.string(mediumEleIdLabel),
+    selections = cms.PSet(
+        good = cms.string(mediumEleIdLabel)
+    ),
+    output = cms.string(eleOutput),
+    wpMask = cms.bool(True),
+    # per-lumi electron counts in the TFileService file, electronIds/LumiSummary
+    lumiSummary = cms.bool(True),
     rho = cms.InputTag("fixedGridRhoFastjetAll"),
     effAreasConfigFile = cms.FileInPath("RecoEgamma/ElectronIdentification/data/Summer16/effAreaElectrons_cone03_pfNeuHadronsAndPhotons_80X.txt")
 )
 
-# mediumElectrons = cms.EDProducer("PATElectronIdSelector",
+vetoElectronIds = electronIds.clone(
+    src = cms.InputTag( "slimmedElectrons" ),
+    selections = cms.PSet(
+        veto = cms.string(vetoEleIdLabel)
+    )
+)
+
+def electronIdAlias(module, instance):
+    return cms.EDAlias(**{module: cms.VPSet(cms.PSet(
+        type = cms.string("patElectronsRefs" if eleOutput == "refs" else "patElectrons"),
+        fromProductInstance = cms.string(instance),
+        toProductInstance = cms.string("")
+    ))})
+
+goodElectrons = electronIdAlias("electronIds", "good")
+vetoElectrons = electronIdAlias("vetoElectronIds", "veto")
+
+# The former one-module-per-working-point setup, e.g. to validate the
+# combined pass against it (compare the endJob summaries):
+# goodElectrons = cms.EDProducer("PATElectronIdSelector",
 #     src = cms.InputTag( "slimmedElectrons" ),
 #     vertex = cms.InputTag("offlineSlimmedPrimaryVertices"),
 #     idLabel = cms.string(mediumEleIdLabel),
+#     output = cms.string(eleOutput),
 #     rho = cms.InputTag("fixedGridRhoFastjetAll"),
 #     effAreasConfigFile = cms.FileInPath("RecoEgamma/ElectronIdentification/data/Summer16/effAreaElectrons_cone03_pfNeuHadronsAndPhotons_80X.txt")
 # )
 
-vetoElectrons = cms.EDProducer("PATElectronIdSelector",
-    src = cms.InputTag( "slimmedElectrons" ),
-    vertex = cms.InputTag("offlineSlimmedPrimaryVertices"),
-    idLabel = cms.string(vetoEleIdLabel),
-    rho = cms.InputTag("fixedGridRhoFastjetAll"),
-    effAreasConfigFile = cms.FileInPath("RecoEgamma/ElectronIdentification/data/Summer16/effAreaElectrons_cone03_pfNeuHadronsAndPhotons_80X.txt")
-)
-
-
 #goodElectrons = cms.EDFilter("PATElectronIdSelector",
 #                             src = cms.InputTag("tightElectrons"),
 #                             cut = cms.string("pt > 20 && abs(eta) < 2.5 "), 
@@ -55,5 +85,5 @@ vetoElectrons = cms.EDProducer("PATElectronIdSelector",
 #                                             )
 #                             )
 
-eleSequence = cms.Sequence(goodElectrons+vetoElectrons)
+eleSequence = cms.Sequence(electronIds+vetoElectronIds)
 #eleSequence = cms.Sequence(goodElectrons+mediumElectrons+vetoElectrons)
@@ -28,3 +28,50 @@ cleanAK4Jets.finalCut = "pt > 20 & abs(eta) < 4.7"
 
 
 NJetsSequence = cms.Sequence(goodAK4Jets + cleanAK4Jets )
+
+### Cleaning by constituent key
+# The same jets without the deltaR cone: JetConstituentCleaner drops the jets
+# that have the PF candidate of a good muon or electron among their
+# constituents, read from the pfKeyOffsets/pfKeys products of JetUserData.
+# Its src must be the JetUserData jets themselves, so the jet ID comes after;
+# only for the configs that run a JetUserData module (Zanalysis_sig.py,
+# Zanalysis_checkjec.py), the others keep NJetsSequence.
+
+keyCleanAK4Jets = cms.EDProducer("JetConstituentCleaner",
+                        src = cms.InputTag("JetUserData"),
+                        leptons = cms.VInputTag("goodMuons", "goodElectrons"),
+                        cut = cms.string("pt > 20 & abs(eta) < 4.7")
+                        )
+
+goodKeyCleanAK4Jets = goodAK4Jets.clone(src = "keyCleanAK4Jets")
+
+NJetsKeyCleanSequence = cms.Sequence(keyCleanAK4Jets + goodKeyCleanAK4Jets )
+
+### Jet ID, cleaning and JEC in one pass
+# GoodJetProducer does goodAK4Jets + cleanAK4Jets (and the JEC of JetUserData)
+# on slimmedJets in a single module with one output collection; the leptons
+# are matched by PF candidate, by deltaR when they have none.  The JEC
+# payloads (jecAK4chsPayloadNames on simulation, jecEras from jecEras_cff on
+# data) are set by the analysis config, which then schedules
+# NJetsOnePassSequence with ak4jetsSrc = "goodCleanAK4Jets".
+# It does not select the same jets as NJetsSequence: pt > 20 applies to the
+# new-JEC pt instead of the MiniAOD pt, the leptons are removed by PF key
+# before deltaR < 0.4, and the loose ID is its own copy of the functor cuts.
+# No production config uses it until pkuDiffNtuples shows that the ntuples
+# of the two sequences agree.
+
+goodCleanAK4Jets = cms.EDProducer("GoodJetProducer",
+                        src = cms.InputTag("slimmedJets"),
+                        jetId = cms.string("loose"),
+                        checkOverlaps = cms.VPSet(
+                            cms.PSet(src = cms.InputTag("goodMuons"), deltaR = cms.double(0.4)),
+                            cms.PSet(src = cms.InputTag("goodElectrons"), deltaR = cms.double(0.4))
+                            ),
+                        ptMin = cms.double(20.),
+                        etaMax = cms.double(4.7),
+                        rho = cms.InputTag("fixedGridRhoFastjetAll"),
+                        vertex = cms.InputTag("offlineSlimmedPrimaryVertices"),
+                        jecAK4chsPayloadNames = cms.vstring()
+                        )
+
+NJetsOnePassSequence = cms.Sequence(goodCleanAK4Jets )
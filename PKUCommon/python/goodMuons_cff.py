@@ -3,17 +3,45 @@ import FWCore.ParameterSet.Config as cms
 tightMuIdLabel = "tight"
 looseMuIdLabel = "loose"
 
-goodMuons = cms.EDProducer("PATMuonIdSelector",
-    src = cms.InputTag( "slimmedMuons" ),
-    vertex = cms.InputTag("offlineSlimmedPrimaryVertices"),
-    idLabel = cms.string(tightMuIdLabel)
-)   
+# One pass of PATMuonIdSelector evaluates both working points and writes the
+# tight ("good") and loose ("loose") muons, as references into src, plus
+# the per-muon bitmask ("wpMask", pku::wp::Muon bits).  The aliases keep
+# the goodMuons and looseMuons labels the jet cleaning, the V producers and
+# the tree makers read.  "copy" as output restores std::vector<pat::Muon>
+# collections (then alias type "patMuons").
+muOutput = "refs"
 
-looseMuons = cms.EDProducer("PATMuonIdSelector",
+muonIds = cms.EDProducer("PATMuonIdSelector",
     src = cms.InputTag( "slimmedMuons" ),
     vertex = cms.InputTag("offlineSlimmedPrimaryVertices"),
-    idLabel = cms.string(looseMuIdLabel)
-)   
+    selections = cms.PSet(
+        good = cms.string(tightMuIdLabel),
+        loose = cms.string(looseMuIdLabel)
+    ),
+    output = cms.string(muOutput),
+    wpMask = cms.bool(True),
+    # per-lumi muon counts in the TFileService file, muonIds/LumiSummary
+    lumiSummary = cms.bool(True)
+)
+
+def muonIdAlias(instance):
+    return cms.EDAlias(muonIds = cms.VPSet(cms.PSet(
+        type = cms.string("patMuonsRefs" if muOutput == "refs" else "patMuons"),
+        fromProductInstance = cms.string(instance),
+        toProductInstance = cms.string("")
+    )))
+
+goodMuons = muonIdAlias("good")
+looseMuons = muonIdAlias("loose")
+
+# The former one-module-per-working-point setup, e.g. to validate the
+# combined pass against it (compare the endJob summaries):
+# goodMuons = cms.EDProducer("PATMuonIdSelector",
+#     src = cms.InputTag( "slimmedMuons" ),
+#     vertex = cms.InputTag("offlineSlimmedPrimaryVertices"),
+#     idLabel = cms.string(tightMuIdLabel),
+#     output = cms.string(muOutput)
+# )
 
 #goodMuons = cms.EDFilter("PATMuonIdSelector",
 #                             src = cms.InputTag("tightMuons"),
@@ -42,4 +70,4 @@ looseMuons = cms.EDProducer("PATMuonIdSelector",
 
 
 
-muSequence = cms.Sequence(goodMuons+looseMuons)
+muSequence = cms.Sequence(muonIds)
@@ -0,0 +1,27 @@
+import FWCore.ParameterSet.Config as cms
+
+# Summer16_23Sep2016 JEC payload sets of the 2016 data by run range, for the
+# jecEras parameter of the tree makers, JetUserData and GoodJetProducer (see
+# VAJets/PKUTreeMaker/interface/JecRegistry.h), so that one job covers
+# Run2016B-H.  Runs 280386-280918 hold no collision data and are in no era.
+jecEraRuns2016 = (('BCD', 1, 276811),
+                  ('EF', 276812, 278801),
+                  ('G', 278802, 280385),
+                  ('H', 280919, 999999))
+
+def jecDataPayloads(era, algo):
+   return ['Summer16_23Sep2016%sV3_DATA_%s_AK4%s.txt' % (era, level, algo)
+           for level in ('L1FastJet', 'L2Relative', 'L3Absolute', 'L2L3Residual')]
+
+# one PSet per era with, for every payload parameter of the module, the
+# payloads of the given jet algorithm, e.g.
+#   jecEras2016(jecAK4chsPayloadNames = 'PFchs', jecAK4PayloadNames = 'PFpuppi')
+def jecEras2016(**algos):
+   eras = cms.VPSet()
+   for era, firstRun, lastRun in jecEraRuns2016:
+      pset = cms.PSet(firstRun = cms.uint32(firstRun),
+                      lastRun = cms.uint32(lastRun))
+      for name, algo in sorted(algos.items()):
+         setattr(pset, name, cms.vstring(jecDataPayloads(era, algo)))
+      eras.append(pset)
+   return eras
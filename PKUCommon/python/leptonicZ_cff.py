@@ -1,18 +1,28 @@
 import FWCore.ParameterSet.Config as cms
 
-Ztomumu = cms.EDProducer("CandViewCombiner",
-                         decay = cms.string("goodMuons@+ goodMuons@-"),
-                         cut = cms.string("")
-                         )
+#Ztomumu = cms.EDProducer("CandViewCombiner",
+#                         decay = cms.string("goodMuons@+ goodMuons@-"),
+#                         cut = cms.string("")
+#                         )
 
-Ztoee = cms.EDProducer("CandViewCombiner",
-                       decay = cms.string("goodElectrons@+ goodElectrons@-"),
-                       cut = cms.string("")
-                       )
+#Ztoee = cms.EDProducer("CandViewCombiner",
+#                       decay = cms.string("goodElectrons@+ goodElectrons@-"),
+#                       cut = cms.string("")
+#                       )
 
-leptonicV = cms.EDProducer("CandViewMerger",
-                           src = cms.VInputTag( "Ztoee", "Ztomumu"),
-                           cut = cms.string("")
-                           ) 
+#leptonicV = cms.EDProducer("CandViewMerger",
+#                           src = cms.VInputTag( "Ztoee", "Ztomumu"),
+#                           cut = cms.string("")
+#                           ) 
 
-leptonicVSequence = cms.Sequence(Ztomumu + Ztoee + leptonicV)
+# best ee and mumu pair, ee first as with the merger above
+leptonicV = cms.EDProducer("PKUZLepProducer",
+                           electrons = cms.InputTag("goodElectrons"),
+                           muons = cms.InputTag("goodMuons"),
+                           selection = cms.string("leadingPt"),   # or "massWindow"
+                           targetMass = cms.double(91.1876),
+                           minMass = cms.double(0.),
+                           maxMass = cms.double(1e9)
+                           )
+
+leptonicVSequence = cms.Sequence(leptonicV)
@@ -0,0 +1,843 @@
+//
+// Package:    VAJets/PKUTreeMaker
+// Program:    pkuBenchmarkKernels
+//
+/**
+ Description: microbenchmarks of the physics kernels of the tree makers
+ and their producers, outside the framework.
+
+ Implementation:
+     A seeded generator fills a pool of synthetic events with 2016-like
+     multiplicities (leptons, photons, jets with their PF constituent keys,
+     HLT objects, vertices), and every kernel runs over --events events
+     drawn cyclically from the pool, once to warm up and then
+     --repetitions times.  The library code is called directly where the
+     kernel lives in a library (NeutrinoPzSolver, TriggerObjectIndex,
+     photon::classify, EffectiveAreaTable, JetConstituentKeys, LeptonIdKernels,
+     JetKernels, DileptonKernels, FactorizedJetCorrector, JME::JetResolution),
+     so the Type-I summation, the jet ranking and the VBS observables are
+     those of the tree makers.
+
+     zProducer and zCombiner compare PKUZLepProducer with the
+     CandViewCombiner + CandViewMerger chain it replaced: the combiner
+     builds a candidate with two cloned daughters for every opposite-sign
+     pair and the merger copies them, the producer scores the pairs on flat
+     arrays and builds one candidate per flavour.  Both checksums add the
+     daughter indices of the first candidate of each flavour, so equal
+     checksums mean the producer picks the combiner's pair, daughters in
+     the same order.
+
+     The report gives per kernel the median and the fastest ns/event and
+     the heap allocations/event of the timed passes (global operator new
+     is counted), on stdout and as JSON:
+
+       pkuBenchmarkKernels --events 200000 --seed 1 --output kernels.json \
+         --jec Spring16_25nsV6_MC_L1FastJet_AK4PFchs.txt,Spring16_25nsV6_MC_L2Relative_AK4PFchs.txt,Spring16_25nsV6_MC_L3Absolute_AK4PFchs.txt \
+         --jer-resolution Spring16_25nsV10_MC_PtResolution_AK4PFchs.txt --jer-sf Spring16_25nsV10_MC_SF_AK4PFchs.txt
+
+     The JEC and JER kernels need their payload files and are reported as
+     skipped without them; --kernels muonId,electronId runs a subset.
+*/
+//
+
+#include "VAJets/PKUCommon/interface/DileptonKernels.h"
+#include "VAJets/PKUCommon/interface/LeptonIdKernels.h"
+#include "VAJets/PKUTreeMaker/interface/EffectiveAreaTable.h"
+#include "VAJets/PKUTreeMaker/interface/JetConstituentKeys.h"
+#include "VAJets/PKUTreeMaker/interface/JetKernels.h"
+#include "VAJets/PKUTreeMaker/interface/NeutrinoPzSolver.h"
+#include "VAJets/PKUTreeMaker/interface/PhotonCategory.h"
+#include "VAJets/PKUTreeMaker/interface/TriggerObjectIndex.h"
+
+#include "CondFormats/JetMETObjects/interface/FactorizedJetCorrector.h"
+#include "CondFormats/JetMETObjects/interface/JetCorrectorParameters.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "JetMETCorrections/Modules/interface/JetResolution.h"
+#include "TLorentzVector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// allocation counting
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+	unsigned long long nAllocations = 0;
+}
+
+void* operator new(std::size_t n) {
+	++nAllocations;
+	if (void* p = std::malloc(n ? n : 1)) return p;
+	throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+
+namespace {
+
+	const double Pi = M_PI;
+
+	inline double deltaPhi(double phi1, double phi2) {
+		double d = std::fabs(phi1 - phi2);
+		return d > Pi ? 2.*Pi - d : d;
+	}
+	inline double deltaR(double eta1, double phi1, double eta2, double phi2) {
+		const double dEta = eta1 - eta2, dPhi = deltaPhi(phi1, phi2);
+		return std::sqrt(dEta*dEta + dPhi*dPhi);
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// synthetic events
+	////////////////////////////////////////////////////////////////////////////
+	struct Photon {
+		double pt, eta, phi, energy;
+		double hoe, sieie, chiso, nhiso, phoiso;   // isolations before the rho correction
+		double drLepton;
+		bool eleVeto;
+	};
+
+	struct Jet {
+		double rawPt, eta, phi, rawE, area, emFraction;
+		double jecFactor, offsetFactor;   // full chain and L1 alone, for the Type-I kernel
+		double genPt, genEta, genPhi;     // genPt < 0 without a generator jet
+		int muonMultiplicity;
+	};
+
+	struct Event {
+		double rho, metPx, metPy;
+		unsigned nVertices;
+		// the W-candidate leptons, flat for NeutrinoPzSolver
+		std::vector<double> lepPx, lepPy, lepPz, lepE;
+		// the reco objects matched to the HLT objects
+		std::vector<float> recoEta, recoPhi, hltEta, hltPhi;
+		pku::muonId::Variables muons;
+		pku::electronId::Variables electrons;
+		// the same leptons in pt order with a charge, the inputs of the Z candidates
+		pku::dilepton::Leptons zMuons, zElectrons;
+		std::vector<Photon> photons;
+		std::vector<Jet> jets;
+		std::vector<unsigned int> keyOffsets, keys;   // as written by JetUserData
+		std::vector<std::pair<unsigned int, math::XYZTLorentzVector> > muonKeys;   // as recordTypeIJets keys them
+		// the boson and the photon of the VBS observables
+		double vPt, vEta, vPhi, vE;
+		int photon;                                   // -1 without one
+	};
+
+	class EventGenerator {
+		public:
+			explicit EventGenerator(unsigned long long seed) : rng_(seed), chargeRng_(seed + 1) {}
+
+			void generate(Event& ev);
+
+		private:
+			double uniform(double a, double b) { return std::uniform_real_distribution<double>(a, b)(rng_); }
+			double gaus(double mean, double sigma) { return std::normal_distribution<double>(mean, sigma)(rng_); }
+			double expo(double mean) { return std::exponential_distribution<double>(1./mean)(rng_); }
+			unsigned poisson(double mean) { return std::poisson_distribution<unsigned>(mean)(rng_); }
+			bool flip(double p) { return std::bernoulli_distribution(p)(rng_); }
+			double phi() { return uniform(-Pi, Pi); }
+
+			std::mt19937_64 rng_;
+			std::mt19937_64 chargeRng_;   // the Z lepton charges, apart so that the other kernels see the same events
+	};
+
+	void EventGenerator::generate(Event& ev) {
+		ev.nVertices = 1 + poisson(22.);
+		ev.rho = std::max(0.5, 0.55*ev.nVertices + gaus(0., 2.));
+		const double met = expo(35.), metPhi = phi();
+		ev.metPx = met*std::cos(metPhi);
+		ev.metPy = met*std::sin(metPhi);
+
+		ev.lepPx.clear(); ev.lepPy.clear(); ev.lepPz.clear(); ev.lepE.clear();
+		ev.recoEta.clear(); ev.recoPhi.clear();
+		const unsigned nMuons = poisson(1.3), nElectrons = poisson(1.6);
+		ev.muons.resize(nMuons);
+		ev.electrons.resize(nElectrons);
+		std::vector<double> muonEta(nMuons), muonPhi(nMuons);
+		for (unsigned i = 0; i < nMuons + nElectrons; i++) {
+			const double pt = 5. + expo(30.), eta = uniform(-2.5, 2.5), ph = phi();
+			ev.lepPx.push_back(pt*std::cos(ph));
+			ev.lepPy.push_back(pt*std::sin(ph));
+			ev.lepPz.push_back(pt*std::sinh(eta));
+			ev.lepE.push_back(pt*std::cosh(eta));
+			ev.recoEta.push_back(eta);
+			ev.recoPhi.push_back(ph);
+			const bool prompt = flip(0.7);
+			if (i < nMuons) {
+				pku::muonId::Variables& m = ev.muons;
+				muonEta[i] = eta; muonPhi[i] = ph;
+				m.pt[i] = pt; m.absEta[i] = std::fabs(eta);
+				m.isolation[i] = prompt ? expo(0.04) : expo(0.4);
+				m.d0[i] = std::fabs(gaus(0., prompt ? 0.01 : 0.1));
+				m.dz[i] = std::fabs(gaus(0., prompt ? 0.02 : 0.3));
+				m.isGlobal[i] = flip(0.9); m.isTracker[i] = flip(0.95); m.isPF[i] = flip(0.97);
+				m.matchedStations[i] = poisson(2.5);
+				m.normalizedChi2[i] = m.isGlobal[i] ? expo(1.5) : 1e9;
+				m.validMuonHits[i] = m.isGlobal[i] ? poisson(20.) : 0;
+				m.validPixelHits[i] = m.isGlobal[i] ? poisson(3.) : 0;
+				m.trackerLayers[i] = m.isGlobal[i] ? 3 + poisson(9.) : 0;
+			} else {
+				pku::electronId::Variables& e = ev.electrons;
+				const unsigned j = i - nMuons;
+				const double absEta = std::fabs(eta);
+				e.region[j] = absEta <= 1.479 ? 1 : (absEta < 2.5 ? 2 : 0);
+				const bool eb = e.region[j] == 1;
+				e.pt[j] = pt;
+				e.isolation[j] = prompt ? expo(0.03) : expo(0.3);
+				e.d0[j] = std::fabs(gaus(0., prompt ? 0.01 : 0.1));
+				e.dz[j] = std::fabs(gaus(0., prompt ? 0.03 : 0.3));
+				e.sigmaIEtaIEta[j] = std::fabs(gaus(eb ? 0.0095 : 0.027, eb ? 0.0015 : 0.004));
+				e.dPhiIn[j] = std::fabs(gaus(0., prompt ? 0.02 : 0.1));
+				e.dEtaIn[j] = std::fabs(gaus(0., prompt ? 0.002 : 0.008));
+				e.hoe[j] = expo(prompt ? 0.02 : 0.15);
+				e.ooemoop[j] = expo(prompt ? 0.01 : 0.1);
+				e.missingHits[j] = poisson(0.3);
+				e.conversionVeto[j] = flip(0.95);
+			}
+		}
+
+		const unsigned nPhotons = poisson(2.2);
+		ev.photons.resize(nPhotons);
+		ev.photon = -1;
+		for (unsigned i = 0; i < nPhotons; i++) {
+			Photon& g = ev.photons[i];
+			const bool prompt = flip(0.5);
+			g.pt = 10. + expo(30.); g.eta = uniform(-2.5, 2.5); g.phi = phi();
+			g.energy = g.pt*std::cosh(g.eta);
+			const bool eb = std::fabs(g.eta) < 1.4442;
+			g.hoe = expo(prompt ? 0.01 : 0.05);
+			g.sieie = std::fabs(gaus(eb ? 0.009 : 0.026, eb ? 0.002 : 0.005));
+			g.chiso = prompt ? expo(0.3) + 0.01*ev.rho : expo(5.);
+			g.nhiso = prompt ? expo(0.8) + 0.05*ev.rho : expo(4.);
+			g.phoiso = prompt ? expo(0.8) + 0.1*ev.rho : expo(4.);
+			g.eleVeto = flip(0.9);
+			g.drLepton = 10.;
+			for (std::size_t l = 0; l < ev.recoEta.size(); l++)
+				g.drLepton = std::min(g.drLepton, deltaR(g.eta, g.phi, ev.recoEta[l], ev.recoPhi[l]));
+			if (ev.photon < 0 || g.pt > ev.photons[ev.photon].pt) ev.photon = i;
+			ev.recoEta.push_back(g.eta);
+			ev.recoPhi.push_back(g.phi);
+		}
+
+		// jets in random pt order, as the makers do not trust the input order
+		const unsigned nJets = poisson(5.5);
+		ev.jets.resize(nJets);
+		ev.keyOffsets.assign(1, 0);
+		ev.keys.clear();
+		unsigned nextKey = 0;
+		std::vector<unsigned> constituents;
+		for (unsigned i = 0; i < nJets; i++) {
+			Jet& j = ev.jets[i];
+			j.rawPt = 10. + expo(35.); j.eta = uniform(-4.7, 4.7); j.phi = phi();
+			const double mass = 0.1*j.rawPt*uniform(0.5, 1.5);
+			j.rawE = std::sqrt(std::pow(j.rawPt*std::cosh(j.eta), 2) + mass*mass);
+			j.area = gaus(0.5, 0.03);
+			j.emFraction = flip(0.05) ? uniform(0.9, 1.) : uniform(0., 0.7);
+			j.jecFactor = 1. + 8./std::sqrt(j.rawPt) + gaus(0., 0.02);
+			j.offsetFactor = std::max(0.5, 1. - ev.rho*j.area/j.rawPt);
+			j.muonMultiplicity = 0;
+			j.genPt = flip(0.8) ? j.rawPt*j.jecFactor*gaus(1., 0.1) : -1.;
+			j.genEta = j.eta + gaus(0., 0.03);
+			j.genPhi = j.phi + gaus(0., 0.03);
+			constituents.resize(8 + poisson(0.25*j.rawPt));
+			for (std::size_t c = 0; c < constituents.size(); c++) constituents[c] = (nextKey += 1 + poisson(0.5));
+			std::shuffle(constituents.begin(), constituents.end(), rng_);
+			pku::JetConstituentKeys::append(ev.keyOffsets, ev.keys, constituents.begin(), constituents.end());
+			ev.recoEta.push_back(j.eta);
+			ev.recoPhi.push_back(j.phi);
+		}
+
+		// a third of the muons are constituents of a jet
+		ev.muonKeys.clear();
+		for (unsigned i = 0; i < nMuons; i++) {
+			unsigned int key = ++nextKey;
+			if (nJets && flip(0.33)) {
+				const unsigned jet = std::uniform_int_distribution<unsigned>(0, nJets - 1)(rng_);
+				const unsigned n = ev.keyOffsets[jet + 1] - ev.keyOffsets[jet];
+				key = ev.keys[ev.keyOffsets[jet] + std::uniform_int_distribution<unsigned>(0, n - 1)(rng_)];
+				ev.jets[jet].muonMultiplicity++;
+			}
+			const double pt = ev.muons.pt[i];
+			ev.muonKeys.push_back(std::make_pair(key, math::XYZTLorentzVector(pt*std::cos(muonPhi[i]), pt*std::sin(muonPhi[i]),
+			                                                                  pt*std::sinh(muonEta[i]), pt*std::cosh(muonEta[i]))));
+		}
+
+		// HLT objects: about one per reco lepton and photon near it, the rest anywhere
+		ev.hltEta.clear(); ev.hltPhi.clear();
+		for (std::size_t i = 0; i < ev.recoEta.size() - nJets; i++) {
+			if (!flip(0.8)) continue;
+			ev.hltEta.push_back(ev.recoEta[i] + gaus(0., 0.02));
+			ev.hltPhi.push_back(std::remainder(ev.recoPhi[i] + gaus(0., 0.02), 2.*Pi));
+		}
+		for (unsigned i = poisson(10.); i > 0; i--) {
+			ev.hltEta.push_back(uniform(-5., 5.));
+			ev.hltPhi.push_back(phi());
+		}
+
+		// the boson of the VBS observables, from the leading two leptons or a generated one
+		TLorentzVector v;
+		if (ev.lepPx.size() >= 2) {
+			v.SetPxPyPzE(ev.lepPx[0] + ev.lepPx[1], ev.lepPy[0] + ev.lepPy[1], ev.lepPz[0] + ev.lepPz[1], ev.lepE[0] + ev.lepE[1]);
+		} else {
+			v.SetPtEtaPhiM(20. + expo(40.), uniform(-2.5, 2.5), phi(), 91.19);
+		}
+		ev.vPt = v.Pt(); ev.vEta = v.Eta(); ev.vPhi = v.Phi(); ev.vE = v.E();
+
+		// the Z leptons, with charges of their own generator
+		std::vector<std::pair<double, unsigned> > order;
+		for (int flavour = 0; flavour < 2; flavour++) {
+			const unsigned begin = flavour ? nMuons : 0, end = flavour ? nMuons + nElectrons : nMuons;
+			order.clear();
+			for (unsigned i = begin; i < end; i++) order.push_back(std::make_pair(-std::hypot(ev.lepPx[i], ev.lepPy[i]), i));
+			std::sort(order.begin(), order.end());
+			pku::dilepton::Leptons& l = flavour ? ev.zElectrons : ev.zMuons;
+			l.resize(order.size());
+			for (std::size_t k = 0; k < order.size(); k++) {
+				const unsigned i = order[k].second;
+				l.px[k] = ev.lepPx[i]; l.py[k] = ev.lepPy[i]; l.pz[k] = ev.lepPz[i]; l.e[k] = ev.lepE[i];
+				l.charge[k] = std::bernoulli_distribution(0.5)(chargeRng_) ? 1 : -1;
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// kernels
+	////////////////////////////////////////////////////////////////////////////
+	class Kernel {
+		public:
+			explicit Kernel(const std::string& name) : name_(name) {}
+			virtual ~Kernel() {}
+
+			const std::string& name() const { return name_; }
+			// empty when the kernel can run
+			const std::string& skipped() const { return skipped_; }
+			// the objects the kernel handles in the event, for the per-object rate
+			virtual std::size_t objects(const Event& ev) const = 0;
+			// returns a checksum of the results, so that nothing is optimised away
+			virtual double run(const Event& ev) = 0;
+
+		protected:
+			std::string skipped_;
+
+		private:
+			std::string name_;
+	};
+
+	class NeutrinoPz : public Kernel {
+		public:
+			NeutrinoPz() : Kernel("neutrinoPz") {}
+			std::size_t objects(const Event& ev) const { return ev.lepPx.size(); }
+			double run(const Event& ev) {
+				const std::size_t n = ev.lepPx.size();
+				pz_.resize(n);
+				complex_.resize(n);
+				if (n) solver_.solve(n, &ev.lepPx[0], &ev.lepPy[0], &ev.lepPz[0], &ev.lepE[0], ev.metPx, ev.metPy, &pz_[0], &complex_[0]);
+				double sum = 0.;
+				for (std::size_t i = 0; i < n; i++) sum += pz_[i] + complex_[i];
+				return sum;
+			}
+		private:
+			pku::NeutrinoPzSolver solver_;
+			std::vector<double> pz_;
+			std::vector<unsigned char> complex_;
+	};
+
+	// JetUserData: index the HLT objects, nearest one within 0.3 per reco object
+	class DeltaRMatching : public Kernel {
+		public:
+			DeltaRMatching() : Kernel("deltaRMatching") {}
+			std::size_t objects(const Event& ev) const { return ev.recoEta.size(); }
+			double run(const Event& ev) {
+				index_.clear();
+				for (std::size_t i = 0; i < ev.hltEta.size(); i++) index_.add(ev.hltEta[i], ev.hltPhi[i], i);
+				index_.build();
+				double sum = 0.;
+				for (std::size_t i = 0; i < ev.recoEta.size(); i++) sum += index_.nearest(ev.recoEta[i], ev.recoPhi[i], 0.3f);
+				return sum;
+			}
+		private:
+			pku::TriggerObjectIndex index_;
+	};
+
+	// TreeMakerCore: rho-corrected isolations, category bits, selected photon of every block
+	class PhotonId : public Kernel {
+		public:
+			PhotonId() : Kernel("photonId"), areas_(pku::EffectiveAreaTable::photonSpring16()),
+			             selections_(pku::photon::selections(edm::ParameterSet())) {}
+			std::size_t objects(const Event& ev) const { return ev.photons.size(); }
+			double run(const Event& ev) {
+				const std::size_t n = ev.photons.size();
+				masks_.resize(n);
+				for (std::size_t i = 0; i < n; i++) {
+					const Photon& g = ev.photons[i];
+					const float* ea = areas_.areas(std::fabs(g.eta));
+					pku::photon::Variables v;
+					v.pt = g.pt; v.eta = g.eta; v.phi = g.phi; v.energy = g.energy;
+					v.hoe = g.hoe; v.sieie = g.sieie;
+					v.chiso  = std::max(g.chiso  - ev.rho*ea[pku::EffectiveAreaTable::ChargedHadron], 0.);
+					v.nhiso  = std::max(g.nhiso  - ev.rho*ea[pku::EffectiveAreaTable::NeutralHadron], 0.);
+					v.phoiso = std::max(g.phoiso - ev.rho*ea[pku::EffectiveAreaTable::Photon], 0.);
+					v.drLepton = g.drLepton;
+					v.isEB = std::fabs(g.eta) < 1.4442;
+					v.isEE = std::fabs(g.eta) > 1.566 && std::fabs(g.eta) < 2.5;
+					v.eleVeto = g.eleVeto;
+					masks_[i] = pku::photon::classify(v);
+				}
+				double sum = 0.;
+				for (std::size_t s = 0; s < selections_.size(); s++) {
+					int best = -1;
+					for (std::size_t i = 0; i < n; i++)
+						if (selections_[s].pass(masks_[i]) && (best < 0 || ev.photons[i].pt > ev.photons[best].pt)) best = i;
+					sum += best;
+				}
+				return sum;
+			}
+		private:
+			pku::EffectiveAreaTable areas_;
+			std::vector<pku::photon::Selection> selections_;
+			std::vector<unsigned> masks_;
+	};
+
+	class ElectronId : public Kernel {
+		public:
+			ElectronId() : Kernel("electronId") {}
+			std::size_t objects(const Event& ev) const { return ev.electrons.size(); }
+			double run(const Event& ev) {
+				pku::electronId::evaluate(ev.electrons, masks_);
+				double sum = 0.;
+				for (std::size_t i = 0; i < masks_.size(); i++) sum += masks_[i];
+				return sum;
+			}
+		private:
+			std::vector<int> masks_;
+	};
+
+	class MuonId : public Kernel {
+		public:
+			MuonId() : Kernel("muonId") {}
+			std::size_t objects(const Event& ev) const { return ev.muons.size(); }
+			double run(const Event& ev) {
+				pku::muonId::evaluate(ev.muons, masks_);
+				double sum = 0.;
+				for (std::size_t i = 0; i < masks_.size(); i++) sum += masks_[i];
+				return sum;
+			}
+		private:
+			std::vector<int> masks_;
+	};
+
+	// the AK4 jet loop of the tree makers
+	class JecLookup : public Kernel {
+		public:
+			explicit JecLookup(const std::vector<std::string>& payloads) : Kernel("jecLookup") {
+				if (payloads.empty()) { skipped_ = "no --jec payloads"; return; }
+				std::vector<JetCorrectorParameters> vPar;
+				for (std::size_t i = 0; i < payloads.size(); i++) vPar.push_back(JetCorrectorParameters(payloads[i]));
+				jec_.reset(new FactorizedJetCorrector(vPar));
+			}
+			std::size_t objects(const Event& ev) const { return ev.jets.size(); }
+			double run(const Event& ev) {
+				double sum = 0.;
+				for (std::size_t i = 0; i < ev.jets.size(); i++) {
+					const Jet& j = ev.jets[i];
+					jec_->setJetEta(j.eta);
+					jec_->setJetPt(j.rawPt);
+					jec_->setJetE(j.rawE);
+					jec_->setRho(ev.rho);
+					jec_->setNPV(ev.nVertices);
+					jec_->setJetA(j.area);
+					sum += jec_->getCorrection();
+				}
+				return sum;
+			}
+		private:
+			std::unique_ptr<FactorizedJetCorrector> jec_;
+	};
+
+	// JetUserData: resolution and scale factors, then the hybrid scaling/smearing
+	class JerSmearing : public Kernel {
+		public:
+			JerSmearing(const std::string& resolutionFile, const std::string& sfFile, unsigned long long seed) : Kernel("jerSmearing"), rng_(seed) {
+				if (resolutionFile.empty() || sfFile.empty()) { skipped_ = "no --jer-resolution/--jer-sf files"; return; }
+				resolution_.reset(new JME::JetResolution(resolutionFile));
+				sf_.reset(new JME::JetResolutionScaleFactor(sfFile));
+			}
+			std::size_t objects(const Event& ev) const { return ev.jets.size(); }
+			double run(const Event& ev) {
+				const double coneSize = 0.4;
+				double sum = 0.;
+				for (std::size_t i = 0; i < ev.jets.size(); i++) {
+					const Jet& j = ev.jets[i];
+					const double pt = j.jecFactor*j.rawPt;
+					JME::JetParameters jetParam;
+					jetParam.setJetPt(pt).setJetEta(j.eta).setRho(ev.rho);
+					const float ptResolution = resolution_->getResolution(jetParam);
+					const float sfs[3] = { sf_->getScaleFactor(jetParam), sf_->getScaleFactor(jetParam, Variation::UP),
+					                       sf_->getScaleFactor(jetParam, Variation::DOWN) };
+					const double dPt = pt - j.genPt;
+					const bool matched = j.genPt > 0. && deltaR(j.eta, j.phi, j.genEta, j.genPhi) < coneSize/2.
+					                     && std::fabs(dPt) < 3*ptResolution*pt;
+					for (int v = 0; v < 3; v++) {
+						if (matched) sum += std::max(0., 1 + (sfs[v] - 1)*dPt/pt);
+						else if (sfs[v] > 1) sum += 1 + std::normal_distribution<double>(0., std::sqrt(sfs[v]*sfs[v] - 1)*ptResolution)(rng_);
+						else sum += 1.;
+					}
+				}
+				return sum;
+			}
+		private:
+			std::unique_ptr<JME::JetResolution> resolution_;
+			std::unique_ptr<JME::JetResolutionScaleFactor> sf_;
+			std::mt19937_64 rng_;
+	};
+
+	// recordTypeIJets with the constituent keys and TreeMakerLogic::typeICorrection;
+	// the JEC factors are the generated ones, their lookup is the jecLookup kernel
+	class TypeIMet : public Kernel {
+		public:
+			TypeIMet() : Kernel("typeIMet") {}
+			std::size_t objects(const Event& ev) const { return ev.jets.size(); }
+			double run(const Event& ev) {
+				const pku::JetConstituentKeys constituents(ev.keyOffsets, ev.keys);
+				pku::TypeISums sums;
+				for (std::size_t iJet = 0; iJet < ev.jets.size(); iJet++) {
+					const Jet& j = ev.jets[iJet];
+					if (j.emFraction > 0.9) continue;
+					math::XYZTLorentzVector subtracted(j.rawPt*std::cos(j.phi), j.rawPt*std::sin(j.phi), j.rawPt*std::sinh(j.eta), j.rawE);
+					if (j.muonMultiplicity != 0)
+						subtracted -= pku::typeIMuonP4(&constituents, iJet, ev.muonKeys, []() { return math::XYZTLorentzVector(); });
+					pku::addTypeIJet(sums, subtracted, j.jecFactor, [&j]() { return j.offsetFactor; });
+				}
+				return sums.corrEx + sums.corrEy + sums.corrSumEt;
+			}
+	};
+
+	// the tree makers: corrected jets above 20 GeV, ranked in pt, the
+	// leading two at dR > 0.5 from the photon
+	class JetRanking : public Kernel {
+		public:
+			JetRanking() : Kernel("jetRanking") {}
+			std::size_t objects(const Event& ev) const { return ev.jets.size(); }
+			double run(const Event& ev) {
+				jets_.clear();
+				for (std::size_t i = 0; i < ev.jets.size(); i++) {
+					const Jet& j = ev.jets[i];
+					if (j.jecFactor*j.rawPt <= 20.) continue;
+					TLorentzVector p4(0, 0, 0, 0);
+					p4.SetPtEtaPhiE(j.jecFactor*j.rawPt, j.eta, j.phi, j.jecFactor*j.rawE);
+					jets_.push_back(p4);
+				}
+				pku::rankByPt(jets_);
+				int index[2] = { -1, -1 };
+				if (ev.photon >= 0) {
+					const Photon& g = ev.photons[ev.photon];
+					pku::taggingJets(jets_, g.eta, g.phi, index);
+				}
+				return index[1] > -1 ? jets_[index[0]].Pt() + jets_[index[1]].Pt() : -1.;
+			}
+		private:
+			std::vector<TLorentzVector> jets_;   // kept across events, as ZAnalysisCore does
+	};
+
+	// the tree makers: Mjj, deltaetajj, zepp and the jet-MET angles of the leading two jets
+	class VbsObservables : public Kernel {
+		public:
+			VbsObservables() : Kernel("vbsObservables") {}
+			std::size_t objects(const Event& ev) const { return ev.photon >= 0 && ev.jets.size() >= 2 ? 1 : 0; }
+			double run(const Event& ev) {
+				if (ev.photon < 0 || ev.jets.size() < 2) return 0.;
+				const Jet& a = ev.jets[0];
+				const Jet& b = ev.jets[1];
+				const Photon& g = ev.photons[ev.photon];
+				TLorentzVector j1p4, j2p4, photonp4, vp4;
+				j1p4.SetPtEtaPhiE(a.jecFactor*a.rawPt, a.eta, a.phi, a.jecFactor*a.rawE);
+				j2p4.SetPtEtaPhiE(b.jecFactor*b.rawPt, b.eta, b.phi, b.jecFactor*b.rawE);
+				photonp4.SetPtEtaPhiE(g.pt, g.eta, g.phi, g.energy);
+				vp4.SetPtEtaPhiE(ev.vPt, ev.vEta, ev.vPhi, ev.vE);
+				const pku::VbsObservables vbs(j1p4, j2p4, photonp4, vp4, std::atan2(ev.metPy, ev.metPx));
+				const double drj1a = reco::deltaR(a.eta, a.phi, g.eta, g.phi), drj2a = reco::deltaR(b.eta, b.phi, g.eta, g.phi);
+				return vbs.Mjj + vbs.deltaetajj + vbs.zepp + drj1a + drj2a + vbs.j1metPhi + vbs.j2metPhi;
+			}
+	};
+
+	// the candidates of the Z kernels: a four-momentum and owned daughters,
+	// which point back to their lepton by index
+	struct Candidate {
+		double px, py, pz, e;
+		int charge;
+		std::size_t index;
+		std::vector<std::unique_ptr<Candidate> > daughters;
+
+		Candidate() : px(0.), py(0.), pz(0.), e(0.), charge(0), index(0) {}
+		Candidate(const pku::dilepton::Leptons& l, std::size_t i)
+			: px(l.px[i]), py(l.py[i]), pz(l.pz[i]), e(l.e[i]), charge(l.charge[i]), index(i) {}
+		Candidate* clone() const {
+			Candidate* c = new Candidate;
+			c->px = px; c->py = py; c->pz = pz; c->e = e; c->charge = charge; c->index = index;
+			for (std::size_t i = 0; i < daughters.size(); i++) c->daughters.emplace_back(daughters[i]->clone());
+			return c;
+		}
+		void addDaughter(Candidate* d) {
+			px += d->px; py += d->py; pz += d->pz; e += d->e; charge += d->charge;
+			daughters.emplace_back(d);
+		}
+	};
+	typedef std::vector<std::unique_ptr<Candidate> > Candidates;
+
+	// daughter indices of the first candidate, or 0 without one
+	inline double firstPair(const Candidates& c, std::size_t begin, std::size_t end) {
+		if (begin == end) return 0.;
+		const Candidate& z = *c[begin];
+		return 1. + z.daughters[0]->index + 0.01*z.daughters[1]->index;
+	}
+
+	// leptonicZ_cff.py before PKUZLepProducer: a CandViewCombiner per flavour
+	// ("@+ @-", every opposite-sign pair, daughters in collection order) and
+	// a CandViewMerger copying both, each product allocated per event
+	class ZCombiner : public Kernel {
+		public:
+			ZCombiner() : Kernel("zCombiner") {}
+			std::size_t objects(const Event& ev) const { return ev.zElectrons.size() + ev.zMuons.size(); }
+			double run(const Event& ev) {
+				Candidates ee, mumu;
+				combine(ev.zElectrons, ee);
+				combine(ev.zMuons, mumu);
+				Candidates merged;
+				for (std::size_t i = 0; i < ee.size(); i++) merged.emplace_back(ee[i]->clone());
+				for (std::size_t i = 0; i < mumu.size(); i++) merged.emplace_back(mumu[i]->clone());
+				return firstPair(merged, 0, ee.size()) + firstPair(merged, ee.size(), merged.size());
+			}
+		private:
+			static void combine(const pku::dilepton::Leptons& l, Candidates& out) {
+				for (std::size_t i = 0; i < l.size(); i++) {
+					for (std::size_t j = i + 1; j < l.size(); j++) {
+						if (l.charge[i]*l.charge[j] >= 0) continue;
+						std::unique_ptr<Candidate> z(new Candidate);
+						z->addDaughter(new Candidate(l, i));
+						z->addDaughter(new Candidate(l, j));
+						out.push_back(std::move(z));
+					}
+				}
+			}
+	};
+
+	// PKUZLepProducer: the leptons are copied into flat arrays kept across
+	// events, the pair comes from Pairing::bestPair and one candidate per
+	// flavour is made
+	class ZProducer : public Kernel {
+		public:
+			ZProducer() : Kernel("zProducer") {}
+			std::size_t objects(const Event& ev) const { return ev.zElectrons.size() + ev.zMuons.size(); }
+			double run(const Event& ev) {
+				Candidates out;
+				electrons_ = ev.zElectrons;
+				add(electrons_, out);
+				const std::size_t nEE = out.size();
+				muons_ = ev.zMuons;
+				add(muons_, out);
+				return firstPair(out, 0, nEE) + firstPair(out, nEE, out.size());
+			}
+		private:
+			void add(const pku::dilepton::Leptons& l, Candidates& out) const {
+				std::size_t first = 0, second = 0;
+				if (!pairing_.bestPair(l, first, second)) return;
+				std::unique_ptr<Candidate> z(new Candidate);
+				z->addDaughter(new Candidate(l, first));
+				z->addDaughter(new Candidate(l, second));
+				out.push_back(std::move(z));
+			}
+			pku::dilepton::Pairing pairing_;
+			pku::dilepton::Leptons electrons_, muons_;
+	};
+
+	////////////////////////////////////////////////////////////////////////////
+	// driver
+	////////////////////////////////////////////////////////////////////////////
+	struct Options {
+		unsigned long long events, seed;
+		unsigned pool, repetitions;
+		std::string output, jerResolution, jerSF;
+		std::vector<std::string> jec, kernels;
+	};
+
+	std::vector<std::string> split(const std::string& s) {
+		std::vector<std::string> out;
+		std::stringstream ss(s);
+		std::string item;
+		while (std::getline(ss, item, ',')) if (!item.empty()) out.push_back(item);
+		return out;
+	}
+
+	void usage(std::ostream& out) {
+		out << "usage: pkuBenchmarkKernels [--events N] [--pool N] [--repetitions N] [--seed N] [--output file.json]\n"
+		    << "                           [--jec l1.txt,l2.txt,...] [--jer-resolution file] [--jer-sf file] [--kernels a,b,...]\n";
+	}
+
+	Options parse(int argc, char** argv) {
+		Options o;
+		o.events = 100000; o.seed = 12345; o.pool = 1000; o.repetitions = 5;
+		o.output = "benchmarkKernels.json";
+		for (int i = 1; i < argc; i++) {
+			const std::string arg = argv[i];
+			if (arg == "-h" || arg == "--help") { usage(std::cout); std::exit(0); }
+			if (i + 1 >= argc) throw std::invalid_argument("missing value of " + arg);
+			const std::string value = argv[++i];
+			if      (arg == "--events")         o.events = std::stoull(value);
+			else if (arg == "--pool")           o.pool = std::stoul(value);
+			else if (arg == "--repetitions")    o.repetitions = std::stoul(value);
+			else if (arg == "--seed")           o.seed = std::stoull(value);
+			else if (arg == "--output")         o.output = value;
+			else if (arg == "--jec")            o.jec = split(value);
+			else if (arg == "--jer-resolution") o.jerResolution = value;
+			else if (arg == "--jer-sf")         o.jerSF = value;
+			else if (arg == "--kernels")        o.kernels = split(value);
+			else throw std::invalid_argument("unknown option " + arg);
+		}
+		if (!o.events || !o.pool || !o.repetitions) throw std::invalid_argument("--events, --pool and --repetitions must be positive");
+		return o;
+	}
+
+	struct Result {
+		std::string name, skipped;
+		double objectsPerEvent, nsPerEvent, nsPerEventMin, allocsPerEvent, checksum;
+	};
+
+	Result measure(Kernel& kernel, const std::vector<Event>& pool, const Options& o) {
+		Result r;
+		r.name = kernel.name();
+		r.skipped = kernel.skipped();
+		r.objectsPerEvent = r.nsPerEvent = r.nsPerEventMin = r.allocsPerEvent = r.checksum = 0.;
+		if (!r.skipped.empty()) return r;
+
+		std::size_t objects = 0;
+		for (std::size_t i = 0; i < pool.size(); i++) objects += kernel.objects(pool[i]);
+		r.objectsPerEvent = objects/double(pool.size());
+
+		// warm-up pass: the buffers the kernels reuse reach their size
+		for (std::size_t i = 0; i < pool.size(); i++) r.checksum += kernel.run(pool[i]);
+
+		std::vector<double> ns;
+		unsigned long long allocs = 0;
+		for (unsigned rep = 0; rep < o.repetitions; rep++) {
+			const unsigned long long allocs0 = nAllocations;
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			std::size_t k = 0;
+			for (unsigned long long i = 0; i < o.events; i++) {
+				r.checksum += kernel.run(pool[k]);
+				if (++k == pool.size()) k = 0;
+			}
+			const std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+			allocs += nAllocations - allocs0;
+			ns.push_back(std::chrono::duration<double, std::nano>(stop - start).count()/o.events);
+		}
+		std::sort(ns.begin(), ns.end());
+		r.nsPerEvent = ns[ns.size()/2];
+		r.nsPerEventMin = ns.front();
+		r.allocsPerEvent = allocs/double(o.events*o.repetitions);
+		return r;
+	}
+
+	void writeJson(std::ostream& out, const Options& o, const std::vector<Result>& results) {
+		out << std::setprecision(6)
+		    << "{\n  \"seed\": " << o.seed << ",\n  \"events\": " << o.events << ",\n  \"pool\": " << o.pool
+		    << ",\n  \"repetitions\": " << o.repetitions << ",\n  \"kernels\": [";
+		for (std::size_t i = 0; i < results.size(); i++) {
+			const Result& r = results[i];
+			out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\"";
+			if (!r.skipped.empty()) {
+				out << ", \"skipped\": \"" << r.skipped << "\"}";
+				continue;
+			}
+			out << ", \"objectsPerEvent\": " << r.objectsPerEvent << ", \"nsPerEvent\": " << r.nsPerEvent
+			    << ", \"nsPerEventMin\": " << r.nsPerEventMin
+			    << ", \"nsPerObject\": " << (r.objectsPerEvent > 0. ? r.nsPerEvent/r.objectsPerEvent : 0.)
+			    << ", \"allocsPerEvent\": " << r.allocsPerEvent
+			    << ", \"checksum\": " << (std::isfinite(r.checksum) ? r.checksum : 0.) << "}";
+		}
+		out << "\n  ]\n}\n";
+	}
+
+}
+
+int main(int argc, char** argv) {
+	Options o;
+	try {
+		o = parse(argc, argv);
+	} catch (std::exception& e) {
+		std::cerr << "pkuBenchmarkKernels: " << e.what() << "\n";
+		usage(std::cerr);
+		return 2;
+	}
+
+	std::vector<std::unique_ptr<Kernel> > kernels;
+	try {
+		kernels.emplace_back(new NeutrinoPz);
+		kernels.emplace_back(new DeltaRMatching);
+		kernels.emplace_back(new PhotonId);
+		kernels.emplace_back(new ElectronId);
+		kernels.emplace_back(new MuonId);
+		kernels.emplace_back(new JecLookup(o.jec));
+		kernels.emplace_back(new JerSmearing(o.jerResolution, o.jerSF, o.seed));
+		kernels.emplace_back(new TypeIMet);
+		kernels.emplace_back(new JetRanking);
+		kernels.emplace_back(new VbsObservables);
+		kernels.emplace_back(new ZCombiner);
+		kernels.emplace_back(new ZProducer);
+	} catch (std::exception& e) {
+		std::cerr << "pkuBenchmarkKernels: " << e.what() << "\n";
+		return 1;
+	}
+	for (std::size_t i = 0; i < o.kernels.size(); i++) {
+		bool known = false;
+		for (std::size_t k = 0; k < kernels.size(); k++) known |= kernels[k]->name() == o.kernels[i];
+		if (!known) {
+			std::cerr << "pkuBenchmarkKernels: unknown kernel " << o.kernels[i] << "\n";
+			return 2;
+		}
+	}
+
+	std::vector<Event> pool(o.pool);
+	EventGenerator generator(o.seed);
+	for (std::size_t i = 0; i < pool.size(); i++) generator.generate(pool[i]);
+
+	std::vector<Result> results;
+	for (std::size_t k = 0; k < kernels.size(); k++) {
+		if (!o.kernels.empty() && std::find(o.kernels.begin(), o.kernels.end(), kernels[k]->name()) == o.kernels.end()) continue;
+		results.push_back(measure(*kernels[k], pool, o));
+	}
+
+	std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++\n"
+	          << "pkuBenchmarkKernels SUMMARY: " << o.events << " events x " << o.repetitions
+	          << " repetitions, pool of " << o.pool << ", seed " << o.seed << "\n";
+	for (std::size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		std::cout << "  " << std::left << std::setw(16) << r.name << std::right;
+		if (!r.skipped.empty()) { std::cout << "skipped: " << r.skipped << "\n"; continue; }
+		std::cout << std::fixed << std::setprecision(1) << std::setw(10) << r.nsPerEvent << " ns/event (min "
+		          << r.nsPerEventMin << ")  " << std::setprecision(2) << r.allocsPerEvent << " allocs/event  "
+		          << r.objectsPerEvent << " objects/event\n";
+	}
+	std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+
+	std::ofstream out(o.output.c_str());
+	writeJson(out, o, results);
+	if (!out) {
+		std::cerr << "pkuBenchmarkKernels: cannot write " << o.output << "\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,360 @@
+//
+// Package:    VAJets/PKUTreeMaker
+// Program:    pkuBenchmarkNtupleIO
+//
+/**
+ Description: size and write/read throughput of the ntuple branch
+ encodings and output policies against the plain layout, on a fixed
+ sample.
+
+ Implementation:
+     The entries of an existing ntuple (the first --events of them) are
+     read once into memory through pku::NtupleReader, every branch in its
+     decoded type.  The sample is then written with the same branches
+     declared in an NtupleSchema, once as they are ("plain", the layout
+     the tree makers write by default, every kinematic branch a double)
+     and once with the --encoding patterns applied ("encoded"), and every
+     file is read back through NtupleReader, decoding included:
+
+       pkuBenchmarkNtupleIO ZtreePKU.root --events 100000 --repetitions 5 \
+         --encoding '*eta*=trunc:12' --encoding 'HLT_*=int8' \
+         --policy lz4=LZ4:4:10000:10000 --policy zstd=ZSTD:5:10000:10000
+
+     Without --encoding the set of the commented branchEncodings example of
+     test/Zanalysis.py is used; a pattern that fits no branch of the
+     sample is reported and ignored.
+
+     Each layout is written once per output policy, a TreeOutputPolicy
+     given as name=ALGORITHM:level[:autoFlush[:entriesPerBasket]] (see
+     TreeOutputPolicy.h).  The policy "input" is always there and keeps the
+     compression of the input file with the TreeOutputPolicy defaults;
+     without --policy the outputPolicy of test/Zanalysis.py is added as
+     "zanalysis".
+
+     The report gives per layout and policy the bytes per entry before
+     compression, the totBytes and zipBytes of the tree, their ratio to
+     the plain layout with the input policy, and the median write and read
+     rates in events/s and uncompressed MB/s, on stdout and as JSON.  The
+     write time includes copying the entry from the sample, the encoding,
+     the Fill and the final flush of the file; the read time includes the
+     decoding.
+*/
+//
+
+#include "VAJets/PKUTreeMaker/interface/BranchEncoding.h"
+#include "VAJets/PKUTreeMaker/interface/NtupleReader.h"
+#include "VAJets/PKUTreeMaker/interface/NtupleSchema.h"
+#include "VAJets/PKUTreeMaker/interface/TreeOutputPolicy.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "TFile.h"
+#include "TROOT.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+	struct Options {
+		std::string input, tree, output, workdir;
+		unsigned long long events;
+		unsigned repetitions;
+		std::vector<std::pair<std::string, std::string> > encodings;   // pattern, spec
+		std::vector<std::pair<std::string, edm::ParameterSet> > policies;
+	};
+
+	void usage(std::ostream& out) {
+		out << "usage: pkuBenchmarkNtupleIO input.root [--tree dir/name] [--events N] [--repetitions N]\n"
+		    << "                            [--encoding pattern=spec ...] [--policy name=ALGORITHM:level[:autoFlush[:entriesPerBasket]] ...]\n"
+		    << "                            [--workdir dir] [--output file.json]\n";
+	}
+
+	edm::ParameterSet policy(const std::string& algorithm, int level, long long autoFlush, int entriesPerBasket) {
+		edm::ParameterSet pset;
+		pset.addParameter<std::string>("compressionAlgorithm", algorithm);
+		pset.addParameter<int>("compressionLevel", level);
+		if (autoFlush) pset.addParameter<long long>("autoFlush", autoFlush);
+		if (entriesPerBasket) pset.addParameter<int>("entriesPerBasket", entriesPerBasket);
+		return pset;
+	}
+
+	// name=ALGORITHM:level[:autoFlush[:entriesPerBasket]]
+	std::pair<std::string, edm::ParameterSet> parsePolicy(const std::string& value) {
+		const std::string::size_type eq = value.find('=');
+		if (eq == std::string::npos || eq == 0) throw std::invalid_argument("--policy needs name=ALGORITHM:level[:autoFlush[:entriesPerBasket]]");
+		std::vector<std::string> fields;
+		std::stringstream ss(value.substr(eq + 1));
+		for (std::string field; std::getline(ss, field, ':'); ) fields.push_back(field);
+		if (fields.size() < 2 || fields.size() > 4) throw std::invalid_argument("bad --policy " + value);
+		const edm::ParameterSet pset = policy(fields[0], std::stoi(fields[1]),
+		                                      fields.size() > 2 ? std::stoll(fields[2]) : 0,
+		                                      fields.size() > 3 ? std::stoi(fields[3]) : 0);
+		// reject an unknown algorithm or level here rather than after the first layout
+		pku::TreeOutputPolicy::compressionSettings(fields[0], std::stoi(fields[1]));
+		return std::make_pair(value.substr(0, eq), pset);
+	}
+
+	// the commented branchEncodings example of test/Zanalysis.py
+	void defaultEncodings(Options& o) {
+		const char* sets[][2] = {
+			{ "*eta*", "trunc:12" }, { "*phi*", "trunc:12" },
+			{ "*pt*", "trunc:14" }, { "*e", "trunc:14" }, { "*mass*", "trunc:14" },
+			{ "drla*", "fixed16:0:10" }, { "drj*", "fixed16:0:10" },
+			{ "HLT_*", "int8" },
+			{ "passFilter_*", "bits:passFilter_bits" },
+			{ "photon_pev", "bits:photon_flags" }, { "photon_pevnew", "bits:photon_flags" }, { "photon_ppsv", "bits:photon_flags" },
+			{ "photon_iseb", "bits:photon_flags" }, { "photon_isee", "bits:photon_flags" },
+		};
+		for (std::size_t i = 0; i < sizeof(sets)/sizeof(sets[0]); i++) o.encodings.push_back(std::make_pair(sets[i][0], sets[i][1]));
+	}
+
+	Options parse(int argc, char** argv) {
+		Options o;
+		o.tree = "treeDumper/ZPKUCandidates";
+		o.output = "benchmarkNtupleIO.json";
+		o.workdir = ".";
+		o.events = 0;
+		o.repetitions = 3;
+		std::vector<std::string> files;
+		for (int i = 1; i < argc; i++) {
+			const std::string arg = argv[i];
+			if (arg == "-h" || arg == "--help") { usage(std::cout); std::exit(0); }
+			if (arg.compare(0, 2, "--") != 0) { files.push_back(arg); continue; }
+			if (i + 1 >= argc) throw std::invalid_argument("missing value of " + arg);
+			const std::string value = argv[++i];
+			if      (arg == "--tree")        o.tree = value;
+			else if (arg == "--events")      o.events = std::stoull(value);
+			else if (arg == "--repetitions") o.repetitions = std::stoul(value);
+			else if (arg == "--workdir")     o.workdir = value;
+			else if (arg == "--output")      o.output = value;
+			else if (arg == "--encoding") {
+				const std::string::size_type eq = value.find('=');
+				if (eq == std::string::npos) throw std::invalid_argument("--encoding needs pattern=spec");
+				o.encodings.push_back(std::make_pair(value.substr(0, eq), value.substr(eq + 1)));
+			}
+			else if (arg == "--policy")      o.policies.push_back(parsePolicy(value));
+			else throw std::invalid_argument("unknown option " + arg);
+		}
+		if (files.size() != 1) throw std::invalid_argument("one input file is needed");
+		if (!o.repetitions) throw std::invalid_argument("--repetitions must be positive");
+		o.input = files[0];
+		if (o.encodings.empty()) defaultEncodings(o);
+		// the outputPolicy of test/Zanalysis.py
+		if (o.policies.empty()) o.policies.push_back(std::make_pair(std::string("zanalysis"), policy("LZMA", 4, 10000, 10000)));
+		o.policies.insert(o.policies.begin(), std::make_pair(std::string("input"), edm::ParameterSet()));
+		return o;
+	}
+
+	// the sample: every entry as the concatenated buffers of the columns
+	struct Sample {
+		std::vector<pku::NtupleColumn> columns;
+		std::vector<char> rows;
+		std::size_t rowBytes;
+		Long64_t entries;
+		int compression;
+
+		void load(std::size_t entry) {
+			const char* row = &rows[entry*rowBytes];
+			for (std::size_t c = 0; c < columns.size(); c++) {
+				std::memcpy(&columns[c].buffer[0], row, columns[c].buffer.size());
+				row += columns[c].buffer.size();
+			}
+		}
+	};
+
+	struct Result {
+		std::string layout, policy;
+		std::vector<std::string> unused;   // encodings that fit no branch
+		std::size_t bytesPerEntry;
+		Long64_t totBytes, zipBytes;
+		double writeSeconds, readSeconds, checksum;
+	};
+
+	double median(std::vector<double> v) {
+		std::sort(v.begin(), v.end());
+		return v[v.size()/2];
+	}
+
+	void declare(pku::NtupleSchema& schema, Sample& sample) {
+		for (std::size_t c = 0; c < sample.columns.size(); c++) {
+			pku::NtupleColumn& column = sample.columns[c];
+			schema.addColumn(column.name, &column.buffer[0], column.type, column.length, pku::Stage::Event);
+		}
+	}
+
+	void write(const std::string& path, const std::string& treeName, pku::NtupleSchema& schema, const edm::ParameterSet& pset,
+	           Sample& sample, Result& r) {
+		std::unique_ptr<TFile> file(TFile::Open(path.c_str(), "RECREATE", "", sample.compression));
+		if (!file || file->IsZombie()) throw std::runtime_error("cannot create " + path);
+		file->cd();
+		TTree* tree = new TTree(treeName.c_str(), treeName.c_str());
+		schema.book(tree, pku::BranchSelector());
+		pku::TreeOutputPolicy policy(pset);
+		policy.apply(tree);
+		for (Long64_t i = 0; i < sample.entries; i++) {
+			sample.load(i);
+			schema.encode();
+			policy.fill(tree);
+		}
+		tree->Write();
+		r.totBytes = tree->GetTotBytes();
+		r.zipBytes = tree->GetZipBytes();
+		file->Close();
+	}
+
+	double read(const std::string& path, const std::string& treeName) {
+		std::unique_ptr<TFile> file(TFile::Open(path.c_str(), "READ"));
+		if (!file || file->IsZombie()) throw std::runtime_error("cannot open " + path);
+		TTree* tree = dynamic_cast<TTree*>(file->Get(treeName.c_str()));
+		if (!tree) throw std::runtime_error("no tree " + treeName + " in " + path);
+		pku::NtupleReader reader(tree);
+		std::vector<std::string> skipped;
+		const std::vector<pku::NtupleColumn> columns = reader.bindColumns(pku::BranchSelector(), skipped);
+		double checksum = 0.;
+		for (Long64_t i = 0; i < tree->GetEntries(); i++) {
+			reader.getEntry(i);
+			for (std::size_t c = 0; c < columns.size(); c++) checksum += columns[c].value(0);
+		}
+		return checksum;
+	}
+
+	Result run(const Options& o, Sample& sample, const std::string& layout, bool encoded, std::size_t policy) {
+		Result r;
+		r.layout = layout;
+		r.policy = o.policies[policy].first;
+		pku::NtupleSchema schema;
+		declare(schema, sample);
+		if (encoded) {
+			for (std::size_t i = 0; i < o.encodings.size(); i++) {
+				try {
+					schema.setEncoding(o.encodings[i].first, pku::Encoding::parse(o.encodings[i].second));
+				} catch (cms::Exception&) {
+					r.unused.push_back(o.encodings[i].first + "=" + o.encodings[i].second);
+				}
+			}
+		}
+		const std::string path = o.workdir + "/benchmarkNtupleIO_" + layout + "_" + r.policy + ".root";
+		const std::string treeName = "ntuple";
+		std::vector<double> writes, reads;
+		r.checksum = 0.;
+		for (unsigned rep = 0; rep < o.repetitions; rep++) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			write(path, treeName, schema, o.policies[policy].second, sample, r);
+			writes.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+			start = std::chrono::steady_clock::now();
+			r.checksum = read(path, treeName);
+			reads.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+		r.bytesPerEntry = schema.bookedBytesPerEntry();
+		r.writeSeconds = median(writes);
+		r.readSeconds = median(reads);
+		return r;
+	}
+
+	void writeJson(std::ostream& out, const Options& o, const Sample& sample, const std::vector<Result>& results) {
+		out << std::setprecision(6)
+		    << "{\n  \"input\": \"" << o.input << "\",\n  \"entries\": " << sample.entries
+		    << ",\n  \"branches\": " << sample.columns.size() << ",\n  \"repetitions\": " << o.repetitions
+		    << ",\n  \"layouts\": [";
+		for (std::size_t i = 0; i < results.size(); i++) {
+			const Result& r = results[i];
+			const double mb = r.totBytes/1e6;
+			out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.layout << "\", \"policy\": \"" << r.policy
+			    << "\", \"bytesPerEntry\": " << r.bytesPerEntry
+			    << ", \"totBytes\": " << r.totBytes << ", \"zipBytes\": " << r.zipBytes
+			    << ", \"zipRatioToPlain\": " << (results[0].zipBytes ? r.zipBytes/double(results[0].zipBytes) : 0.)
+			    << ", \"writeEventsPerSecond\": " << sample.entries/r.writeSeconds << ", \"writeMBPerSecond\": " << mb/r.writeSeconds
+			    << ", \"readEventsPerSecond\": " << sample.entries/r.readSeconds << ", \"readMBPerSecond\": " << mb/r.readSeconds
+			    << ", \"unusedEncodings\": [";
+			for (std::size_t u = 0; u < r.unused.size(); u++) out << (u ? ", " : "") << "\"" << r.unused[u] << "\"";
+			out << "]}";
+		}
+		out << "\n  ]\n}\n";
+	}
+
+}
+
+int main(int argc, char** argv) {
+	Options o;
+	try {
+		o = parse(argc, argv);
+	} catch (std::exception& e) {
+		std::cerr << "pkuBenchmarkNtupleIO: " << e.what() << "\n";
+		usage(std::cerr);
+		return 2;
+	}
+
+	Sample sample;
+	std::vector<std::string> skipped;
+	std::vector<Result> results;
+	try {
+		std::unique_ptr<TFile> in(TFile::Open(o.input.c_str(), "READ"));
+		if (!in || in->IsZombie()) throw std::runtime_error("cannot open " + o.input);
+		TTree* tree = dynamic_cast<TTree*>(in->Get(o.tree.c_str()));
+		if (!tree) throw std::runtime_error("no tree " + o.tree + " in " + o.input);
+		sample.compression = in->GetCompressionSettings();
+		sample.entries = o.events && Long64_t(o.events) < tree->GetEntries() ? Long64_t(o.events) : tree->GetEntries();
+		if (!sample.entries) throw std::runtime_error(o.input + " has no entries");
+		{
+			pku::NtupleReader reader(tree);
+			sample.columns = reader.bindColumns(pku::BranchSelector(), skipped);
+			sample.rowBytes = 0;
+			for (std::size_t c = 0; c < sample.columns.size(); c++) sample.rowBytes += sample.columns[c].buffer.size();
+			sample.rows.resize(sample.entries*sample.rowBytes);
+			for (Long64_t i = 0; i < sample.entries; i++) {
+				reader.getEntry(i);
+				char* row = &sample.rows[i*sample.rowBytes];
+				for (std::size_t c = 0; c < sample.columns.size(); c++) {
+					std::memcpy(row, &sample.columns[c].buffer[0], sample.columns[c].buffer.size());
+					row += sample.columns[c].buffer.size();
+				}
+			}
+		}
+		tree->ResetBranchAddresses();
+
+		for (std::size_t p = 0; p < o.policies.size(); p++) {
+			results.push_back(run(o, sample, "plain", false, p));
+			results.push_back(run(o, sample, "encoded", true, p));
+		}
+	} catch (std::exception& e) {
+		std::cerr << "pkuBenchmarkNtupleIO: " << e.what() << "\n";
+		return 2;
+	}
+
+	std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++\n"
+	          << "pkuBenchmarkNtupleIO SUMMARY: " << sample.entries << " entries, " << sample.columns.size() << " branches of "
+	          << o.input << ", " << o.repetitions << " repetitions\n";
+	if (!skipped.empty()) std::cout << "  " << skipped.size() << " branches not handled by NtupleReader left out\n";
+	std::cout << std::fixed << std::setprecision(1);
+	for (std::size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		const double mb = r.totBytes/1e6;
+		std::cout << "  " << std::setw(8) << std::left << r.layout << std::setw(12) << r.policy << std::right
+		          << " " << r.bytesPerEntry << " B/entry, totBytes=" << r.totBytes << " zipBytes=" << r.zipBytes
+		          << " (" << std::setprecision(3) << (results[0].zipBytes ? r.zipBytes/double(results[0].zipBytes) : 0.) << " of plain)"
+		          << std::setprecision(1) << ", write " << sample.entries/r.writeSeconds << " ev/s " << mb/r.writeSeconds << " MB/s"
+		          << ", read " << sample.entries/r.readSeconds << " ev/s " << mb/r.readSeconds << " MB/s\n";
+		for (std::size_t u = 0; i < 2 && u < r.unused.size(); u++) std::cout << "    encoding " << r.unused[u] << " fits no branch\n";
+	}
+	std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+
+	std::ofstream json(o.output.c_str());
+	writeJson(json, o, sample, results);
+	if (!json) {
+		std::cerr << "pkuBenchmarkNtupleIO: cannot write " << o.output << "\n";
+		return 2;
+	}
+	return 0;
+}
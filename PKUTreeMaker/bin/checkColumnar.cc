@@ -0,0 +1,342 @@
+//
+// Package:    VAJets/PKUTreeMaker
+// Program:    pkuCheckColumnar
+//
+/**
+ Description: round trip of the same events through the TTree and the
+ columnar output, compared column by column.
+
+ Implementation:
+     The events are declared in one NtupleSchema, booked on a TTree and
+     given to a ColumnarWriter, as in the tree makers with columnarOutput.
+     Every row is kept in memory as written; both files are then read back,
+     the tree through NtupleReader and the columnar file through
+     ColumnarReader, and every value of every column is compared bytewise
+     with the reference.  The columnar chunk statistics are checked to
+     bound their values.
+
+       pkuCheckColumnar                                   synthetic events
+       pkuCheckColumnar --input ZtreePKU.root [--tree treeDumper/ZPKUCandidates] [--events N]
+
+     The synthetic events have a scalar of every leaf type, arrays of
+     doubles, ints and bools and the limits of every type, over several
+     row groups the last of which is partial.  With --input the branches
+     of an existing ntuple are used instead, in their decoded type.  The
+     exit code is 0 if both outputs reproduce every value, 1 otherwise.
+*/
+//
+
+#include "VAJets/PKUTreeMaker/interface/ColumnarFile.h"
+#include "VAJets/PKUTreeMaker/interface/NtupleReader.h"
+#include "VAJets/PKUTreeMaker/interface/NtupleSchema.h"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+	struct Options {
+		std::string input, tree, workdir;
+		Long64_t events;
+		std::size_t rowsPerGroup;
+	};
+
+	void usage(std::ostream& out) {
+		out << "usage: pkuCheckColumnar [--input file.root [--tree dir/name]] [--events N] [--rowsPerGroup N] [--workdir dir]\n";
+	}
+
+	Options parse(int argc, char** argv) {
+		Options o;
+		o.tree = "treeDumper/ZPKUCandidates";
+		o.workdir = ".";
+		o.events = 0;
+		o.rowsPerGroup = 1000;
+		for (int i = 1; i < argc; i++) {
+			const std::string arg = argv[i];
+			if (arg == "-h" || arg == "--help") { usage(std::cout); std::exit(0); }
+			if (i + 1 >= argc) throw std::invalid_argument("missing value of " + arg);
+			const std::string value = argv[++i];
+			if      (arg == "--input")        o.input = value;
+			else if (arg == "--tree")         o.tree = value;
+			else if (arg == "--events")       o.events = std::stoll(value);
+			else if (arg == "--rowsPerGroup") o.rowsPerGroup = std::stoul(value);
+			else if (arg == "--workdir")      o.workdir = value;
+			else throw std::invalid_argument("unknown option " + arg);
+		}
+		if (!o.rowsPerGroup) throw std::invalid_argument("--rowsPerGroup must be positive");
+		return o;
+	}
+
+	// One variable of every leaf type, and arrays.
+	struct Synthetic {
+		double d; float f; Int_t i; UInt_t u; Short_t s; UShort_t us;
+		Char_t c; UChar_t uc; Long64_t L; ULong64_t l; bool o;
+		double da[6]; Int_t ia[3]; bool oa[4];
+		std::mt19937 rng;
+
+		void declare(pku::NtupleSchema& schema) {
+			schema.add("d", &d, pku::Stage::Event);
+			schema.add("f", &f, pku::Stage::Event);
+			schema.add("i", &i, pku::Stage::Event);
+			schema.add("u", &u, pku::Stage::Event);
+			schema.add("s", &s, pku::Stage::Event);
+			schema.add("us", &us, pku::Stage::Event);
+			schema.add("c", &c, pku::Stage::Event);
+			schema.add("uc", &uc, pku::Stage::Event);
+			schema.add("L", &L, pku::Stage::Event);
+			schema.add("l", &l, pku::Stage::Event);
+			schema.add("o", &o, pku::Stage::Event);
+			schema.add("da", da, pku::Stage::Event);
+			schema.add("ia", ia, pku::Stage::Event);
+			schema.add("oa", oa, pku::Stage::Event);
+		}
+
+		template<typename T> static T pick(Long64_t row, T value) {
+			// the limits of the type on the first rows, then 'value'
+			switch (row) {
+				case 0: return std::numeric_limits<T>::lowest();
+				case 1: return std::numeric_limits<T>::max();
+				case 2: return T(0);
+				default: return value;
+			}
+		}
+
+		void next(Long64_t row) {
+			std::uniform_real_distribution<double> flat(-1e3, 1e3);
+			d  = pick<double>(row, row == 3 ? -99. : flat(rng));
+			f  = pick<float>(row, float(flat(rng)));
+			i  = pick<Int_t>(row, Int_t(rng()));
+			u  = pick<UInt_t>(row, UInt_t(rng()));
+			s  = pick<Short_t>(row, Short_t(rng()));
+			us = pick<UShort_t>(row, UShort_t(rng()));
+			c  = pick<Char_t>(row, Char_t(rng()));
+			uc = pick<UChar_t>(row, UChar_t(rng()));
+			L  = pick<Long64_t>(row, (Long64_t(rng()) << 32) | rng());
+			l  = pick<ULong64_t>(row, (ULong64_t(rng()) << 32) | rng());
+			o  = rng() & 1;
+			for (int k = 0; k < 6; k++) da[k] = row == 4 ? std::numeric_limits<double>::denorm_min() : flat(rng);
+			for (int k = 0; k < 3; k++) ia[k] = pick<Int_t>(row, Int_t(rng() % 200) - 100);
+			for (int k = 0; k < 4; k++) oa[k] = (row >> k) & 1;
+		}
+	};
+
+	// the booked branches of a schema as fixed-size slices of a row
+	struct RowLayout {
+		std::vector<const pku::BranchSpec*> specs;
+		std::vector<std::size_t> offsets, sizes;
+		std::size_t bytes;
+
+		explicit RowLayout(const pku::NtupleSchema& schema) : specs(schema.booked()), bytes(0) {
+			for (std::size_t i = 0; i < specs.size(); i++) {
+				offsets.push_back(bytes);
+				sizes.push_back(pku::NtupleSchema::typeSize(specs[i]->type) * std::max(1, specs[i]->length));
+				bytes += sizes.back();
+			}
+		}
+		void snapshot(std::vector<char>& rows) const {
+			for (std::size_t i = 0; i < specs.size(); i++) {
+				const char* p = static_cast<const char*>(specs[i]->address);
+				rows.insert(rows.end(), p, p + sizes[i]);
+			}
+		}
+		int index(const std::string& name) const {
+			for (std::size_t i = 0; i < specs.size(); i++) if (specs[i]->name == name) return i;
+			return -1;
+		}
+	};
+
+	// mismatches of one column, reported with the first bad row
+	struct Report {
+		int failures;
+		void mismatch(const std::string& output, const std::string& column, Long64_t row, Long64_t count) {
+			std::cout << "  " << output << ": column " << column << " differs in " << count << " rows, first " << row << "\n";
+			++failures;
+		}
+		void problem(const std::string& output, const std::string& what) {
+			std::cout << "  " << output << ": " << what << "\n";
+			++failures;
+		}
+	};
+
+	template<typename T> void bounds(const char* data, std::size_t n, double& lo, double& hi) {
+		const T* v = reinterpret_cast<const T*>(data);
+		for (std::size_t i = 0; i < n; i++) {
+			if (double(v[i]) < lo) lo = v[i];
+			if (double(v[i]) > hi) hi = v[i];
+		}
+	}
+
+	void checkTree(const std::string& path, const std::string& treeName, const RowLayout& layout,
+	               const std::vector<char>& rows, Long64_t entries, Report& report) {
+		std::unique_ptr<TFile> file(TFile::Open(path.c_str(), "READ"));
+		TTree* tree = file ? dynamic_cast<TTree*>(file->Get(treeName.c_str())) : 0;
+		if (!tree) { report.problem("TTree", "cannot read back " + path); return; }
+		if (tree->GetEntries() != entries) { report.problem("TTree", "wrong number of entries"); return; }
+		pku::NtupleReader reader(tree);
+		std::vector<std::string> skipped;
+		const std::vector<pku::NtupleColumn> columns = reader.bindColumns(pku::BranchSelector(), skipped);
+		for (std::size_t k = 0; k < skipped.size(); k++) report.problem("TTree", "branch " + skipped[k] + " not readable");
+		if (columns.size() != layout.specs.size()) report.problem("TTree", "wrong number of branches");
+
+		std::vector<int> index(columns.size());
+		std::vector<Long64_t> bad(columns.size(), 0), first(columns.size(), -1);
+		for (std::size_t c = 0; c < columns.size(); c++) {
+			index[c] = layout.index(columns[c].name);
+			const pku::BranchSpec* spec = index[c] < 0 ? 0 : layout.specs[index[c]];
+			if (!spec || spec->type != columns[c].type || spec->length != columns[c].length) {
+				report.problem("TTree", "branch " + columns[c].name + " not as declared");
+				index[c] = -1;
+			}
+		}
+		for (Long64_t row = 0; row < entries; row++) {
+			reader.getEntry(row);
+			const char* ref = &rows[row * layout.bytes];
+			for (std::size_t c = 0; c < columns.size(); c++) {
+				if (index[c] < 0) continue;
+				if (std::memcmp(&columns[c].buffer[0], ref + layout.offsets[index[c]], layout.sizes[index[c]]) != 0) {
+					if (!bad[c]++) first[c] = row;
+				}
+			}
+		}
+		for (std::size_t c = 0; c < columns.size(); c++)
+			if (bad[c]) report.mismatch("TTree", columns[c].name, first[c], bad[c]);
+	}
+
+	void checkColumnar(const std::string& path, const RowLayout& layout, const std::vector<char>& rows,
+	                   Long64_t entries, Report& report) {
+		pku::ColumnarReader reader(path);
+		if (Long64_t(reader.rows()) != entries) { report.problem("columnar", "wrong number of rows"); return; }
+		if (reader.columns().size() != layout.specs.size()) report.problem("columnar", "wrong number of columns");
+		for (std::size_t c = 0; c < reader.columns().size(); c++) {
+			const pku::columnar::Column& column = reader.columns()[c];
+			const int i = layout.index(column.name);
+			if (i < 0 || layout.specs[i]->type != column.type || layout.specs[i]->length != column.length) {
+				report.problem("columnar", "column " + column.name + " not as declared");
+				continue;
+			}
+			Long64_t bad = 0, first = -1, row = 0;
+			for (std::size_t g = 0; g < reader.rowGroups().size(); g++) {
+				const Long64_t n = reader.rowGroups()[g].rows;
+				const char* data = static_cast<const char*>(reader.chunk(c, g));
+				for (Long64_t r = 0; r < n; r++, row++) {
+					if (std::memcmp(data + r * layout.sizes[i], &rows[row * layout.bytes + layout.offsets[i]], layout.sizes[i]) != 0) {
+						if (!bad++) first = row;
+					}
+				}
+				// chunk statistics must be the bounds of the values
+				double lo = std::numeric_limits<double>::infinity(), hi = -lo;
+				const std::size_t values = n * std::max(1, column.length);
+				switch (column.type) {
+					case 'D': bounds<double>(data, values, lo, hi); break;
+					case 'F': bounds<float>(data, values, lo, hi); break;
+					case 'I': bounds<Int_t>(data, values, lo, hi); break;
+					case 'i': bounds<UInt_t>(data, values, lo, hi); break;
+					case 'S': bounds<Short_t>(data, values, lo, hi); break;
+					case 's': bounds<UShort_t>(data, values, lo, hi); break;
+					case 'B': bounds<Char_t>(data, values, lo, hi); break;
+					case 'b': bounds<UChar_t>(data, values, lo, hi); break;
+					case 'L': bounds<Long64_t>(data, values, lo, hi); break;
+					case 'l': bounds<ULong64_t>(data, values, lo, hi); break;
+					case 'O': bounds<bool>(data, values, lo, hi); break;
+				}
+				const pku::columnar::Chunk& chunk = reader.rowGroups()[g].chunks[c];
+				if (chunk.min != lo || chunk.max != hi)
+					report.problem("columnar", "statistics of " + column.name + " in row group " + std::to_string(g));
+			}
+			if (bad) report.mismatch("columnar", column.name, first, bad);
+		}
+	}
+
+}
+
+int main(int argc, char** argv) {
+	Options o;
+	try {
+		o = parse(argc, argv);
+	} catch (std::exception& e) {
+		std::cerr << "pkuCheckColumnar: " << e.what() << "\n";
+		usage(std::cerr);
+		return 2;
+	}
+
+	const std::string treePath = o.workdir + "/checkColumnar.root";
+	const std::string columnarPath = o.workdir + "/checkColumnar.col";
+	const std::string treeName = "ntuple";
+	Report report = { 0 };
+	Long64_t entries = 0;
+	try {
+		pku::NtupleSchema schema;
+		std::function<void(Long64_t)> next;
+
+		Synthetic synthetic;
+		std::unique_ptr<TFile> in;
+		std::unique_ptr<pku::NtupleReader> source;
+		std::vector<pku::NtupleColumn> sourceColumns;
+		if (o.input.empty()) {
+			entries = o.events ? o.events : Long64_t(5 * o.rowsPerGroup / 2);
+			synthetic.declare(schema);
+			next = [&synthetic](Long64_t row) { synthetic.next(row); };
+		} else {
+			in.reset(TFile::Open(o.input.c_str(), "READ"));
+			TTree* tree = in ? dynamic_cast<TTree*>(in->Get(o.tree.c_str())) : 0;
+			if (!tree) throw std::runtime_error("no tree " + o.tree + " in " + o.input);
+			entries = o.events && o.events < tree->GetEntries() ? o.events : tree->GetEntries();
+			source.reset(new pku::NtupleReader(tree));
+			std::vector<std::string> skipped;
+			sourceColumns = source->bindColumns(pku::BranchSelector(), skipped);
+			if (!skipped.empty()) std::cout << "pkuCheckColumnar: " << skipped.size() << " branches of " << o.input << " not handled, left out\n";
+			for (std::size_t c = 0; c < sourceColumns.size(); c++) {
+				pku::NtupleColumn& column = sourceColumns[c];
+				schema.addColumn(column.name, &column.buffer[0], column.type, column.length, pku::Stage::Event);
+			}
+			pku::NtupleReader* reader = source.get();
+			next = [reader](Long64_t row) { reader->getEntry(row); };
+		}
+
+		std::unique_ptr<TFile> out(TFile::Open(treePath.c_str(), "RECREATE"));
+		if (!out || out->IsZombie()) throw std::runtime_error("cannot create " + treePath);
+		out->cd();
+		TTree* tree = new TTree(treeName.c_str(), treeName.c_str());
+		schema.book(tree, pku::BranchSelector());
+		const RowLayout layout(schema);
+		std::vector<char> rows;
+		rows.reserve(entries * layout.bytes);
+		{
+			pku::ColumnarWriter columnar(columnarPath, schema, o.rowsPerGroup);
+			for (Long64_t row = 0; row < entries; row++) {
+				next(row);
+				layout.snapshot(rows);
+				schema.encode();
+				tree->Fill();
+				columnar.fill();
+			}
+			columnar.close();
+		}
+		tree->Write();
+		out->Close();
+
+		checkTree(treePath, treeName, layout, rows, entries, report);
+		checkColumnar(columnarPath, layout, rows, entries, report);
+
+		std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++\n"
+		          << "pkuCheckColumnar SUMMARY: " << entries << " events, " << layout.specs.size() << " columns of "
+		          << (o.input.empty() ? std::string("synthetic events") : o.input) << ", "
+		          << (report.failures ? std::to_string(report.failures) + " problems" : std::string("TTree and columnar identical")) << "\n"
+		          << "++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+	} catch (std::exception& e) {
+		std::cerr << "pkuCheckColumnar: " << e.what() << "\n";
+		return 2;
+	}
+	return report.failures ? 1 : 0;
+}
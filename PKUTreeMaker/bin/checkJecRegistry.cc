@@ -0,0 +1,120 @@
+//
+// Package:    VAJets/PKUTreeMaker
+// Program:    pkuCheckJecRegistry
+//
+/**
+ Description: run -> payload lookup of JecRegistry at the era boundaries.
+
+ Implementation:
+     A registry is built from the Summer16_23Sep2016 data era table of
+     VAJets/PKUCommon/python/jecEras_cff.py and every boundary is probed
+     from both sides, in increasing and decreasing run order so that both
+     the cached era and a fresh lookup are exercised:
+
+       BCD  1      - 276811
+       EF   276812 - 278801
+       G    278802 - 280385
+       H    280919 - 999999
+
+     Runs 280386-280918 (no collision data) belong to no era and must be
+     rejected.  A second registry with the flat list as well checks that
+     the flat list takes every run outside the eras.  Only the payload
+     names are looked up, no corrector is compiled, so no payload file is
+     needed.  The exit code is 0 if every lookup is as expected.
+*/
+//
+
+#include "VAJets/PKUTreeMaker/interface/JecRegistry.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+	struct Era {
+		const char* name;
+		unsigned firstRun, lastRun;
+	};
+
+	// keep in sync with jecEraRuns2016 of VAJets/PKUCommon/python/jecEras_cff.py
+	const Era kEras[] = {
+		{ "BCD", 1,      276811 },
+		{ "EF",  276812, 278801 },
+		{ "G",   278802, 280385 },
+		{ "H",   280919, 999999 },
+	};
+	const unsigned kNEras = sizeof(kEras) / sizeof(kEras[0]);
+
+	edm::ParameterSet config(bool withFlat) {
+		std::vector<edm::ParameterSet> eras;
+		for (unsigned i = 0; i < kNEras; i++) {
+			edm::ParameterSet era;
+			era.addParameter<unsigned>("firstRun", kEras[i].firstRun);
+			era.addParameter<unsigned>("lastRun", kEras[i].lastRun);
+			era.addParameter<std::vector<std::string> >("jecAK4chsPayloadNames", std::vector<std::string>(1, kEras[i].name));
+			eras.push_back(era);
+		}
+		edm::ParameterSet pset;
+		pset.addParameter<std::vector<edm::ParameterSet> >("jecEras", eras);
+		if (withFlat) pset.addParameter<std::vector<std::string> >("jecAK4chsPayloadNames", std::vector<std::string>(1, "MC"));
+		return pset;
+	}
+
+	// expected payload set of 'run', "" if none
+	std::string expected(unsigned run, bool withFlat) {
+		for (unsigned i = 0; i < kNEras; i++)
+			if (run >= kEras[i].firstRun && run <= kEras[i].lastRun) return kEras[i].name;
+		return withFlat ? "MC" : "";
+	}
+
+	int check(pku::JecRegistry& registry, const std::vector<unsigned>& runs, bool withFlat) {
+		int failures = 0;
+		for (size_t i = 0; i < runs.size(); i++) {
+			const unsigned run = runs[i];
+			const std::string want = expected(run, withFlat);
+			std::string got;
+			try {
+				got = registry.payloads(run).front();
+			} catch (cms::Exception&) {
+				got = "";
+			}
+			if (got != want) {
+				std::cout << "  run " << run << ": payloads " << (got.empty() ? "<none>" : got)
+				          << ", expected " << (want.empty() ? "<none>" : want) << "\n";
+				++failures;
+			}
+		}
+		return failures;
+	}
+
+}
+
+int main() {
+	std::vector<unsigned> runs;
+	runs.push_back(0);
+	for (unsigned i = 0; i < kNEras; i++) {
+		const unsigned edges[] = { kEras[i].firstRun - 1, kEras[i].firstRun, kEras[i].firstRun + 1,
+		                           kEras[i].lastRun - 1, kEras[i].lastRun, kEras[i].lastRun + 1 };
+		runs.insert(runs.end(), edges, edges + 6);
+	}
+	runs.push_back(280600);
+	runs.push_back(4294967295u);
+	const std::vector<unsigned> backwards(runs.rbegin(), runs.rend());
+
+	int failures = 0;
+	for (int withFlat = 0; withFlat < 2; withFlat++) {
+		pku::JecRegistry registry(config(withFlat), "jecAK4chsPayloadNames");
+		failures += check(registry, runs, withFlat);
+		failures += check(registry, backwards, withFlat);
+	}
+
+	std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++\n"
+	          << "pkuCheckJecRegistry SUMMARY: " << 4 * runs.size() << " lookups, "
+	          << (failures ? std::to_string(failures) + " wrong" : std::string("all as expected")) << "\n"
+	          << "++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+	return failures ? 1 : 0;
+}
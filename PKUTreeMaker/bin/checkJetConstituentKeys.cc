@@ -0,0 +1,109 @@
+//
+// Package:    VAJets/PKUTreeMaker
+// Program:    pkuCheckJetConstituentKeys
+//
+/**
+ Description: Type-I muon subtraction with the jet constituent keys
+ against the daughter scan, on one jet.
+
+ Implementation:
+     The jet has two constituents linked to selected muons, one to a muon
+     failing the selection and one hadron; the event has one more selected
+     muon outside the jet.  Both modes of pku::typeIMuonP4 must give the
+     four-momentum of the two selected muons of the jet, each counted once,
+     and the key mode must not run the scan.  The keys go through
+     JetConstituentKeys::append as JetUserData writes them, with a first
+     jet so that the one tested is not at offset 0.  The exit code is 0 if
+     both modes agree.
+*/
+//
+
+#include "VAJets/PKUTreeMaker/interface/JetConstituentKeys.h"
+
+#include "TLorentzVector.h"
+
+#include <cmath>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace {
+
+	struct Daughter {
+		unsigned int key;     // PF candidate key
+		TLorentzVector p4;
+		bool selectedMuon;    // linked to a muon passing the skip selection
+	};
+
+	TLorentzVector p4(double pt, double eta, double phi, double m) {
+		TLorentzVector v;
+		v.SetPtEtaPhiM(pt, eta, phi, m);
+		return v;
+	}
+
+	bool same(const TLorentzVector& a, const TLorentzVector& b) {
+		return std::abs(a.Px() - b.Px()) < 1e-9 && std::abs(a.Py() - b.Py()) < 1e-9
+		    && std::abs(a.Pz() - b.Pz()) < 1e-9 && std::abs(a.E() - b.E()) < 1e-9;
+	}
+
+	void print(std::ostream& out, const char* what, const TLorentzVector& v) {
+		out << "  " << what << " (" << v.Px() << ", " << v.Py() << ", " << v.Pz() << ", " << v.E() << ")\n";
+	}
+
+}
+
+int main() {
+	std::vector<Daughter> daughters;
+	daughters.push_back(Daughter{ 17, p4(35.,  0.4, 1.0, 0.106), true  });
+	daughters.push_back(Daughter{  4, p4(60.,  0.5, 1.1, 1.2),   false });
+	daughters.push_back(Daughter{ 23, p4(12.,  0.3, 0.9, 0.106), true  });
+	daughters.push_back(Daughter{  9, p4( 8.,  0.6, 1.2, 0.106), false });   // muon failing the selection
+
+	// selected muons of the event, by the key of their PF candidate
+	std::vector<std::pair<unsigned int, TLorentzVector> > muonKeys;
+	for (std::size_t i = 0; i < daughters.size(); i++)
+		if (daughters[i].selectedMuon) muonKeys.push_back(std::make_pair(daughters[i].key, daughters[i].p4));
+	muonKeys.push_back(std::make_pair(31u, p4(40., -1.5, -2.0, 0.106)));   // outside the jet
+
+	std::vector<unsigned int> offsets(1, 0), keys;
+	const unsigned int otherJet[] = { 31, 2, 5 };
+	pku::JetConstituentKeys::append(offsets, keys, otherJet, otherJet + 3);
+	std::vector<unsigned int> jetKeys;
+	for (std::size_t i = 0; i < daughters.size(); i++) jetKeys.push_back(daughters[i].key);
+	pku::JetConstituentKeys::append(offsets, keys, jetKeys.begin(), jetKeys.end());
+	const pku::JetConstituentKeys constituents(offsets, keys);
+	const std::size_t jet = 1;
+
+	int scans = 0;
+	auto scan = [&daughters, &scans]() {
+		++scans;
+		TLorentzVector sum;
+		for (std::size_t i = 0; i < daughters.size(); i++)
+			if (daughters[i].selectedMuon) sum += daughters[i].p4;
+		return sum;
+	};
+
+	TLorentzVector expected;
+	for (std::size_t i = 0; i < daughters.size(); i++)
+		if (daughters[i].selectedMuon) expected += daughters[i].p4;
+
+	const TLorentzVector byScan = pku::typeIMuonP4<TLorentzVector>(0, jet, muonKeys, scan);
+	const int scansInScanMode = scans;
+	const TLorentzVector byKeys = pku::typeIMuonP4<TLorentzVector>(&constituents, jet, muonKeys, scan);
+	const int scansInKeyMode = scans - scansInScanMode;
+
+	int failures = 0;
+	if (!same(byScan, expected)) { std::cout << "scan mode:\n"; print(std::cout, "got     ", byScan); ++failures; }
+	if (!same(byKeys, expected)) { std::cout << "key mode:\n"; print(std::cout, "got     ", byKeys); ++failures; }
+	if (failures) print(std::cout, "expected", expected);
+	if (scansInScanMode != 1 || scansInKeyMode != 0) {
+		std::cout << "  scan ran " << scansInScanMode << " time(s) in scan mode and " << scansInKeyMode << " in key mode\n";
+		++failures;
+	}
+
+	std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++\n"
+	          << "pkuCheckJetConstituentKeys SUMMARY: key and scan mode "
+	          << (failures ? "differ" : "agree") << "\n"
+	          << "++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,208 @@
+//
+// Package:    VAJets/PKUTreeMaker
+// Program:    pkuCheckZRecord
+//
+/**
+ Description: the round trip of the ZPKUTreeMaker event records through
+ ZRecordWriter and ZRecordReader.
+
+ Implementation:
+     Generated records, with every status and empty as well as filled
+     collections, are written to a file, read back and written again; the
+     two files must be byte for byte the same, with the configuration and
+     the record count of the first.  A truncated copy and a copy with a
+     byte-swapped version word must be rejected with a cms::Exception.  The
+     files are written in the working directory, or in the one given:
+
+       pkuCheckZRecord [directory] [--events N]
+
+     This covers the capture and the file, not the analysis: that the
+     replay reproduces the ntuple of cmsRun is checked by
+     test/checkReplay.py.  The exit code is 0 if every check passes.
+*/
+//
+
+#include "VAJets/PKUTreeMaker/interface/ZEventRecord.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+	class Generator {
+		public:
+			explicit Generator(unsigned seed) : rng_(seed) {}
+
+			void fill(pku::ZEventRecord& r, unsigned long i) {
+				r.clear();
+				r.status = i % (pku::ZEventRecord::Complete + 1);
+				r.run = 273150 + i/5000; r.ls = 1 + i/100; r.event = 1000 + i;
+				r.theWeight = uniform(-1., 1.) < 0. ? -1. : 1.;
+				r.nBX = integer(-1, 1); r.npT = uniform(0., 50.); r.npIT = uniform(0., 50.);
+				r.HLT_Ele1 = integer(-99, 1); r.HLT_Mu1 = integer(0, 1); r.HLT_Mu8 = integer(0, 1);
+				r.passFilter_HBHE = integer(0, 1); r.passFilter_badMuon = integer(0, 1); r.passFilter_duplicateMuon = integer(0, 1);
+				r.rho = uniform(0., 40.);
+				r.genParticles.resize(size());
+				for (std::size_t k = 0; k < r.genParticles.size(); k++) {
+					pku::ZEventRecord::GenParticle& g = r.genParticles[k];
+					g.pdgId = integer(-22, 22); g.pt = uniform(0., 200.); g.eta = uniform(-5., 5.); g.phi = uniform(-3.2, 3.2);
+				}
+				r.genJets.resize(size());
+				for (std::size_t k = 0; k < r.genJets.size(); k++) {
+					pku::ZEventRecord::GenJet& g = r.genJets[k];
+					g.e = uniform(20., 500.); g.pt = uniform(20., 300.); g.eta = uniform(-5., 5.); g.phi = uniform(-3.2, 3.2);
+				}
+				r.nlooseeles = integer(0, 3); r.nloosemus = integer(0, 3); r.ngoodmus = integer(0, 3);
+				r.muon1_trackerLayers = integer(5, 18); r.lep1_eta_station2 = uniform(-2.4, 2.4);
+				r.ptV = uniform(0., 300.); r.massV = uniform(70., 110.); r.energyV = uniform(90., 800.);
+				lepton(r.lepton1); lepton(r.lepton2);
+				r.met = uniform(0., 200.); r.metPhi = uniform(-3.2, 3.2);
+				r.vertices.resize(size());
+				for (std::size_t k = 0; k < r.vertices.size(); k++) {
+					pku::ZEventRecord::Vertex& v = r.vertices[k];
+					v.chi2 = uniform(0., 50.); v.ndof = uniform(4., 100.); v.rho = uniform(0., 2.); v.z = uniform(-24., 24.);
+				}
+				r.hasMET = integer(0, 1);
+				r.mets.resize(r.hasMET);
+				for (std::size_t k = 0; k < r.mets.size(); k++) {
+					r.mets[k].uncorPt = uniform(0., 200.); r.mets[k].uncorPhi = uniform(-3.2, 3.2); r.mets[k].uncorSumEt = uniform(100., 2000.);
+				}
+				r.typeIJets.resize(size());
+				for (std::size_t k = 0; k < r.typeIJets.size(); k++) {
+					pku::ZEventRecord::TypeIJet& j = r.typeIJets[k];
+					j.px = uniform(-100., 100.); j.py = uniform(-100., 100.); j.pz = uniform(-300., 300.); j.e = uniform(300., 400.);
+					j.subPx = j.px; j.subPy = j.py; j.subPz = j.pz; j.subE = j.e; j.area = uniform(0.4, 0.6);
+				}
+				r.photons.resize(size());
+				for (std::size_t k = 0; k < r.photons.size(); k++) {
+					pku::ZEventRecord::Photon& p = r.photons[k];
+					p.pt = uniform(10., 200.); p.eta = uniform(-2.5, 2.5); p.scEta = p.eta; p.scPhi = uniform(-3.2, 3.2); p.energy = uniform(10., 600.);
+					p.hoe = uniform(0., .1); p.sieie = uniform(0., .03); p.chIso = uniform(0., 5.); p.nhIso = uniform(0., 5.); p.phoIso = uniform(0., 5.);
+					p.isEB = integer(0, 1); p.isEE = !p.isEB; p.eleVeto = integer(0, 1); p.passEleVeto = integer(0, 1); p.hasPixelSeed = integer(0, 1);
+					p.istrue = integer(-1, 1); p.isprompt = integer(-1, 1);
+				}
+				r.jets.resize(size());
+				for (std::size_t k = 0; k < r.jets.size(); k++) {
+					pku::ZEventRecord::Jet& j = r.jets[k];
+					j.px = uniform(-100., 100.); j.py = uniform(-100., 100.); j.pz = uniform(-300., 300.); j.e = uniform(300., 400.);
+					j.eta = uniform(-4.7, 4.7); j.phi = uniform(-3.2, 3.2); j.area = uniform(0.4, 0.6); j.csv = uniform(0., 1.); j.icsv = uniform(0., 1.);
+				}
+			}
+
+		private:
+			double uniform(double a, double b) { return std::uniform_real_distribution<double>(a, b)(rng_); }
+			int integer(int a, int b) { return std::uniform_int_distribution<int>(a, b)(rng_); }
+			// empty one time in four
+			std::size_t size() { return integer(0, 3) ? integer(1, 12) : 0; }
+			void lepton(pku::ZEventRecord::Lepton& l) {
+				l.pdgId = integer(0, 1) ? 11 : -13; l.pt = uniform(20., 200.); l.eta = uniform(-2.4, 2.4); l.phi = uniform(-3.2, 3.2); l.energy = uniform(20., 600.);
+			}
+
+			std::mt19937 rng_;
+	};
+
+	std::string contents(const std::string& path) {
+		std::ifstream in(path.c_str(), std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+
+	void store(const std::string& path, const std::string& data) {
+		std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+		out.write(data.data(), data.size());
+	}
+
+	// the reader must throw on 'path', at the header or at a record
+	bool rejected(const std::string& path, std::string& message) {
+		try {
+			pku::ZRecordReader reader(path);
+			pku::ZEventRecord record;
+			while (reader.next(record)) {}
+		} catch (cms::Exception& e) {
+			message = e.what();
+			const std::string::size_type end = message.find_last_not_of("\n ");
+			message = message.substr(0, end == std::string::npos ? 0 : end + 1);
+			return true;
+		}
+		return false;
+	}
+
+	void report(bool& ok, bool pass, const std::string& what) {
+		std::cout << "  " << (pass ? "ok    " : "FAILED") << " " << what << "\n";
+		ok = ok && pass;
+	}
+
+}
+
+int main(int argc, char** argv) {
+	std::string directory = ".";
+	unsigned long events = 5000;
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "--events" && i + 1 < argc) events = std::stoul(argv[++i]);
+		else if (arg.compare(0, 2, "--") != 0) directory = arg;
+		else { std::cerr << "usage: pkuCheckZRecord [directory] [--events N]\n"; return 2; }
+	}
+	const std::string first = directory + "/checkZRecord_1.zrec", second = directory + "/checkZRecord_2.zrec",
+		truncated = directory + "/checkZRecord_truncated.zrec", swapped = directory + "/checkZRecord_swapped.zrec";
+	const std::string configuration = "<treeDumper: a configuration that must come back unchanged>";
+
+	bool ok = true;
+	std::cout << "pkuCheckZRecord: " << events << " records\n";
+	try {
+		Generator generator(20161019);
+		pku::ZEventRecord record;
+		unsigned long long bytes = 0;
+		{
+			pku::ZRecordWriter writer(first, configuration);
+			for (unsigned long i = 0; i < events; i++) {
+				generator.fill(record, i);
+				writer.write(record);
+			}
+			writer.close();
+			bytes = writer.bytesWritten();
+			report(ok, writer.events() == events, "writer counts the records");
+		}
+		report(ok, contents(first).size() == bytes, "writer counts the bytes of the file");
+
+		unsigned long read = 0;
+		{
+			pku::ZRecordReader reader(first);
+			report(ok, reader.configuration() == configuration, "configuration read back");
+			pku::ZRecordWriter writer(second, reader.configuration());
+			while (reader.next(record)) {
+				writer.write(record);
+				++read;
+			}
+		}
+		report(ok, read == events, "every record read back");
+		report(ok, contents(first) == contents(second), "records written again are byte for byte the same");
+
+		const std::string data = contents(first);
+		std::string message;
+		store(truncated, data.substr(0, data.size() - 3));
+		bool pass = rejected(truncated, message);
+		report(ok, pass, "truncated file rejected: " + message);
+		std::string other = data;
+		std::swap(other[8], other[11]); std::swap(other[9], other[10]);
+		store(swapped, other);
+		pass = rejected(swapped, message);
+		report(ok, pass, "other byte order rejected: " + message);
+	} catch (cms::Exception& e) {
+		std::cout << "  FAILED " << e.what() << "\n";
+		ok = false;
+	}
+	std::remove(first.c_str());
+	std::remove(second.c_str());
+	std::remove(truncated.c_str());
+	std::remove(swapped.c_str());
+	std::cout << (ok ? "all checks passed" : "some checks FAILED") << std::endl;
+	return ok ? 0 : 1;
+}
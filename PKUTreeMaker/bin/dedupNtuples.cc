@@ -0,0 +1,281 @@
+//
+// Package:    VAJets/PKUTreeMaker
+// Program:    pkuDedupNtuples
+//
+/**
+ Description: merges the data ntuples of several primary datasets, keeping
+ every event once.
+
+ Implementation:
+     An event triggering both the electron and the muon paths (elPaths*,
+     muPaths* of the tree makers) is in DoubleEG and in DoubleMuon, or in
+     a single lepton dataset as well.  The datasets are given in priority
+     order; an event is taken from the first dataset that has it and
+     dropped from the others:
+
+       pkuDedupNtuples ZtreePKU_data.root --dataset DoubleMuon=@mu.txt \
+           --dataset DoubleEG=@eg.txt --dataset SingleMuon=a.root,b.root
+
+     (@list.txt is a text file with one file per line.)  A first pass reads
+     the run branch of every input and counts the entries per run; the
+     runs are then taken in groups whose keys fit in --memory MB
+     (EventKeySet, EventKeys.h), and for every group the inputs are read
+     in priority order, only those whose runs overlap the group.  With
+     enough memory there is one group and one pass over the data.  A file
+     whose entries are all taken in a group is copied basket by basket
+     ("fast" CopyEntries), the others entry by entry.
+
+     The summary gives, per dataset, the entries read and taken, and the
+     duplicates per pair of datasets, the one that kept the event first;
+     an event repeated within a dataset counts on the diagonal.
+*/
+//
+
+#include "VAJets/PKUTreeMaker/interface/EventKeys.h"
+
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+	struct Input {
+		std::string path;
+		std::size_t dataset;
+		Long64_t entries;
+		unsigned firstRun, lastRun;
+	};
+
+	struct Options {
+		std::string output, tree;
+		std::vector<std::string> datasets;
+		std::vector<Input> inputs;
+		double memoryMB;
+	};
+
+	void usage(std::ostream& out) {
+		out << "usage: pkuDedupNtuples output.root --dataset NAME=file.root[,file.root...|@list.txt] [--dataset ...]\n"
+		    << "                       [--tree dir/name] [--memory MB]\n";
+	}
+
+	void addFiles(Options& o, const std::string& spec) {
+		if (!spec.empty() && spec[0] == '@') {
+			std::ifstream list(spec.c_str() + 1);
+			if (!list) throw std::invalid_argument("cannot read " + spec.substr(1));
+			std::string line;
+			while (std::getline(list, line)) {
+				line = line.substr(0, line.find('#'));
+				const std::string::size_type a = line.find_first_not_of(" \t"), b = line.find_last_not_of(" \t\r");
+				if (a == std::string::npos) continue;
+				Input in = { line.substr(a, b - a + 1), o.datasets.size() - 1, 0, 0, 0 };
+				o.inputs.push_back(in);
+			}
+			return;
+		}
+		std::string::size_type start = 0;
+		while (start <= spec.size()) {
+			const std::string::size_type comma = std::min(spec.find(',', start), spec.size());
+			if (comma > start) {
+				Input in = { spec.substr(start, comma - start), o.datasets.size() - 1, 0, 0, 0 };
+				o.inputs.push_back(in);
+			}
+			start = comma + 1;
+		}
+	}
+
+	Options parse(int argc, char** argv) {
+		Options o;
+		o.tree = "treeDumper/ZPKUCandidates";
+		o.memoryMB = 2048.;
+		for (int i = 1; i < argc; i++) {
+			const std::string arg = argv[i];
+			if (arg == "-h" || arg == "--help") { usage(std::cout); std::exit(0); }
+			if (arg.compare(0, 2, "--") != 0) {
+				if (!o.output.empty()) throw std::invalid_argument("more than one output: " + arg);
+				o.output = arg;
+				continue;
+			}
+			if (i + 1 >= argc) throw std::invalid_argument("missing value of " + arg);
+			const std::string value = argv[++i];
+			if (arg == "--tree") o.tree = value;
+			else if (arg == "--memory") o.memoryMB = std::atof(value.c_str());
+			else if (arg == "--dataset") {
+				const std::string::size_type eq = value.find('=');
+				if (eq == std::string::npos || eq == 0) throw std::invalid_argument("--dataset needs NAME=files, not " + value);
+				if (std::find(o.datasets.begin(), o.datasets.end(), value.substr(0, eq)) != o.datasets.end())
+					throw std::invalid_argument("dataset " + value.substr(0, eq) + " given twice");
+				o.datasets.push_back(value.substr(0, eq));
+				addFiles(o, value.substr(eq + 1));
+			}
+			else throw std::invalid_argument("unknown option " + arg);
+		}
+		if (o.output.empty()) throw std::invalid_argument("no output");
+		if (o.datasets.empty() || o.inputs.empty()) throw std::invalid_argument("no input dataset");
+		if (o.datasets.size() > 255) throw std::invalid_argument("at most 255 datasets");
+		if (o.memoryMB <= 0.) throw std::invalid_argument("--memory must be positive");
+		return o;
+	}
+
+	TTree* openTree(std::unique_ptr<TFile>& file, const std::string& path, const std::string& name) {
+		file.reset(TFile::Open(path.c_str(), "READ"));
+		if (!file || file->IsZombie()) throw std::runtime_error("cannot open " + path);
+		TTree* tree = dynamic_cast<TTree*>(file->Get(name.c_str()));
+		if (!tree) throw std::runtime_error("no tree " + name + " in " + path);
+		return tree;
+	}
+
+	// consecutive runs whose keys fit in the memory budget; a larger run is a group alone
+	std::vector<std::pair<unsigned, unsigned> > runGroups(const std::map<unsigned, Long64_t>& perRun, double memoryMB) {
+		const double budget = memoryMB*1024.*1024./pku::EventKeySet::bytesPerKey;
+		std::vector<std::pair<unsigned, unsigned> > groups;
+		double keys = 0.;
+		for (std::map<unsigned, Long64_t>::const_iterator r = perRun.begin(); r != perRun.end(); ++r) {
+			if (groups.empty() || keys + r->second > budget) {
+				groups.push_back(std::make_pair(r->first, r->first));
+				keys = 0.;
+			}
+			groups.back().second = r->first;
+			keys += r->second;
+		}
+		return groups;
+	}
+
+}
+
+int main(int argc, char** argv) {
+	Options o;
+	try {
+		o = parse(argc, argv);
+	} catch (std::exception& e) {
+		std::cerr << "pkuDedupNtuples: " << e.what() << "\n";
+		usage(std::cerr);
+		return 2;
+	}
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	const std::size_t nData = o.datasets.size();
+	std::vector<Long64_t> read(nData, 0), taken(nData, 0);
+	std::vector<std::vector<Long64_t> > duplicates(nData, std::vector<Long64_t>(nData, 0));
+	std::vector<std::pair<unsigned, unsigned> > groups;
+	std::size_t peakBytes = 0, fastCopies = 0;
+	try {
+		// pass 1: entries per run, and the runs of every input
+		std::map<unsigned, Long64_t> perRun;
+		for (std::size_t f = 0; f < o.inputs.size(); f++) {
+			Input& input = o.inputs[f];
+			std::unique_ptr<TFile> file;
+			TTree* tree = openTree(file, input.path, o.tree);
+			pku::EventKeyReader keys(tree);
+			input.entries = tree->GetEntries();
+			input.firstRun = ~0U;
+			input.lastRun = 0;
+			for (Long64_t i = 0; i < input.entries; i++) {
+				const unsigned run = keys.run(i);
+				++perRun[run];
+				input.firstRun = std::min(input.firstRun, run);
+				input.lastRun = std::max(input.lastRun, run);
+			}
+			read[input.dataset] += input.entries;
+		}
+		groups = runGroups(perRun, o.memoryMB);
+
+		// pass 2: the inputs in priority order, one group of runs at a time
+		const std::string::size_type slash = o.tree.rfind('/');
+		const std::string dirName = slash == std::string::npos ? "" : o.tree.substr(0, slash);
+		std::unique_ptr<TFile> out;
+		TTree* merged = 0;
+		pku::EventKeySet seen;
+		for (std::size_t g = 0; g < groups.size(); g++) {
+			const unsigned lo = groups[g].first, hi = groups[g].second;
+			seen.clear();
+			for (std::size_t d = 0; d < nData; d++) {
+				for (std::size_t f = 0; f < o.inputs.size(); f++) {
+					const Input& input = o.inputs[f];
+					if (input.dataset != d || input.entries == 0 || input.lastRun < lo || input.firstRun > hi) continue;
+					std::unique_ptr<TFile> file;
+					TTree* tree = openTree(file, input.path, o.tree);
+					pku::EventKeyReader keys(tree);
+					std::vector<bool> take(input.entries, false);
+					Long64_t nTake = 0;
+					for (Long64_t i = 0; i < input.entries; i++) {
+						if (input.firstRun < lo || input.lastRun > hi) {
+							const unsigned run = keys.run(i);
+							if (run < lo || run > hi) continue;
+						}
+						unsigned run, ls;
+						unsigned long long event;
+						keys.key(i, run, ls, event);
+						const int first = seen.insert(run, ls, event, static_cast<unsigned char>(d));
+						if (first >= 0) { ++duplicates[first][d]; continue; }
+						take[i] = true;
+						++nTake;
+					}
+					taken[d] += nTake;
+					peakBytes = std::max(peakBytes, seen.memoryBytes());
+
+					if (!out) {
+						out.reset(TFile::Open(o.output.c_str(), "RECREATE", "", file->GetCompressionSettings()));
+						if (!out || out->IsZombie()) throw std::runtime_error("cannot create " + o.output);
+						TDirectory* dir = out.get();
+						if (!dirName.empty()) dir = out->mkdir(dirName.c_str());
+						dir->cd();
+						merged = tree->CloneTree(0);
+						merged->SetDirectory(dir);
+					}
+					if (nTake == input.entries) {
+						merged->CopyEntries(tree, -1, "fast");
+						++fastCopies;
+					} else if (nTake > 0) {
+						// as the slow path of CopyEntries, only the entries taken
+						merged->CopyAddresses(tree);
+						for (Long64_t i = 0; i < input.entries; i++) {
+							if (!take[i]) continue;
+							tree->GetEntry(i);
+							merged->Fill();
+						}
+						tree->ResetBranchAddresses();
+					}
+				}
+			}
+		}
+		if (!merged) throw std::runtime_error("all inputs are empty");
+		merged->GetDirectory()->cd();
+		merged->Write();
+		out->Close();
+	} catch (std::exception& e) {
+		std::cerr << "pkuDedupNtuples: " << e.what() << "\n";
+		return 1;
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	Long64_t allRead = 0, allTaken = 0;
+	std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++\n"
+	          << "pkuDedupNtuples SUMMARY: " << o.inputs.size() << " files of " << nData << " datasets into " << o.output << "\n";
+	for (std::size_t d = 0; d < nData; d++) {
+		std::cout << "  " << d + 1 << ". " << o.datasets[d] << ": " << read[d] << " entries, " << taken[d] << " taken, "
+		          << read[d] - taken[d] << " duplicates\n";
+		allRead += read[d];
+		allTaken += taken[d];
+	}
+	std::cout << "  duplicates (kept in / dropped from):\n";
+	for (std::size_t a = 0; a < nData; a++)
+		for (std::size_t b = 0; b < nData; b++)
+			if (duplicates[a][b]) std::cout << "    " << o.datasets[a] << " / " << o.datasets[b] << ": " << duplicates[a][b] << "\n";
+	std::cout << "  " << allTaken << " of " << allRead << " entries taken, " << groups.size() << " run group(s) in "
+	          << o.memoryMB << " MB, key set peak " << std::fixed << std::setprecision(1) << peakBytes/1048576. << " MB, "
+	          << fastCopies << " fast copies, " << std::setprecision(2) << seconds << " s\n"
+	          << "++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+	return 0;
+}
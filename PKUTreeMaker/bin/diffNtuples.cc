@@ -0,0 +1,409 @@
+//
+// Package:    VAJets/PKUTreeMaker
+// Program:    pkuDiffNtuples
+//
+/**
+ Description: compares two ntuples of a tree maker event by event and
+ branch by branch, to check that a change leaves the physics output alone.
+
+ Implementation:
+     The events of the two files are aligned by (run, ls, event): the keys
+     of the second file are indexed first, then the first file is read in
+     order and every event is compared with its partner.  Both trees are
+     read through pku::NtupleReader, so branch encodings are decoded and an
+     encoded file compares with a plain one; bit groups are compared member
+     by member.  Reading goes through a TTreeCache of --cache MB per file,
+     and with --threads N ROOT unzips the baskets of the branches of an
+     entry in parallel.
+
+     Integer and bool branches must be equal.  Floating point branches are
+     compared with the first --tolerance whose pattern matches, bitwise
+     equal (NaN included) when none does:
+
+       pkuDiffNtuples golden.root ZtreePKU.root --threads 4 \
+         --tolerance '*eta*=ulp:4' --tolerance 'MET*=rel:1e-9' --skip 'photonsieie2*'
+
+     ulp:N allows N units in the last place (of float when either side is
+     a float), rel:x |a-b| <= x max(|a|,|b|) and abs:x |a-b| <= x.  The
+     report lists the differing branches with the number of events, the
+     largest differences and the first event, and --list N prints the
+     first N differing events.  The exit status is 0 when the files agree,
+     1 when they do not (differences, unmatched events or branches present
+     in one file only) and 2 on errors.
+*/
+//
+
+#include "VAJets/PKUTreeMaker/interface/BranchEncoding.h"
+#include "VAJets/PKUTreeMaker/interface/NtupleReader.h"
+#include "VAJets/PKUTreeMaker/interface/NtupleSchema.h"
+
+#include "TFile.h"
+#include "TROOT.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+	struct Tolerance {
+		enum Kind { Exact, Ulp, Relative, Absolute };
+		Kind kind;
+		double value;
+	};
+
+	Tolerance parseTolerance(const std::string& spec) {
+		Tolerance t;
+		t.kind = Tolerance::Exact;
+		t.value = 0.;
+		const std::string::size_type colon = spec.find(':');
+		const std::string kind = spec.substr(0, colon);
+		if (kind == "exact" && colon == std::string::npos) return t;
+		if (colon == std::string::npos) throw std::invalid_argument("cannot parse tolerance " + spec);
+		t.value = std::stod(spec.substr(colon + 1));
+		if      (kind == "ulp") t.kind = Tolerance::Ulp;
+		else if (kind == "rel") t.kind = Tolerance::Relative;
+		else if (kind == "abs") t.kind = Tolerance::Absolute;
+		else throw std::invalid_argument("cannot parse tolerance " + spec);
+		if (!(t.value >= 0.)) throw std::invalid_argument("negative tolerance " + spec);
+		return t;
+	}
+
+	struct Options {
+		std::string fileA, fileB, tree;
+		std::vector<std::string> keep, drop;
+		std::vector<std::pair<std::string, Tolerance> > tolerances;
+		unsigned threads, list;
+		unsigned long long cacheMB;
+	};
+
+	void usage(std::ostream& out) {
+		out << "usage: pkuDiffNtuples a.root b.root [--tree dir/name] [--branches p1,p2,...] [--skip p1,p2,...]\n"
+		    << "                      [--tolerance pattern=exact|ulp:N|rel:x|abs:x ...] [--threads N] [--cache MB] [--list N]\n";
+	}
+
+	std::vector<std::string> split(const std::string& s) {
+		std::vector<std::string> out;
+		std::stringstream ss(s);
+		std::string item;
+		while (std::getline(ss, item, ',')) if (!item.empty()) out.push_back(item);
+		return out;
+	}
+
+	Options parse(int argc, char** argv) {
+		Options o;
+		o.tree = "treeDumper/ZPKUCandidates";
+		o.keep.push_back("*");
+		o.threads = 1; o.list = 0; o.cacheMB = 100;
+		std::vector<std::string> files;
+		for (int i = 1; i < argc; i++) {
+			const std::string arg = argv[i];
+			if (arg == "-h" || arg == "--help") { usage(std::cout); std::exit(0); }
+			if (arg.compare(0, 2, "--") != 0) { files.push_back(arg); continue; }
+			if (i + 1 >= argc) throw std::invalid_argument("missing value of " + arg);
+			const std::string value = argv[++i];
+			if      (arg == "--tree")     o.tree = value;
+			else if (arg == "--branches") o.keep = split(value);
+			else if (arg == "--skip")     o.drop = split(value);
+			else if (arg == "--threads")  o.threads = std::stoul(value);
+			else if (arg == "--cache")    o.cacheMB = std::stoull(value);
+			else if (arg == "--list")     o.list = std::stoul(value);
+			else if (arg == "--tolerance") {
+				const std::string::size_type eq = value.find('=');
+				if (eq == std::string::npos) throw std::invalid_argument("--tolerance needs pattern=spec");
+				o.tolerances.push_back(std::make_pair(value.substr(0, eq), parseTolerance(value.substr(eq + 1))));
+			}
+			else throw std::invalid_argument("unknown option " + arg);
+		}
+		if (files.size() != 2) throw std::invalid_argument("two files are needed");
+		if (!o.threads) throw std::invalid_argument("--threads must be positive");
+		o.fileA = files[0];
+		o.fileB = files[1];
+		return o;
+	}
+
+	typedef pku::NtupleColumn Column;
+
+	struct Key {
+		Long64_t run, ls, event;
+		bool operator==(const Key& o) const { return run == o.run && ls == o.ls && event == o.event; }
+	};
+	struct KeyHash {
+		std::size_t operator()(const Key& k) const {
+			std::size_t h = std::hash<Long64_t>()(k.event);
+			h ^= std::hash<Long64_t>()(k.run) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+			h ^= std::hash<Long64_t>()(k.ls) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+			return h;
+		}
+	};
+	std::ostream& operator<<(std::ostream& out, const Key& k) { return out << k.run << ":" << k.ls << ":" << k.event; }
+
+	// run, ls and event of every entry, read on their own
+	std::vector<Key> readKeys(TTree* tree) {
+		std::vector<Key> keys(tree->GetEntries());
+		Int_t run = 0, ls = 0, event = 0;
+		tree->SetBranchStatus("*", false);
+		tree->SetBranchStatus("run", true);
+		tree->SetBranchStatus("ls", true);
+		tree->SetBranchStatus("event", true);
+		{
+			pku::NtupleReader reader(tree);
+			reader.bind("run", &run);
+			reader.bind("ls", &ls);
+			reader.bind("event", &event);
+			for (Long64_t i = 0; i < Long64_t(keys.size()); i++) {
+				reader.getEntry(i);
+				keys[i].run = run; keys[i].ls = ls; keys[i].event = event;
+			}
+		}
+		tree->ResetBranchAddresses();
+		tree->SetBranchStatus("*", true);
+		return keys;
+	}
+
+	// maps the bits of a float/double onto unsigned integers in the order of the values
+	template<class U, class T> U ordered(T x) {
+		U u;
+		std::memcpy(&u, &x, sizeof(u));
+		const U sign = U(1) << (8*sizeof(U) - 1);
+		return (u & sign) ? ~u : (u | sign);
+	}
+
+	// distance in units in the last place, of float if 'single'
+	double ulps(double a, double b, bool single) {
+		if (single) {
+			const UInt_t ua = ordered<UInt_t>(float(a)), ub = ordered<UInt_t>(float(b));
+			return ua > ub ? ua - ub : ub - ua;
+		}
+		const ULong64_t ua = ordered<ULong64_t>(a), ub = ordered<ULong64_t>(b);
+		return double(ua > ub ? ua - ub : ub - ua);
+	}
+
+	// a branch present in both files
+	struct Pair {
+		const Column* a;
+		const Column* b;
+		Tolerance tolerance;
+		bool sameLayout;    // same type and length: equal bytes are equal values
+		bool floating;
+		bool single;
+		unsigned long long events;
+		double maxAbs, maxRel, maxUlp;
+		Key first;
+
+		// false if some element is out of tolerance
+		bool compare(const Key& key) {
+			if (sameLayout && std::memcmp(&a->buffer[0], &b->buffer[0], a->buffer.size()) == 0) return true;
+			bool same = true;
+			const int n = std::min(a->size(), b->size());
+			for (int k = 0; k < n; k++) {
+				const double va = a->value(k), vb = b->value(k);
+				if (va == vb || (std::isnan(va) && std::isnan(vb))) continue;
+				const double diff = std::fabs(va - vb);
+				const double rel = diff/std::max(std::fabs(va), std::fabs(vb));
+				const double ulp = floating ? ulps(va, vb, single) : 0.;
+				bool pass = false;
+				if (floating) {
+					switch (tolerance.kind) {
+						case Tolerance::Ulp:      pass = ulp <= tolerance.value; break;
+						case Tolerance::Relative: pass = rel <= tolerance.value; break;
+						case Tolerance::Absolute: pass = diff <= tolerance.value; break;
+						default: break;
+					}
+				}
+				if (pass) continue;
+				same = false;
+				if (std::isnan(diff) || diff > maxAbs) maxAbs = diff;
+				if (std::isnan(rel) || rel > maxRel) maxRel = rel;
+				if (ulp > maxUlp) maxUlp = ulp;
+			}
+			if (a->size() != b->size()) same = false;
+			if (!same && events++ == 0) first = key;
+			return same;
+		}
+	};
+
+	template<class T>
+	void printList(std::ostream& out, const char* what, const std::vector<T>& names) {
+		if (names.empty()) return;
+		out << "  " << what << ":";
+		for (std::size_t i = 0; i < names.size(); i++) out << " " << names[i];
+		out << "\n";
+	}
+
+}
+
+int main(int argc, char** argv) {
+	Options o;
+	try {
+		o = parse(argc, argv);
+	} catch (std::exception& e) {
+		std::cerr << "pkuDiffNtuples: " << e.what() << "\n";
+		usage(std::cerr);
+		return 2;
+	}
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (o.threads > 1) ROOT::EnableImplicitMT(o.threads);
+
+	std::unique_ptr<TFile> fileA, fileB;
+	TTree* treeA = 0;
+	TTree* treeB = 0;
+	std::unique_ptr<pku::NtupleReader> readerA, readerB;
+	std::vector<Column> columnsA, columnsB;
+	std::vector<std::string> skippedA, skippedB;
+	std::vector<Key> keysB;
+	std::unordered_map<Key, Long64_t, KeyHash> indexB;
+	std::vector<Pair> pairs;
+	std::vector<std::string> onlyA, onlyB, typeChanged;
+	unsigned long long duplicates = 0;
+	std::size_t iRun = 0, iLs = 0, iEvent = 0;
+	try {
+		fileA.reset(TFile::Open(o.fileA.c_str(), "READ"));
+		fileB.reset(TFile::Open(o.fileB.c_str(), "READ"));
+		if (!fileA || fileA->IsZombie()) throw std::runtime_error("cannot open " + o.fileA);
+		if (!fileB || fileB->IsZombie()) throw std::runtime_error("cannot open " + o.fileB);
+		treeA = dynamic_cast<TTree*>(fileA->Get(o.tree.c_str()));
+		treeB = dynamic_cast<TTree*>(fileB->Get(o.tree.c_str()));
+		if (!treeA) throw std::runtime_error("no tree " + o.tree + " in " + o.fileA);
+		if (!treeB) throw std::runtime_error("no tree " + o.tree + " in " + o.fileB);
+
+		keysB = readKeys(treeB);
+		indexB.reserve(keysB.size());
+		for (std::size_t j = 0; j < keysB.size(); j++)
+			if (!indexB.insert(std::make_pair(keysB[j], Long64_t(j))).second) ++duplicates;
+
+		// run, ls and event are needed to align the events, whatever the selection
+		std::vector<std::string> keep = o.keep;
+		keep.push_back("run"); keep.push_back("ls"); keep.push_back("event");
+		const pku::BranchSelector selector(keep, o.drop);
+		readerA.reset(new pku::NtupleReader(treeA));
+		readerB.reset(new pku::NtupleReader(treeB));
+		columnsA = readerA->bindColumns(selector, skippedA);
+		columnsB = readerB->bindColumns(selector, skippedB);
+		const Long64_t cache = o.cacheMB*1024*1024;
+		treeA->SetCacheSize(cache);
+		treeA->AddBranchToCache("*", true);
+		treeB->SetCacheSize(cache);
+		treeB->AddBranchToCache("*", true);
+
+		for (std::size_t i = 0; i < columnsA.size(); i++) {
+			const Column& a = columnsA[i];
+			if (a.name == "run") iRun = i;
+			if (a.name == "ls") iLs = i;
+			if (a.name == "event") iEvent = i;
+			std::size_t j = 0;
+			while (j < columnsB.size() && columnsB[j].name != a.name) ++j;
+			if (j == columnsB.size()) { onlyA.push_back(a.name); continue; }
+			const Column& b = columnsB[j];
+			if (a.type != b.type || a.length != b.length) typeChanged.push_back(a.name);
+			Pair p;
+			p.a = &a;
+			p.b = &b;
+			p.tolerance.kind = Tolerance::Exact;
+			p.tolerance.value = 0.;
+			for (std::size_t t = 0; t < o.tolerances.size(); t++) {
+				if (pku::BranchSelector::match(o.tolerances[t].first.c_str(), a.name.c_str())) { p.tolerance = o.tolerances[t].second; break; }
+			}
+			p.sameLayout = a.type == b.type && a.length == b.length;
+			p.floating = a.floating() || b.floating();
+			p.single = a.type == 'F' || b.type == 'F';
+			p.events = 0;
+			p.maxAbs = p.maxRel = p.maxUlp = 0.;
+			pairs.push_back(p);
+		}
+		for (std::size_t j = 0; j < columnsB.size(); j++) {
+			std::size_t i = 0;
+			while (i < columnsA.size() && columnsA[i].name != columnsB[j].name) ++i;
+			if (i == columnsA.size()) onlyB.push_back(columnsB[j].name);
+		}
+		if (columnsA.empty() || columnsA[iRun].name != "run" || columnsA[iLs].name != "ls" || columnsA[iEvent].name != "event")
+			throw std::runtime_error(o.fileA + " has no run, ls and event branches");
+	} catch (std::exception& e) {
+		std::cerr << "pkuDiffNtuples: " << e.what() << "\n";
+		return 2;
+	}
+
+	const Long64_t nA = treeA->GetEntries();
+	std::vector<bool> matchedB(keysB.size(), false);
+	unsigned long long matched = 0, differing = 0, onlyInA = 0;
+	std::vector<std::string> listed;
+	try {
+		for (Long64_t i = 0; i < nA; i++) {
+			readerA->getEntry(i);
+			Key key;
+			key.run = Long64_t(columnsA[iRun].value(0));
+			key.ls = Long64_t(columnsA[iLs].value(0));
+			key.event = Long64_t(columnsA[iEvent].value(0));
+			std::unordered_map<Key, Long64_t, KeyHash>::const_iterator j = indexB.find(key);
+			if (j == indexB.end() || matchedB[j->second]) { ++onlyInA; continue; }
+			matchedB[j->second] = true;
+			readerB->getEntry(j->second);
+			++matched;
+
+			bool same = true;
+			std::ostringstream branches;
+			for (std::size_t k = 0; k < pairs.size(); k++) {
+				if (pairs[k].compare(key)) continue;
+				if (same) branches << key << ":";
+				same = false;
+				if (listed.size() < o.list) branches << " " << pairs[k].a->name;
+			}
+			if (same) continue;
+			++differing;
+			if (listed.size() < o.list) listed.push_back(branches.str());
+		}
+	} catch (std::exception& e) {
+		std::cerr << "pkuDiffNtuples: " << e.what() << "\n";
+		return 2;
+	}
+	const unsigned long long onlyInB = std::count(matchedB.begin(), matchedB.end(), false);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::vector<const Pair*> differ;
+	for (std::size_t k = 0; k < pairs.size(); k++) if (pairs[k].events) differ.push_back(&pairs[k]);
+	std::stable_sort(differ.begin(), differ.end(), [](const Pair* x, const Pair* y) { return x->events > y->events; });
+
+	std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++\n"
+	          << "pkuDiffNtuples SUMMARY: " << o.fileA << " vs " << o.fileB << " (" << o.tree << ")\n"
+	          << "  events: " << nA << " vs " << keysB.size() << ", " << matched << " matched, " << onlyInA << " only in the first, "
+	          << onlyInB << " only in the second, " << duplicates << " duplicate keys in the second\n"
+	          << "  branches: " << pairs.size() << " compared, " << onlyA.size() << " only in the first, "
+	          << onlyB.size() << " only in the second, " << typeChanged.size() << " with another type\n"
+	          << "  differing: " << differ.size() << " branches in " << differing << " events\n";
+	printList(std::cout, "only in the first", onlyA);
+	printList(std::cout, "only in the second", onlyB);
+	printList(std::cout, "with another type", typeChanged);
+	printList(std::cout, "not compared (variable length or unknown type)", skippedA);
+	if (!differ.empty()) {
+		std::cout << "  " << std::left << std::setw(28) << "branch" << std::right << std::setw(10) << "events"
+		          << std::setw(14) << "max |diff|" << std::setw(12) << "max rel" << std::setw(12) << "max ulp" << "  first run:ls:event\n";
+		for (std::size_t k = 0; k < differ.size(); k++) {
+			const Pair& p = *differ[k];
+			std::cout << "  " << std::left << std::setw(28) << p.a->name << std::right << std::setw(10) << p.events
+			          << std::setprecision(4) << std::setw(14) << p.maxAbs << std::setw(12) << p.maxRel;
+			if (p.floating) std::cout << std::setw(12) << p.maxUlp;
+			else std::cout << std::setw(12) << "-";
+			std::cout << "  " << p.first << "\n";
+		}
+	}
+	for (std::size_t k = 0; k < listed.size(); k++) std::cout << "  " << listed[k] << "\n";
+	std::cout << "  " << std::fixed << std::setprecision(2) << seconds << " s, "
+	          << std::setprecision(0) << (seconds > 0. ? (nA + keysB.size())/seconds : 0.) << " entries/s\n"
+	          << "++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+
+	const bool agree = differ.empty() && !onlyInA && !onlyInB && !duplicates && onlyA.empty() && onlyB.empty();
+	return agree ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+//
+// Package:    VAJets/PKUTreeMaker
+// Program:    pkuMergeNtuples
+//
+/**
+ Description: joins the segments of a checkpointed tree maker output.
+
+ Implementation:
+     A job that resumes from a checkpoint (see Checkpoint.h) writes its
+     output in segments, ZtreePKU.root, ZtreePKU_seg1.root, ...; a segment
+     that did not finish may hold entries written after its last
+     checkpoint, which the next segment writes again.  For every input the
+     sidecar <input>.ckpt.json is read: an incomplete segment contributes
+     its first "entries" entries, a complete one (or one without sidecar)
+     all of them.  Entries whose (run, ls, event) was already taken are
+     dropped as well.
+
+       pkuMergeNtuples ZtreePKU_merged.root ZtreePKU.root ZtreePKU_seg1.root ZtreePKU_seg2.root
+
+     The output takes the compression of the first input.  A segment kept
+     whole and without repeated keys is copied basket by basket, without
+     decompressing it ("fast" CopyEntries); the others entry by entry.
+     Only the tree (--tree, default treeDumper/ZPKUCandidates) is copied,
+     with the LumiSummary tree of its directory when the inputs have one
+     (LumiSummary.h): the first "summaryEntries" entries of an incomplete
+     segment, all of a complete one.  A resumed job starts the input file
+     that was open at the checkpoint over, so its first summary rows are
+     those of the "lumis" that had already ended in that file; the rows
+     that repeat them, in order, are dropped.  A luminosity block that has
+     events in a later file as well gets its own row there, which is kept.
+*/
+//
+
+#include "VAJets/PKUTreeMaker/interface/Checkpoint.h"
+#include "VAJets/PKUTreeMaker/interface/EventKeys.h"
+#include "VAJets/PKUTreeMaker/interface/LumiSummary.h"
+
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+	struct Options {
+		std::string output, tree;
+		std::vector<std::string> inputs;
+	};
+
+	void usage(std::ostream& out) {
+		out << "usage: pkuMergeNtuples output.root input.root [input_seg1.root ...] [--tree dir/name]\n";
+	}
+
+	Options parse(int argc, char** argv) {
+		Options o;
+		o.tree = "treeDumper/ZPKUCandidates";
+		std::vector<std::string> files;
+		for (int i = 1; i < argc; i++) {
+			const std::string arg = argv[i];
+			if (arg == "-h" || arg == "--help") { usage(std::cout); std::exit(0); }
+			if (arg.compare(0, 2, "--") != 0) { files.push_back(arg); continue; }
+			if (i + 1 >= argc) throw std::invalid_argument("missing value of " + arg);
+			const std::string value = argv[++i];
+			if (arg == "--tree") o.tree = value;
+			else throw std::invalid_argument("unknown option " + arg);
+		}
+		if (files.size() < 2) throw std::invalid_argument("an output and at least one input are needed");
+		o.output = files[0];
+		o.inputs.assign(files.begin() + 1, files.end());
+		return o;
+	}
+
+}
+
+int main(int argc, char** argv) {
+	Options o;
+	try {
+		o = parse(argc, argv);
+	} catch (std::exception& e) {
+		std::cerr << "pkuMergeNtuples: " << e.what() << "\n";
+		usage(std::cerr);
+		return 2;
+	}
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	const std::string::size_type slash = o.tree.rfind('/');
+	const std::string dirName = slash == std::string::npos ? "" : o.tree.substr(0, slash);
+	std::unique_ptr<TFile> out;
+	const std::string summaryName = (dirName.empty() ? "" : dirName + "/") + pku::LumiSummary::treeName();
+	TTree* merged = 0;
+	TTree* mergedSummary = 0;
+	Long64_t summaryRows = 0;
+	pku::EventKeySet seen;
+	Long64_t read = 0, cut = 0, repeated = 0, repeatedRows = 0;
+	pku::Checkpoint::State previous;
+	previous.found = false;
+	std::vector<std::string> lines;
+	try {
+		for (std::size_t f = 0; f < o.inputs.size(); f++) {
+			const std::string& path = o.inputs[f];
+			std::unique_ptr<TFile> in(TFile::Open(path.c_str(), "READ"));
+			if (!in || in->IsZombie()) throw std::runtime_error("cannot open " + path);
+			TTree* tree = dynamic_cast<TTree*>(in->Get(o.tree.c_str()));
+			if (!tree) throw std::runtime_error("no tree " + o.tree + " in " + path);
+
+			const pku::Checkpoint::State state = pku::Checkpoint::read(path + ".ckpt.json");
+			const Long64_t entries = tree->GetEntries();
+			const Long64_t keep = state.found && !state.complete ? std::min(state.entries, entries) : entries;
+			read += entries;
+			cut += entries - keep;
+
+			// the keys decide between a whole copy and one entry at a time
+			pku::EventKeyReader keys(tree);
+			std::vector<bool> take(keep, true);
+			Long64_t nRepeated = 0;
+			for (Long64_t i = 0; i < keep; i++) {
+				unsigned run, ls;
+				unsigned long long event;
+				keys.key(i, run, ls, event);
+				if (seen.insert(run, ls, event, 0) < 0) continue;
+				take[i] = false;
+				++nRepeated;
+			}
+			repeated += nRepeated;
+
+			if (!out) {
+				out.reset(TFile::Open(o.output.c_str(), "RECREATE", "", in->GetCompressionSettings()));
+				if (!out || out->IsZombie()) throw std::runtime_error("cannot create " + o.output);
+				TDirectory* dir = out.get();
+				if (!dirName.empty()) dir = out->mkdir(dirName.c_str());
+				dir->cd();
+				merged = tree->CloneTree(0);
+				merged->SetDirectory(dir);
+			}
+
+			TTree* summary = dynamic_cast<TTree*>(in->Get(summaryName.c_str()));
+			Long64_t nRepeatedRows = 0;
+			if (summary) {
+				const Long64_t rows = state.found && !state.complete && state.summaryEntries >= 0
+					? std::min(state.summaryEntries, summary->GetEntries()) : summary->GetEntries();
+				// the lumis of the file that was open at the checkpoint of the previous segment
+				if (f > 0 && previous.found && !previous.complete && !previous.lumis.empty()) {
+					UInt_t run = 0, ls = 0;
+					summary->SetBranchAddress("run", &run);
+					summary->SetBranchAddress("ls", &ls);
+					while (nRepeatedRows < rows && nRepeatedRows < Long64_t(previous.lumis.size())) {
+						summary->GetEntry(nRepeatedRows);
+						if (run != previous.lumis[nRepeatedRows].first || ls != previous.lumis[nRepeatedRows].second) break;
+						++nRepeatedRows;
+					}
+					summary->ResetBranchAddresses();
+				}
+				if (!mergedSummary) {
+					merged->GetDirectory()->cd();
+					mergedSummary = summary->CloneTree(0);
+					mergedSummary->SetDirectory(merged->GetDirectory());
+				}
+				if (nRepeatedRows) {
+					mergedSummary->CopyAddresses(summary);
+					for (Long64_t i = nRepeatedRows; i < rows; i++) {
+						summary->GetEntry(i);
+						mergedSummary->Fill();
+					}
+					summary->ResetBranchAddresses();
+				}
+				else if (rows == summary->GetEntries()) mergedSummary->CopyEntries(summary, -1, "fast");
+				else mergedSummary->CopyEntries(summary, rows);
+				summaryRows += rows - nRepeatedRows;
+				repeatedRows += nRepeatedRows;
+			}
+			previous = state;
+
+			const bool fast = keep == entries && nRepeated == 0;
+			if (fast) {
+				merged->CopyEntries(tree, -1, "fast");
+			} else if (nRepeated == 0) {
+				merged->CopyEntries(tree, keep);
+			} else {
+				// as the slow path of CopyEntries, skipping the repeated keys
+				merged->CopyAddresses(tree);
+				for (Long64_t i = 0; i < keep; i++) {
+					if (!take[i]) continue;
+					tree->GetEntry(i);
+					merged->Fill();
+				}
+				tree->ResetBranchAddresses();
+			}
+
+			std::ostringstream line;
+			line << "  " << path << ": " << entries << " entries, " << keep - nRepeated << " taken";
+			if (state.found) line << " (segment " << state.segment << (state.complete ? ", complete" : ", checkpoint") << ")";
+			else line << " (no sidecar)";
+			if (entries != keep) line << ", " << entries - keep << " after the checkpoint";
+			if (nRepeated) line << ", " << nRepeated << " repeated";
+			if (nRepeatedRows) line << ", " << nRepeatedRows << " summary rows repeated";
+			line << (fast ? ", fast copy" : "");
+			lines.push_back(line.str());
+		}
+		merged->GetDirectory()->cd();
+		merged->Write();
+		if (mergedSummary) mergedSummary->Write();
+		out->Close();
+	} catch (std::exception& e) {
+		std::cerr << "pkuMergeNtuples: " << e.what() << "\n";
+		return 1;
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++\n"
+	          << "pkuMergeNtuples SUMMARY: " << o.inputs.size() << " segment(s) into " << o.output << "\n";
+	for (std::size_t i = 0; i < lines.size(); i++) std::cout << lines[i] << "\n";
+	std::cout << "  " << read - cut - repeated << " of " << read << " entries kept, " << cut
+	          << " after checkpoints, " << repeated << " repeated keys, " << summaryRows << " lumi summary rows (" << repeatedRows << " repeated), " << std::fixed << std::setprecision(2) << seconds << " s\n"
+	          << "++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+	return 0;
+}
@@ -0,0 +1,233 @@
+//
+// Package:    VAJets/PKUTreeMaker
+// Program:    pkuReplayZTreeMaker
+//
+/**
+ Description: runs the ZPKUTreeMaker analysis over the event records of a
+ job, without the framework.
+
+ Implementation:
+     ZPKUTreeMaker writes its records with recordFile set (see
+     ZEventRecord.h); the file carries the configuration of the tree maker,
+     from which every worker builds its own pku::ZAnalysisCore and books
+     ZPKUCandidates in <module label>/ of its output file, as TFileService
+     does.  The workers take batches of --batch records from one reader
+     under a mutex and fill their trees independently:
+
+       pkuReplayZTreeMaker ZtreePKU.zrec --threads 8 --output replay.root
+
+     With one thread the tree is that of the job, entry by entry; with N
+     threads the workers write replay_0.root ... replay_<N-1>.root, each
+     in the order of its batches, to be merged with hadd.  Next to the
+     tree every worker writes the LumiSummary of the job (lumiSummary =
+     False drops it) with the generator weight sums of countEvent(); the
+     LHE weight sums are not in the records.  The JEC payload
+     names of the configuration are read relative to the working directory,
+     as in the job.  Only the ROOT output is replayed, outputFormat
+     "columnar" is written as "root".
+*/
+//
+
+#include "VAJets/PKUTreeMaker/interface/LumiSummary.h"
+#include "VAJets/PKUTreeMaker/interface/ZAnalysisCore.h"
+#include "VAJets/PKUTreeMaker/interface/ZEventRecord.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TROOT.h"
+#include "TTree.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	struct Options {
+		std::string records, output;
+		unsigned threads, batch;
+		unsigned long long events;
+	};
+
+	void usage(std::ostream& out) {
+		out << "usage: pkuReplayZTreeMaker records.zrec [--threads N] [--batch N] [--events N] [--output file.root]\n";
+	}
+
+	Options parse(int argc, char** argv) {
+		Options o;
+		o.output = "ZtreePKU_replay.root";
+		o.threads = 1; o.batch = 256; o.events = 0;
+		for (int i = 1; i < argc; i++) {
+			const std::string arg = argv[i];
+			if (arg == "-h" || arg == "--help") { usage(std::cout); std::exit(0); }
+			if (arg.compare(0, 2, "--") != 0) {
+				if (!o.records.empty()) throw std::invalid_argument("more than one record file");
+				o.records = arg;
+				continue;
+			}
+			if (i + 1 >= argc) throw std::invalid_argument("missing value of " + arg);
+			const std::string value = argv[++i];
+			if      (arg == "--threads") o.threads = std::stoul(value);
+			else if (arg == "--batch")   o.batch = std::stoul(value);
+			else if (arg == "--events")  o.events = std::stoull(value);
+			else if (arg == "--output")  o.output = value;
+			else throw std::invalid_argument("unknown option " + arg);
+		}
+		if (o.records.empty()) throw std::invalid_argument("no record file");
+		if (!o.threads || !o.batch) throw std::invalid_argument("--threads and --batch must be positive");
+		return o;
+	}
+
+	// replay.root -> replay_<i>.root
+	std::string workerFile(const std::string& output, unsigned i, unsigned n) {
+		if (n == 1) return output;
+		std::ostringstream name;
+		const std::string::size_type dot = output.rfind(".root");
+		name << output.substr(0, dot) << "_" << i << (dot == std::string::npos ? "" : ".root");
+		return name.str();
+	}
+
+	// the reader shared by the workers; --events caps the records handed out
+	class RecordQueue {
+		public:
+			RecordQueue(pku::ZRecordReader& reader, unsigned long long maxEvents)
+				: reader_(reader), maxEvents_(maxEvents), handed_(0), done_(false) {}
+
+			// the next batch, empty at the end
+			void next(std::vector<pku::ZEventRecord>& batch, std::size_t size) {
+				std::lock_guard<std::mutex> lock(mutex_);
+				batch.resize(size);
+				std::size_t n = 0;
+				while (n < size && !done_) {
+					if ((maxEvents_ && handed_ == maxEvents_) || !reader_.next(batch[n])) { done_ = true; break; }
+					++handed_;
+					++n;
+				}
+				batch.resize(n);
+			}
+			unsigned long long handed() const { return handed_; }
+
+		private:
+			pku::ZRecordReader& reader_;
+			unsigned long long maxEvents_;
+			unsigned long long handed_;
+			bool done_;
+			std::mutex mutex_;
+	};
+
+	// A worker ends a luminosity block of its LumiSummary when the block of
+	// its records changes, so with several threads a block may have a row
+	// in more than one file; the sums over the rows are those of the job.
+	struct Worker {
+		std::unique_ptr<TFile> file;
+		std::unique_ptr<pku::ZAnalysisCore> core;
+		TTree* tree;
+		unsigned long long events;
+		std::exception_ptr error;
+
+		void run(RecordQueue& queue, std::size_t batchSize) {
+			try {
+				std::vector<pku::ZEventRecord> batch;
+				bool inLumi = false;
+				unsigned run = 0, ls = 0;
+				for (queue.next(batch, batchSize); !batch.empty(); queue.next(batch, batchSize)) {
+					for (std::size_t i = 0; i < batch.size(); i++) {
+						const pku::ZEventRecord& record = batch[i];
+						if (inLumi && (unsigned(record.run) != run || unsigned(record.ls) != ls)) core->endLumi(run, ls);
+						inLumi = true;
+						run = record.run;
+						ls = record.ls;
+						core->countRecord(record);
+						core->process(record);
+					}
+					events += batch.size();
+				}
+				if (inLumi) core->endLumi(run, ls);
+			} catch (...) {
+				error = std::current_exception();
+			}
+		}
+	};
+
+}
+
+int main(int argc, char** argv) {
+	Options o;
+	try {
+		o = parse(argc, argv);
+	} catch (std::exception& e) {
+		std::cerr << "pkuReplayZTreeMaker: " << e.what() << "\n";
+		usage(std::cerr);
+		return 2;
+	}
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<Worker> workers(o.threads);
+	std::unique_ptr<pku::ZRecordReader> reader;
+	try {
+		reader.reset(new pku::ZRecordReader(o.records));
+		const edm::ParameterSet config(reader->configuration());
+		const std::string label = config.existsAs<std::string>("@module_label") ? config.getParameter<std::string>("@module_label") : "treeDumper";
+		ROOT::EnableThreadSafety();
+		// the cores read their payloads and book their trees here, one after the other
+		for (unsigned i = 0; i < o.threads; i++) {
+			Worker& w = workers[i];
+			const std::string path = workerFile(o.output, i, o.threads);
+			w.file.reset(TFile::Open(path.c_str(), "RECREATE"));
+			if (!w.file || w.file->IsZombie()) throw std::runtime_error("cannot create " + path);
+			w.file->mkdir(label.c_str())->cd();
+			w.tree = new TTree(pku::ZAnalysisCore::treeName(), pku::ZAnalysisCore::treeTitle());
+			w.core.reset(new pku::ZAnalysisCore(config));
+			w.core->book(w.tree, false);
+			if (!config.existsAs<bool>("lumiSummary") || config.getParameter<bool>("lumiSummary"))
+				w.core->attachSummary(new TTree(pku::LumiSummary::treeName(), pku::LumiSummary::treeTitle()));
+			w.events = 0;
+		}
+	} catch (std::exception& e) {
+		std::cerr << "pkuReplayZTreeMaker: " << e.what() << "\n";
+		return 1;
+	}
+
+	RecordQueue queue(*reader, o.events);
+	std::vector<std::thread> threads;
+	for (unsigned i = 0; i < o.threads; i++) threads.emplace_back(&Worker::run, &workers[i], std::ref(queue), std::size_t(o.batch));
+	for (std::size_t i = 0; i < threads.size(); i++) threads[i].join();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	int status = 0;
+	for (unsigned i = 0; i < o.threads; i++) {
+		Worker& w = workers[i];
+		if (w.error) {
+			try { std::rethrow_exception(w.error); }
+			catch (std::exception& e) { std::cerr << "pkuReplayZTreeMaker: worker " << i << ": " << e.what() << "\n"; }
+			status = 1;
+			continue;
+		}
+		std::ostringstream ss;
+		w.core->finish(ss);
+		// the tree and the LumiSummary of the core
+		w.file->Write();
+		w.file->Close();
+		if (o.threads > 1) std::cout << "worker " << i << ", " << w.events << " events:\n";
+		std::cout << ss.str();
+	}
+
+	std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++\n"
+	          << "pkuReplayZTreeMaker SUMMARY: " << queue.handed() << " records of " << o.records << " on "
+	          << o.threads << " thread(s) in " << std::fixed << std::setprecision(2) << seconds << " s ("
+	          << std::setprecision(1) << (seconds > 0. ? queue.handed()/seconds : 0.) << " events/s)\n";
+	for (unsigned i = 0; i < o.threads && status == 0; i++)
+		std::cout << "  " << workerFile(o.output, i, o.threads) << ": " << workers[i].events << " events\n";
+	std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+	return status;
+}
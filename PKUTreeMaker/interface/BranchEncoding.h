@@ -0,0 +1,98 @@
+#ifndef VAJets_PKUTreeMaker_BranchEncoding_h
+#define VAJets_PKUTreeMaker_BranchEncoding_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      BranchEncoding
+//
+/**\class BranchEncoding BranchEncoding.h VAJets/PKUTreeMaker/interface/BranchEncoding.h
+
+ Description: on-disk encodings of ntuple branches.
+
+ Implementation:
+     The tree makers keep filling their double/int/bool members; the schema
+     converts them to the encoded representation just before TTree::Fill.
+     The encoding of every encoded branch is stored as a TNamed in the
+     tree UserInfo ("<branch>" -> spec()), which is what NtupleReader uses
+     to give back the original types.
+
+       native      as declared (default)
+       float32     double stored as /F
+       trunc:N     /F with only N mantissa bits kept (rounded), for eta/phi/pt
+       fixed16:a:b unsigned 16-bit fixed point on [a,b], values are clamped
+       int8        int stored as /B, values are clamped to [-128,127]
+       bits:G:o:n  bool (array of n) stored as bits o..o+n-1 of branch G
+
+     The bit-group branch G itself is recorded as "word:<leaf type>".
+*/
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "Rtypes.h"
+
+namespace pku {
+
+	struct Encoding {
+		enum Kind { Native = 0, Float32, Truncated, Fixed16, Int8, Bits };
+
+		Encoding() : kind(Native), mantissaBits(23), lo(0.), hi(1.), offset(0), width(0) {}
+
+		static Encoding float32()                     { Encoding e; e.kind = Float32; return e; }
+		static Encoding truncated(int bits)           { Encoding e; e.kind = Truncated; e.mantissaBits = bits; return e; }
+		static Encoding fixed16(double lo, double hi) { Encoding e; e.kind = Fixed16; e.lo = lo; e.hi = hi; return e; }
+		static Encoding int8()                        { Encoding e; e.kind = Int8; return e; }
+		static Encoding bits(const std::string& grp)  { Encoding e; e.kind = Bits; e.group = grp; return e; }
+
+		// leaf type code of the encoded value (0 for bit members)
+		char storedType(char nativeType) const {
+			switch (kind) {
+				case Float32: case Truncated: return 'F';
+				case Fixed16: return 's';
+				case Int8:    return 'B';
+				case Bits:    return 0;
+				default:      return nativeType;
+			}
+		}
+
+		std::string spec() const;
+		static Encoding parse(const std::string& spec);
+
+		Kind        kind;
+		int         mantissaBits;
+		double      lo, hi;
+		std::string group;
+		int         offset, width;   // bit members only, assigned at booking
+	};
+
+	// Round a float to its 'bits' most significant mantissa bits.
+	inline float truncateMantissa(float x, int bits) {
+		if (bits >= 23 || !std::isfinite(x)) return x;
+		UInt_t u;
+		std::memcpy(&u, &x, sizeof(u));
+		const UInt_t drop = 23 - std::max(bits, 0);
+		u += 1u << (drop - 1);
+		u &= ~((1u << drop) - 1);
+		std::memcpy(&x, &u, sizeof(u));
+		return x;
+	}
+
+	inline UShort_t encodeFixed16(double x, double lo, double hi) {
+		if (!(x > lo)) return 0;
+		if (x >= hi) return 65535;
+		return static_cast<UShort_t>((x - lo) / (hi - lo) * 65535. + 0.5);
+	}
+
+	inline double decodeFixed16(UShort_t q, double lo, double hi) {
+		return lo + q * ((hi - lo) / 65535.);
+	}
+
+	inline Char_t encodeInt8(int x) {
+		return static_cast<Char_t>(std::min(127, std::max(-128, x)));
+	}
+
+}
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef VAJets_PKUTreeMaker_Checkpoint_h
+#define VAJets_PKUTreeMaker_Checkpoint_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      Checkpoint
+//
+/**\class Checkpoint Checkpoint.h VAJets/PKUTreeMaker/interface/Checkpoint.h
+
+ Description: periodic checkpoints of a tree maker output, so that a
+ failed job resumes instead of starting over.
+
+ Implementation:
+     Configured by the optional "checkpoint" PSet of the tree makers;
+     without it, or with both periods 0, nothing is done:
+
+       everyLumis    checkpoint after every N luminosity blocks
+       everySeconds  ... or when N seconds have passed since the last one
+       sidecar       default <TFileService file>.ckpt.json
+       segment       set by resumeCheckpoint.py for the resumed jobs
+
+     Checkpoints are taken at the end of a luminosity block: the tree is
+     AutoSaved (its baskets flushed and its header written, so that the
+     file is readable up to there if the job dies), then the sidecar is
+     rewritten atomically with the entries of the tree, the last
+     (run, ls, event) analyzed, the input file with the number of its
+     events analyzed, the files closed so far and the luminosity blocks of
+     the open file that ended.  The LumiSummary tree of the module, if
+     any, is AutoSaved with it and its entries recorded as
+     "summaryEntries".  endJob writes it once more with "complete": true.
+
+     A TFileService file cannot be reopened, so a resumed job writes the
+     next segment of the output (ZtreePKU_seg1.root, ...), skipping the
+     closed files and starting the open one over
+     (test/resumeCheckpoint.py).  pkuMergeNtuples (bin/mergeNtuples.cc)
+     keeps the first "entries" entries of an incomplete segment and
+     drops repeated (run, ls, event) keys when it joins the segments, and
+     the summary rows that the next segment writes again for the "lumis"
+     of the open file.
+
+     The time of every checkpoint is measured; printSummary() gives the
+     count, the total and the largest, and their share of the job.
+*/
+//
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+class TTree;
+namespace edm { class ParameterSet; }
+
+namespace pku {
+
+	class Checkpoint {
+		public:
+			typedef std::chrono::steady_clock Clock;
+
+			// what pkuMergeNtuples needs from a sidecar
+			struct State {
+				bool found, complete;
+				long long entries;
+				long long summaryEntries;   // -1 if not recorded
+				int segment;
+				std::vector<std::pair<unsigned, unsigned> > lumis;   // ended in the open file, in order
+			};
+
+			Checkpoint();   // disabled
+			Checkpoint(const edm::ParameterSet& pset, const std::string& output);
+
+			bool enabled() const { return enabled_; }
+
+			// from respondToOpenInputFile / respondToCloseInputFile
+			void openFile(const std::string& name);
+			void closeFile();
+			// every analyzed event
+			void event(unsigned run, unsigned ls, unsigned long long event) {
+				lastRun_ = run; lastLs_ = ls; lastEvent_ = event;
+				++fileEvents_;
+			}
+			// end of a luminosity block; checkpoints 'tree' and 'summary' (may be null) when due
+			void endLumi(unsigned run, unsigned ls, TTree* tree, TTree* summary = 0);
+			// endJob: the final sidecar
+			void finish(TTree* tree, TTree* summary = 0);
+
+			void printSummary(std::ostream& out) const;
+
+			static State read(const std::string& sidecar);
+
+		private:
+			void write(TTree* tree, TTree* summary, bool complete);
+
+			bool enabled_;
+			std::string output_;
+			std::string sidecar_;
+			int segment_;
+			unsigned everyLumis_;
+			double everySeconds_;
+
+			unsigned lastRun_, lastLs_;
+			unsigned long long lastEvent_;
+			std::string file_;
+			unsigned long long fileEvents_;
+			std::vector<std::string> closedFiles_;
+			std::vector<std::pair<unsigned, unsigned> > fileLumis_;   // ended in the open file
+
+			unsigned lumisSince_;
+			Clock::time_point start_, last_;
+			unsigned long checkpoints_;
+			double seconds_, maxSeconds_;
+	};
+
+}
+
+#endif
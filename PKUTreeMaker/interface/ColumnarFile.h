@@ -0,0 +1,132 @@
+#ifndef VAJets_PKUTreeMaker_ColumnarFile_h
+#define VAJets_PKUTreeMaker_ColumnarFile_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      ColumnarWriter, ColumnarReader
+//
+/**\class ColumnarWriter ColumnarFile.h VAJets/PKUTreeMaker/interface/ColumnarFile.h
+
+ Description: chunked columnar output of an NtupleSchema, alternative to the TTree.
+
+ Implementation:
+     The booked branches of the schema are written column by column in row
+     groups.  Layout, every number in the byte order of the writing host
+     (little endian on all the platforms CMSSW runs on; a file is not
+     portable to a big-endian host):
+
+       "PKUCOL1\0"
+       row group 0: column 0 chunk, column 1 chunk, ...   (8-byte aligned)
+       row group 1: ...
+       footer:  nColumns, {name, leaf type, array length}
+                nRowGroups, {nRows, per column {offset, stored bytes,
+                                                raw bytes, codec, min, max}}
+       footer size (uint64), "PKUCOL1\0"
+
+     Values are written in their declared (native) type; branch encodings
+     only apply to the TTree.  Arrays are stored row-major, N values per
+     row.  Uncompressed chunks are read in place from a read-only mmap, so
+     post-processing touches only the pages of the columns it asks for.
+     Chunks can be zstd compressed when the package is built with
+     PKU_COLUMNAR_ZSTD (and <use name="zstd"/>); they are then inflated on
+     first access and cached by the reader.
+*/
+//
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Rtypes.h"
+#include "VAJets/PKUTreeMaker/interface/NtupleSchema.h"
+
+namespace pku {
+
+	namespace columnar {
+		enum Codec : UChar_t { None = 0, Zstd = 1 };
+
+		struct Chunk {
+			ULong64_t offset;
+			ULong64_t storedBytes;
+			ULong64_t rawBytes;
+			UChar_t   codec;
+			double    min, max;   // over all values of the chunk
+		};
+		struct RowGroup {
+			ULong64_t rows;
+			std::vector<Chunk> chunks;
+		};
+		struct Column {
+			std::string name;
+			char        type;     // ROOT leaf type code
+			int         length;   // 0 for scalars
+		};
+	}
+
+	class ColumnarWriter {
+		public:
+			// Columns are the branches booked in 'schema' at construction.
+			ColumnarWriter(const std::string& path, const NtupleSchema& schema,
+			               std::size_t rowsPerGroup = 10000, columnar::Codec codec = columnar::None, int level = 3);
+			~ColumnarWriter();
+
+			// Append the current values of the booked branches.
+			void fill();
+			// Flush the last row group and write the footer; called by the destructor.
+			void close();
+
+			ULong64_t rows() const { return rows_; }
+			ULong64_t bytesWritten() const { return offset_; }
+
+		private:
+			void flushGroup();
+			void write(const void* data, std::size_t size);
+
+			std::ofstream out_;
+			std::vector<const BranchSpec*>  specs_;
+			std::vector<columnar::Column>   columns_;
+			std::vector<std::vector<char> > buffers_;
+			std::vector<columnar::RowGroup> groups_;
+			std::size_t     rowsPerGroup_;
+			columnar::Codec codec_;
+			int             level_;
+			ULong64_t       groupRows_;
+			ULong64_t       rows_;
+			ULong64_t       offset_;
+			bool            closed_;
+	};
+
+	class ColumnarReader {
+		public:
+			explicit ColumnarReader(const std::string& path);
+			~ColumnarReader();
+
+			const std::vector<columnar::Column>& columns() const { return columns_; }
+			const std::vector<columnar::RowGroup>& rowGroups() const { return groups_; }
+			ULong64_t rows() const;
+			int columnIndex(const std::string& name) const;   // -1 if absent
+
+			// Values of 'column' in row group 'group': rows*max(1,length)
+			// elements of the column type.  Points into the mapped file for
+			// uncompressed chunks.
+			const void* chunk(int column, std::size_t group);
+
+			template<typename T>
+			const T* values(const std::string& name, std::size_t group) {
+				return static_cast<const T*>(chunk(checkedIndex(name, LeafType<T>::code), group));
+			}
+
+		private:
+			int checkedIndex(const std::string& name, char type) const;
+
+			int         fd_;
+			const char* map_;
+			std::size_t size_;
+			std::vector<columnar::Column>   columns_;
+			std::vector<columnar::RowGroup> groups_;
+			std::vector<std::vector<char> > inflated_;   // per column*group, zstd only
+	};
+
+}
+
+#endif
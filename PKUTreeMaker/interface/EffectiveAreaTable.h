@@ -0,0 +1,71 @@
+#ifndef VAJets_PKUTreeMaker_EffectiveAreaTable_h
+#define VAJets_PKUTreeMaker_EffectiveAreaTable_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      EffectiveAreaTable
+//
+/**\class EffectiveAreaTable EffectiveAreaTable.h VAJets/PKUTreeMaker/interface/EffectiveAreaTable.h
+
+ Description: |eta|-binned effective areas of up to three isolation
+ components, for the rho correction of the photon and electron isolation.
+
+ Implementation:
+     The components share one binning and are stored row by row, so
+     areas(absEta) returns all of them with one lookup.  The bin is the
+     number of lower edges at or below |eta|, summed without branches over
+     the (few) edges; outside the table the lookup lands on a row of zeros,
+     as EffectiveAreas::getEffectiveArea returns 0 there.
+
+     The tables are read from the RecoEgamma effective-area text files
+     ("absEtaMin absEtaMax area" per line, '#' comments), one file per
+     component, whose bins must agree.  photonSpring16() is the built-in
+     photon table the tree makers always used (charged hadrons, neutral
+     hadrons, photons, open-ended last bin).
+*/
+//
+
+#include <string>
+#include <vector>
+
+namespace pku {
+
+	class EffectiveAreaTable {
+		public:
+			enum Component { ChargedHadron = 0, NeutralHadron = 1, Photon = 2 };
+			static const unsigned maxComponents = 3;
+
+			EffectiveAreaTable() : nComponents_(0), absEtaMax_(0.f), areas_(maxComponents, 0.f) {}
+			// one file per component; throws cms::Exception on unreadable or inconsistent files
+			explicit EffectiveAreaTable(const std::vector<std::string>& files);
+			explicit EffectiveAreaTable(const std::string& file);
+
+			// lower bin edges, nComponents areas per bin, end of the last bin
+			EffectiveAreaTable(const std::vector<float>& lowEdges, const std::vector<float>& areas, unsigned nComponents, float absEtaMax);
+
+			static EffectiveAreaTable photonSpring16();
+
+			// the nComponents() areas of the bin of absEta
+			const float* areas(float absEta) const {
+				const std::size_t nBins = lowEdges_.size();
+				std::size_t bin = 0;
+				for (std::size_t i = 1; i < nBins; i++) bin += absEta >= lowEdges_[i];
+				const bool inside = nBins && absEta >= lowEdges_[0] && absEta < absEtaMax_;
+				return &areas_[(inside ? bin : nBins)*maxComponents];
+			}
+			float area(float absEta, Component c = ChargedHadron) const { return areas(absEta)[c]; }
+
+			unsigned nComponents() const { return nComponents_; }
+			std::size_t nBins() const { return lowEdges_.size(); }
+
+		private:
+			void read(const std::string& file, unsigned component, std::vector<float>& lowEdges, float& absEtaMax, std::vector<float>& areas);
+
+			unsigned nComponents_;
+			std::vector<float> lowEdges_;
+			float absEtaMax_;
+			std::vector<float> areas_;   // (nBins+1) x maxComponents, last row zero
+	};
+
+}
+
+#endif
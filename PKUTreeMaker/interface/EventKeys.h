@@ -0,0 +1,88 @@
+#ifndef VAJets_PKUTreeMaker_EventKeys_h
+#define VAJets_PKUTreeMaker_EventKeys_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      EventKeySet, EventKeyReader
+//
+/**\class EventKeySet EventKeys.h VAJets/PKUTreeMaker/interface/EventKeys.h
+
+ Description: compact set of (run, ls, event) keys, and the reader of the
+ key branches of an ntuple.
+
+ Implementation:
+     The keys are kept per run, each run in an open addressing table of
+     64-bit words holding ls (24 bits) and event (40 bits), with linear
+     probing and a load factor of at most 1/2; every key carries the small
+     integer "owner" that inserted it first (the dataset, for
+     pkuDedupNtuples).  A key that does not fit the packing goes to a
+     std::map, which stays empty for real data.  18 to 36 bytes per key:
+
+       pku::EventKeySet keys;
+       int first = keys.insert(run, ls, event, dataset);   // -1 if new
+
+     clear() releases the tables, so that a caller can go through the runs
+     in groups with bounded memory.
+
+     EventKeyReader reads the run, ls and event branches of an entry
+     without the others, whatever their integer type; run() alone reads
+     only the run branch.
+*/
+//
+
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "Rtypes.h"
+
+class TBranch;
+class TLeaf;
+class TTree;
+
+namespace pku {
+
+	class EventKeySet {
+		public:
+			EventKeySet() : size_(0) {}
+
+			// the owner that inserted the key first, or -1 (and owner is recorded)
+			int insert(unsigned run, unsigned ls, unsigned long long event, unsigned char owner);
+
+			std::size_t size() const { return size_; }
+			std::size_t memoryBytes() const;
+			void clear();
+
+			static const std::size_t bytesPerKey = 27;   // on average, for memory budgets
+
+		private:
+			struct Table {
+				Table() : used(0) {}
+				std::vector<unsigned long long> words;   // 0 = empty, else packed key + 1
+				std::vector<unsigned char> owners;
+				std::size_t used;
+			};
+			static unsigned long long mix(unsigned long long x);
+			static void grow(Table& t);
+
+			std::unordered_map<unsigned, Table> runs_;
+			std::map<std::tuple<unsigned, unsigned, unsigned long long>, unsigned char> overflow_;
+			std::size_t size_;
+	};
+
+	class EventKeyReader {
+		public:
+			// throws cms::Exception if the tree has no run, ls or event branch
+			explicit EventKeyReader(TTree* tree);
+
+			unsigned run(Long64_t entry);
+			void key(Long64_t entry, unsigned& run, unsigned& ls, unsigned long long& event);
+
+		private:
+			TBranch* branches_[3];
+			TLeaf* leaves_[3];
+	};
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef VAJets_PKUTreeMaker_JecRegistry_h
+#define VAJets_PKUTreeMaker_JecRegistry_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      JecRegistry
+//
+/**\class JecRegistry JecRegistry.h VAJets/PKUTreeMaker/interface/JecRegistry.h
+
+ Description: run-range -> JEC payload set table of a module.
+
+ Implementation:
+     Built from a vstring parameter of the module, e.g.
+     "jecAK4chsPayloadNames", and the optional "jecEras" VPSet:
+
+       jecEras = cms.VPSet(
+           cms.PSet(firstRun = cms.uint32(272007), lastRun = cms.uint32(278808),
+                    jecAK4chsPayloadNames = cms.vstring(... BCD ...)),
+           ...)
+
+     Each era carries its payload list under the same name as the flat
+     parameter (or under 'eraKey' if given).  The flat list, when present
+     and non-empty, is used for the runs no era covers, typically run 1 of
+     the simulation; a data run outside every era is an error.
+
+     The FactorizedJetCorrector of an era (full chain and the first level
+     alone, the L1 offset used by the Type-I MET correction) is compiled
+     the first time a corrector of that era is asked for and kept for the
+     whole job; payloads() only looks up the table.
+     select() only searches the table when the run leaves the range of the
+     era selected last, so the per-event cost is one comparison.
+*/
+//
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+class FactorizedJetCorrector;
+namespace edm { class ParameterSet; }
+
+namespace pku {
+
+	class JecRegistry {
+		public:
+			JecRegistry(const edm::ParameterSet& iConfig, const std::string& payloadName, const std::string& eraKey = "");
+			~JecRegistry();
+
+			// correctors of the era containing 'run', owned by the registry
+			FactorizedJetCorrector* corrector(unsigned run) { return compiled(select(run)).full.get(); }
+			FactorizedJetCorrector* offset(unsigned run)    { return compiled(select(run)).offset.get(); }
+			const std::vector<std::string>& payloads(unsigned run) { return select(run).payloads; }
+
+			bool empty() const { return eras_.empty(); }
+			void printSummary(std::ostream& out) const;
+
+		private:
+			struct Era {
+				unsigned firstRun, lastRun;
+				std::vector<std::string> payloads;
+				std::unique_ptr<FactorizedJetCorrector> full;
+				std::unique_ptr<FactorizedJetCorrector> offset;
+				unsigned long long calls;
+			};
+
+			Era& select(unsigned run) {
+				if (current_ < 0 || run < cacheFirst_ || run > cacheLast_) lookup(run);
+				Era& era = eras_[current_];
+				++era.calls;
+				return era;
+			}
+			Era& compiled(Era& era) {
+				if (!era.full) compile(era);
+				return era;
+			}
+			void lookup(unsigned run);
+			void compile(Era& era);
+
+			std::string name_;
+			std::vector<Era> eras_;   // sorted by firstRun, the fallback (if any) last
+			bool hasFallback_;
+			int current_;
+			unsigned cacheFirst_, cacheLast_;   // runs for which current_ holds
+			unsigned switches_;
+	};
+
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef VAJets_PKUTreeMaker_JetConstituentKeys_h
+#define VAJets_PKUTreeMaker_JetConstituentKeys_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      JetConstituentKeys
+//
+/**\class JetConstituentKeys JetConstituentKeys.h VAJets/PKUTreeMaker/interface/JetConstituentKeys.h
+
+ Description: the PF-candidate keys of the constituents of every jet of a
+ collection, as two flat products instead of one userData vector per jet.
+
+ Implementation:
+     Compressed sparse rows: "pfKeyOffsets" has one entry per jet plus one,
+     and the keys of jet i are pfKeys[offsets[i]] .. pfKeys[offsets[i+1]-1],
+     sorted, so that a lookup is a binary search.  Both products are plain
+     std::vector<unsigned int> written by JetUserData next to its jets and
+     aligned with them; this class only reads them.
+
+       edm::Handle<std::vector<unsigned int> > offsets, keys;
+       iEvent.getByToken(offsetsToken_, offsets);
+       iEvent.getByToken(keysToken_, keys);
+       const pku::JetConstituentKeys constituents(*offsets, *keys);
+       if (constituents.contains(iJet, muon.sourceCandidatePtr(0).key())) ...
+*/
+//
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace pku {
+
+	class JetConstituentKeys {
+		public:
+			// throws cms::Exception if the offsets do not describe the keys
+			JetConstituentKeys(const std::vector<unsigned int>& offsets, const std::vector<unsigned int>& keys);
+
+			std::size_t nJets() const { return nJets_; }
+			std::size_t size(std::size_t jet) const { return offsets_[jet + 1] - offsets_[jet]; }
+			const unsigned int* begin(std::size_t jet) const { return keys_ + offsets_[jet]; }
+			const unsigned int* end(std::size_t jet) const { return keys_ + offsets_[jet + 1]; }
+
+			bool contains(std::size_t jet, unsigned int key) const { return std::binary_search(begin(jet), end(jet), key); }
+			// true if any key of [first, last) belongs to the jet
+			template<class It> bool overlaps(std::size_t jet, It first, It last) const {
+				for (; first != last; ++first)
+					if (contains(jet, *first)) return true;
+				return false;
+			}
+
+			// append one jet, given by its (unsorted) constituent keys; offsets must start as {0}
+			template<class It> static void append(std::vector<unsigned int>& offsets, std::vector<unsigned int>& keys, It first, It last) {
+				const std::size_t row = keys.size();
+				keys.insert(keys.end(), first, last);
+				std::sort(keys.begin() + row, keys.end());
+				offsets.push_back(keys.size());
+			}
+
+		private:
+			const unsigned int* offsets_;
+			const unsigned int* keys_;
+			std::size_t nJets_;
+	};
+
+	// Muon four-momentum to remove from a raw jet before the Type-I MET
+	// correction.  With the constituent keys it is the sum of the muons,
+	// given as (PF key, p4), whose PF candidate is a constituent of 'jet';
+	// without them, 'scan' sums the muon daughters of the jet itself.  Only
+	// one of the two is ever used.
+	template<class P4, class Scan>
+	P4 typeIMuonP4(const JetConstituentKeys* constituents, std::size_t jet,
+	               const std::vector<std::pair<unsigned int, P4> >& muonKeys, Scan scan) {
+		if (!constituents) return scan();
+		P4 sum;
+		for (std::size_t m = 0; m < muonKeys.size(); m++)
+			if (constituents->contains(jet, muonKeys[m].first)) sum += muonKeys[m].second;
+		return sum;
+	}
+
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef VAJets_PKUTreeMaker_JetKernels_h
+#define VAJets_PKUTreeMaker_JetKernels_h
+//
+// Package:    VAJets/PKUTreeMaker
+//
+/**
+ Description: the jet kernels shared by the tree makers: the Type-I MET
+ summation, the pt ranking of the corrected jets with the choice of the
+ two tagging jets, and the VBS observables of those two jets.
+
+ Implementation:
+     Header-only and free of framework products, so that TreeMakerLogic,
+     ZAnalysisCore, PKUTreeMaker and the kernel benchmark
+     (bin/benchmarkKernels.cc) run the same code.  The JEC factors are
+     computed by the caller; the L1 offset factor of the Type-I summation
+     is asked for through a callable, only for the jets above threshold.
+
+       pku::TypeISums sums;
+       for (...) pku::addTypeIJet(sums, jet.subtracted, corr, [&]() { return offsetFactor(jet); });
+
+       pku::rankByPt(jets_);
+       int tagging[2];
+       pku::taggingJets(jets_, photon.eta, photon.phi, tagging);
+       if (tagging[1] > -1) {
+         const pku::VbsObservables vbs(jets_[tagging[0]], jets_[tagging[1]], photonp4, vp4, MET_phi);
+         ...
+       }
+*/
+//
+
+#include "DataFormats/Math/interface/LorentzVector.h"
+#include "DataFormats/Math/interface/deltaR.h"
+#include "TLorentzVector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace pku {
+
+	struct TypeISums {
+		double corrEx, corrEy, corrSumEt;
+		TypeISums() : corrEx(0), corrEy(0), corrSumEt(0) {}
+	};
+
+	// Adds one jet to the Type-I correction: 'subtracted' is its raw
+	// four-momentum minus the selected muons, 'corr' its full JEC factor;
+	// above 'ptThreshold' after the full JEC, offset() gives the L1 factor.
+	template<class Offset>
+	inline void addTypeIJet(TypeISums& sums, const math::XYZTLorentzVector& subtracted, double corr,
+	                        Offset offset, double ptThreshold = 10.0) {
+		const math::XYZTLorentzVector corrJetP4 = corr*subtracted;
+		if (!(corrJetP4.pt() > ptThreshold)) return;
+		const math::XYZTLorentzVector rawJetP4offsetCorr = offset()*subtracted;
+		sums.corrEx    -= (corrJetP4.px() - rawJetP4offsetCorr.px());
+		sums.corrEy    -= (corrJetP4.py() - rawJetP4offsetCorr.py());
+		sums.corrSumEt += (corrJetP4.Et() - rawJetP4offsetCorr.Et());
+	}
+
+	// corrected jets in decreasing pt; jets of equal pt keep their order
+	inline void rankByPt(std::vector<TLorentzVector>& jets) {
+		std::stable_sort(jets.begin(), jets.end(),
+		                 [](const TLorentzVector& a, const TLorentzVector& b) { return a.Pt() > b.Pt(); });
+	}
+
+	// indices in the ranked 'jets' of the leading two at dR > drMin from
+	// (eta, phi), -1 for those not found
+	inline void taggingJets(const std::vector<TLorentzVector>& jets, double eta, double phi, int index[2],
+	                        double drMin = 0.5) {
+		index[0] = index[1] = -1;
+		for (std::size_t i = 0; i < jets.size() && index[1] == -1; i++)
+			if (reco::deltaR(jets[i].Eta(), jets[i].Phi(), eta, phi) > drMin) index[index[0] == -1 ? 0 : 1] = i;
+	}
+
+	// Of the two tagging jets with the photon and the boson.  The jets are
+	// rebuilt from pt, eta, phi and E, as stored in the jet1/jet2 branches.
+	struct VbsObservables {
+		double Mjj, deltaetajj, zepp, j1metPhi, j2metPhi;
+
+		VbsObservables(const TLorentzVector& jet1, const TLorentzVector& jet2,
+		               const TLorentzVector& photon, const TLorentzVector& v, double metPhi) {
+			const double pi = 3.141593;   // as the tree makers always folded it
+			TLorentzVector j1p4, j2p4;
+			j1p4.SetPtEtaPhiE(jet1.Pt(), jet1.Eta(), jet1.Phi(), jet1.E());
+			j2p4.SetPtEtaPhiE(jet2.Pt(), jet2.Eta(), jet2.Phi(), jet2.E());
+			j1metPhi = std::fabs(jet1.Phi() - metPhi);
+			if (j1metPhi > pi) j1metPhi = 2.0*pi - j1metPhi;
+			j2metPhi = std::fabs(jet2.Phi() - metPhi);
+			if (j2metPhi > pi) j2metPhi = 2.0*pi - j2metPhi;
+			Mjj = (j1p4 + j2p4).M();
+			deltaetajj = std::fabs(jet1.Eta() - jet2.Eta());
+			zepp = std::fabs((v + photon).Rapidity() - (j1p4.Rapidity() + j2p4.Rapidity())/2.0);
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef VAJets_PKUTreeMaker_LumiMask_h
+#define VAJets_PKUTreeMaker_LumiMask_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      LumiMask
+//
+/**\class LumiMask LumiMask.h VAJets/PKUTreeMaker/interface/LumiMask.h
+
+ Description: certified (run, lumi section) table read from a Cert_*_JSON.txt.
+
+ Implementation:
+     The JSON {"run": [[first, last], ...], ...} is compiled into a sorted
+     run array and one flat array of merged lumi intervals, the intervals
+     of run i being [offset_[i], offset_[i+1]).  contains() remembers the
+     last answer together with the lumi range it holds for (the matching
+     interval, or the gap between two intervals), so events of the same
+     lumi section or of a neighbouring one cost one comparison; otherwise
+     it is a binary search in the runs (only when the run changes) and in
+     the intervals of the run.
+*/
+//
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pku {
+
+	class LumiMask {
+		public:
+			LumiMask();
+			explicit LumiMask(const std::string& jsonFile);
+
+			// Parse the text of a certification JSON; throws cms::Exception if malformed.
+			void parse(const std::string& json);
+
+			bool contains(unsigned run, unsigned lumi) {
+				if (run == cacheRun_ && lumi >= cacheLo_ && lumi <= cacheHi_) return cacheIn_;
+				return lookup(run, lumi);
+			}
+			bool hasRun(unsigned run) const;
+
+			bool empty() const { return runs_.empty(); }
+			std::size_t nRuns() const { return runs_.size(); }
+			unsigned long long nLumis() const;   // certified lumi sections
+			unsigned long long nLumis(unsigned run) const;
+
+		private:
+			bool lookup(unsigned run, unsigned lumi);
+			int runIndex(unsigned run) const;
+
+			std::vector<unsigned> runs_;
+			std::vector<unsigned> offset_;   // runs_.size()+1 entries
+			std::vector<std::pair<unsigned, unsigned> > lumis_;
+
+			unsigned cacheRun_, cacheLo_, cacheHi_;
+			bool     cacheIn_;
+	};
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef VAJets_PKUTreeMaker_LumiSummary_h
+#define VAJets_PKUTreeMaker_LumiSummary_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      LumiSummary
+//
+/**\class LumiSummary LumiSummary.h VAJets/PKUTreeMaker/interface/LumiSummary.h
+
+ Description: per luminosity block counters and sums of a module, written
+ as one entry of a "LumiSummary" tree at the end of every block.
+
+ Implementation:
+     Every entry has run, ls and events (the events the module saw in the
+     block), then one double per counter and one std::vector<double> per
+     vector sum the module booked.  Counters are booked once, in the
+     constructor, and addressed by index like the StageTimer ones:
+
+       nPassed_ = summary_.counter("pass_tight");
+       ...
+       summary_.event();            // every event
+       summary_.add(nPassed_, n);
+       ...
+       summary_.endLumi(run, ls);   // fills the entry, counts from zero again
+
+     attach() creates the branches on the tree, which is usually made by
+     TFileService in the directory of the module; counters may be booked
+     before or after it, but not once an entry is filled.  The rows of
+     several jobs merge with hadd, and summing a column over the rows of
+     a sample gives its total, e.g. the sum of generator weights that
+     normalises lumiWeight.  Without a tree only the job totals are kept,
+     for printSummary().
+*/
+//
+
+#include <deque>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class TTree;
+
+namespace pku {
+
+	class LumiSummary {
+		public:
+			static const char* treeName()  { return "LumiSummary"; }
+			static const char* treeTitle() { return "per luminosity block counters"; }
+
+			LumiSummary();
+
+			// the tree receiving the entries, may be null
+			void attach(TTree* tree);
+			bool attached() const { return tree_ != 0; }
+
+			std::size_t counter(const std::string& name);
+			std::size_t vector(const std::string& name);
+
+			void event() { ++events_; }
+			void add(std::size_t counter, double value = 1.) { values_[counter] += value; }
+			// element-wise, the vector growing to the longest given
+			void add(std::size_t vector, const std::vector<double>& values);
+
+			void endLumi(unsigned run, unsigned ls);
+
+			void printSummary(std::ostream& out) const;
+
+		private:
+			void book(std::size_t counter);
+			void bookVector(std::size_t vector);
+
+			TTree* tree_;
+			bool filled_;
+			unsigned run_, ls_;
+			unsigned long long events_, totalEvents_, lumis_;
+			std::vector<std::string> names_, vectorNames_;
+			// deques: the addresses handed to the branches must not move
+			std::deque<double> values_, totals_;
+			std::deque<std::vector<double> > vectors_;
+			std::deque<std::vector<double>*> vectorAddresses_;
+			std::vector<std::vector<double> > vectorTotals_;
+	};
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef VAJets_PKUTreeMaker_NeutrinoPzSolver_h
+#define VAJets_PKUTreeMaker_NeutrinoPzSolver_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      NeutrinoPzSolver
+//
+/**\class NeutrinoPzSolver NeutrinoPzSolver.h VAJets/PKUTreeMaker/interface/NeutrinoPzSolver.h
+
+ Description: neutrino longitudinal momentum from the W mass constraint.
+
+ Implementation:
+     With the MET as the neutrino transverse momentum and a massless
+     lepton, (l + nu)^2 = mW^2 is a quadratic in pz(nu),
+
+       A pz^2 + B pz + C = 0,  a = mW^2 + 2 (pxl px + pyl py),
+       A = 4 (El^2 - pzl^2),  B = -4 a pzl,  C = 4 El^2 (px^2 + py^2) - a^2.
+
+     A negative discriminant gives the real part -B/2A.  Otherwise the root
+     is chosen by the policy ("type" of the original tree-maker code):
+
+       0 ClosestThenCentral  closest to pzl, the most central one if that
+                             is above 300 GeV in |pz|
+       1 ClosestToLepton     closest to pzl
+       2 MostCentral         smaller |pz|
+       3 MaxCosTheta         larger cos(theta*) of the lepton in the W frame
+
+     solve() handles all leptons of an event against one MET at once, on
+     flat arrays, with the policy dispatched outside the loop and a
+     branch-free body the compiler can vectorise.
+*/
+//
+
+#include <cmath>
+#include <cstddef>
+
+namespace pku {
+
+	class NeutrinoPzSolver {
+		public:
+			enum RootChoice { ClosestThenCentral = 0, ClosestToLepton = 1, MostCentral = 2, MaxCosTheta = 3 };
+
+			explicit NeutrinoPzSolver(RootChoice choice = ClosestThenCentral, double mW = 80.385) : choice_(choice), mW_(mW) {}
+
+			// 'complex' (may be null) is set to 1 where the discriminant is negative
+			void solve(std::size_t n, const double* pxl, const double* pyl, const double* pzl, const double* El,
+			           double metPx, double metPy, double* pz, unsigned char* complex = 0) const;
+
+			double pz(double pxl, double pyl, double pzl, double El, double metPx, double metPy, bool* complex = 0) const {
+				double out;
+				unsigned char c;
+				solve(1, &pxl, &pyl, &pzl, &El, metPx, metPy, &out, &c);
+				if (complex) *complex = c;
+				return out;
+			}
+
+			RootChoice choice() const { return choice_; }
+			double mW() const { return mW_; }
+
+		private:
+			template<RootChoice C>
+			void solveAll(std::size_t n, const double* pxl, const double* pyl, const double* pzl, const double* El,
+			              double metPx, double metPy, double* pz, unsigned char* complex) const;
+
+			RootChoice choice_;
+			double mW_;
+	};
+
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef VAJets_PKUTreeMaker_NtupleReader_h
+#define VAJets_PKUTreeMaker_NtupleReader_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      NtupleReader
+//
+/**\class NtupleReader NtupleReader.h VAJets/PKUTreeMaker/interface/NtupleReader.h
+
+ Description: reads back ntuples written with branch encodings.
+
+ Implementation:
+     The encodings are taken from the tree UserInfo written by NtupleSchema.
+     Branches are bound to variables of their original type; getEntry()
+     reads the entry and decodes the encoded ones into the bound variables.
+     Unencoded branches are simply attached with SetBranchAddress, so the
+     same code reads both encoded and plain ntuples:
+
+       pku::NtupleReader reader(tree);
+       double photonet; bool iseb[6];
+       reader.bind("photonet", &photonet);
+       reader.bind("photon_iseb", iseb, 6);
+       for (Long64_t i = 0; i < tree->GetEntries(); i++) reader.getEntry(i);
+
+     Tools that handle any branch (pkuDiffNtuples, the ntuple I/O
+     benchmark) let bindColumns() bind every selected branch to a buffer
+     of its decoded type instead.
+*/
+//
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "VAJets/PKUTreeMaker/interface/BranchEncoding.h"
+#include "VAJets/PKUTreeMaker/interface/NtupleSchema.h"
+
+class TTree;
+
+namespace pku {
+
+	// One branch as NtupleReader gives it back: the leaf type of a native
+	// branch, double for the float/int8 encoded ones and bool for the bit
+	// members.
+	struct NtupleColumn {
+		std::string name;
+		char type;     // leaf type code of the decoded values
+		int length;    // 0 for scalars
+		std::vector<char> buffer;
+
+		int size() const { return length > 0 ? length : 1; }
+		bool floating() const { return type == 'D' || type == 'F'; }
+		double value(int i) const;
+	};
+
+	class NtupleReader {
+		public:
+			explicit NtupleReader(TTree* tree);
+
+			template<typename T>
+			void bind(const std::string& name, T* address, int length = 0) {
+				attach(name, address, LeafType<T>::code, length);
+			}
+
+			Int_t getEntry(Long64_t entry);
+
+			// Binds every branch matching 'selector' to a column.  The other
+			// branches are switched off, as are those with several leaves, a
+			// variable length or an unknown type, which go to 'skipped'.
+			std::vector<NtupleColumn> bindColumns(const BranchSelector& selector, std::vector<std::string>& skipped);
+
+			// Encoding of a branch as written, Native if unencoded.
+			Encoding encoding(const std::string& name) const;
+
+		private:
+			struct Binding {
+				std::string name;
+				Encoding    encoding;
+				void*       address;
+				char        type;
+				int         length;
+				int         group;     // index in groups_ for bit members
+				std::vector<char> buffer;
+			};
+			struct Group {
+				std::string name;
+				char type;
+				std::vector<char> buffer;
+			};
+
+			void attach(const std::string& name, void* address, char type, int length);
+			void bind(NtupleColumn& column);
+			static void store(void* address, char type, int i, double value);
+
+			// deques: the buffers handed to SetBranchAddress must not move
+			TTree*              tree_;
+			std::deque<Binding> bindings_;
+			std::deque<Group>   groups_;
+	};
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef VAJets_PKUTreeMaker_NtupleSchema_h
+#define VAJets_PKUTreeMaker_NtupleSchema_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      NtupleSchema
+//
+/**\class NtupleSchema NtupleSchema.h VAJets/PKUTreeMaker/interface/NtupleSchema.h
+
+ Description: the branch set of a tree maker declared as data.
+
+ Implementation:
+     Every branch is registered once with its name, leaf type, array length
+     and the producer stage that fills it.  A BranchSelector (whitelist and
+     blacklist of wildcard patterns) decides which branches are booked; the
+     stages left without any booked branch, and not required by another
+     active stage, report active()==false so that the tree maker can skip
+     the corresponding computation.
+
+     Branches can be given an on-disk Encoding (see BranchEncoding.h); the
+     tree maker then calls encode() right before every TTree::Fill.
+*/
+//
+
+#include <bitset>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Rtypes.h"
+#include "VAJets/PKUTreeMaker/interface/BranchEncoding.h"
+
+class TTree;
+
+namespace pku {
+
+	// Producer stages of the ntuples.  Order is irrelevant, Event is always on.
+	enum class Stage : unsigned {
+		Event = 0,    // run/ls/event, nVtx, leptonic V summary
+		Weights,      // generator and normalisation weights
+		Pileup,       // PileupSummaryInfo
+		Gen,          // generator-level photons/leptons/jets
+		GenMuonMatch, // reco-gen muon matching (rochester correction inputs)
+		HLT,          // trigger bits
+		Filters,      // MET filters
+		Lepton,       // lepton kinematics and ID counters
+		Station2,     // muon extrapolation to the second muon station
+		Photon,       // photon array and the selected photon
+		FakePhoton,   // fake-photon (inverted ID) selected photon
+		Jets,         // AK4 jet array
+		VBS,          // tagging jets and VBS observables
+		VBSFake,      // tagging jets and VBS observables for the fake photon
+		MET,          // Type-I corrected MET
+		NStages
+	};
+
+	const char* stageName(Stage stage);
+
+	// ROOT leaf type code of a C++ type, see TTree::Branch.
+	template<typename T> struct LeafType;
+	template<> struct LeafType<double>         { static const char code = 'D'; };
+	template<> struct LeafType<float>          { static const char code = 'F'; };
+	template<> struct LeafType<int>            { static const char code = 'I'; };
+	template<> struct LeafType<unsigned int>   { static const char code = 'i'; };
+	template<> struct LeafType<short>          { static const char code = 'S'; };
+	template<> struct LeafType<unsigned short> { static const char code = 's'; };
+	template<> struct LeafType<char>           { static const char code = 'B'; };
+	template<> struct LeafType<unsigned char>  { static const char code = 'b'; };
+	template<> struct LeafType<Long64_t>       { static const char code = 'L'; };
+	template<> struct LeafType<ULong64_t>      { static const char code = 'l'; };
+	template<> struct LeafType<bool>           { static const char code = 'O'; };
+
+	struct BranchSpec {
+		std::string name;
+		std::string leaf;    // leaf name, defaults to the branch name
+		void*       address;
+		char        type;    // ROOT leaf type code
+		int         length;  // 0 for scalars, N for fixed-size arrays
+		Stage       stage;
+		Encoding    encoding;
+	};
+
+	class BranchSelector {
+		public:
+			// Everything is kept by default.  A branch is booked if it matches
+			// at least one keep pattern and no drop pattern; '*' and '?' are
+			// the usual wildcards.
+			BranchSelector();
+			BranchSelector(const std::vector<std::string>& keep, const std::vector<std::string>& drop);
+
+			bool selected(const std::string& name) const;
+			static bool match(const char* pattern, const char* name);
+
+		private:
+			std::vector<std::string> keep_;
+			std::vector<std::string> drop_;
+	};
+
+	class NtupleSchema {
+		public:
+			NtupleSchema();
+
+			// Scalars are passed by address, fixed-size arrays by name.
+			template<typename P>
+			typename std::enable_if<std::is_pointer<P>::value>::type
+			add(const std::string& name, P address, Stage stage, const std::string& leaf = "") {
+				declare(name, leaf, address, LeafType<typename std::remove_pointer<P>::type>::code, 0, stage);
+			}
+			template<typename T, std::size_t N>
+			void add(const std::string& name, T (&array)[N], Stage stage, const std::string& leaf = "") {
+				declare(name, leaf, array, LeafType<T>::code, N, stage);
+			}
+			// A branch whose leaf type code and length are only known at run
+			// time, e.g. one copied from an existing tree.
+			void addColumn(const std::string& name, void* address, char type, int length, Stage stage) {
+				declare(name, "", address, type, length, stage);
+			}
+
+			// Encoding of every declared branch matching 'pattern'; must be
+			// called before book().  Bit packing is only valid for bools,
+			// int8 for ints and the float encodings for doubles/floats.
+			void setEncoding(const std::string& pattern, const Encoding& encoding);
+
+			// An active 'stage' needs 'requirement' to be computed as well,
+			// even when none of the branches of the latter are written.
+			void dependsOn(Stage stage, Stage requirement);
+
+			// Book the selected branches on 'tree' and resolve the active stages.
+			void book(TTree* tree, const BranchSelector& selector);
+
+			// Convert the booked branches to their encoded representation.
+			void encode();
+
+			bool active(Stage stage) const { return active_.test(static_cast<unsigned>(stage)); }
+			bool written(const std::string& name) const;
+
+			const std::vector<BranchSpec>& branches() const { return branches_; }
+			const std::vector<const BranchSpec*>& booked() const { return booked_; }
+
+			// Leaf list in TTree::Branch syntax, e.g. "photon_pt[6]/D",
+			// using the encoded type.
+			static std::string leafList(const BranchSpec& spec);
+			static std::size_t typeSize(char type);
+			std::size_t bookedBytesPerEntry() const;
+
+			void printSummary(std::ostream& out) const;
+
+		private:
+			typedef std::bitset<static_cast<unsigned>(Stage::NStages)> StageSet;
+
+			struct Slot {
+				const BranchSpec* spec;
+				std::vector<char> buffer;
+			};
+			struct BitGroup {
+				std::string name;
+				char type;
+				int width;
+				std::vector<const BranchSpec*> members;
+				std::vector<char> buffer;
+			};
+
+			void declare(const std::string& name, const std::string& leaf, void* address, char type, int length, Stage stage);
+
+			std::vector<BranchSpec>        branches_;
+			std::vector<const BranchSpec*> booked_;
+			std::vector<Slot>              slots_;
+			std::vector<BitGroup>          groups_;
+			std::vector<StageSet>          requires_;
+			StageSet                       active_;
+	};
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef VAJets_PKUTreeMaker_PhotonCategory_h
+#define VAJets_PKUTreeMaker_PhotonCategory_h
+//
+// Package:    VAJets/PKUTreeMaker
+//
+/**
+ Description: per-photon category bits of the tree makers, and the
+ "selected photon" definitions built on them.
+
+ Implementation:
+     classify() turns the rho-corrected isolations, the shower shape and
+     the lepton separation of one photon into a bit mask, once per photon,
+     with the Spring16 cut-based medium and loose cuts.  A selection is a
+     set of required and a set of vetoed bits; its selected photon is the
+     highest-pt photon passing it, and every branch of its block carries
+     the selection suffix.
+
+     The two historical blocks are always defined:
+
+       ""    medium ID, electron veto, dR(photon, leptons) > 0.7
+       "_f"  fake-rate template: loose H/E, isolations below
+             min(0.2 pt, 5 x loose) and the electron veto and lepton dR,
+             with the loose sieie + isolation cuts inverted
+
+     Further control regions come from the optional "photonSelections"
+     VPSet of the tree maker; an entry with the suffix of an existing
+     block redefines it:
+
+       photonSelections = cms.VPSet(
+         cms.PSet(suffix = cms.string("_sb"),
+                  require = cms.vstring("eleVeto", "leptonDR", "mediumNoSieie"),
+                  veto = cms.vstring("medium")))
+*/
+//
+
+#include <string>
+#include <vector>
+
+namespace edm { class ParameterSet; }
+
+namespace pku {
+
+	namespace photon {
+
+		enum Category {
+			EleVeto          = 1<<0,  // pat::Photon::passElectronVeto
+			LeptonDR         = 1<<1,  // dR(supercluster, every selected lepton) > 0.7
+			Medium           = 1<<2,
+			MediumNoSieie    = 1<<3,  // medium without the sieie cut
+			MediumNoChIso    = 1<<4,  // medium without the charged isolation cut
+			Loose            = 1<<5,  // loose sieie and isolations, no H/E
+			FakePreselection = 1<<6   // loose H/E, isolations below min(0.2 pt, 5 x loose)
+		};
+
+		// 0 for an unknown name
+		unsigned categoryBit(const std::string& name);
+
+		struct Variables {
+			double pt, eta, phi, energy;   // supercluster eta and phi
+			double hoe, sieie;
+			double chiso, nhiso, phoiso;   // rho corrected
+			double drLepton;               // smallest dR to the selected leptons
+			bool isEB, isEE, eleVeto;
+		};
+
+		unsigned classify(const Variables& v);
+
+		struct Selection {
+			std::string suffix;
+			unsigned require;
+			unsigned veto;
+
+			bool pass(unsigned mask) const { return (mask & require) == require && !(mask & veto); }
+		};
+
+		// "" and "_f", then the "photonSelections" entries of iConfig;
+		// throws cms::Exception on an unknown category name
+		std::vector<Selection> selections(const edm::ParameterSet& iConfig);
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef VAJets_PKUTreeMaker_PileupReweighting_h
+#define VAJets_PKUTreeMaker_PileupReweighting_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      PileupReweighting
+//
+/**\class PileupReweighting PileupReweighting.h VAJets/PKUTreeMaker/interface/PileupReweighting.h
+
+ Description: data/MC pileup weight table, nominal and with the minimum
+ bias cross section shifted up and down.
+
+ Implementation:
+     Built from the optional "pileupReweighting" PSet of the tree maker:
+
+       pileupReweighting = cms.PSet(
+           data = cms.vstring("PileupData_69200.root",     # pileupCalc.py outputs:
+                              "PileupData_72383.root",     # nominal, up, down
+                              "PileupData_66017.root"),
+           dataHist = cms.string("pileup"),                # default "pileup"
+           mc = mix.input.nbPileupEvents.probValue,        # P(npT) in unit bins from 0
+           maxWeight = cms.double(0))                      # cap, 0 for none
+
+     The MC profile can be a histogram instead, mcFile/mcHist.  The three
+     data histograms must share one uniform binning; the MC profile is
+     integrated over the same bins, both are normalised to unit area and
+     the ratios are stored bin by bin, the three weights of a bin next to
+     each other.  weights() is then an O(1) lookup of the true number of
+     interactions; values outside the range take the first or last bin.
+     A bin without MC has weight 0; the summary counts them.  Without the
+     PSet every weight is 1.
+*/
+//
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace edm { class ParameterSet; }
+
+namespace pku {
+
+	class PileupReweighting {
+		public:
+			enum Variation { Nominal = 0, Up = 1, Down = 2 };
+
+			PileupReweighting();   // disabled: all weights 1
+			explicit PileupReweighting(const edm::ParameterSet& pset);
+
+			bool enabled() const { return !table_.empty(); }
+
+			// the three weights of an event with npT true interactions
+			void weights(double npT, double& nominal, double& up, double& down) const {
+				if (table_.empty()) { nominal = up = down = 1.; return; }
+				const double x = (npT - low_)*invWidth_;
+				const std::size_t bin = x <= 0. ? 0 : (x >= nBins_ - 1 ? nBins_ - 1 : static_cast<std::size_t>(x));
+				const double* w = &table_[3*bin];
+				nominal = w[Nominal]; up = w[Up]; down = w[Down];
+			}
+
+			void printSummary(std::ostream& out) const;
+
+		private:
+			// contents of a histogram in a file, with its binning
+			static std::vector<double> readHist(const std::string& file, const std::string& name,
+			                                    std::size_t& nBins, double& low, double& high);
+
+			std::vector<double> table_;   // 3 weights per bin
+			std::size_t nBins_;
+			double low_, high_, invWidth_;
+			std::vector<std::string> dataFiles_;
+			std::string mcSource_;
+			double maxWeight_;
+			std::size_t emptyMcBins_, capped_;
+	};
+
+}
+
+#endif
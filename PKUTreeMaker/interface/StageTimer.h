@@ -0,0 +1,116 @@
+#ifndef VAJets_PKUTreeMaker_StageTimer_h
+#define VAJets_PKUTreeMaker_StageTimer_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      StageTimer
+//
+/**\class StageTimer StageTimer.h VAJets/PKUTreeMaker/interface/StageTimer.h
+
+ Description: wall-clock time and counters of the named stages of a module.
+
+ Implementation:
+     Configured by the optional "timing" PSet of a module; without it the
+     timer is disabled and every call returns after one test:
+
+       report       JSON file written at endJob, default <module>_timing.json
+       histograms   ROOT file receiving one latency histogram per stage in
+                    a directory named after the module; empty (default) for
+                    none
+
+     Stages and counters are booked once, in the constructor, and then
+     addressed by index:
+
+       stageHLT_ = timer_.stage("hlt");
+       ...
+       timer_.enter(stageHLT_);   // ends the stage entered before, if any
+       ...
+       timer_.stop();
+       { pku::StageTimer::Scope s(timer_, stageEvent_); ... }   // one block
+
+     The latencies are kept per stage in power-of-two bins of nanoseconds,
+     from which the report gives the 50/90/99% quantiles.  A timer belongs
+     to one module instance; the framework calls a legacy module from one
+     thread at a time, so it takes no lock.
+*/
+//
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace edm { class ParameterSet; }
+
+namespace pku {
+
+	class StageTimer {
+		public:
+			typedef std::chrono::steady_clock Clock;
+			static const std::size_t npos = std::size_t(-1);
+
+			StageTimer();   // disabled
+			StageTimer(const std::string& module, const edm::ParameterSet& pset);
+
+			bool enabled() const { return enabled_; }
+			std::size_t stage(const std::string& name);
+			std::size_t counter(const std::string& name);
+
+			void enter(std::size_t stage) {
+				if (!enabled_) return;
+				const Clock::time_point now = Clock::now();
+				if (current_ != npos) record(current_, now - start_);
+				current_ = stage;
+				start_ = now;
+			}
+			void stop() { enter(npos); }
+			void count(std::size_t counter, unsigned long n = 1) { if (enabled_) counters_[counter].value += n; }
+
+			class Scope {
+				public:
+					Scope(StageTimer& timer, std::size_t stage) : timer_(timer.enabled_ ? &timer : 0), stage_(stage) {
+						if (timer_) start_ = Clock::now();
+					}
+					~Scope() { if (timer_) timer_->record(stage_, Clock::now() - start_); }
+				private:
+					StageTimer* timer_;
+					std::size_t stage_;
+					Clock::time_point start_;
+			};
+
+			// JSON report and histograms, if enabled; call from endJob
+			void writeReport() const;
+			void printSummary(std::ostream& out) const;
+
+		private:
+			static const int nBins = 40;   // [2^i, 2^(i+1)) ns, the last one open
+
+			struct Stage {
+				std::string name;
+				unsigned long calls;
+				double seconds, min, max;
+				std::vector<unsigned long> bins;
+			};
+			struct Counter {
+				std::string name;
+				unsigned long value;
+			};
+
+			void record(std::size_t stage, Clock::duration elapsed);
+			double quantile(const Stage& s, double q) const;   // seconds
+			void writeJson(std::ostream& out) const;
+			void writeHistograms() const;
+
+			bool enabled_;
+			std::string module_;
+			std::string report_;
+			std::string histograms_;
+			std::vector<Stage> stages_;
+			std::vector<Counter> counters_;
+			std::size_t current_;
+			Clock::time_point start_;
+	};
+
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef VAJets_PKUTreeMaker_TreeMakerLogic_h
+#define VAJets_PKUTreeMaker_TreeMakerLogic_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      TreeMakerLogic
+//
+/**\class TreeMakerLogic TreeMakerLogic.h VAJets/PKUTreeMaker/interface/TreeMakerLogic.h
+
+ Description: the framework-independent state of the W+gamma and Z+gamma
+ tree makers.
+
+ Implementation:
+     Holds what TreeMakerCore (plugins/PKUTreeMakerCore.h) used to keep and
+     does not need an edm::Event for: the Type-I JEC payloads and the MET
+     correction computed from the jets, the photon effective areas, the
+     photon selections and blocks with selectPhotons(), the stage timer
+     and the per luminosity block summary with the cut flow of analyze()
+     (LumiSummary.h).  The event-reading side (tokens, muon subtraction, truth
+     matching) stays in TreeMakerCore, which derives from this class; the
+     Z analysis core (ZAnalysisCore.h) derives from it as well, so that the
+     same code runs in the plugin and in the replay executable.
+*/
+//
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "DataFormats/Math/interface/LorentzVector.h"
+#include "VAJets/PKUTreeMaker/interface/EffectiveAreaTable.h"
+#include "VAJets/PKUTreeMaker/interface/JecRegistry.h"
+#include "VAJets/PKUTreeMaker/interface/LumiSummary.h"
+#include "VAJets/PKUTreeMaker/interface/PhotonCategory.h"
+#include "VAJets/PKUTreeMaker/interface/StageTimer.h"
+
+class FactorizedJetCorrector;
+namespace edm { class ParameterSet; }
+
+namespace pku {
+
+	// The highest-pt photon of one pku::photon::Selection; its branches carry
+	// the selection suffix.  The lepton-dependent entries are left to the tree maker.
+	struct SelectedPhoton {
+		int index;
+		double et, eta, phi, e;
+		double sieie, phoiso, chiso, nhiso;
+		double drla, drla2, Mla, Mla2, Mva;
+
+		SelectedPhoton() { reset(); }
+		void reset() {
+			index = -1;
+			et = eta = phi = e = -1e1;
+			sieie = phoiso = chiso = nhiso = -1e1;
+			drla = drla2 = 1e1;
+			Mla = Mla2 = Mva = -1e1;
+		}
+	};
+
+	// stages and counters of the tree makers' analyze(); record is the
+	// event capture of ZPKUTreeMaker, npos elsewhere
+	struct TreeMakerStages {
+		std::size_t event, weights, hlt, gen, filters, vertices, typeI, met, photons, jets, matching, fill, record;
+		std::size_t nEvents, nPhotons, nJets;
+	};
+
+	// LumiSummary counters of the events passing each early return of analyze();
+	// the tree is filled either way, with dummy values past a failed cut
+	struct TreeMakerCuts {
+		std::size_t leptonicV, vertex, goodVertex;
+		std::size_t sumGenWeight, sumGenWeight2, sumGenSign;   // of every MC event, see addGenWeight()
+	};
+
+	// One t1jetSrc jet entering the Type-I correction, after the EM-fraction
+	// cut: its uncorrected four-momentum (correctedP4(0)) and the same with
+	// the selected muons subtracted.
+	struct TypeIJet {
+		math::XYZTLorentzVector uncorrected, subtracted;
+		double area;
+	};
+
+	class TreeMakerLogic {
+		public:
+			explicit TreeMakerLogic(const edm::ParameterSet& iConfig);
+			virtual ~TreeMakerLogic() {}
+
+		protected:
+			// fills TypeICorrMap_ from the jets, with the payloads of 'run' and nVtx
+			void typeICorrection(const std::vector<TypeIJet>& jets, unsigned run, double rho);
+			double getDR(double eta1, double phi1, double eta2, double phi2);
+			// rank photonVars_ by pt once and fill the first nSelections photon blocks
+			void selectPhotons(std::size_t nSelections);
+			// the generator weight of an MC event into the summary: countEvent()
+			// of the tree makers, and the replay for ZAnalysisCore; genWeight_
+			// keeps it for the weighted sums of the same event
+			void addGenWeight(double w) {
+				genWeight_ = w;
+				summary_.add(cuts_.sumGenWeight, w);
+				summary_.add(cuts_.sumGenWeight2, w*w);
+				summary_.add(cuts_.sumGenSign, w > 0 ? 1. : (w < 0 ? -1. : 0.));
+			}
+
+			int nVtx;
+			double genWeight_;   // of the last addGenWeight()
+			pku::JecRegistry jecAK4chs_;   // Type-I MET payloads, per run range
+			FactorizedJetCorrector* jecAK4_;
+			FactorizedJetCorrector* jecOffset_;
+			std::map<std::string,double>  TypeICorrMap_;
+			pku::EffectiveAreaTable photonEA_;   // charged, neutral hadrons, photons
+			std::vector<pku::photon::Selection> photonSelections_;   // "" and "_f" first
+			std::vector<SelectedPhoton> photonBlocks_;               // one per selection, never resized
+			std::vector<pku::photon::Variables> photonVars_;         // this event's photons
+			std::vector<unsigned> photonMasks_;                      // their pku::photon::Category bits
+			std::vector<unsigned> photonOrder_;
+			pku::StageTimer timer_;
+			TreeMakerStages stages_;
+			pku::LumiSummary summary_;
+			TreeMakerCuts cuts_;
+
+		private:
+			static double jecFactor(FactorizedJetCorrector* corrector, const math::XYZTLorentzVector& p4, double area, double rho, int npv);
+			static pku::EffectiveAreaTable photonEffectiveAreas(const edm::ParameterSet& iConfig);
+	};
+
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef VAJets_PKUTreeMaker_TreeOutputPolicy_h
+#define VAJets_PKUTreeMaker_TreeOutputPolicy_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      TreeOutputPolicy
+//
+/**\class TreeOutputPolicy TreeOutputPolicy.h VAJets/PKUTreeMaker/interface/TreeOutputPolicy.h
+
+ Description: compression, cluster and basket layout of the output trees.
+
+ Implementation:
+     Configured by the optional "outputPolicy" PSet of the tree makers:
+
+       compressionAlgorithm  "ZLIB", "LZMA", "LZ4" or "ZSTD" (ROOT >= 6.20);
+                             empty keeps the TFileService file setting
+       compressionLevel      1-9
+       autoFlush             TTree::SetAutoFlush argument, > 0 entries per
+                             cluster, < 0 bytes per cluster
+       basketSize            initial basket size of every branch
+       entriesPerBasket      if > 0, once calibrationEntries entries are
+                             written every basket is resized to hold about
+                             that many entries of its branch, within
+                             [minBasketSize, maxBasketSize]
+       calibrationEntries    entries used to measure the branch sizes
+
+     With a negative autoFlush ROOT runs its own TTree::OptimizeBaskets at
+     the first cluster; give autoFlush in entries to keep the per-branch
+     sizing of entriesPerBasket.
+*/
+//
+
+#include <iosfwd>
+#include <string>
+
+#include "Rtypes.h"
+
+class TTree;
+namespace edm { class ParameterSet; }
+
+namespace pku {
+
+	class TreeOutputPolicy {
+		public:
+			TreeOutputPolicy();
+			explicit TreeOutputPolicy(const edm::ParameterSet& pset);
+
+			// Apply compression, auto-flush and initial basket size to the
+			// branches booked so far on 'tree'.
+			void apply(TTree* tree);
+
+			// TTree::Fill, timed; resizes the baskets after the calibration sample.
+			Int_t fill(TTree* tree);
+
+			void printSummary(std::ostream& out, const TTree* tree) const;
+
+			// algorithm*100 + level, the ROOT compression settings convention
+			static int compressionSettings(const std::string& algorithm, int level);
+
+		private:
+			void resizeBaskets(TTree* tree);
+
+			int      compression_;   // -1: keep the file setting
+			Long64_t autoFlush_;
+			int      basketSize_;
+			int      entriesPerBasket_;
+			int      minBasketSize_;
+			int      maxBasketSize_;
+			Long64_t calibrationEntries_;
+
+			Long64_t filled_;
+			Long64_t bytesFilled_;
+			double   fillSeconds_;
+			bool     resized_;
+	};
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef VAJets_PKUTreeMaker_TriggerObjectIndex_h
+#define VAJets_PKUTreeMaker_TriggerObjectIndex_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      TriggerObjectIndex
+//
+/**\class TriggerObjectIndex TriggerObjectIndex.h VAJets/PKUTreeMaker/interface/TriggerObjectIndex.h
+
+ Description: (eta, phi) lookup of the trigger objects of one event, for
+ matching offline jets, leptons and photons to the HLT.
+
+ Implementation:
+     The objects of the requested filter (and path) are added once per
+     event from slimmedPatTrigger, keyed by their index in that collection,
+     then build() sorts them into
+     square (eta, phi) cells, stored contiguously with one offset per cell.
+     A query only visits the cells within dRmax of the point; objects
+     beyond |eta| = etaMax share the edge cells, which every query past
+     the edge also visits.  deltaR uses the wrapped delta phi.
+
+       pku::TriggerObjectIndex index;
+       index.add(*triggerObjects, iEvent.triggerNames(*triggerResults), "hltPFHT", "HLT_PFHT800");   // per event
+       index.build();
+       float dR;
+       int key = index.nearest(jet.eta(), jet.phi(), 0.2, &dR);   // -1 if none
+*/
+//
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace edm { class TriggerNames; }
+namespace pat { class TriggerObjectStandAlone; }
+
+namespace pku {
+
+	class TriggerObjectIndex {
+		public:
+			explicit TriggerObjectIndex(float cellSize = 0.4f, float etaMax = 5.f);
+
+			void clear();
+			void add(float eta, float phi, unsigned key);
+			// objects of the filter module 'filter' that 'path' (any version
+			// HLT_X_v<N> of it) accepted; an empty filter or path does not
+			// restrict.  names are those of the TriggerResults of the HLT
+			// process, to unpack the path names of the objects.
+			void add(const std::vector<pat::TriggerObjectStandAlone>& objects, const edm::TriggerNames& names,
+			         const std::string& filter, const std::string& path);
+			// call after the last add() and before querying
+			void build();
+
+			// key of the nearest object within dRmax, -1 if none
+			int nearest(float eta, float phi, float dRmax, float* dR = 0) const;
+			// keys of all objects within dRmax, in increasing order
+			void within(float eta, float phi, float dRmax, std::vector<unsigned>& keys) const;
+
+			std::size_t size() const { return entries_.size(); }
+
+		private:
+			struct Entry {
+				float eta, phi;
+				unsigned key;
+			};
+
+			int etaCell(float eta) const;
+			int phiCell(float phi) const;
+			template<class Visit> void visit(float eta, float phi, float dRmax, Visit& v) const;
+
+			float cellSize_, etaMax_, phiCellSize_;
+			int nEta_, nPhi_;
+			std::vector<Entry> pending_;
+			std::vector<Entry> entries_;          // grouped by cell
+			std::vector<unsigned> cellStart_;     // nEta x nPhi + 1 offsets into entries_
+	};
+
+}
+
+#endif
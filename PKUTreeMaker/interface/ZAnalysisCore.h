@@ -0,0 +1,187 @@
+#ifndef VAJets_PKUTreeMaker_ZAnalysisCore_h
+#define VAJets_PKUTreeMaker_ZAnalysisCore_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      ZAnalysisCore
+//
+/**\class ZAnalysisCore ZAnalysisCore.h VAJets/PKUTreeMaker/interface/ZAnalysisCore.h
+
+ Description: the ZPKUCandidates branches and the analysis that fills them
+ from a ZEventRecord.
+
+ Implementation:
+     Everything ZPKUTreeMaker computes once the inputs of the event are
+     read: weights, lepton and photon kinematics, the photon selections,
+     the Type-I MET, the AK4 JEC and the VBS tagging jets.  The constructor
+     declares the branches in schema_ from the tree maker's configuration,
+     book() attaches them to a TTree and/or the columnar writer, and
+     process() fills one entry per record.  The plugin and the replay
+     executable (bin/replayZTreeMaker.cc) both run it, so that a replay of
+     captured records reproduces the tree of the job that wrote them.
+*/
+//
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TLorentzVector.h"
+#include "VAJets/PKUTreeMaker/interface/ColumnarFile.h"
+#include "VAJets/PKUTreeMaker/interface/NtupleSchema.h"
+#include "VAJets/PKUTreeMaker/interface/PileupReweighting.h"
+#include "VAJets/PKUTreeMaker/interface/TreeMakerLogic.h"
+#include "VAJets/PKUTreeMaker/interface/TreeOutputPolicy.h"
+#include "VAJets/PKUTreeMaker/interface/ZEventRecord.h"
+
+class TTree;
+
+namespace pku {
+
+	class ZAnalysisCore : public TreeMakerLogic {
+		public:
+			explicit ZAnalysisCore(const edm::ParameterSet& iConfig);
+			virtual ~ZAnalysisCore() {}
+
+			static const char* treeName()  { return "ZPKUCandidates"; }
+			static const char* treeTitle() { return "ZPKU Candidates"; }
+
+			/// outputFormat: "root" (ZPKUCandidates TTree), "columnar" (see ColumnarFile.h) or "both"
+			const std::string& outputFormat() const { return outputFormat_; }
+			// book the selected branches on 'tree' (may be null) and, with
+			// 'columnar', open the columnar file of the configuration
+			void book(TTree* tree, bool columnar);
+			// compute and fill one entry
+			void process(const ZEventRecord& record);
+			// close the columnar output and summarise schema, output, JEC,
+			// pileup, the LumiSummary and timing
+			void finish(std::ostream& out);
+
+			/// the replay in place of the framework: the LumiSummary tree (may
+			/// be null), countEvent() of an event and the end of a block
+			void attachSummary(TTree* tree) { summary_.attach(tree); }
+			void countRecord(const ZEventRecord& record) { if (RunOnMC_) addGenWeight(record.theWeight); }
+			void endLumi(unsigned run, unsigned ls) { summary_.endLumi(run, ls); }
+
+		protected:
+			void setDummyValues();
+			void fillTree() {
+				timer_.enter(stages_.fill);
+				schema_.encode();
+				if (outTree_) outputPolicy_.fill(outTree_);
+				if (columnar_) columnar_->fill();
+				timer_.stop();
+			}
+
+			TTree* outTree_;
+			pku::NtupleSchema schema_;
+			pku::TreeOutputPolicy outputPolicy_;
+			std::unique_ptr<pku::ColumnarWriter> columnar_;
+			std::vector<std::string> keepBranches_, dropBranches_;
+			std::string outputFormat_;
+			std::string columnarFile_;
+			int columnarRowGroup_;
+			std::string columnarCodec_;
+			pku::PileupReweighting pileup_;
+			/// LumiSummary counters of every MC event, for the normalisation
+			std::size_t sumGenWeightPU_, sumGenWeightPUUp_, sumGenWeightPUDown_, sumGenSignPU_;
+
+			int nevent, run, ls;
+			double triggerWeight, lumiWeight, pileupWeight, pileupWeightUp, pileupWeightDown;
+			double theWeight;
+			double  nump=0.;
+			double  numm=0.;
+			double pweight[703];
+			double  npT, npIT;
+			int     nBX;
+			double ptVlep, yVlep, phiVlep, massVlep;
+			double ptlep1, etalep1, philep1;
+			double ptlep2, etalep2, philep2;
+			// for muon rochester correction
+			int muon1_trackerLayers;
+			double matchedgenMu1_pt;
+			int muon2_trackerLayers;
+			double matchedgenMu2_pt;
+			// for muon rochester correction
+			int  lep, nlooseeles,nloosemus, ngoodmus;
+			double met, metPhi, j1metPhi, j2metPhi;
+			double j1metPhi_f, j2metPhi_f;
+			//Met JEC
+			double METraw_et, METraw_phi, METraw_sumEt;
+			double genMET, MET_et, MET_phi, MET_sumEt, MET_corrPx, MET_corrPy;
+			double useless;
+			// AK4 Jets
+			double ak4jet_pt[6],ak4jet_eta[6],ak4jet_phi[6],ak4jet_e[6];
+			double ak4jet_pt_jer[6];
+			double ak4jet_csv[6],ak4jet_icsv[6];
+			double drjetlep[6], drjetphoton[6];
+			double genphoton_pt[6],genphoton_eta[6],genphoton_phi[6];
+			double genjet_pt[6],genjet_eta[6],genjet_phi[6],genjet_e[6];
+			double genmuon_pt[6],genmuon_eta[6],genmuon_phi[6];
+			int genmuon_pid[6];
+			double genelectron_pt[6],genelectron_eta[6],genelectron_phi[6];
+			//Photon
+			double photon_pt[6],photon_eta[6],photon_phi[6],photon_e[6];
+			bool   photon_pev[6],photon_pevnew[6],photon_ppsv[6],photon_iseb[6],photon_isee[6];
+			double photon_hoe[6],photon_sieie[6],photon_sieie2[6],photon_chiso[6],photon_nhiso[6],photon_phoiso[6],photon_drla[6],photon_drla2[6],photon_mla[6],photon_mla2[6],photon_mva[6];
+			int      photon_istrue[6], photon_isprompt[6];
+			bool passEleVeto, passEleVetonew, passPixelSeedVeto;
+			//Photon gen match
+			int   isTrue_;
+			bool ISRPho;
+			int isprompt_;
+			double dR_;
+			//Jets
+			double jet1pt, jet1eta, jet1phi, jet1e, jet1csv, jet1icsv;
+			double jet1pt_f, jet1eta_f, jet1phi_f, jet1e_f, jet1csv_f, jet1icsv_f;
+			double jet2pt, jet2eta, jet2phi, jet2e, jet2csv, jet2icsv;
+			double jet2pt_f, jet2eta_f, jet2phi_f, jet2e_f, jet2csv_f, jet2icsv_f;
+			double drj1a, drj2a, drj1l, drj2l, drj1l2,drj2l2;
+			double drj1a_f, drj2a_f, drj1l_f, drj2l_f, drj1l2_f, drj2l2_f;
+			double Mjj, deltaetajj, zepp;
+			double Mjj_f, deltaetajj_f, zepp_f;
+			int  HLT_Ele1;
+			int  HLT_Ele2;
+			int  HLT_Mu1;
+			int  HLT_Mu2;
+			int  HLT_Mu3;
+			int  HLT_Mu4;
+			int  HLT_Mu5;
+			int  HLT_Mu6;
+			int  HLT_Mu7;
+			int  HLT_Mu8;
+			// filter
+			bool passFilter_HBHE_                   ;
+			bool passFilter_HBHEIso_                ;
+			bool passFilter_globalTightHalo_ ;
+			bool passFilter_ECALDeadCell_           ;
+			bool passFilter_GoodVtx_                ;
+			bool passFilter_EEBadSc_                ;
+			bool passFilter_badMuon_                ;
+			bool passFilter_badChargedHadron_       ;
+			// Meng
+			bool passFilter_MetbadMuon_		  ;
+			bool passFilter_duplicateMuon_	  ;
+			// muon station2 retrieve, L1 issue, Meng 2017/3/26
+			double lep1_eta_station2;
+			double lep1_phi_station2;
+			int lep1_sign;
+			double lep2_eta_station2;
+			double lep2_phi_station2;
+			int lep2_sign;
+
+			/// Parameters to steer the treeDumper
+			int originalNEvents_;
+			double crossSectionPb_;
+			double targetLumiInvPb_;
+			bool RunOnMC_;
+			pku::JecRegistry jecAK4Jets_;
+
+		private:
+			std::vector<pku::TypeIJet> typeIJets_;
+			std::vector<TLorentzVector> jets_;   // corrected AK4 jets above 20 GeV
+	};
+
+}
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef VAJets_PKUTreeMaker_ZEventRecord_h
+#define VAJets_PKUTreeMaker_ZEventRecord_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      ZEventRecord, ZRecordWriter, ZRecordReader
+//
+/**\class ZEventRecord ZEventRecord.h VAJets/PKUTreeMaker/interface/ZEventRecord.h
+
+ Description: the inputs of one ZPKUTreeMaker event, as read from the
+ edm::Event, and a binary file of them.
+
+ Implementation:
+     ZPKUTreeMaker::analyze() fills a record from the event and hands it to
+     ZAnalysisCore::process(), which computes every branch from it; with
+     recordFile set the records are also written out, and the replay
+     executable (bin/replayZTreeMaker.cc) runs the same process() on them
+     without the framework.  What needs the framework beyond reading a
+     product is resolved at capture time: trigger bits through the
+     HLTConfigProvider, the muon extrapolation to station 2, the prompt
+     electron veto and the photon truth matching, and the muon subtraction
+     of the Type-I jets.  A capture only reads what the booked stages use
+     (and, on MC, the generator weight and the pileup, which the sums of
+     weights need), so a record replays under the configuration it was
+     written with, which the file carries.  The fields are copied as they
+     are in memory, so the file has the byte order of the host that wrote
+     it (little endian on the CMSSW platforms); a reader of the other byte
+     order rejects it at the version word.  Layout:
+
+       "PKUZREC1", uint32 version
+       uint32 length, ParameterSet::toString() of the tree maker
+       per event: uint32 length, the fields in the order of io()
+
+     Vectors are written as a uint32 size followed by the elements.
+     bin/checkZRecord.cc checks the round trip of a file through the
+     writer and the reader; test/checkReplay.py runs a configuration with
+     recordFile set and compares the replayed ntuple with that of cmsRun.
+*/
+//
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "VAJets/PKUTreeMaker/interface/TreeMakerLogic.h"
+
+namespace pku {
+
+	struct ZEventRecord {
+		// how far analyze() got; the tree is filled with what was read so far
+		enum Status { NoLeptonicV = 0, NoVertex, NoGoodVertex, Complete };
+
+		struct GenParticle {   // prompt final-state e, mu, gamma
+			int pdgId;
+			double pt, eta, phi;
+			template<class Archive> void io(Archive& ar) { ar & pdgId & pt & eta & phi; }
+		};
+		struct GenJet {
+			double e, pt, eta, phi;
+			template<class Archive> void io(Archive& ar) { ar & e & pt & eta & phi; }
+		};
+		struct Lepton {        // daughter of the leptonic V
+			int pdgId;
+			double pt, eta, phi, energy;
+			template<class Archive> void io(Archive& ar) { ar & pdgId & pt & eta & phi & energy; }
+		};
+		struct Vertex {
+			double chi2, ndof, rho, z;
+			template<class Archive> void io(Archive& ar) { ar & chi2 & ndof & rho & z; }
+		};
+		struct MET {
+			double uncorPt, uncorPhi, uncorSumEt;
+			template<class Archive> void io(Archive& ar) { ar & uncorPt & uncorPhi & uncorSumEt; }
+		};
+		struct Photon {
+			double pt, eta, scEta, scPhi, energy;
+			float hoe, sieie, chIso, nhIso, phoIso;
+			bool isEB, isEE, eleVeto, passEleVeto, hasPixelSeed;
+			int istrue, isprompt;   // matchToTruth(), MC only
+			template<class Archive> void io(Archive& ar) {
+				ar & pt & eta & scEta & scPhi & energy & hoe & sieie & chIso & nhIso & phoIso
+				   & isEB & isEE & eleVeto & passEleVeto & hasPixelSeed & istrue & isprompt;
+			}
+		};
+		struct Jet {           // ak4jetsSrc
+			double px, py, pz, e;   // correctedP4(0)
+			double eta, phi;        // of the jet as stored
+			float area, csv, icsv;
+			template<class Archive> void io(Archive& ar) { ar & px & py & pz & e & eta & phi & area & csv & icsv; }
+		};
+		struct TypeIJet {      // pku::TypeIJet
+			double px, py, pz, e, subPx, subPy, subPz, subE, area;
+			template<class Archive> void io(Archive& ar) { ar & px & py & pz & e & subPx & subPy & subPz & subE & area; }
+		};
+
+		int status;
+		int run, ls, event;
+		double theWeight;
+		int nBX;
+		double npT, npIT;
+		int HLT_Ele1, HLT_Ele2, HLT_Mu1, HLT_Mu2, HLT_Mu3, HLT_Mu4, HLT_Mu5, HLT_Mu6, HLT_Mu7, HLT_Mu8;
+		bool passFilter_HBHE, passFilter_HBHEIso, passFilter_globalTightHalo, passFilter_ECALDeadCell,
+		     passFilter_GoodVtx, passFilter_EEBadSc, passFilter_badMuon, passFilter_badChargedHadron,
+		     passFilter_MetbadMuon, passFilter_duplicateMuon;
+		double rho;
+		std::vector<GenParticle> genParticles;
+		std::vector<GenJet> genJets;
+		int nlooseeles, nloosemus, ngoodmus;
+		int muon1_trackerLayers, muon2_trackerLayers;
+		double lep1_eta_station2, lep1_phi_station2, lep2_eta_station2, lep2_phi_station2;
+		double ptV, etaV, phiV, massV, energyV;
+		Lepton lepton1, lepton2;
+		double met, metPhi;
+		std::vector<Vertex> vertices;
+		bool hasMET;   // pat::METCollection found
+		std::vector<MET> mets;
+		std::vector<TypeIJet> typeIJets;
+		std::vector<Photon> photons;
+		std::vector<Jet> jets;
+
+		ZEventRecord() { clear(); }
+		// the values analyze() starts from
+		void clear();
+
+		void setTypeIJets(const std::vector<pku::TypeIJet>& jets);
+		void getTypeIJets(std::vector<pku::TypeIJet>& jets) const;
+
+		template<class Archive> void io(Archive& ar) {
+			ar & status & run & ls & event & theWeight & nBX & npT & npIT;
+			ar & HLT_Ele1 & HLT_Ele2 & HLT_Mu1 & HLT_Mu2 & HLT_Mu3 & HLT_Mu4 & HLT_Mu5 & HLT_Mu6 & HLT_Mu7 & HLT_Mu8;
+			ar & passFilter_HBHE & passFilter_HBHEIso & passFilter_globalTightHalo & passFilter_ECALDeadCell
+			   & passFilter_GoodVtx & passFilter_EEBadSc & passFilter_badMuon & passFilter_badChargedHadron
+			   & passFilter_MetbadMuon & passFilter_duplicateMuon;
+			ar & rho & genParticles & genJets;
+			ar & nlooseeles & nloosemus & ngoodmus & muon1_trackerLayers & muon2_trackerLayers;
+			ar & lep1_eta_station2 & lep1_phi_station2 & lep2_eta_station2 & lep2_phi_station2;
+			ar & ptV & etaV & phiV & massV & energyV & lepton1 & lepton2 & met & metPhi;
+			ar & vertices & hasMET & mets & typeIJets & photons & jets;
+		}
+	};
+
+	class ZRecordWriter {
+		public:
+			// 'configuration' is stored in the header for the replay
+			ZRecordWriter(const std::string& path, const std::string& configuration);
+			~ZRecordWriter();
+
+			void write(ZEventRecord& record);
+			void close();
+
+			unsigned long events() const { return events_; }
+			unsigned long long bytesWritten() const { return bytes_; }
+
+		private:
+			void write(const void* data, std::size_t size);
+
+			std::ofstream out_;
+			std::string buffer_;
+			unsigned long events_;
+			unsigned long long bytes_;
+	};
+
+	class ZRecordReader {
+		public:
+			explicit ZRecordReader(const std::string& path);
+
+			const std::string& configuration() const { return configuration_; }
+			// false at the end of the file
+			bool next(ZEventRecord& record);
+
+		private:
+			bool read(void* data, std::size_t size);
+
+			std::string path_;
+			std::ifstream in_;
+			std::string configuration_;
+			std::string buffer_;
+			unsigned long events_;
+	};
+
+}
+
+#endif
@@ -0,0 +1,153 @@
+// -*- C++ -*-
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      CertifiedLumiFilter
+//
+/**\class CertifiedLumiFilter CertifiedLumiFilter.cc VAJets/PKUTreeMaker/plugins/CertifiedLumiFilter.cc
+
+ Description: keeps the events of the certified lumi sections of a Cert_*_JSON.txt.
+
+ Implementation:
+     Put first in the analysis path of the data configurations so that the
+     rejected lumi sections never reach the lepton, jet and photon
+     producers.  Simulated events pass untouched.  The membership test is
+     pku::LumiMask, which the tree makers can also use directly.
+
+     endJob reports, per run, the lumi sections seen and accepted.  With
+     the optional lumiByLS (a "brilcalc lumi --byls" csv) it also reports
+     the recorded luminosity of the processed lumi sections and the
+     fraction kept; without it the fraction is in lumi sections.  The
+     optional "timing" PSet times the mask lookup, see StageTimer.h.
+*/
+//
+
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include "FWCore/Framework/interface/EDFilter.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "VAJets/PKUTreeMaker/interface/LumiMask.h"
+#include "VAJets/PKUTreeMaker/interface/StageTimer.h"
+
+class CertifiedLumiFilter : public edm::EDFilter {
+	public:
+		explicit CertifiedLumiFilter(const edm::ParameterSet&);
+		~CertifiedLumiFilter() {}
+
+	private:
+		struct RunStats {
+			RunStats() : events(0), accepted(0) {}
+			unsigned long long events, accepted;
+			std::set<unsigned> seen, certified;
+		};
+
+		virtual bool filter(edm::Event&, const edm::EventSetup&) override;
+		virtual void endJob() override;
+		void readLumiByLS(const std::string& csv);
+		double recorded(unsigned run, unsigned lumi) const;
+
+		pku::LumiMask mask_;
+		std::map<unsigned, RunStats> stats_;
+		std::map<std::pair<unsigned, unsigned>, double> lumiByLS_;   // recorded /ub
+		RunStats* current_;
+		unsigned currentRun_, currentLumi_;
+		bool currentIn_;
+		pku::StageTimer timer_;   // "timing" PSet, see StageTimer.h
+		std::size_t stageMask_, countLumis_;
+};
+
+CertifiedLumiFilter::CertifiedLumiFilter(const edm::ParameterSet& iConfig)
+	:mask_(iConfig.getParameter<std::string>("jsonFile"))
+	 ,current_(0)
+	 ,currentRun_(0)
+	 ,currentLumi_(0)
+	 ,currentIn_(false)
+{
+	std::string lumiByLS = iConfig.existsAs<std::string>("lumiByLS") ? iConfig.getParameter<std::string>("lumiByLS") : "";
+	if (!lumiByLS.empty()) readLumiByLS(lumiByLS);
+
+	if (iConfig.existsAs<edm::ParameterSet>("timing"))
+		timer_ = pku::StageTimer(iConfig.getParameter<std::string>("@module_label"), iConfig.getParameter<edm::ParameterSet>("timing"));
+	stageMask_  = timer_.stage("mask");
+	countLumis_ = timer_.counter("lumis");
+}
+
+void CertifiedLumiFilter::readLumiByLS(const std::string& csv) {
+	std::ifstream in(csv.c_str());
+	if (!in) throw cms::Exception("Configuration") << "CertifiedLumiFilter: cannot open " << csv;
+	// #run:fill,ls,time,beamstatus,E(GeV),delivered(/ub),recorded(/ub),avgpu,source
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.empty() || line[0] == '#') continue;
+		std::istringstream fields(line);
+		std::string runFill, ls, field;
+		std::getline(fields, runFill, ',');
+		std::getline(fields, ls, ',');
+		for (int i = 0; i < 5; i++) std::getline(fields, field, ',');
+		lumiByLS_[std::make_pair(unsigned(std::stoul(runFill)), unsigned(std::stoul(ls)))] = std::stod(field);
+	}
+}
+
+double CertifiedLumiFilter::recorded(unsigned run, unsigned lumi) const {
+	std::map<std::pair<unsigned, unsigned>, double>::const_iterator it = lumiByLS_.find(std::make_pair(run, lumi));
+	return it == lumiByLS_.end() ? 0. : it->second;
+}
+
+bool CertifiedLumiFilter::filter(edm::Event& iEvent, const edm::EventSetup& iSetup) {
+	if (!iEvent.isRealData()) return true;
+	const unsigned run  = iEvent.id().run();
+	const unsigned lumi = iEvent.luminosityBlock();
+	pku::StageTimer::Scope scope(timer_, stageMask_);
+	if (run != currentRun_ || lumi != currentLumi_ || !current_) {
+		timer_.count(countLumis_);
+		if (run != currentRun_ || !current_) current_ = &stats_[run];
+		currentRun_  = run;
+		currentLumi_ = lumi;
+		currentIn_   = mask_.contains(run, lumi);
+		current_->seen.insert(lumi);
+		if (currentIn_) current_->certified.insert(lumi);
+	}
+	++current_->events;
+	if (currentIn_) ++current_->accepted;
+	return currentIn_;
+}
+
+void CertifiedLumiFilter::endJob() {
+	unsigned long long seen = 0, certified = 0, events = 0, accepted = 0;
+	double lumiSeen = 0., lumiCertified = 0.;
+	std::stringstream ss;
+	ss << std::setw(8) << "run" << std::setw(10) << "lumis" << std::setw(10) << "accepted"
+	   << std::setw(10) << "in JSON" << std::setw(12) << "events" << std::setw(12) << "accepted" << "\n";
+	for (std::map<unsigned, RunStats>::const_iterator it = stats_.begin(); it != stats_.end(); ++it) {
+		const RunStats& r = it->second;
+		ss << std::setw(8) << it->first << std::setw(10) << r.seen.size() << std::setw(10) << r.certified.size()
+		   << std::setw(10) << mask_.nLumis(it->first) << std::setw(12) << r.events << std::setw(12) << r.accepted << "\n";
+		seen += r.seen.size(); certified += r.certified.size();
+		events += r.events; accepted += r.accepted;
+		if (!lumiByLS_.empty()) {
+			for (std::set<unsigned>::const_iterator l = r.seen.begin(); l != r.seen.end(); ++l) lumiSeen += recorded(it->first, *l);
+			for (std::set<unsigned>::const_iterator l = r.certified.begin(); l != r.certified.end(); ++l) lumiCertified += recorded(it->first, *l);
+		}
+	}
+	ss << "lumi sections accepted " << certified << "/" << seen
+	   << ", events accepted " << accepted << "/" << events << "\n";
+	if (!lumiByLS_.empty())
+		ss << "recorded luminosity accepted " << lumiCertified*1e-6 << "/" << lumiSeen*1e-6 << " /pb ("
+		   << (lumiSeen > 0. ? 100.*lumiCertified/lumiSeen : 0.) << "%)\n";
+	else
+		ss << "certified fraction " << (seen ? 100.*certified/seen : 0.) << "% of the lumi sections (no lumiByLS given)\n";
+	timer_.printSummary(ss);
+	edm::LogInfo("CertifiedLumiFilter")<<"SUMMARY:\n"<<ss.str();
+	timer_.writeReport();
+}
+
+//define this as a plug-in
+DEFINE_FWK_MODULE(CertifiedLumiFilter);
@@ -6,6 +6,7 @@
 #include "FWCore/Framework/interface/DependentRecordImplementation.h"
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/Utilities/interface/EDMException.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
 
 #include "DataFormats/PatCandidates/interface/Jet.h"
 #include "DataFormats/PatCandidates/interface/Electron.h"
@@ -25,8 +26,8 @@
 // trigger
 #include "HLTrigger/HLTcore/interface/HLTConfigProvider.h"
 #include "DataFormats/Common/interface/TriggerResults.h"
-#include "DataFormats/HLTReco/interface/TriggerEvent.h"
-#include "DataFormats/HLTReco/interface/TriggerObject.h"
+#include "DataFormats/PatCandidates/interface/TriggerObjectStandAlone.h"
+#include "FWCore/Common/interface/TriggerNames.h"
 #include "DataFormats/HLTReco/interface/TriggerTypeDefs.h" // gives access to the (release cycle dependent) trigger object codes
 #include "DataFormats/JetReco/interface/Jet.h"
 
@@ -41,11 +42,17 @@
 #include <TRandom3.h>
 #include "CondFormats/JetMETObjects/interface/FactorizedJetCorrector.h"
 #include "CommonTools/Utils/interface/StringCutObjectSelector.h"
+#include "VAJets/PKUTreeMaker/interface/JecRegistry.h"
+#include "VAJets/PKUTreeMaker/interface/JetConstituentKeys.h"
+#include "VAJets/PKUTreeMaker/interface/StageTimer.h"
+#include "VAJets/PKUTreeMaker/interface/TriggerObjectIndex.h"
 
 #include <TFile.h>
 #include <TH1F.h>
 #include <TGraphAsymmErrors.h>
 #include <TLorentzVector.h>
+#include <iostream>
+#include <sstream>
 #include <vector>
 
 using namespace fastjet;
@@ -65,7 +72,8 @@ class JetUserData : public edm::EDProducer {
 
 	private:
 		void produce( edm::Event &, const edm::EventSetup & );
-		bool isMatchedWithTrigger(const pat::Jet&, trigger::TriggerObjectCollection,int&,double&,double);
+		void endJob();
+		bool isMatchedWithTrigger(const pat::Jet&, const pku::TriggerObjectIndex&,int&,double&,double);
 
 		edm::EDGetTokenT<std::vector<pat::Jet> >     jetToken_;
 
@@ -79,13 +87,19 @@ class JetUserData : public edm::EDProducer {
 		std::string resolutionsFile_;
 		std::string scaleFactorsFile_;
 		EDGetTokenT< edm::TriggerResults > triggerResultsLabel_;
-		EDGetTokenT< trigger::TriggerEvent > triggerSummaryLabel_;
+		EDGetTokenT< std::vector<pat::TriggerObjectStandAlone> > triggerObjectsLabel_;
 		InputTag hltJetFilterLabel_;
 		std::string hltPath_;
 		double hlt2reco_deltaRmax_;
 		std::string candSVTagInfos_;
 		HLTConfigProvider hltConfig;
 		int triggerBit;
+		pku::TriggerObjectIndex triggerObjects_;   // hltJetFilter objects of hltPath in the event
+		std::vector<unsigned int> constituentKeys_;   // of one jet, reused
+		bool pfKeysUserData_;                      // also the per-jet "pfKeys" userData, on by default for the readers of the jets
+		unsigned long nEvents_, nJets_, nKeys_;
+		pku::StageTimer timer_;   // "timing" PSet, see StageTimer.h
+		std::size_t stageSetup_, stageJec_, stageTypeI_, stageJer_, stageUserData_, stageKeys_, stageTrigger_, stagePut_, countJets_;
 		TRandom3 rnd_;
 		JME::JetParameters jetParam;
 		JME::JetResolution resolution;
@@ -93,9 +107,7 @@ class JetUserData : public edm::EDProducer {
 		//////// for JEC before JEC uncertainty
 		FactorizedJetCorrector* jecOffset_;
 		FactorizedJetCorrector* jecAK4_;
-		std::vector<std::string> jetCorrLabel_;
-		std::vector<std::string> jecAK4chsLabels_;
-		std::vector<std::string> offsetCorrLabel_;
+		pku::JecRegistry jecAK4chs_;
 		edm::EDGetTokenT<reco::VertexCollection> VertexToken_;
 		//////// Meng 2017/5/8
 };
@@ -108,38 +120,42 @@ JetUserData::JetUserData(const edm::ParameterSet& iConfig) :
 	getJERFromTxt_      (iConfig.getParameter<bool>("getJERFromTxt")),
 	jetCorrLabel       (iConfig.getParameter<std::string>("jetCorrLabel")),
 	triggerResultsLabel_(consumes<edm::TriggerResults>(iConfig.getParameter<edm::InputTag>("triggerResults"))),
-	triggerSummaryLabel_(consumes<trigger::TriggerEvent>(iConfig.getParameter<edm::InputTag>("triggerSummary"))),
+	// MiniAOD has no hltTriggerSummaryAOD: the objects come from slimmedPatTrigger
+	triggerObjectsLabel_(consumes<std::vector<pat::TriggerObjectStandAlone> >(iConfig.existsAs<edm::InputTag>("triggerObjects") ?
+	                     iConfig.getParameter<edm::InputTag>("triggerObjects") : edm::InputTag("slimmedPatTrigger"))),
 	hltJetFilterLabel_  (iConfig.getParameter<edm::InputTag>("hltJetFilter")),   //trigger objects we want to match
 	hltPath_            (iConfig.getParameter<std::string>("hltPath")),
 	hlt2reco_deltaRmax_ (iConfig.getParameter<double>("hlt2reco_deltaRmax")),
 	candSVTagInfos_         (iConfig.getParameter<std::string>("candSVTagInfos")),
-	jecAK4chsLabels_    (iConfig.getParameter<std::vector<std::string>>("jecAK4chsPayloadNames_jetUserdata")),
-	VertexToken_ (consumes<reco::VertexCollection> (iConfig.getParameter<edm::InputTag>( "vertex_jetUserdata" )))
+	jecAK4chs_          (iConfig, "jecAK4chsPayloadNames_jetUserdata", "jecAK4chsPayloadNames"),
+	VertexToken_ (consumes<reco::VertexCollection> (iConfig.getParameter<edm::InputTag>( "vertex_jetUserdata" ))),
+	pfKeysUserData_     (iConfig.existsAs<bool>("pfKeysUserData") ? iConfig.getParameter<bool>("pfKeysUserData") : true),
+	nEvents_(0), nJets_(0), nKeys_(0)
 {
 	if (getJERFromTxt_) {
 		resolutionsFile_  = iConfig.getParameter<std::string>("resolutionsFile");
 		scaleFactorsFile_ = iConfig.getParameter<std::string>("scaleFactorsFile");
 	} else
 		jerLabel_         = iConfig.getParameter<std::string>("jerLabel");
-	//////// for JEC before JEC uncertainty
-	jetCorrLabel_ = jecAK4chsLabels_;
-	offsetCorrLabel_.push_back(jetCorrLabel_[0]);
-
-	std::vector<JetCorrectorParameters> vPar;
-	for ( std::vector<std::string>::const_iterator payloadBegin = jecAK4chsLabels_.begin(), payloadEnd = jecAK4chsLabels_.end(), ipayload = payloadBegin; ipayload != payloadEnd; ++ipayload ) {
-		JetCorrectorParameters pars(*ipayload);
-		vPar.push_back(pars);
-	}
-	jecAK4_ = new FactorizedJetCorrector(vPar);
-	vPar.clear();
-	for ( std::vector<std::string>::const_iterator payloadBegin = offsetCorrLabel_.begin(), payloadEnd = offsetCorrLabel_.end(), ipayload = payloadBegin; ipayload != payloadEnd; ++ipayload ) {
-		JetCorrectorParameters pars(*ipayload);
-		vPar.push_back(pars);
-	}
-	jecOffset_ = new FactorizedJetCorrector(vPar);
-	vPar.clear();
-	//////// Meng 2017/5/8
+	//////// JEC before JEC uncertainty: the correctors are taken per run from jecAK4chs_
+	jecOffset_ = 0;
+	jecAK4_    = 0;
 	produces<vector<pat::Jet> >();
+	// constituent keys of the output jets, see JetConstituentKeys.h
+	produces<vector<unsigned int> >("pfKeyOffsets");
+	produces<vector<unsigned int> >("pfKeys");
+
+	if (iConfig.existsAs<edm::ParameterSet>("timing"))
+		timer_ = pku::StageTimer(iConfig.getParameter<std::string>("@module_label"), iConfig.getParameter<edm::ParameterSet>("timing"));
+	stageSetup_    = timer_.stage("setup");
+	stageJec_      = timer_.stage("jec");
+	stageTypeI_    = timer_.stage("typeI");
+	stageJer_      = timer_.stage("jer");
+	stageUserData_ = timer_.stage("userData");
+	stageKeys_     = timer_.stage("keys");
+	stageTrigger_  = timer_.stage("trigger");
+	stagePut_      = timer_.stage("put");
+	countJets_     = timer_.counter("jets");
 }
 
 double JetUserData::get_JER_corr(float JERSF, bool isMC, pat::Jet jet, double conSize, float PtResolution, double jetCorrFactor){
@@ -170,17 +186,30 @@ double JetUserData::get_JER_corr(float JERSF, bool isMC, pat::Jet jet, double co
 
 void JetUserData::produce( edm::Event& iEvent, const edm::EventSetup& iSetup) {
 
+	timer_.enter(stageSetup_);
 	bool isMC = (!iEvent.isRealData());
 
 	double jetCorrEtaMax           = 9.9;
 	edm::Handle<reco::VertexCollection> vertices_;
 	iEvent.getByToken(VertexToken_, vertices_);
 	double nVtx = vertices_->size();
+	jecAK4_    = jecAK4chs_.corrector(iEvent.id().run());
+	jecOffset_ = jecAK4chs_.offset(iEvent.id().run());
 
 	edm::Handle<std::vector<pat::Jet> > jetHandle, packedjetHandle;
 	iEvent.getByToken(jLabel_, jetHandle);
 	auto_ptr<vector<pat::Jet> > jetColl( new vector<pat::Jet> (*jetHandle) );
 
+	// trigger objects of hltJetFilter accepted by hltPath, indexed once for all jets
+	edm::Handle<std::vector<pat::TriggerObjectStandAlone> > triggerObjects;
+	iEvent.getByToken(triggerObjectsLabel_, triggerObjects);
+	edm::Handle<edm::TriggerResults> triggerResults;
+	iEvent.getByToken(triggerResultsLabel_, triggerResults);
+	triggerObjects_.clear();
+	if (triggerObjects.isValid() && triggerResults.isValid())
+		triggerObjects_.add(*triggerObjects, iEvent.triggerNames(*triggerResults), hltJetFilterLabel_.label(), hltPath_);
+	triggerObjects_.build();
+
 	// JEC Uncertainty
 	edm::ESHandle<JetCorrectorParametersCollection> JetCorrParColl;
 	iSetup.get<JetCorrectionsRecord>().get(jetCorrLabel, JetCorrParColl); 
@@ -210,8 +239,12 @@ void JetUserData::produce( edm::Event& iEvent, const edm::EventSetup& iSetup) {
 	std::string skipMuonSelection_string = "isGlobalMuon | isStandAloneMuon";
         StringCutObjectSelector<reco::Candidate>* skipMuonSelection_ = new StringCutObjectSelector<reco::Candidate>(skipMuonSelection_string,true);
 	//--------for MET
+	auto_ptr<vector<unsigned int> > pfKeyOffsets( new vector<unsigned int>(1, 0) );
+	auto_ptr<vector<unsigned int> > pfKeys( new vector<unsigned int> );
+	pfKeyOffsets->reserve(jetColl->size() + 1);
 	for (size_t i = 0; i< jetColl->size(); i++){
 		pat::Jet & jet = (*jetColl)[i];
+		timer_.enter(stageJec_);
 
 		/////// for JEC before JEC uncertainty
 		double jetCorrFactor = 1.;
@@ -260,6 +293,7 @@ void JetUserData::produce( edm::Event& iEvent, const edm::EventSetup& iSetup) {
                 double jecUncertainty_l1_down = jecUnc.getUncertainty(false);//true = UP, false = DOWN //Meng Lu
 
  //-----------------------for MET
+		timer_.enter(stageTypeI_);
 		double emEnergyFraction = jet.chargedEmEnergyFraction() + jet.neutralEmEnergyFraction();
                 double corrEx_MET_JEC = 0;
                 double corrEy_MET_JEC = 0;
@@ -304,6 +338,7 @@ void JetUserData::produce( edm::Event& iEvent, const edm::EventSetup& iSetup) {
 //-----------------------for MET
 
 		// JER
+		timer_.enter(stageJer_);
 		jetParam.setJetPt(jetCorrFactor*rawJetP4.pt()).setJetEta(jet.eta()).setRho(*rho);// resolution depend on pt and eta, SF depend on eta and rho, so the parameter should be initialized with three parameters
 		float PtResolution = resolution.getResolution(jetParam);
 		float JERSF        = res_sf.getScaleFactor(jetParam);
@@ -378,6 +413,7 @@ void JetUserData::produce( edm::Event& iEvent, const edm::EventSetup& iSetup) {
                         corrSumEt_MET_JER_down += (smearedP4_down.Et() - smearedP4_down_raw.Et());
 		}
 
+		timer_.enter(stageUserData_);
 		jet.addUserFloat("jecUncertainty_up",   jecUncertainty_up);
 		jet.addUserFloat("jecUncertainty_down",   jecUncertainty_down);
 		jet.addUserFloat("jecUncertainty_l1_up", jecUncertainty_l1_up);
@@ -455,35 +491,64 @@ void JetUserData::produce( edm::Event& iEvent, const edm::EventSetup& iSetup) {
 		jet.addUserFloat("SV0mass", SV0mass); 
 		jet.addUserFloat("SV1mass", SV1mass); 
 
-		//// Jet constituent indices for lepton matching
-		std::vector<unsigned int> constituentIndices;
-		auto constituents = jet.daughterPtrVector();
-		for ( auto & constituent : constituents ) {
-			constituentIndices.push_back( constituent.key() );
+		//// Jet constituent indices for lepton matching, one flat row per jet
+		timer_.enter(stageKeys_);
+		constituentKeys_.clear();
+		for ( auto & constituent : jet.daughterPtrVector() ) {
+			constituentKeys_.push_back( constituent.key() );
 		}
+		pku::JetConstituentKeys::append(*pfKeyOffsets, *pfKeys, constituentKeys_.begin(), constituentKeys_.end());
+		if (pfKeysUserData_) jet.addUserData("pfKeys", constituentKeys_ );
 
-		jet.addUserData("pfKeys", constituentIndices );
+		//// nearest hltJetFilter object within hlt2reco_deltaRmax: its index in slimmedPatTrigger, -1 if none
+		timer_.enter(stageTrigger_);
+		int hltIndex = -1;
+		double hltDeltaR = -1.;
+		isMatchedWithTrigger(jet, triggerObjects_, hltIndex, hltDeltaR, hlt2reco_deltaRmax_);
+		jet.addUserInt("hltMatch", hltIndex);
+		jet.addUserFloat("hltMatchDR", hltDeltaR);
 
 
 	} //// Loop over all jets 
 
+	timer_.enter(stagePut_);
+	timer_.count(countJets_, jetColl->size());
+	++nEvents_;
+	nJets_ += jetColl->size();
+	nKeys_ += pfKeys->size();
 	iEvent.put( jetColl );
+	iEvent.put( pfKeyOffsets, "pfKeyOffsets" );
+	iEvent.put( pfKeys, "pfKeys" );
+	timer_.stop();
 
 }
 
 // ------------ method called once each job just after ending the event loop  ------------
+void JetUserData::endJob()
+{
+	// the userData form costs, per jet, a label string, an OwnVector slot and a
+	// heap-allocated UserHolder around its own heap-allocated vector
+	const double csr = sizeof(unsigned int)*double(nJets_ + nEvents_ + nKeys_);
+	const double userData = double(nJets_)*(sizeof(std::string) + sizeof(pat::UserData*) + sizeof(pat::UserHolder<std::vector<unsigned int> >))
+		+ sizeof(unsigned int)*double(nKeys_);
+	std::stringstream ss;
+	ss<<"nEvents="<<nEvents_<<" nJets="<<nJets_<<" constituents/jet="<<(nJets_ ? nKeys_/double(nJets_) : 0.)<<"\n"
+		<<"pfKeys bytes/event: flat="<<(nEvents_ ? csr/nEvents_ : 0.)<<" userData>="<<(nEvents_ ? userData/nEvents_ : 0.)
+		<<(pfKeysUserData_ ? " (both written)" : "")<<"\n";
+	timer_.printSummary(ss);
+	edm::LogInfo("JetUserData")<<"SUMMARY:\n"<<ss.str();
+	timer_.writeReport();
+}
+
+// ------------ nearest trigger object of the event index, not just the first one inside the cone  ------------
 	bool
-JetUserData::isMatchedWithTrigger(const pat::Jet& p, trigger::TriggerObjectCollection triggerObjects, int& index, double& deltaR, double deltaRmax = 0.2)
+JetUserData::isMatchedWithTrigger(const pat::Jet& p, const pku::TriggerObjectIndex& triggerObjects, int& index, double& deltaR, double deltaRmax = 0.2)
 {
-	for (size_t i = 0 ; i < triggerObjects.size() ; i++){
-		float dR = sqrt(pow(triggerObjects[i].eta()-p.eta(),2)+ pow(acos(cos(triggerObjects[i].phi()-p.phi())),2)) ;
-		if (dR<deltaRmax) {
-			deltaR = dR;
-			index  = i;
-			return true;
-		}
-	}
-	return false;
+	float dR = -1.f;
+	index = triggerObjects.nearest(p.eta(), p.phi(), deltaRmax, &dR);
+	if (index < 0) return false;
+	deltaR = dR;
+	return true;
 }
 
 #include "FWCore/Framework/interface/MakerMacros.h"
@@ -12,6 +12,7 @@
 #include "FWCore/Utilities/interface/Exception.h"
 #include "CommonTools/UtilAlgos/interface/TFileService.h"
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
 #include "DataFormats/Common/interface/View.h"
 #include "DataFormats/Candidate/interface/Candidate.h"
 #include "DataFormats/EgammaCandidates/interface/GsfElectron.h"
@@ -54,55 +55,30 @@
 #include "SimDataFormats/PileupSummaryInfo/interface/PileupSummaryInfo.h"
 
 #include "DataFormats/Common/interface/ValueMap.h"
-#include "RecoEgamma/EgammaTools/interface/EffectiveAreas.h"
-struct sortPt
-{
-   bool operator()(TLorentzVector* s1, TLorentzVector* s2) const
-   {
-      return s1->Pt() >= s2->Pt();
-   }
-} mysortPt;
+#include "VAJets/PKUTreeMaker/interface/JetKernels.h"
+#include "VAJets/PKUTreeMaker/interface/TreeOutputPolicy.h"
+#include "VAJets/PKUTreeMaker/plugins/PKUTreeMakerCore.h"
+#include <sstream>
 //
 // class declaration
 //
 
-class PKUTreeMaker : public edm::EDAnalyzer {
+class PKUTreeMaker : public pku::TreeMakerCore<pku::WChannel> {
 public:
   explicit PKUTreeMaker(const edm::ParameterSet&);
   ~PKUTreeMaker();
   //static void fillDescriptions(edm::ConfigurationDescriptions & descriptions);
-    
-    enum PhotonMatchType {UNMATCHED = 0,
-        MATCHED_FROM_GUDSCB,
-        MATCHED_FROM_PI0,
-        MATCHED_FROM_OTHER_SOURCES};
   
 private:
   virtual void beginJob() override;
   virtual void analyze(const edm::Event&, const edm::EventSetup&) override;
   virtual void endJob() override;
-  virtual void beginRun(const edm::Run&, const edm::EventSetup&) override;
+  void fillTree() {
+    timer_.enter(stages_.fill);
+    outputPolicy_.fill(outTree_);
+    timer_.stop();
+  }
   virtual void endRun(const edm::Run&, const edm::EventSetup&) override;
-  virtual void addTypeICorr( edm::Event const & event );
-  virtual double getJEC( reco::Candidate::LorentzVector& rawJetP4, const pat::Jet& jet, double& jetCorrEtaMax, std::vector<std::string> jecPayloadNames_ );
-  virtual double getJECOffset( reco::Candidate::LorentzVector& rawJetP4, const pat::Jet& jet, double& jetCorrEtaMax, std::vector<std::string> jecPayloadNames_ );
-  math::XYZTLorentzVector getNeutrinoP4(double& MetPt, double& MetPhi, TLorentzVector& lep, int lepType);
-  bool hasMatchedPromptElectron(const reco::SuperClusterRef &sc, const edm::Handle<edm::View<pat::Electron> > &eleCol,
-                                  const edm::Handle<reco::ConversionCollection> &convCol, const math::XYZPoint &beamspot,
-                                  float lxyMin=2.0, float probMin=1e-6, unsigned int nHitsBeforeVtxMax=0);
-  int matchToTruth(const reco::Photon &pho,
-                     const edm::Handle<edm::View<reco::GenParticle>>  &genParticles, bool &ISRPho, double &dR, int &isprompt);
-    
-  void findFirstNonPhotonMother(const reco::Candidate *particle,
-                                  int &ancestorPID, int &ancestorStatus);
-  float EAch(float x); 
-  float EAnh(float x);
-  float EApho(float x);
-  std::vector<std::string> offsetCorrLabel_;
-  FactorizedJetCorrector* jecOffset_;
-  std::vector<std::string> jetCorrLabel_;
-  edm::Handle< double >  rho_;
-  edm::EDGetTokenT<double> rhoToken_;
   edm::EDGetTokenT<pat::METCollection>  metInputToken_;
   std::vector<edm::EDGetTokenT<pat::METCollection>> mettokens;
   edm::EDGetTokenT<pat::METCollection> metToken_;
@@ -113,32 +89,17 @@ private:
   edm::EDGetTokenT<edm::View<pat::Electron> > looseelectronToken_ ; 
   edm::EDGetTokenT<edm::View<pat::Muon> > loosemuonToken_; 
 
-// Filter
-  edm::EDGetTokenT<edm::TriggerResults> 		     noiseFilterToken_;
-  edm::Handle< edm::TriggerResults> 			     noiseFilterBits_;
-  std::string HBHENoiseFilter_Selector_;
-  std::string HBHENoiseIsoFilter_Selector_;
-  std::string ECALDeadCellNoiseFilter_Selector_;
-  std::string GoodVtxNoiseFilter_Selector_;
-  std::string EEBadScNoiseFilter_Selector_;
-  std::string globalTightHaloFilter_Selector_;
-  edm::EDGetTokenT<bool>  badMuon_Selector_;
-  edm::EDGetTokenT<bool>  badChargedHadron_Selector_;
-
   edm::EDGetTokenT<edm::ValueMap<float> > full5x5SigmaIEtaIEtaMapToken_;
   edm::EDGetTokenT<edm::ValueMap<float> > phoChargedIsolationToken_;
   edm::EDGetTokenT<edm::ValueMap<float> > phoNeutralHadronIsolationToken_;
   edm::EDGetTokenT<edm::ValueMap<float> > phoPhotonIsolationToken_;
-  EffectiveAreas effAreaChHadrons_;
-  EffectiveAreas effAreaNeuHadrons_;
-  EffectiveAreas effAreaPhotons_;
 
   // ----------member data ---------------------------
   TTree* outTree_;
+  pku::TreeOutputPolicy outputPolicy_;
 
   double MW_;
   int nevent, run, ls;
-  int nVtx;
   double triggerWeight, lumiWeight, pileupWeight;
   double theWeight;
   double  nump=0.;
@@ -147,8 +108,6 @@ private:
   int     nBX;
   double ptVlep, yVlep, phiVlep, massVlep, mtVlep, mtVlepnew;
   double ptVlepJEC, yVlepJEC, phiVlepJEC, massVlepJEC, mtVlepJEC, mtVlepJECnew;
-  double Mla, Mva;
-  double Mla_f, Mva_f;
   double ptlep1, etalep1, philep1;
   int  lep, nlooseeles,nloosemus;
   double met, metPhi, j1metPhi, j2metPhi;
@@ -170,13 +129,6 @@ private:
   bool   photon_pev[6],photon_pevnew[6],photon_ppsv[6],photon_iseb[6],photon_isee[6];
   double photon_hoe[6],photon_sieie[6],photon_sieie2[6], photon_chiso[6],photon_nhiso[6],photon_phoiso[6],photon_drla[6],photon_mla[6],photon_mva[6];
   int      photon_istrue[6], photon_isprompt[6];
-  double photonet, photoneta, photonphi, photone;
-  double photonet_f, photoneta_f, photonphi_f, photone_f;
-  double photonsieie, photonphoiso, photonchiso, photonnhiso;
-  double photonsieie_f, photonphoiso_f, photonchiso_f, photonnhiso_f;
-  int iphoton;
-  int iphoton_f;
-  double drla, drla_f;
   bool passEleVeto, passEleVetonew, passPixelSeedVeto;
   //Photon gen match
   int   isTrue_;
@@ -201,21 +153,12 @@ private:
   double targetLumiInvPb_;
   std::string PKUChannel_;
   bool isGen_ , RunOnMC_;
-  std::vector<std::string> jecAK4Labels_;
-  std::vector<std::string> jecAK4chsLabels_;
+  pku::JecRegistry jecAK4Jets_;
   //correction jet
-  FactorizedJetCorrector* jecAK4_;
   std::string gravitonSrc_;
-  std::map<std::string,double>  TypeICorrMap_;
   edm::InputTag mets_;
 
   //High Level Trigger
-  HLTConfigProvider hltConfig;
-  edm::EDGetTokenT<edm::TriggerResults> hltToken_;
-  std::vector<std::string> elPaths1_, elPaths2_;
-  std::vector<std::string> muPaths1_, muPaths2_, muPaths3_;
-  std::vector<std::string> elPaths1, elPaths2;
-  std::vector<std::string> muPaths1, muPaths2, muPaths3;
   int  HLT_Ele1, HLT_Ele2;
   int  HLT_Mu1, HLT_Mu2, HLT_Mu3;
 
@@ -229,86 +172,32 @@ private:
   bool passFilter_badMuon_                ;
   bool passFilter_badChargedHadron_       ;
 
-  edm::EDGetTokenT<GenEventInfoProduct> GenToken_;
-  edm::EDGetTokenT<std::vector<PileupSummaryInfo>> PUToken_;
   edm::EDGetTokenT<edm::View<reco::Candidate>> leptonicVSrc_;
   edm::EDGetTokenT<edm::View<pat::Jet>> ak4jetsSrc_;
   edm::EDGetTokenT<edm::View<pat::Photon>> photonSrc_;
   edm::EDGetTokenT<edm::View<reco::GenParticle>> genSrc_;
   edm::EDGetTokenT<edm::View<reco::Candidate>> metSrc_;
-  edm::EDGetTokenT<reco::VertexCollection> VertexToken_;
-  edm::EDGetTokenT<pat::JetCollection> t1jetSrc_;
-  edm::EDGetTokenT<edm::View<pat::Muon>> t1muSrc_;
 };
 
-float PKUTreeMaker::EAch( float x){
- float EA = 0.0360;
- if(x>1.0)   EA = 0.0377;
- if(x>1.479) EA = 0.0306;
- if(x>2.0)   EA = 0.0283;
- if(x>2.2)   EA = 0.0254;
- if(x>2.3)   EA = 0.0217;
- if(x>2.4)   EA = 0.0167;
- return EA;
-}
-
-float PKUTreeMaker::EAnh( float x){
- float EA = 0.0597;
- if(x>1.0)   EA = 0.0807;
- if(x>1.479) EA = 0.0629;
- if(x>2.0)   EA = 0.0197;
- if(x>2.2)   EA = 0.0184;
- if(x>2.3)   EA = 0.0284;
- if(x>2.4)   EA = 0.0591;
- return EA;
-}
-
-float PKUTreeMaker::EApho( float x){
- float EA = 0.1210;
- if(x>1.0)   EA = 0.1107;
- if(x>1.479) EA = 0.0699;
- if(x>2.0)   EA = 0.1056;
- if(x>2.2)   EA = 0.1457;
- if(x>2.3)   EA = 0.1719;
- if(x>2.4)   EA = 0.1998;
- return EA;
-}
-
-
 //
 // constructors and destructor
 //
 PKUTreeMaker::PKUTreeMaker(const edm::ParameterSet& iConfig)//:
-  :effAreaChHadrons_((iConfig.getParameter<edm::FileInPath>("effAreaChHadFile")).fullPath() )
-  ,effAreaNeuHadrons_((iConfig.getParameter<edm::FileInPath>("effAreaNeuHadFile")).fullPath() )
-  ,effAreaPhotons_((iConfig.getParameter<edm::FileInPath>("effAreaPhoFile")).fullPath() )
+  :pku::TreeMakerCore<pku::WChannel>(iConfig)
+  ,jecAK4Jets_(iConfig, "jecAK4PayloadNames")
 {
-  hltToken_=consumes<edm::TriggerResults>(iConfig.getParameter<edm::InputTag>("hltToken"));
-  elPaths1_=iConfig.getParameter<std::vector<std::string>>("elPaths1");
-  elPaths2_=iConfig.getParameter<std::vector<std::string>>("elPaths2");
-  muPaths1_=iConfig.getParameter<std::vector<std::string>>("muPaths1");
-  muPaths2_=iConfig.getParameter<std::vector<std::string>>("muPaths2");
-  muPaths3_=iConfig.getParameter<std::vector<std::string>>("muPaths3");
-  GenToken_=consumes<GenEventInfoProduct> (iConfig.getParameter<edm::InputTag>( "generator") ) ;
 //  LheToken_=consumes<LHEEventProduct> (iConfig.getParameter<edm::InputTag>( "lhe") ) ;
-  PUToken_=consumes<std::vector<PileupSummaryInfo>>(iConfig.getParameter<edm::InputTag>("pileup") ) ;
   leptonicVSrc_=consumes<edm::View<reco::Candidate> >(iConfig.getParameter<edm::InputTag>( "leptonicVSrc") ) ;
   ak4jetsSrc_      = consumes<edm::View<pat::Jet>>(iConfig.getParameter<edm::InputTag>( "ak4jetsSrc") ) ;
   photonSrc_      = consumes<edm::View<pat::Photon>>(iConfig.getParameter<edm::InputTag>( "photonSrc") ) ;
   genSrc_      = consumes<edm::View<reco::GenParticle>>(iConfig.getParameter<edm::InputTag>( "genSrc") ) ;
   metSrc_      = consumes<edm::View<reco::Candidate>>(iConfig.getParameter<edm::InputTag>( "metSrc") ) ;
-  VertexToken_ =consumes<reco::VertexCollection> (iConfig.getParameter<edm::InputTag>( "vertex" ) ) ;
-  t1jetSrc_      = consumes<pat::JetCollection>(iConfig.getParameter<edm::InputTag>( "t1jetSrc") ) ;
-  t1muSrc_      = consumes<edm::View<pat::Muon>>(iConfig.getParameter<edm::InputTag>( "t1muSrc") ) ;
   originalNEvents_ = iConfig.getParameter<int>("originalNEvents");
   crossSectionPb_  = iConfig.getParameter<double>("crossSectionPb");
   targetLumiInvPb_ = iConfig.getParameter<double>("targetLumiInvPb");
   PKUChannel_     = iConfig.getParameter<std::string>("PKUChannel");
   isGen_           = iConfig.getParameter<bool>("isGen");
   RunOnMC_           = iConfig.getParameter<bool>("RunOnMC");
-  rhoToken_  = consumes<double>(iConfig.getParameter<edm::InputTag>("rho"));
-  jecAK4chsLabels_   =  iConfig.getParameter<std::vector<std::string>>("jecAK4chsPayloadNames");
-  jecAK4Labels_   =  iConfig.getParameter<std::vector<std::string>>("jecAK4PayloadNames");
   metToken_ = consumes<pat::METCollection>(iConfig.getParameter<edm::InputTag>("metSrc"));
   mettokens.push_back( metToken_ );
   metInputToken_ = mettokens[0];
@@ -318,20 +207,6 @@ PKUTreeMaker::PKUTreeMaker(const edm::ParameterSet& iConfig)//:
   beamSpotToken_    = (consumes<reco::BeamSpot>(iConfig.getParameter<edm::InputTag>("beamSpot"))) ;
   conversionsToken_ = (consumes<std::vector<reco::Conversion> >(iConfig.getParameter<edm::InputTag>("conversions"))) ;
     
-  jetCorrLabel_ = jecAK4chsLabels_;
-  offsetCorrLabel_.push_back(jetCorrLabel_[0]);
-
-// filter
-   noiseFilterToken_ = consumes<edm::TriggerResults>(iConfig.getParameter<edm::InputTag>("noiseFilter"));
-   HBHENoiseFilter_Selector_ =  iConfig.getParameter<std::string> ("noiseFilterSelection_HBHENoiseFilter");
-   HBHENoiseIsoFilter_Selector_ =  iConfig.getParameter<std::string> ("noiseFilterSelection_HBHENoiseIsoFilter");  
-   globalTightHaloFilter_Selector_ = iConfig.getParameter<std::string> ("noiseFilterSelection_globalTightHaloFilter"); 
-   ECALDeadCellNoiseFilter_Selector_ =  iConfig.getParameter<std::string> ("noiseFilterSelection_EcalDeadCellTriggerPrimitiveFilter");
-   GoodVtxNoiseFilter_Selector_ =  iConfig.getParameter<std::string> ("noiseFilterSelection_goodVertices");
-   EEBadScNoiseFilter_Selector_ =  iConfig.getParameter<std::string> ("noiseFilterSelection_eeBadScFilter");
-   badMuon_Selector_ =  consumes<bool>(iConfig.getParameter<edm::InputTag> ("noiseFilterSelection_badMuon"));
-   badChargedHadron_Selector_ =  consumes<bool>(iConfig.getParameter<edm::InputTag> ("noiseFilterSelection_badChargedHadron"));
-
    full5x5SigmaIEtaIEtaMapToken_=(consumes <edm::ValueMap<float> >
 				(iConfig.getParameter<edm::InputTag>("full5x5SigmaIEtaIEtaMap")));
    phoChargedIsolationToken_=(consumes <edm::ValueMap<float> >
@@ -344,8 +219,10 @@ PKUTreeMaker::PKUTreeMaker(const edm::ParameterSet& iConfig)//:
    MW_=80.385; 
   //now do what ever initialization is needed
   edm::Service<TFileService> fs;
-  outTree_ = fs->make<TTree>("PKUCandidates","PKU Candidates");
+  outTree_ = fs->make<TTree>(pku::WChannel::treeName(), pku::WChannel::treeTitle());
   /// Basic event quantities
+  outTree_->Branch("run"             ,&run            ,"run/I"            );
+  outTree_->Branch("ls"              ,&ls             ,"ls/I"             );
   outTree_->Branch("event"           ,&nevent         ,"event/I"          );
   outTree_->Branch("nVtx"            ,&nVtx           ,"nVtx/I"           );
   outTree_->Branch("theWeight"           ,&theWeight         ,"theWeight/D"          );
@@ -359,10 +236,6 @@ PKUTreeMaker::PKUTreeMaker(const edm::ParameterSet& iConfig)//:
   outTree_->Branch("phiVlepJEC"         ,&phiVlepJEC        ,"phiVlepJEC/D"        );
   outTree_->Branch("massVlepJEC"        ,&massVlepJEC       ,"massVlepJEC/D"       );
   outTree_->Branch("mtVlepJECnew"          ,&mtVlepJECnew         ,"mtVlepJECnew/D"         );
-  outTree_->Branch("Mla"          ,&Mla         ,"Mla/D"         );
-  outTree_->Branch("Mla_f"          ,&Mla_f         ,"Mla_f/D"         );
-  outTree_->Branch("Mva"          ,&Mva         ,"Mva/D"         );
-  outTree_->Branch("Mva_f"          ,&Mva_f         ,"Mva_f/D"         );
   outTree_->Branch("nlooseeles"          ,&nlooseeles         ,"nlooseeles/I"         );
   outTree_->Branch("nloosemus"          ,&nloosemus         ,"nloosemus/I"         );
   outTree_->Branch("genphoton_pt"        , genphoton_pt       ,"genphoton_pt[6]/D"       );
@@ -395,29 +268,26 @@ PKUTreeMaker::PKUTreeMaker(const edm::ParameterSet& iConfig)//:
   outTree_->Branch("photon_drla"        , photon_drla       ,"photon_drla[6]/D"       );
   outTree_->Branch("photon_mla"        , photon_mla       ,"photon_mla[6]/D"       );
   outTree_->Branch("photon_mva"        , photon_mva       ,"photon_mva[6]/D"       );
+  // one block per photon selection, "" (medium) and "_f" (fake template) first
+  for (size_t s = 0; s < photonBlocks_.size(); s++) {
+    pku::SelectedPhoton& block = photonBlocks_[s];
+    const std::string& sfx = photonSelections_[s].suffix;
+    outTree_->Branch(("photonet" + sfx).c_str()     ,&block.et      ,("photonet" + sfx + "/D").c_str()     );
+    outTree_->Branch(("photoneta" + sfx).c_str()    ,&block.eta     ,("photoneta" + sfx + "/D").c_str()    );
+    outTree_->Branch(("photonphi" + sfx).c_str()    ,&block.phi     ,("photonphi" + sfx + "/D").c_str()    );
+    outTree_->Branch(("photone" + sfx).c_str()      ,&block.e       ,("photone" + sfx + "/D").c_str()      );
+    outTree_->Branch(("photonsieie" + sfx).c_str()  ,&block.sieie   ,("photonsieie" + sfx + "/D").c_str()  );
+    outTree_->Branch(("photonphoiso" + sfx).c_str() ,&block.phoiso  ,("photonphoiso" + sfx + "/D").c_str() );
+    outTree_->Branch(("photonchiso" + sfx).c_str()  ,&block.chiso   ,("photonchiso" + sfx + "/D").c_str()  );
+    outTree_->Branch(("photonnhiso" + sfx).c_str()  ,&block.nhiso   ,("photonnhiso" + sfx + "/D").c_str()  );
+    outTree_->Branch(("iphoton" + sfx).c_str()      ,&block.index   ,("iphoton" + sfx + "/I").c_str()      );
+    outTree_->Branch(("drla" + sfx).c_str()         ,&block.drla    ,("drla" + sfx + "/D").c_str()         );
+    outTree_->Branch(("Mla" + sfx).c_str()          ,&block.Mla     ,("Mla" + sfx + "/D").c_str()          );
+    outTree_->Branch(("Mva" + sfx).c_str()          ,&block.Mva     ,("Mva" + sfx + "/D").c_str()          );
+  }
   outTree_->Branch("passEleVeto"        , &passEleVeto       ,"passEleVeto/O"       );
   outTree_->Branch("passEleVetonew"        , &passEleVetonew       ,"passEleVetonew/O"       );
   outTree_->Branch("passPixelSeedVeto"        , &passPixelSeedVeto       ,"passPixelSeedVeto/O"       );
-  outTree_->Branch("photonet"          ,&photonet         ,"photonet/D"         );
-  outTree_->Branch("photonet_f"          ,&photonet_f         ,"photonet_f/D"         );
-  outTree_->Branch("photoneta"          ,&photoneta         ,"photoneta/D"         );
-  outTree_->Branch("photoneta_f"          ,&photoneta_f         ,"photoneta_f/D"         );
-  outTree_->Branch("photonphi"          ,&photonphi         ,"photonphi/D"         );
-  outTree_->Branch("photonphi_f"          ,&photonphi_f         ,"photonphi_f/D"         );
-  outTree_->Branch("photone"          ,&photone         ,"photone/D"         );
-  outTree_->Branch("photone_f"          ,&photone_f         ,"photone_f/D"         );
-  outTree_->Branch("photonsieie"          ,&photonsieie         ,"photonsieie/D"         );
-  outTree_->Branch("photonsieie_f"          ,&photonsieie_f         ,"photonsieie_f/D"         );
-  outTree_->Branch("photonphoiso"          ,&photonphoiso         ,"photonphoiso/D"         );
-  outTree_->Branch("photonphoiso_f"          ,&photonphoiso_f         ,"photonphoiso_f/D"         );
-  outTree_->Branch("photonchiso"          ,&photonchiso         ,"photonchiso/D"         );
-  outTree_->Branch("photonchiso_f"          ,&photonchiso_f         ,"photonchiso_f/D"         );
-  outTree_->Branch("photonnhiso"          ,&photonnhiso         ,"photonnhiso/D"         );
-  outTree_->Branch("photonnhiso_f"          ,&photonnhiso_f         ,"photonnhiso_f/D"         );
-  outTree_->Branch("iphoton"             ,&iphoton            ,"iphoton/I"            );
-  outTree_->Branch("iphoton_f"             ,&iphoton_f            ,"iphoton_f/I"            );
-  outTree_->Branch("drla"          ,&drla         ,"drla/D"         );
-  outTree_->Branch("drla_f"          ,&drla_f         ,"drla_f/D"         );
     //photon gen match
 //    outTree_->Branch("dR"    , &dR_, "dR/D");
 //    outTree_->Branch("ISRPho"        , &ISRPho       ,"ISRPho/O"       );
@@ -504,294 +374,12 @@ PKUTreeMaker::PKUTreeMaker(const edm::ParameterSet& iConfig)//:
 //  outTree_->Branch("triggerWeight"   ,&triggerWeight  ,"triggerWeight/D"  );
   outTree_->Branch("lumiWeight"      ,&lumiWeight     ,"lumiWeight/D"     );
   outTree_->Branch("pileupWeight"    ,&pileupWeight   ,"pileupWeight/D"   );
-}
-
-//------------------------------------
-double PKUTreeMaker::getJEC( reco::Candidate::LorentzVector& rawJetP4, const pat::Jet& jet, double& jetCorrEtaMax, std::vector<std::string> jecPayloadNames_ ){
-    double jetCorrFactor = 1.;
-    if ( fabs(rawJetP4.eta()) < jetCorrEtaMax ){
-        jecAK4_->setJetEta( rawJetP4.eta() );
-        jecAK4_->setJetPt ( rawJetP4.pt() );
-        jecAK4_->setJetE  ( rawJetP4.energy() );
-        jecAK4_->setJetPhi( rawJetP4.phi()    );
-        jecAK4_->setJetA  ( jet.jetArea() );
-        jecAK4_->setRho   ( *(rho_.product()) );
-        jecAK4_->setNPV   ( nVtx );
-        jetCorrFactor = jecAK4_->getCorrection();
-    }
-    reco::Candidate::LorentzVector corrJetP4 = rawJetP4;
-    corrJetP4 *= jetCorrFactor;
-    return jetCorrFactor;
-}
-//------------------------------------
-double PKUTreeMaker::getJECOffset( reco::Candidate::LorentzVector& rawJetP4, const pat::Jet& jet, double& jetCorrEtaMax, std::vector<std::string> jecPayloadNames_ ){
-    double jetCorrFactor = 1.;
-    if ( fabs(rawJetP4.eta()) < jetCorrEtaMax ){
-        jecOffset_->setJetEta( rawJetP4.eta()     );
-        jecOffset_->setJetPt ( rawJetP4.pt()      );
-        jecOffset_->setJetE  ( rawJetP4.energy()  );
-        jecOffset_->setJetPhi( rawJetP4.phi()     );
-        jecOffset_->setJetA  ( jet.jetArea()      );
-        jecOffset_->setRho   ( *(rho_.product())  );
-        jecOffset_->setNPV   ( nVtx  );
-        jetCorrFactor = jecOffset_->getCorrection();
-    }
-    reco::Candidate::LorentzVector corrJetP4 = rawJetP4;
-    corrJetP4 *= jetCorrFactor;
-    return jetCorrFactor;
-}
-//------------------------------------
-void PKUTreeMaker::addTypeICorr( edm::Event const & event ){
-    TypeICorrMap_.clear();
-    edm::Handle<pat::JetCollection> jets_;
-    event.getByToken(t1jetSrc_, jets_);
-    event.getByToken(rhoToken_      , rho_     );
-    edm::Handle<reco::VertexCollection> vertices_;
-    event.getByToken(VertexToken_, vertices_);
-    edm::Handle<edm::View<pat::Muon>> muons_;
-    event.getByToken(t1muSrc_,muons_);
-    bool skipEM_                    = true;
-    double skipEMfractionThreshold_ = 0.9;
-    bool skipMuons_                 = true;
-    std::string skipMuonSelection_string = "isGlobalMuon | isStandAloneMuon";
-    StringCutObjectSelector<reco::Candidate>* skipMuonSelection_ = new StringCutObjectSelector<reco::Candidate>(skipMuonSelection_string,true);
-    double jetCorrEtaMax_           = 9.9;
-    double type1JetPtThreshold_     = 10.0;
-    double corrEx    = 0;
-    double corrEy    = 0;
-    double corrSumEt = 0;
-
-    std::vector<JetCorrectorParameters> vPar;
-    for ( std::vector<std::string>::const_iterator payloadBegin = jecAK4chsLabels_.begin(), payloadEnd = jecAK4chsLabels_.end(), ipayload = payloadBegin; ipayload != payloadEnd; ++ipayload ) {
-        JetCorrectorParameters pars(*ipayload);
-        vPar.push_back(pars);
-    }
-    jecAK4_ = new FactorizedJetCorrector(vPar);
-    vPar.clear();
-    for ( std::vector<std::string>::const_iterator payloadBegin = offsetCorrLabel_.begin(), payloadEnd = offsetCorrLabel_.end(), ipayload = payloadBegin; ipayload != payloadEnd; ++ipayload ) {
-        JetCorrectorParameters pars(*ipayload);
-        vPar.push_back(pars);
-    }
-    jecOffset_ = new FactorizedJetCorrector(vPar);
-    vPar.clear();
 
-    for (const pat::Jet &jet : *jets_) {
-        double emEnergyFraction = jet.chargedEmEnergyFraction() + jet.neutralEmEnergyFraction();
-        if ( skipEM_ && emEnergyFraction > skipEMfractionThreshold_ ) continue;
-        reco::Candidate::LorentzVector rawJetP4 = jet.correctedP4(0);
-        double corr = getJEC(rawJetP4, jet, jetCorrEtaMax_, jetCorrLabel_);   
-/*
-        if ( skipMuons_ && jet.muonMultiplicity() != 0 ) {
-            for (const pat::Muon &muon : *muons_) {
-                if( !muon.isGlobalMuon() && !muon.isStandAloneMuon() ) continue;
-                TLorentzVector muonV; muonV.SetPtEtaPhiE(muon.p4().pt(),muon.p4().eta(),muon.p4().phi(),muon.p4().e());
-                TLorentzVector jetV; jetV.SetPtEtaPhiE(jet.p4().pt(),jet.p4().eta(),jet.p4().phi(),jet.p4().e());
-                if( muonV.DeltaR(jetV) < 0.5 ){
-                    reco::Candidate::LorentzVector muonP4 = muon.p4();
-                    rawJetP4 -= muonP4;
-                }
-            }
-        }
-*/
-     if ( skipMuons_ ) {
-       const std::vector<reco::CandidatePtr> & cands = jet.daughterPtrVector();
-       for ( std::vector<reco::CandidatePtr>::const_iterator cand = cands.begin();
-             cand != cands.end(); ++cand ) {
-     	 const reco::PFCandidate *pfcand = dynamic_cast<const reco::PFCandidate *>(cand->get());
-     	 const reco::Candidate *mu = (pfcand != 0 ? ( pfcand->muonRef().isNonnull() ? pfcand->muonRef().get() : 0) : cand->get());
-         if ( mu != 0 && (*skipMuonSelection_)(*mu) ) {
-           reco::Candidate::LorentzVector muonP4 = (*cand)->p4();
-           rawJetP4 -= muonP4;
-         }
-       }
-     }
-        reco::Candidate::LorentzVector corrJetP4 = corr*rawJetP4;
-        if ( corrJetP4.pt() > type1JetPtThreshold_ ) {
-            reco::Candidate::LorentzVector tmpP4 = jet.correctedP4(0);
-            corr = getJECOffset(tmpP4, jet, jetCorrEtaMax_, offsetCorrLabel_);
-            reco::Candidate::LorentzVector rawJetP4offsetCorr = corr*rawJetP4;
-            corrEx    -= (corrJetP4.px() - rawJetP4offsetCorr.px());
-            corrEy    -= (corrJetP4.py() - rawJetP4offsetCorr.py());
-            corrSumEt += (corrJetP4.Et() - rawJetP4offsetCorr.Et());
-        }
-    }
-    TypeICorrMap_["corrEx"]    = corrEx;
-    TypeICorrMap_["corrEy"]    = corrEy;
-    TypeICorrMap_["corrSumEt"] = corrSumEt;
-	delete jecAK4_;
-	jecAK4_=0;
-	delete jecOffset_;
-	jecOffset_=0;
-	delete skipMuonSelection_;
-	skipMuonSelection_=0;
+  if (iConfig.existsAs<edm::ParameterSet>("outputPolicy")) outputPolicy_ = pku::TreeOutputPolicy(iConfig.getParameter<edm::ParameterSet>("outputPolicy"));
+  outputPolicy_.apply(outTree_);
+  checkpointTree_ = outTree_;
 }
-//------------------------------------
-math::XYZTLorentzVector
-PKUTreeMaker::getNeutrinoP4(double& MetPt, double& MetPhi, TLorentzVector& lep, int lepType){
-    double leppt = lep.Pt();
-    double lepphi = lep.Phi();
-    double lepeta = lep.Eta();
-    double lepenergy = lep.Energy();
-    
-    double metpt = MetPt;
-    double metphi = MetPhi;
-    
-    double  px = metpt*cos(metphi);
-    double  py = metpt*sin(metphi);
-    double  pz = 0;
-    double  pxl= leppt*cos(lepphi);
-    double  pyl= leppt*sin(lepphi);
-    double  pzl= leppt*sinh(lepeta);
-    double  El = lepenergy;
-    double  a = pow(MW_,2) + pow(px+pxl,2) + pow(py+pyl,2) - px*px - py*py - El*El + pzl*pzl;
-    double  b = 2.*pzl;
-    double  A = b*b -4.*El*El;
-    double  B = 2.*a*b;
-    double  C = a*a-4.*(px*px+py*py)*El*El;
-    ///////////////////////////pz for fnal
-    double M_mu =  0;
-    //if(lepType==1)M_mu=0.105658367;//mu
-    //if(lepType==0)M_mu=0.00051099891;//electron
-    int type=2; // use the small abs real root
-    a = MW_*MW_ - M_mu*M_mu + 2.0*pxl*px + 2.0*pyl*py;
-    A = 4.0*(El*El - pzl*pzl);
-    B = -4.0*a*pzl;
-    C = 4.0*El*El*(px*px + py*py) - a*a;
-    double tmproot = B*B - 4.0*A*C;
-    if (tmproot<0) {
-        //std::cout << "Complex root detected, taking real part..." << std::endl;
-        pz = - B/(2*A); // take real part of complex roots
-    }
-    else {
-        double tmpsol1 = (-B + sqrt(tmproot))/(2.0*A);
-        double tmpsol2 = (-B - sqrt(tmproot))/(2.0*A);
-        //std::cout << " Neutrino Solutions: " << tmpsol1 << ", " << tmpsol2 << std::endl;
-        if (type == 0 ) {
-            // two real roots, pick the one closest to pz of muon
-            if (TMath::Abs(tmpsol2-pzl) < TMath::Abs(tmpsol1-pzl)) { pz = tmpsol2; }
-            else { pz = tmpsol1; }
-            // if pz is > 300 pick the most central root
-            if ( abs(pz) > 300. ) {
-                if (TMath::Abs(tmpsol1)<TMath::Abs(tmpsol2) ) { pz = tmpsol1; }
-                else { pz = tmpsol2; }
-            }
-        }
-        if (type == 1 ) {
-            // two real roots, pick the one closest to pz of muon
-            if (TMath::Abs(tmpsol2-pzl) < TMath::Abs(tmpsol1-pzl)) { pz = tmpsol2; }
-            else {pz = tmpsol1; }
-        }
-        if (type == 2 ) {
-            // pick the most central root.
-            if (TMath::Abs(tmpsol1)<TMath::Abs(tmpsol2) ) { pz = tmpsol1; }
-            else { pz = tmpsol2; }
-        }
-        /*if (type == 3 ) {
-         // pick the largest value of the cosine
-         TVector3 p3w, p3mu;
-         p3w.SetXYZ(pxl+px, pyl+py, pzl+ tmpsol1);
-         p3mu.SetXYZ(pxl, pyl, pzl );
-         double sinthcm1 = 2.*(p3mu.Perp(p3w))/MW_;
-         p3w.SetXYZ(pxl+px, pyl+py, pzl+ tmpsol2);
-         double sinthcm2 = 2.*(p3mu.Perp(p3w))/MW_;
-         double costhcm1 = sqrt(1. - sinthcm1*sinthcm1);
-         double costhcm2 = sqrt(1. - sinthcm2*sinthcm2);
-         if ( costhcm1 > costhcm2 ) { pz = tmpsol1; otherSol_ = tmpsol2; }
-         else { pz = tmpsol2;otherSol_ = tmpsol1; }
-         }*///end of type3
-    }//endl of if real root
-    //dont correct pt neutrino
-    math::XYZTLorentzVector outP4(px,py,pz,sqrt(px*px+py*py+pz*pz));
-    return outP4;
-}//end neutrinoP4
 
-//------------------------------------
-bool PKUTreeMaker::hasMatchedPromptElectron(const reco::SuperClusterRef &sc, const edm::Handle<edm::View<pat::Electron> > &eleCol, const edm::Handle<reco::ConversionCollection> &convCol, const math::XYZPoint &beamspot,  float lxyMin, float probMin, unsigned int nHitsBeforeVtxMax) {
-    //check if a given SuperCluster matches to at least one GsfElectron having zero expected inner hits
-    //and not matching any conversion in the collection passing the quality cuts
-    if (sc.isNull()) return false;
-    for (edm::View<pat::Electron>::const_iterator it = eleCol->begin(); it!=eleCol->end(); ++it) {
-        //match electron to supercluster
-        if (it->superCluster()!=sc) continue;
-        //check expected inner hits
-        if (it->gsfTrack()->hitPattern().numberOfHits(reco::HitPattern::MISSING_INNER_HITS) > 0) continue;
-        //check if electron is matching to a conversion
-        if (ConversionTools::hasMatchedConversion(*it,convCol,beamspot)) continue;
-        return true;
-    }
-    return false;
-}
-//------------------------------------
-int PKUTreeMaker::matchToTruth(const reco::Photon &pho,
-                                      const edm::Handle<edm::View<reco::GenParticle>>
-                                      &genParticles, bool &ISRPho, double &dR, int &isprompt)
-{
-    //
-    // Explicit loop and geometric matching method
-    //
-    // Find the closest status 1 gen photon to the reco photon
-    dR = 999;
-    const reco::Candidate *closestPhoton = 0;
-  //std::cout<<"genParticles->size() = "<<genParticles->size()<<std::endl;
-    int im=0;
-    for(size_t i=0; i<genParticles->size();i++){
-        const reco::Candidate *particle = &(*genParticles)[i];
-        if( abs(particle->pdgId()) != 22 || particle->status() != 1 )
-        continue;
-        double dRtmp = deltaR(pho.eta(),pho.phi(),particle->eta(),particle->phi());  
-        if( dRtmp < dR ){
-            dR = dRtmp;
-            im=i;    
-            closestPhoton = particle;
-         }
-  }
-    // See if the closest photon (if it exists) is close enough.
-    // If not, no match found.
-    if( !(closestPhoton != 0 && dR < 0.3) ) {
-        return UNMATCHED;
-       // ISRPho = false;
-    }
-     isprompt=(*genParticles)[im].isPromptFinalState();
-    // Find ID of the parent of the found generator level photon match
-    int ancestorPID = -999;
-    int ancestorStatus = -999;
-    findFirstNonPhotonMother(closestPhoton, ancestorPID, ancestorStatus);
-    // Allowed parens: quarks pdgId 1-5, or a gluon 21
-    std::vector<int> allowedParents { -1, 1, -2, 2, -3, 3, -4, 4, -5, 5, 21,-11,11,-13,13,-15,15,23,-24,24 };
-    if( !(std::find(allowedParents.begin(),
-                    allowedParents.end(), ancestorPID)
-          != allowedParents.end()) ){
-        // So it is not from g, u, d, s, c, b. Check if it is from pi0 or not.
-        if( abs(ancestorPID) == 111 )
-        return MATCHED_FROM_PI0;
-       // ISRPho =true;
-        else
-//      std::cout<<"Mother = "<<abs(ancestorPID)<<" "<<closestPhoton->mother(0)->pdgId()<<" "<<closestPhoton->mother(0)->status()<<std::endl;
-//      std::cout<<"Run="<<run<<" Event="<<nevent<<" lumi="<<ls<<std::endl;
-        return MATCHED_FROM_OTHER_SOURCES;
-      //  ISRPho =true;
-    }
-    return MATCHED_FROM_GUDSCB;  //Z, W ?
-     //   ISRPho =true;
-}
-//------------------------------------
-
-void PKUTreeMaker::findFirstNonPhotonMother(const reco::Candidate *particle,
-                                                   int &ancestorPID, int &ancestorStatus){
-    if( particle == 0 ){
-        printf("SimplePhotonNtupler: ERROR! null candidate pointer, this should never happen\n");
-        return;
-    }
-    // Is this the first non-photon parent? If yes, return, otherwise
-    // go deeper into recursion
-    if( abs(particle->pdgId()) == 22 ){
-        findFirstNonPhotonMother(particle->mother(0), ancestorPID, ancestorStatus);
-    }else{
-        ancestorPID = particle->pdgId();
-        ancestorStatus = particle->status();
-    }
-    return;
-}
 //------------------------------------
 //------------------------------------
 PKUTreeMaker::~PKUTreeMaker()
@@ -805,6 +393,11 @@ void
 PKUTreeMaker::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
 {
     using namespace edm;
+   countEvent(iEvent);
+   pku::StageTimer::Scope eventTimer(timer_, stages_.event);
+   timer_.count(stages_.nEvents);
+   summary_.event();
+   timer_.enter(stages_.weights);
    setDummyValues(); //Initalize variables with dummy values
    nevent = iEvent.eventAuxiliary().event();
    run    = iEvent.eventAuxiliary().run();
@@ -838,57 +431,21 @@ PKUTreeMaker::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
    if (RunOnMC_){
 
 //        std::cout<<lheEvtInfo->hepeup().NUP<<std::endl; 
-        edm::Handle<GenEventInfoProduct> genEvtInfo;
-        iEvent.getByToken(GenToken_,genEvtInfo);
-        theWeight = genEvtInfo->weight();
+        theWeight = genWeight_;   // read by countEvent()
         if(theWeight>0) nump = nump+1;
         if(theWeight<0) numm = numm+1;
-        edm::Handle<std::vector<PileupSummaryInfo>>  PupInfo;
-        iEvent.getByToken(PUToken_, PupInfo);
-        std::vector<PileupSummaryInfo>::const_iterator PVI;
-        for(PVI = PupInfo->begin(); PVI != PupInfo->end(); ++PVI) {
-          nBX = PVI->getBunchCrossing();
-          if(nBX == 0) { // "0" is the in-time crossing, negative values are the early crossings, positive are late
-          npT = PVI->getTrueNumInteractions();
-          npIT = PVI->getPU_NumInteractions();
-          }
-        } 
+        readPileup(iEvent, nBX, npT, npIT);
      } 
 
-   Handle<TriggerResults> trigRes;
-   iEvent.getByToken(hltToken_, trigRes);
-   int xtemp1=0;
-   for (size_t i=0; i<elPaths1.size();i++) {
-      xtemp1 = (int)trigRes->accept(hltConfig.triggerIndex(elPaths1[i]));
-      if(HLT_Ele1<xtemp1) HLT_Ele1=xtemp1;
-   }
-   int xtemp2=0;
-   for (size_t i=0; i<elPaths2.size();i++) {
-      xtemp2 = (int)trigRes->accept(hltConfig.triggerIndex(elPaths2[i]));
-      if(HLT_Ele2<xtemp2) HLT_Ele2=xtemp2;
-   }
-   int mtemp1=0;
-   for (size_t i=0; i<muPaths1.size();i++) {
-//std::cout<<muPaths1.size()<<" "<<muPaths1[i]<<std::endl;
-//std::cout<<(hltConfig.triggerIndex(muPaths1[i]))<<std::endl;
-      mtemp1 = (int)trigRes->accept(hltConfig.triggerIndex(muPaths1[i]));
-      if(HLT_Mu1<mtemp1) HLT_Mu1=mtemp1;
-   }
-   int mtemp2=0;
-   for (size_t i=0; i<muPaths2.size();i++) {
-      mtemp2 = (int)trigRes->accept(hltConfig.triggerIndex(muPaths2[i]));
-      if(HLT_Mu2<mtemp2) HLT_Mu2=mtemp2;
-   }
-   int mtemp3=0;
-   for (size_t i=0; i<muPaths3.size();i++) {
-      mtemp3 = (int)trigRes->accept(hltConfig.triggerIndex(muPaths3[i]));
-      if(HLT_Mu3<mtemp3) HLT_Mu3=mtemp3;
-   }
+   timer_.enter(stages_.hlt);
+   int* const hltBits[] = { &HLT_Ele1, &HLT_Ele2, &HLT_Mu1, &HLT_Mu2, &HLT_Mu3 };
+   readHltBits(iEvent, hltBits);
 
    edm::Handle<edm::View<reco::Candidate> > leptonicVs;
    iEvent.getByToken(leptonicVSrc_, leptonicVs);
 
-   if (leptonicVs->empty()) {  outTree_->Fill(); return;  }
+   if (leptonicVs->empty()) {  fillTree(); return;  }
+   summary_.add(cuts_.leptonicV);
  
    iEvent.getByToken(rhoToken_      , rho_     );
    double fastJetRho = *(rho_.product());
@@ -904,6 +461,7 @@ PKUTreeMaker::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
    iEvent.getByToken(genSrc_, genParticles);
 //   iEvent.getByLabel(InputTag("packedGenParticles"), genParticles);
 
+   timer_.enter(stages_.gen);
    if (RunOnMC_){
     int ipp=0, imm=0, iee=0;
     for(size_t i=0; i<genParticles->size();i++){// std::cout<<"i = "<<i<<std::endl;
@@ -937,37 +495,23 @@ PKUTreeMaker::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
    iEvent.getByToken(metSrc_, metHandle); 
 
 //filter
-   iEvent.getByToken(noiseFilterToken_, noiseFilterBits_);
-   const edm::TriggerNames &names = iEvent.triggerNames(*noiseFilterBits_);
-   for (unsigned int i = 0, n = noiseFilterBits_->size(); i < n; ++i) {
-   if (names.triggerName(i) == HBHENoiseFilter_Selector_)
-            passFilter_HBHE_ = noiseFilterBits_->accept(i);  
-   if (names.triggerName(i) == HBHENoiseIsoFilter_Selector_)
-            passFilter_HBHEIso_ = noiseFilterBits_->accept(i);  
-   if (names.triggerName(i) ==ECALDeadCellNoiseFilter_Selector_)
-	      passFilter_globalTightHalo_ = noiseFilterBits_->accept(i);  
-   if (names.triggerName(i) == ECALDeadCellNoiseFilter_Selector_)
-            passFilter_ECALDeadCell_ = noiseFilterBits_->accept(i);  
-   if (names.triggerName(i) == GoodVtxNoiseFilter_Selector_)
-            passFilter_GoodVtx_ = noiseFilterBits_->accept(i);  
-   if (names.triggerName(i) == EEBadScNoiseFilter_Selector_)
-            passFilter_EEBadSc_ = noiseFilterBits_->accept(i);  
-   }  
-     edm::Handle<bool> badMuonResultHandle;
-     edm::Handle<bool> badChargedHadronResultHandle;
-     iEvent.getByToken(badMuon_Selector_, badMuonResultHandle);
-     iEvent.getByToken(badChargedHadron_Selector_, badChargedHadronResultHandle);
-     passFilter_badMuon_ = *badMuonResultHandle;
-     passFilter_badChargedHadron_ = *badChargedHadronResultHandle;
+   timer_.enter(stages_.filters);
+   bool* const pass[pku::MetFilters::nFlags] = {
+     &passFilter_HBHE_, &passFilter_HBHEIso_, &passFilter_globalTightHalo_,
+     &passFilter_ECALDeadCell_, &passFilter_GoodVtx_, &passFilter_EEBadSc_,
+     0, 0,   // no muon MET filters in the W ntuple
+     &passFilter_badMuon_, &passFilter_badChargedHadron_ };
+   readMetFilters(iEvent, pass);
 
-  
    const reco::Candidate& leptonicV = leptonicVs->at(0);
    const reco::Candidate& metCand = metHandle->at(0);
    const reco::Candidate& lepton = (*leptonicV.daughter(0));
        
+   timer_.enter(stages_.vertices);
    edm::Handle<reco::VertexCollection> vertices;
    iEvent.getByToken(VertexToken_, vertices);
-   if (vertices->empty()) { outTree_->Fill(); return;} // skip the event if no PV found
+   if (vertices->empty()) { fillTree(); return;} // skip the event if no PV found
+   summary_.add(cuts_.vertex);
    nVtx = vertices->size();
    reco::VertexCollection::const_iterator firstGoodVertex = vertices->end();
    for (reco::VertexCollection::const_iterator vtx = vertices->begin(); vtx != vertices->end(); ++vtx) {
@@ -981,10 +525,12 @@ PKUTreeMaker::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
            break;
           }           
       }
-   if ( firstGoodVertex==vertices->end() ) {outTree_->Fill();  return;} // skip event if there are no good PVs
+   if ( firstGoodVertex==vertices->end() ) {fillTree();  return;} // skip event if there are no good PVs
+   summary_.add(cuts_.goodVertex);
 
 
 // ************************* MET ********************** //
+    timer_.enter(stages_.met);
     edm::Handle<pat::METCollection>  METs_;
     bool defaultMET = iEvent.getByToken(metInputToken_ , METs_ );
     if(RunOnMC_){
@@ -992,7 +538,9 @@ PKUTreeMaker::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
      genMET=xmet.genMET()->pt();
     }
     if(defaultMET){
+        timer_.enter(stages_.typeI);
         addTypeICorr(iEvent);
+        timer_.enter(stages_.met);
         for (const pat::MET &met : *METs_) {
 //         const float  rawPt    = met.shiftedPt(pat::MET::METUncertainty::NoShift, pat::MET::METUncertaintyLevel::Raw);
 //         const float  rawPhi   = met.shiftedPhi(pat::MET::METUncertainty::NoShift, pat::MET::METUncertaintyLevel::Raw);
@@ -1035,24 +583,20 @@ PKUTreeMaker::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
        phiVlep      = leptonicV.phi();
        massVlep     = leptonicV.mass();
        mtVlep       = leptonicV.mt();
-       ptlep1       = leptonicV.daughter(1)->pt();
-       etalep1      = leptonicV.daughter(1)->eta();
-       philep1      = leptonicV.daughter(1)->phi();
-       double energylep1     = leptonicV.daughter(1)->energy();
-       if(leptonicV.daughter(0)->isElectron()||leptonicV.daughter(0)->isMuon() ) {
-       ptlep1       = leptonicV.daughter(0)->pt();
-       etalep1      = leptonicV.daughter(0)->eta();
-       philep1      = leptonicV.daughter(0)->phi(); 
-       energylep1     = leptonicV.daughter(0)->energy(); }
+       const reco::Candidate* chargedLepton = leptonicV.daughter(pku::WChannel::leptonDaughter(leptonicV));
+       ptlep1       = chargedLepton->pt();
+       etalep1      = chargedLepton->eta();
+       philep1      = chargedLepton->phi();
+       double energylep1     = chargedLepton->energy();
        met          = metCand.pt();
        metPhi       = metCand.phi();
-       mtVlepnew=sqrt(2*ptlep1*met*(1.0-cos(philep1-metPhi)));
+       mtVlepnew=pku::WChannel::transverseMass(ptlep1, philep1, met, metPhi);
        nlooseeles = looseeles->size(); 
        nloosemus = loosemus->size(); 
 
        TLorentzVector  glepton;
        glepton.SetPtEtaPhiE(ptlep1, etalep1, philep1, energylep1);
-       math::XYZTLorentzVector neutrinoP4 = getNeutrinoP4(MET_et, MET_phi, glepton, 1);
+       math::XYZTLorentzVector neutrinoP4 = pku::WChannel::neutrinoP4(MET_et, MET_phi, glepton, MW_);
        reco::CandidateBaseRef METBaseRef = metHandle->refAt(0);  //?????
        reco::ShallowCloneCandidate neutrino(METBaseRef, 0 , neutrinoP4);
        reco::CompositeCandidate WLeptonic;
@@ -1065,10 +609,11 @@ PKUTreeMaker::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
        phiVlepJEC      = WLeptonic.phi();
        massVlepJEC     = WLeptonic.mass();
        mtVlepJEC       = WLeptonic.mt();
-       mtVlepJECnew=sqrt(2*ptlep1*MET_et*(1.0-cos(philep1-MET_phi)));
+       mtVlepJECnew=pku::WChannel::transverseMass(ptlep1, philep1, MET_et, MET_phi);
 
 // ************************* Photon Jets Information****************** //
 // *************************************************************//
+         timer_.enter(stages_.photons);
          double rhoVal_;
          rhoVal_=-99.;
          rhoVal_ = *rho_;
@@ -1081,152 +626,106 @@ PKUTreeMaker::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
          edm::Handle<edm::ValueMap<float> > phoPhotonIsolationMap;
          iEvent.getByToken(phoPhotonIsolationToken_, phoPhotonIsolationMap);
 
-         photonet=-100.; photonet_f=-100.;  iphoton=-1; iphoton_f=-1;
+         edm::Handle<edm::View<pat::Electron> > electrons;
+         iEvent.getByToken(electronToken_, electrons);
+         edm::Handle<reco::BeamSpot> beamSpot;
+         iEvent.getByToken(beamSpotToken_,beamSpot);
+         edm::Handle<std::vector<reco::Conversion> > conversions;
+         iEvent.getByToken(conversionsToken_,conversions);
+         TLorentzVector wp4;
+         wp4.SetPtEtaPhiE(WLeptonic.pt(), WLeptonic.eta(), WLeptonic.phi(), WLeptonic.energy());
+
+         photonVars_.clear();
+         photonMasks_.clear();
+          timer_.count(stages_.nPhotons, photons->size());
           for (size_t ip=0; ip<photons->size();ip++)
          {
             const auto pho = photons->ptrAt(ip);
- 
-            double phosc_eta=pho->superCluster()->eta();
-//            std::cout<<pho->superCluster()->eta()<<" "<<(*photons)[ip].eta()<<std::endl;
-            double phosc_phi=pho->superCluster()->phi();
-            double pho_ieie=(*full5x5SigmaIEtaIEtaMap)[pho];
-//            std::cout<<(*full5x5SigmaIEtaIEtaMap)[ pho ]<<" "<<(*photons)[ip].sigmaIetaIeta()<<std::endl;
-            double chIso1 =  (*phoChargedIsolationMap)[pho];
-            double nhIso1 =  (*phoNeutralHadronIsolationMap)[pho];
-            double phIso1 = (*phoPhotonIsolationMap)[pho];
-            double chiso=std::max(0.0, chIso1 - rhoVal_*EAch(fabs((*photons)[ip].eta()))); //effAreaChHadrons_.getEffectiveArea(fabs(phosc_eta)));
-//            double chiso=std::max((*photons)[ip].chargedHadronIso()-rhoVal_*EAch(fabs((*photons)[ip].eta())),0.0);
-            double nhiso=std::max(0.0, nhIso1 - rhoVal_*EAnh(fabs((*photons)[ip].eta()))); //effAreaNeuHadrons_.getEffectiveArea(fabs(phosc_eta)));
-//            double nhiso=std::max((*photons)[ip].neutralHadronIso()-rhoVal_*EAnh(fabs((*photons)[ip].eta())),0.0);
-            double phoiso=std::max(0.0, phIso1 - rhoVal_*EApho(fabs((*photons)[ip].eta()))); //effAreaPhotons_.getEffectiveArea(fabs(phosc_eta)));
-//            double phoiso=std::max((*photons)[ip].photonIso()-rhoVal_*EApho(fabs((*photons)[ip].eta())),0.0);
-
-            int ismedium_photon=0;
-			int ismedium_photon_f=0;
-             edm::Handle<edm::View<pat::Electron> > electrons;
-             iEvent.getByToken(electronToken_, electrons);
-             edm::Handle<reco::BeamSpot> beamSpot;
-             iEvent.getByToken(beamSpotToken_,beamSpot);
-             edm::Handle<std::vector<reco::Conversion> > conversions;
-             iEvent.getByToken(conversionsToken_,conversions);
-             passEleVeto = (!hasMatchedPromptElectron((*photons)[ip].superCluster(),electrons, conversions, beamSpot->position() ) );
-             passEleVetonew=(*photons)[ip].passElectronVeto();
-             passPixelSeedVeto=(*photons)[ip].hasPixelSeed();
-
+            const pat::Photon& photon = (*photons)[ip];
+            const float* EA = photonEA_.areas(fabs(photon.eta()));
+
+            pku::photon::Variables v;
+            v.pt = photon.pt();
+            v.eta = pho->superCluster()->eta();
+            v.phi = pho->superCluster()->phi();
+            v.energy = photon.energy();
+            v.hoe = photon.hadTowOverEm();
+            v.sieie = (*full5x5SigmaIEtaIEtaMap)[pho];
+            v.chiso = std::max(0.0, (*phoChargedIsolationMap)[pho] - rhoVal_*EA[pku::EffectiveAreaTable::ChargedHadron]);
+            v.nhiso = std::max(0.0, (*phoNeutralHadronIsolationMap)[pho] - rhoVal_*EA[pku::EffectiveAreaTable::NeutralHadron]);
+            v.phoiso = std::max(0.0, (*phoPhotonIsolationMap)[pho] - rhoVal_*EA[pku::EffectiveAreaTable::Photon]);
+            v.drLepton = deltaR(v.eta, v.phi, etalep1, philep1);
+            v.isEB = photon.isEB();
+            v.isEE = photon.isEE();
+            v.eleVeto = photon.passElectronVeto();
+            photonVars_.push_back(v);
+            photonMasks_.push_back(pku::photon::classify(v));
+
+             passEleVeto = (!hasMatchedPromptElectron(photon.superCluster(),electrons, conversions, beamSpot->position() ) );
+             passEleVetonew=v.eleVeto;
+             passPixelSeedVeto=photon.hasPixelSeed();
 
             if(ip<6)  {
-                photon_pt[ip] = (*photons)[ip].pt();
-                photon_eta[ip] = phosc_eta;//(*photons)[ip].eta();
-                photon_phi[ip] = phosc_phi;//(*photons)[ip].phi();
-                photon_e[ip] = (*photons)[ip].energy();
+                photon_pt[ip] = v.pt;
+                photon_eta[ip] = v.eta;
+                photon_phi[ip] = v.phi;
+                photon_e[ip] = v.energy;
                 photon_pev[ip]=passEleVeto;
                 photon_pevnew[ip]=passEleVetonew;
                 photon_ppsv[ip]=passPixelSeedVeto;
-                photon_iseb[ip]=(*photons)[ip].isEB();
-                photon_isee[ip]=(*photons)[ip].isEE();
-                photon_hoe[ip]=(*photons)[ip].hadTowOverEm();
-                photon_sieie[ip]=pho_ieie;//(*photons)[ip].sigmaIetaIeta();
-                photon_sieie2[ip]=(*photons)[ip].sigmaIetaIeta();
-                photon_chiso[ip]=chiso;
-                photon_nhiso[ip]=nhiso;
-                photon_phoiso[ip]=phoiso;
+                photon_iseb[ip]=v.isEB;
+                photon_isee[ip]=v.isEE;
+                photon_hoe[ip]=v.hoe;
+                photon_sieie[ip]=v.sieie;
+                photon_sieie2[ip]=photon.sigmaIetaIeta();
+                photon_chiso[ip]=v.chiso;
+                photon_nhiso[ip]=v.nhiso;
+                photon_phoiso[ip]=v.phoiso;
                 if(RunOnMC_ && photon_pt[ip]>0){
-                  const auto pho = photons->ptrAt(ip);
                   photon_istrue[ip]=matchToTruth(*pho, genParticles, ISRPho, dR_, photon_isprompt[ip]);
                  }
-                photon_drla[ip]=deltaR(photon_eta[ip],photon_phi[ip],etalep1,philep1);
+                photon_drla[ip]=v.drLepton;
                 TLorentzVector tp4;
                 tp4.SetPtEtaPhiE(photon_pt[ip],photon_eta[ip],photon_phi[ip],photon_e[ip]);
                 photon_mla[ip]=(tp4+glepton).M();
-                TLorentzVector fwp4;
-                fwp4.SetPtEtaPhiE(WLeptonic.pt(), WLeptonic.eta(), WLeptonic.phi(), WLeptonic.energy());
-                photon_mva[ip]=(tp4+fwp4).M();
+                photon_mva[ip]=(tp4+wp4).M();
                }
+	 }
 
-            if(passEleVetonew && (*photons)[ip].isEB() && (*photons)[ip].hadTowOverEm()<0.0396 && photon_sieie[ip]<0.01022 && chiso<0.441 && nhiso<(2.725 + (0.0148*(*photons)[ip].pt()+0.000017*(*photons)[ip].pt()*(*photons)[ip].pt())) && phoiso<(2.571+0.0047*(*photons)[ip].pt())) {ismedium_photon=1;}
-            if(passEleVetonew && (*photons)[ip].isEE() && (*photons)[ip].hadTowOverEm()<0.0219 && photon_sieie[ip]<0.03001 && chiso<0.442 && nhiso<(1.715 + (0.0163*(*photons)[ip].pt()+0.000014*(*photons)[ip].pt()*(*photons)[ip].pt())) && phoiso<(3.863+0.0034*(*photons)[ip].pt())) {ismedium_photon=1;}
-
-             if(ismedium_photon==1 && deltaR(phosc_eta,phosc_phi,etalep1,philep1) > 0.7) { if(ip==0) {photonet=(*photons)[ip].pt(); iphoton=ip;}
-                 if((*photons)[ip].pt()>photonet)
-                         {
-                      photonet=(*photons)[ip].pt(); iphoton=ip;
-
-          }
+         // nominal (medium), fake-rate ("_f") and the configured control regions, from one ranking
+         selectPhotons(photonBlocks_.size());
+         for (size_t s=0; s<photonBlocks_.size(); s++) {
+               pku::SelectedPhoton& block = photonBlocks_[s];
+               if(block.index<0) continue;
+               block.drla=photonVars_[block.index].drLepton;
+               TLorentzVector photonp4;
+               photonp4.SetPtEtaPhiE(block.et, block.eta, block.phi, block.e);
+               block.Mla=(photonp4+glepton).M();
+               block.Mva=(photonp4+wp4).M();
          }
-         
-//////////////////////////////////for fake photon study, store photon without sieie cut
-//Inverting loose ID
-            if(passEleVetonew && (*photons)[ip].isEB() && (*photons)[ip].hadTowOverEm()<0.0597 && chiso<std::min(0.2*(*photons)[ip].pt(), 5.*1.295) && nhiso<std::min(0.2*(*photons)[ip].pt(), 5.*(10.910 + (0.0148*(*photons)[ip].pt()+0.000017*(*photons)[ip].pt()*(*photons)[ip].pt())))  && phoiso<std::min(0.2*(*photons)[ip].pt(), 5.*(3.630+0.0047*(*photons)[ip].pt())) && !(photon_sieie[ip]<0.01031&&chiso<1.295 && nhiso<(10.910 + (0.0148*(*photons)[ip].pt()+0.000017*(*photons)[ip].pt()*(*photons)[ip].pt())) && phoiso<(3.630+0.0047*(*photons)[ip].pt())) ) {ismedium_photon_f=1;}
-            if(passEleVetonew && (*photons)[ip].isEE() && (*photons)[ip].hadTowOverEm()<0.0481 && chiso<std::min(0.2*(*photons)[ip].pt(), 5.*1.011) && nhiso<std::min(0.2*(*photons)[ip].pt(), 5.*(5.931 + (0.0163*(*photons)[ip].pt()+0.000014*(*photons)[ip].pt()*(*photons)[ip].pt())))  && phoiso<std::min(0.2*(*photons)[ip].pt(), 5.*(6.641+0.0034*(*photons)[ip].pt())) && !(photon_sieie[ip]<0.03013 && chiso<1.011 && nhiso<(5.931 + (0.0163*(*photons)[ip].pt()+0.000014*(*photons)[ip].pt()*(*photons)[ip].pt())) && phoiso<(6.641+0.0034*(*photons)[ip].pt()))) {ismedium_photon_f=1;}
-            if(ismedium_photon_f==1 && deltaR(phosc_eta,phosc_phi,etalep1,philep1) > 0.7) {
-                if(ip==0) {photonet_f=(*photons)[ip].pt(); iphoton_f=ip;}
-                if((*photons)[ip].pt()>photonet_f) {
-                  photonet_f=(*photons)[ip].pt(); iphoton_f=ip;
-                }
-            }		 
-////////////////////////////////////////////////////////////////////////////////////////		 
-	 }
+         const pku::SelectedPhoton& nominalPhoton = photonBlocks_[0];
+         const pku::SelectedPhoton& fakePhoton = photonBlocks_[1];
 
              //Gen photon matching
-    if(RunOnMC_ && iphoton>-1){
-             const auto pho1 = photons->ptrAt(iphoton);
+    if(RunOnMC_ && nominalPhoton.index>-1){
+             const auto pho1 = photons->ptrAt(nominalPhoton.index);
              isTrue_= matchToTruth(*pho1, genParticles, ISRPho, dR_, isprompt_);
     }
 
-         if(iphoton>-1 && iphoton<6) {
-               photonet=photon_pt[iphoton];//(*photons)[iphoton].pt();
-               photoneta=photon_eta[iphoton];//(*photons)[iphoton].eta();
-               photonphi=photon_phi[iphoton];//(*photons)[iphoton].phi();
-               photone=photon_e[iphoton];//(*photons)[iphoton].energy();
-               photonsieie=photon_sieie[iphoton];//(*photons)[iphoton].sigmaIetaIeta();
-               photonphoiso=photon_phoiso[iphoton];//std::max((*photons)[iphoton].photonIso()-rhoVal_*EApho(fabs((*photons)[iphoton].eta())),0.0);
-               photonchiso=photon_chiso[iphoton];//std::max((*photons)[iphoton].chargedHadronIso()-rhoVal_*EAch(fabs((*photons)[iphoton].eta())),0.0);
-               photonnhiso=photon_nhiso[iphoton];//std::max((*photons)[iphoton].neutralHadronIso()-rhoVal_*EAnh(fabs((*photons)[iphoton].eta())),0.0);
-               drla=deltaR(photon_eta[iphoton],photon_phi[iphoton],etalep1,philep1);
-               TLorentzVector photonp4;
-               photonp4.SetPtEtaPhiE(photonet, photoneta, photonphi, photone);
-               Mla=(photonp4+glepton).M();
-               TLorentzVector wp4;
-               wp4.SetPtEtaPhiE(WLeptonic.pt(), WLeptonic.eta(), WLeptonic.phi(), WLeptonic.energy());
-               Mva=(photonp4+wp4).M();
-         }
-
-
-         if(iphoton_f>-1 && iphoton_f<6) {
-		       photonet_f=photon_pt[iphoton_f];//(*photons)[iphoton_f].pt();
-		       photoneta_f=photon_eta[iphoton_f];//(*photons)[iphoton_f].eta();
-		       photonphi_f=photon_phi[iphoton_f];//(*photons)[iphoton_f].phi();
-		       photone_f=photon_e[iphoton_f];//(*photons)[iphoton_f].energy();
-		       photonsieie_f=photon_sieie[iphoton_f];//(*photons)[iphoton_f].sigmaIetaIeta();
-		       photonphoiso_f=photon_phoiso[iphoton_f];//std::max((*photons)[iphoton_f].photonIso()-rhoVal_*EApho(fabs((*photons)[iphoton_f].eta())),0.0);
-		       photonchiso_f=photon_chiso[iphoton_f];//std::max((*photons)[iphoton_f].chargedHadronIso()-rhoVal_*EAch(fabs((*photons)[iphoton_f].eta())),0.0);
-		       photonnhiso_f=photon_nhiso[iphoton_f];//std::max((*photons)[iphoton_f].neutralHadronIso()-rhoVal_*EAnh(fabs((*photons)[iphoton_f].eta())),0.0);
-		       drla_f=deltaR(photon_eta[iphoton_f],photon_phi[iphoton_f],etalep1,philep1);
-		       TLorentzVector photonp4_f;
-		       photonp4_f.SetPtEtaPhiE(photonet_f, photoneta_f, photonphi_f, photone_f);
-	           Mla_f=(photonp4_f+glepton).M();
-	           TLorentzVector wp4_f;
-	           wp4_f.SetPtEtaPhiE(WLeptonic.pt(), WLeptonic.eta(), WLeptonic.phi(), WLeptonic.energy());
-	           Mva_f=(photonp4_f+wp4_f).M();
-	     }
-
 // ************************* AK4 Jets Information****************** //
 // ***********************************************************//
+    timer_.enter(stages_.jets);
     Int_t jetindexphoton12[2] = {-1,-1}; 
 	Int_t jetindexphoton12_f[2] = {-1,-1};
 
-    std::vector<JetCorrectorParameters> vPar;
-    for ( std::vector<std::string>::const_iterator payloadBegin = jecAK4Labels_.begin(), payloadEnd = jecAK4Labels_.end(), ipayload = payloadBegin; ipayload != payloadEnd; ++ipayload ) {
-         JetCorrectorParameters pars(*ipayload);
-         vPar.push_back(pars);    }
-    jecAK4_ = new FactorizedJetCorrector(vPar);
-    vPar.clear();
+    jecAK4_ = jecAK4Jets_.corrector(run);
 
     int nujets=0 ;
     double tmpjetptcut=20.0;
-    std::vector<TLorentzVector*> jets;
+    std::vector<TLorentzVector> jets;
    
 //################Jet Correction##########################
+        timer_.count(stages_.nJets, ak4jets->size());
         for (size_t ik=0; ik<ak4jets->size();ik++)
          {
             reco::Candidate::LorentzVector uncorrJet = (*ak4jets)[ik].correctedP4(0);
@@ -1239,8 +738,8 @@ PKUTreeMaker::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
             double corr = jecAK4_->getCorrection();
 
             if(corr*uncorrJet.pt()>tmpjetptcut) {
-            TLorentzVector *dummy = new TLorentzVector(0,0,0,0);    
-            dummy->SetPtEtaPhiE(corr*uncorrJet.pt(), uncorrJet.eta(), uncorrJet.phi(), corr*uncorrJet.energy());
+            TLorentzVector dummy(0,0,0,0);
+            dummy.SetPtEtaPhiE(corr*uncorrJet.pt(), uncorrJet.eta(), uncorrJet.phi(), corr*uncorrJet.energy());
             jets.push_back(dummy);
             ++nujets;
             }   
@@ -1253,112 +752,77 @@ PKUTreeMaker::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
                 ak4jet_icsv[ik] = (*ak4jets)[ik].bDiscriminator("pfCombinedInclusiveSecondaryVertexV2BJetTags");   }
           }
     
-       sort (jets.begin (), jets.end (), mysortPt);
-
-           for (size_t i=0;i<jets.size();i++) {
-             if(iphoton>-1) {    
-              double drtmp1=deltaR(jets.at(i)->Eta(), jets.at(i)->Phi(), photoneta,photonphi);
-               if(drtmp1>0.5 && jetindexphoton12[0]==-1&&jetindexphoton12[1]==-1) {
-                     jetindexphoton12[0] = i;
-                     continue;  // the first num
-               }
-              if(drtmp1>0.5 && jetindexphoton12[0]!=-1&&jetindexphoton12[1]==-1) {
-                     jetindexphoton12[1] = i;
-                     continue; // the second num
-               }
-              }
-           }
-
-	   for (size_t i=0;i<jets.size();i++) {
-	     if(iphoton_f>-1) {    
-	      double drtmp1_f=deltaR(jets.at(i)->Eta(), jets.at(i)->Phi(), photoneta_f,photonphi_f);
-	       if(drtmp1_f>0.5 && jetindexphoton12_f[0]==-1&&jetindexphoton12_f[1]==-1) {
-		    jetindexphoton12_f[0] = i;
-		    continue;  // the first num
-	       }
-              if(drtmp1_f>0.5 && jetindexphoton12_f[0]!=-1&&jetindexphoton12_f[1]==-1) {
-	            jetindexphoton12_f[1] = i;
-	            continue; // the second num
-	       }
-	      }
-	    }
+       timer_.enter(stages_.matching);
+       pku::rankByPt(jets);
+       if(nominalPhoton.index>-1)
+              pku::taggingJets(jets, nominalPhoton.eta, nominalPhoton.phi, jetindexphoton12);
+       if(fakePhoton.index>-1)
+              pku::taggingJets(jets, fakePhoton.eta, fakePhoton.phi, jetindexphoton12_f);
 
          if(jetindexphoton12[0]>-1 && jetindexphoton12[1]>-1) {
-            jet1pt=jets[jetindexphoton12[0]]->Pt();
-            jet1eta=jets[jetindexphoton12[0]]->Eta();
-            jet1phi=jets[jetindexphoton12[0]]->Phi();
-            jet1e=jets[jetindexphoton12[0]]->E();
-            jet2pt=jets[jetindexphoton12[1]]->Pt();
-            jet2eta=jets[jetindexphoton12[1]]->Eta();
-            jet2phi=jets[jetindexphoton12[1]]->Phi();
-            jet2e=jets[jetindexphoton12[1]]->E();
+            jet1pt=jets[jetindexphoton12[0]].Pt();
+            jet1eta=jets[jetindexphoton12[0]].Eta();
+            jet1phi=jets[jetindexphoton12[0]].Phi();
+            jet1e=jets[jetindexphoton12[0]].E();
+            jet2pt=jets[jetindexphoton12[1]].Pt();
+            jet2eta=jets[jetindexphoton12[1]].Eta();
+            jet2phi=jets[jetindexphoton12[1]].Phi();
+            jet2e=jets[jetindexphoton12[1]].E();
             jet1csv =(*ak4jets)[jetindexphoton12[0]].bDiscriminator("pfCombinedSecondaryVertexV2BJetTags");
             jet2csv =(*ak4jets)[jetindexphoton12[1]].bDiscriminator("pfCombinedSecondaryVertexV2BJetTags");
             jet1icsv =(*ak4jets)[jetindexphoton12[0]].bDiscriminator("pfCombinedInclusiveSecondaryVertexV2BJetTags");
             jet2icsv =(*ak4jets)[jetindexphoton12[1]].bDiscriminator("pfCombinedInclusiveSecondaryVertexV2BJetTags");
-            drj1a=deltaR(jet1eta,jet1phi,photoneta,photonphi);
-            drj2a=deltaR(jet2eta,jet2phi,photoneta,photonphi);
+            drj1a=deltaR(jet1eta,jet1phi,nominalPhoton.eta,nominalPhoton.phi);
+            drj2a=deltaR(jet2eta,jet2phi,nominalPhoton.eta,nominalPhoton.phi);
             drj1l=deltaR(jet1eta,jet1phi,etalep1,philep1);
             drj2l=deltaR(jet2eta,jet2phi,etalep1,philep1);
-            TLorentzVector j1p4;
-            j1p4.SetPtEtaPhiE(jet1pt, jet1eta, jet1phi, jet1e);
-            TLorentzVector j2p4;
-            j2p4.SetPtEtaPhiE(jet2pt, jet2eta, jet2phi, jet2e);
             TLorentzVector photonp42;
-            photonp42.SetPtEtaPhiE(photonet, photoneta, photonphi, photone);
+            photonp42.SetPtEtaPhiE(nominalPhoton.et, nominalPhoton.eta, nominalPhoton.phi, nominalPhoton.e);
             TLorentzVector vp4;
 //            vp4.SetPtEtaPhiE(leptonicV.pt(), leptonicV.eta(), leptonicV.phi(), leptonicV.energy());
             vp4.SetPtEtaPhiE(WLeptonic.pt(), WLeptonic.eta(), WLeptonic.phi(), WLeptonic.energy());
-            j1metPhi=fabs(jet1phi-MET_phi);
-            if(j1metPhi>Pi) {j1metPhi=2.0*Pi-j1metPhi;}
-            j2metPhi=fabs(jet2phi-MET_phi);
-            if(j2metPhi>Pi) {j2metPhi=2.0*Pi-j2metPhi;}
-            Mjj=(j1p4 + j2p4).M();
-            deltaeta = fabs(jet1eta - jet2eta);
-            zepp = fabs((vp4+photonp42).Rapidity() - (j1p4.Rapidity() + j2p4.Rapidity())/ 2.0); 
+            const pku::VbsObservables vbs(jets[jetindexphoton12[0]], jets[jetindexphoton12[1]], photonp42, vp4, MET_phi);
+            j1metPhi=vbs.j1metPhi;
+            j2metPhi=vbs.j2metPhi;
+            Mjj=vbs.Mjj;
+            deltaeta = vbs.deltaetajj;
+            zepp = vbs.zepp;
          }
 
 
 
          if(jetindexphoton12_f[0]>-1 && jetindexphoton12_f[1]>-1) {
-	    jet1pt_f=jets[jetindexphoton12_f[0]]->Pt();
-            jet1eta_f=jets[jetindexphoton12_f[0]]->Eta();
-            jet1phi_f=jets[jetindexphoton12_f[0]]->Phi();
-            jet1e_f=jets[jetindexphoton12_f[0]]->E();
-            jet2pt_f=jets[jetindexphoton12_f[1]]->Pt();
-            jet2eta_f=jets[jetindexphoton12_f[1]]->Eta();
-            jet2phi_f=jets[jetindexphoton12_f[1]]->Phi();
-            jet2e_f=jets[jetindexphoton12_f[1]]->E();
+	    jet1pt_f=jets[jetindexphoton12_f[0]].Pt();
+            jet1eta_f=jets[jetindexphoton12_f[0]].Eta();
+            jet1phi_f=jets[jetindexphoton12_f[0]].Phi();
+            jet1e_f=jets[jetindexphoton12_f[0]].E();
+            jet2pt_f=jets[jetindexphoton12_f[1]].Pt();
+            jet2eta_f=jets[jetindexphoton12_f[1]].Eta();
+            jet2phi_f=jets[jetindexphoton12_f[1]].Phi();
+            jet2e_f=jets[jetindexphoton12_f[1]].E();
             jet1csv_f =(*ak4jets)[jetindexphoton12_f[0]].bDiscriminator("pfCombinedSecondaryVertexV2BJetTags");
             jet2csv_f =(*ak4jets)[jetindexphoton12_f[1]].bDiscriminator("pfCombinedSecondaryVertexV2BJetTags");
             jet1icsv_f =(*ak4jets)[jetindexphoton12_f[0]].bDiscriminator("pfCombinedInclusiveSecondaryVertexV2BJetTags");
             jet2icsv_f =(*ak4jets)[jetindexphoton12_f[1]].bDiscriminator("pfCombinedInclusiveSecondaryVertexV2BJetTags");
-	    drj1a_f=deltaR(jet1eta_f,jet1phi_f,photoneta_f,photonphi_f);
-            drj2a_f=deltaR(jet2eta_f,jet2phi_f,photoneta_f,photonphi_f);
+	    drj1a_f=deltaR(jet1eta_f,jet1phi_f,fakePhoton.eta,fakePhoton.phi);
+            drj2a_f=deltaR(jet2eta_f,jet2phi_f,fakePhoton.eta,fakePhoton.phi);
             drj1l_f=deltaR(jet1eta_f,jet1phi_f,etalep1,philep1);
             drj2l_f=deltaR(jet2eta_f,jet2phi_f,etalep1,philep1);
-            TLorentzVector j1p4_f;
-            j1p4_f.SetPtEtaPhiE(jet1pt_f, jet1eta_f, jet1phi_f, jet1e_f);
-            TLorentzVector j2p4_f;
-            j2p4_f.SetPtEtaPhiE(jet2pt_f, jet2eta_f, jet2phi_f, jet2e_f);
             TLorentzVector photonp42_f;
-            photonp42_f.SetPtEtaPhiE(photonet_f, photoneta_f, photonphi_f, photone_f);
+            photonp42_f.SetPtEtaPhiE(fakePhoton.et, fakePhoton.eta, fakePhoton.phi, fakePhoton.e);
             TLorentzVector vp4_f;
 //            vp4.SetPtEtaPhiE(leptonicV.pt(), leptonicV.eta(), leptonicV.phi(), leptonicV.energy());
             vp4_f.SetPtEtaPhiE(WLeptonic.pt(), WLeptonic.eta(), WLeptonic.phi(), WLeptonic.energy());
-            j1metPhi_f=fabs(jet1phi_f-MET_phi);
-            if(j1metPhi_f>Pi) {j1metPhi_f=2.0*Pi-j1metPhi_f;}
-            j2metPhi_f=fabs(jet2phi_f-MET_phi);
-            if(j2metPhi_f>Pi) {j2metPhi_f=2.0*Pi-j2metPhi_f;}
-            Mjj_f=(j1p4_f + j2p4_f).M();
-	    deltaeta_f = fabs(jet1eta_f - jet2eta_f);
-            zepp_f = fabs((vp4_f+photonp42_f).Rapidity() - (j1p4_f.Rapidity() + j2p4_f.Rapidity())/ 2.0);
+            const pku::VbsObservables vbs_f(jets[jetindexphoton12_f[0]], jets[jetindexphoton12_f[1]], photonp42_f, vp4_f, MET_phi);
+            j1metPhi_f=vbs_f.j1metPhi;
+            j2metPhi_f=vbs_f.j2metPhi;
+            Mjj_f=vbs_f.Mjj;
+            deltaeta_f = vbs_f.deltaetajj;
+            zepp_f = vbs_f.zepp;
          }
 
 
-       outTree_->Fill();
-	   delete jecAK4_;
-	   jecAK4_=0;
+       fillTree();
    }
    
 //-------------------------------------------------------------------------------------------------------------------------------------//
@@ -1389,8 +853,6 @@ void PKUTreeMaker::setDummyValues() {
      massVlepJEC       = -1e1;
      mtVlepJEC         = -1e1;
      mtVlepJECnew      = -1e1;
-     Mla=-1e1;		Mla_f=-1e1;	
-     Mva=-1e1;		Mva_f=-1e1;
      ptlep1         = -1e1;
      etalep1        = -1e1;
      philep1        = -1e1;
@@ -1447,16 +909,7 @@ void PKUTreeMaker::setDummyValues() {
      ak4jet_icsv[i]=-1e1;
      }
 
-     photonet=-1e1;	 photonet_f=-1e1;
-     photoneta=-1e1;  photoneta_f=-1e1;
-     photonphi=-1e1;  photonphi_f=-1e1;
-     photone=-1e1;   photone_f=-1e1;
-     photonsieie=-1e1;  photonsieie_f=-1e1;
-     photonphoiso=-1e1;  photonphoiso_f=-1e1;
-     photonchiso=-1e1;  photonchiso_f=-1e1;
-     photonnhiso=-1e1;  photonnhiso_f=-1e1;
-     iphoton=-1;	 iphoton_f=-1;
-     drla=1e1; 		 drla_f=1e1;
+     for (size_t s=0; s<photonBlocks_.size(); s++) photonBlocks_[s].reset();
      passEleVeto=false;
      passEleVetonew=false;
      passPixelSeedVeto=false;
@@ -1508,74 +961,6 @@ PKUTreeMaker::beginJob()
 {
 }
 
-// ------------ method called once each job just after ending the event loop  ------------
-void PKUTreeMaker::beginRun(const edm::Run& iRun, const edm::EventSetup& iSetup)
- {
-
-  elPaths1.clear();
-  elPaths2.clear();
-  muPaths1.clear();
-  muPaths2.clear();
-  muPaths3.clear();
-  
-
-  std::cout<<"-----begin-----"<<std::endl; 
-   bool changed;
-   if ( !hltConfig.init(iRun, iSetup, "HLT", changed) ) {
-        edm::LogError("HltAnalysis") << "Initialization of HLTConfigProvider failed!!";
-       return;
-      }
-   for (size_t i = 0; i < elPaths1_.size(); i++) {
-         std::vector<std::string> foundPaths1 = hltConfig.matched( hltConfig.triggerNames(), elPaths1_[i] );
-         while ( !foundPaths1.empty() ){
-               elPaths1.push_back( foundPaths1.back() );
-               foundPaths1.pop_back(); }
-                                                }
-   for (size_t i = 0; i < muPaths1_.size(); i++) {
-         std::vector<std::string> foundPaths1 = hltConfig.matched( hltConfig.triggerNames(), muPaths1_[i] );
-         while ( !foundPaths1.empty() ){
-               muPaths1.push_back( foundPaths1.back() );
-               foundPaths1.pop_back();
-                                      }
-                                                }
-   std::cout<<"\n************** HLT-1 Information **************\n";
-   for (size_t i=0; i < elPaths1.size(); i++) std::cout << "\n Electron paths-1:    " << i<<"  "<<elPaths1[i].c_str() <<"\t"<< std::endl;
-   for (size_t i=0; i < muPaths1.size(); i++) std::cout << "\n Muon paths-1:   " << i<<"  "<<muPaths1[i].c_str() <<"\t"<< std::endl;
-   std::cout<<"\n*********************************************\n\n";
-
-   for (size_t i = 0; i < elPaths2_.size(); i++) {
-         std::vector<std::string> foundPaths2 = hltConfig.matched( hltConfig.triggerNames(), elPaths2_[i] );
-         while ( !foundPaths2.empty() ){
-               elPaths2.push_back( foundPaths2.back() );
-               foundPaths2.pop_back();
-                                      }
-                                                }
-   for (size_t i = 0; i < muPaths2_.size(); i++) {
-         std::vector<std::string> foundPaths2 = hltConfig.matched( hltConfig.triggerNames(), muPaths2_[i] );
-         while ( !foundPaths2.empty() ){
-               muPaths2.push_back( foundPaths2.back() );
-               foundPaths2.pop_back();
-                                      }
-                                                }
-   std::cout<<"\n************** HLT-2 Information **************\n";
-   for (size_t i=0; i < elPaths2.size(); i++) std::cout << "\n Electron paths-2:    " << i<<"  "<<elPaths2[i].c_str() <<"\t"<< std::endl;
-   for (size_t i=0; i < muPaths2.size(); i++) std::cout << "\n Muon paths-2:   " << i<<"  "<<muPaths2[i].c_str() <<"\t"<< std::endl;
-   std::cout<<"\n*********************************************\n\n";
-   for (size_t i = 0; i < muPaths3_.size(); i++) {
-         std::vector<std::string> foundPaths3 = hltConfig.matched( hltConfig.triggerNames(), muPaths3_[i] );
-         while ( !foundPaths3.empty() ){
-               muPaths3.push_back( foundPaths3.back() );
-               foundPaths3.pop_back();
-                                      }
-                                                }
-
-   std::cout<<"\n************** HLT-3 Information **************\n";
-   for (size_t i=0; i < muPaths3.size(); i++) std::cout << "\n Muon paths-3:   " << i<<"  "<<muPaths3[i].c_str() <<"\t"<< std::endl;
-   std::cout<<"\n*********************************************\n\n";
-
-
-
-}
 //temp5
 //temp on window
 void PKUTreeMaker::endRun(const edm::Run& iRun, const edm::EventSetup& iSetup)
@@ -1586,6 +971,16 @@ void PKUTreeMaker::endRun(const edm::Run& iRun, const edm::EventSetup& iSetup)
 void
 PKUTreeMaker::endJob() {
   std::cout << "PKUTreeMaker endJob()..." << std::endl;
+  std::stringstream ss;
+  outputPolicy_.printSummary(ss, outTree_);
+  jecAK4chs_.printSummary(ss);
+  jecAK4Jets_.printSummary(ss);
+  timer_.printSummary(ss);
+  summary_.printSummary(ss);
+  checkpoint_.finish(checkpointTree_, summaryTree_);
+  checkpoint_.printSummary(ss);
+  timer_.writeReport();
+  edm::LogInfo("PKUTreeMaker") << "PKUCandidates output SUMMARY:\n" << ss.str();
 }
 
 //define this as a plug-in
@@ -0,0 +1,533 @@
+#ifndef VAJets_PKUTreeMaker_PKUTreeMakerCore_h
+#define VAJets_PKUTreeMaker_PKUTreeMakerCore_h
+//
+// Package:    VAJets/PKUTreeMaker
+// Class:      TreeMakerCore
+//
+/**\class TreeMakerCore PKUTreeMakerCore.h VAJets/PKUTreeMaker/plugins/PKUTreeMakerCore.h
+
+ Description: code shared by the W+gamma (PKUTreeMaker) and Z+gamma
+ (ZPKUTreeMaker) tree makers.
+
+ Implementation:
+     TreeMakerCore<Channel, Logic> reads the event for the framework-free
+     part of the tree makers, Logic (TreeMakerLogic.h by default, which
+     holds the Type-I MET correction, the AK4 JEC payloads, the photon
+     effective-area table, built in or read from the effArea*File inputs
+     with useEffAreaFiles = True, the photon selections and the stage
+     timer).  Here are the inputs: the Type-I jets with the muons removed
+     (recordTypeIJets, addTypeICorr), the prompt-electron veto and the
+     photon truth matching.  The tree maker fills photonVars_ and
+     photonMasks_ in its photon loop, and selectPhotons() picks the photon
+     of every block from one pt ranking (see PhotonCategory.h).  The
+     channel policy supplies what differs between the two final states:
+     the tree name, which leg of the leptonic boson is the reference
+     lepton, whether the Type-I correction also removes reco muons near the
+     jets (Z only), the HLT path groups (elPaths1.., muPaths1..) and the
+     muon MET filters it reads, and, for the W, the neutrino reconstruction
+     and the transverse mass.  The policy switches are compile-time
+     constants, so the branch not taken by a channel is not compiled into
+     its plugin.  The core also reads what both tree makers read the same
+     way: the HLT bits of the path groups, whose menu paths are looked up
+     at every beginRun(), the MET filter bits and, on MC, the pileup.  Data
+     and MC stay the runtime RunOnMC flag: one plugin name serves the data
+     and MC configurations, and the replay of ZAnalysisCore reads it from
+     the captured configuration.
+     The Z tree maker uses ZAnalysisCore.h as its Logic, so that its
+     analysis also runs on captured ZEventRecords outside the framework.
+     With the "checkpoint" PSet the output tree is checkpointed at the end
+     of luminosity blocks (Checkpoint.h); the tree maker hands its tree to
+     checkpointTree_ and calls countEvent() for every event.  countEvent()
+     also adds to the LumiSummary tree of the module (lumiSummary = False
+     turns it off) the sum of the generator weights, of their squares and
+     of their signs, and the sums of the LHE weights when lheWeights names
+     the LHEEventProduct; the events and the cut flow are counted by the
+     analysis itself (TreeMakerLogic.h).
+*/
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TLorentzVector.h"
+#include "TMath.h"
+#include "FWCore/Framework/interface/EDAnalyzer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/FileBlock.h"
+#include "FWCore/Framework/interface/LuminosityBlock.h"
+#include "FWCore/Framework/interface/Run.h"
+#include "FWCore/Common/interface/TriggerNames.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "CommonTools/UtilAlgos/interface/TFileService.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "SimDataFormats/GeneratorProducts/interface/GenEventInfoProduct.h"
+#include "SimDataFormats/GeneratorProducts/interface/LHEEventProduct.h"
+#include "DataFormats/Candidate/interface/Candidate.h"
+#include "DataFormats/Common/interface/View.h"
+#include "DataFormats/EgammaCandidates/interface/Photon.h"
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+#include "DataFormats/Math/interface/deltaR.h"
+#include "DataFormats/Math/interface/LorentzVector.h"
+#include "DataFormats/ParticleFlowCandidate/interface/PFCandidate.h"
+#include "DataFormats/PatCandidates/interface/Electron.h"
+#include "DataFormats/PatCandidates/interface/Jet.h"
+#include "DataFormats/PatCandidates/interface/Muon.h"
+#include "DataFormats/VertexReco/interface/VertexFwd.h"
+#include "DataFormats/Common/interface/TriggerResults.h"
+#include "HLTrigger/HLTcore/interface/HLTConfigProvider.h"
+#include "SimDataFormats/PileupSummaryInfo/interface/PileupSummaryInfo.h"
+#include "VAJets/PKUTreeMaker/interface/Checkpoint.h"
+#include "VAJets/PKUTreeMaker/interface/JetConstituentKeys.h"
+#include "VAJets/PKUTreeMaker/interface/NeutrinoPzSolver.h"
+#include "VAJets/PKUTreeMaker/interface/TreeMakerLogic.h"
+#include "CommonTools/Utils/interface/StringCutObjectSelector.h"
+#include "RecoEgamma/EgammaTools/interface/ConversionTools.h"
+
+namespace pku {
+
+	// W -> l nu
+	struct WChannel {
+		static const char* treeName()  { return "PKUCandidates"; }
+		static const char* treeTitle() { return "PKU Candidates"; }
+		static const bool subtractMuonsInCone = false;
+		// HLT_Ele1-2 and HLT_Mu1-3, from elPaths1-2 and muPaths1-3
+		static const unsigned nElPaths = 2, nMuPaths = 3;
+		static const bool muonMetFilters = false;
+		// the charged lepton is whichever daughter is an electron or a muon
+		static unsigned leptonDaughter(const reco::Candidate& V) {
+			return (V.daughter(0)->isElectron() || V.daughter(0)->isMuon()) ? 0 : 1;
+		}
+		static double transverseMass(double ptLep, double phiLep, double met, double metPhi) {
+			return sqrt(2*ptLep*met*(1.0-cos(phiLep-metPhi)));
+		}
+		// neutrino four-momentum from the W mass constraint, most central pz root
+		static math::XYZTLorentzVector neutrinoP4(double MetPt, double MetPhi, const TLorentzVector& lep, double mW);
+	};
+
+	// Z -> l l
+	struct ZChannel {
+		static const char* treeName()  { return "ZPKUCandidates"; }
+		static const char* treeTitle() { return "ZPKU Candidates"; }
+		static const bool subtractMuonsInCone = true;
+		// HLT_Ele1-2 and HLT_Mu1-8, from elPaths1-2 and muPaths1-8
+		static const unsigned nElPaths = 2, nMuPaths = 8;
+		// also badMuonFilterSelection and duplicateMuonFilterSelection
+		static const bool muonMetFilters = true;
+		static unsigned leptonDaughter(const reco::Candidate&) { return 0; }
+	};
+
+	// the flags of TreeMakerCore::readMetFilters(), in the order of its 'pass' array
+	struct MetFilters {
+		enum Flag { HBHE, HBHEIso, globalTightHalo, ECALDeadCell, GoodVtx, EEBadSc,
+		            MetbadMuon, duplicateMuon,      // Channel::muonMetFilters only
+		            badMuon, badChargedHadron,      // the bool products
+		            nFlags };
+	};
+
+	template<class Channel, class Logic = pku::TreeMakerLogic>
+	class TreeMakerCore : public edm::EDAnalyzer, public Logic {
+		public:
+			enum PhotonMatchType {UNMATCHED = 0,
+				MATCHED_FROM_GUDSCB,
+				MATCHED_FROM_PI0,
+				MATCHED_FROM_OTHER_SOURCES};
+
+		protected:
+			explicit TreeMakerCore(const edm::ParameterSet& iConfig);
+			virtual ~TreeMakerCore() {}
+
+			// TypeICorrMap_ of the event; needs nVtx
+			virtual void addTypeICorr( edm::Event const & event );
+			// the t1jetSrc jets entering the Type-I correction, with the muons subtracted
+			void recordTypeIJets( edm::Event const & event, std::vector<pku::TypeIJet>& typeIJets );
+			bool hasMatchedPromptElectron(const reco::SuperClusterRef &sc, const edm::Handle<edm::View<pat::Electron> > &eleCol,const edm::Handle<reco::ConversionCollection> &convCol, const math::XYZPoint &beamspot,float lxyMin=2.0, float probMin=1e-6, unsigned int nHitsBeforeVtxMax=0);
+			int matchToTruth(const reco::Photon &pho,const edm::Handle<edm::View<reco::GenParticle>>  &genParticles, bool &ISRPho, double &dR, int &isprompt);
+			void findFirstNonPhotonMother(const reco::Candidate *particle,int &ancestorPID, int &ancestorStatus);
+			// first thing in analyze(): checkpoint position and lumi summary sums
+			void countEvent(const edm::Event& event);
+			// HLT_Ele1.. then HLT_Mu1.. (Channel::nElPaths + nMuPaths bits): a bit is
+			// raised to 1 or 0 if a path of its group is in the menu and left as is otherwise
+			void readHltBits(const edm::Event& event, int* const bits[]);
+			// the MET filters of 'pass' that are not null, see MetFilters
+			void readMetFilters(const edm::Event& event, bool* const pass[MetFilters::nFlags]);
+			// MC: the in-time pileup, nBX of the last bunch crossing of the summary
+			void readPileup(const edm::Event& event, int& nBX, double& npT, double& npIT);
+			// the menu paths of the HLT path groups
+			virtual void beginRun(const edm::Run& run, const edm::EventSetup& setup) override;
+			virtual void respondToOpenInputFile(edm::FileBlock const& fb) override { checkpoint_.openFile(fb.fileName()); }
+			virtual void respondToCloseInputFile(edm::FileBlock const&) override { checkpoint_.closeFile(); }
+			virtual void endLuminosityBlock(edm::LuminosityBlock const& lumi, edm::EventSetup const&) override {
+				this->summary_.endLumi(lumi.id().run(), lumi.id().luminosityBlock());
+				checkpoint_.endLumi(lumi.id().run(), lumi.id().luminosityBlock(), checkpointTree_, summaryTree_);
+			}
+
+			edm::Handle< double >  rho_;
+			edm::EDGetTokenT<double> rhoToken_;
+			edm::EDGetTokenT<reco::VertexCollection> VertexToken_;
+			edm::EDGetTokenT<pat::JetCollection> t1jetSrc_;
+			edm::EDGetTokenT<edm::View<pat::Muon>> t1muSrc_;
+			bool t1jetUseKeys_;   // t1jetConstituents given: muons found by constituent key
+			edm::EDGetTokenT<std::vector<unsigned int> > t1jetKeyOffsets_;
+			edm::EDGetTokenT<std::vector<unsigned int> > t1jetKeys_;
+			std::vector<pku::TypeIJet> typeIJets_;
+			pku::Checkpoint checkpoint_;
+			TTree* checkpointTree_;   // the output tree, null if there is none
+			TTree* summaryTree_;      // the LumiSummary tree, null if there is none
+			bool summaryGen_;         // RunOnMC: sum the generator weights
+			edm::EDGetTokenT<GenEventInfoProduct> summaryGenToken_;
+			edm::EDGetTokenT<LHEEventProduct> summaryLheToken_;
+			bool summaryLhe_;
+			std::vector<double> lheWeights_;   // reused between events
+			std::size_t sumLheWeights_;
+			HLTConfigProvider hltConfig_;
+			edm::EDGetTokenT<edm::TriggerResults> hltToken_;
+			std::vector<std::string> hltGroups_;                 // elPaths1.., muPaths1..
+			std::vector<std::vector<std::string> > hltPatterns_; // of the configuration
+			std::vector<std::vector<std::string> > hltPaths_;    // of the menu of the run
+			edm::EDGetTokenT<edm::TriggerResults> noiseFilterToken_;
+			std::string metFilterNames_[MetFilters::badMuon];
+			edm::EDGetTokenT<bool> badMuonToken_, badChargedHadronToken_;
+			edm::EDGetTokenT<std::vector<PileupSummaryInfo> > pileupToken_;
+	};
+
+	//------------------------------------
+	inline math::XYZTLorentzVector
+	WChannel::neutrinoP4(double MetPt, double MetPhi, const TLorentzVector& lep, double mW){
+		// most central real root (type 2), the real part for complex roots
+		const pku::NeutrinoPzSolver solver(pku::NeutrinoPzSolver::MostCentral, mW);
+		double px = MetPt*cos(MetPhi);
+		double py = MetPt*sin(MetPhi);
+		double pz = solver.pz(lep.Pt()*cos(lep.Phi()), lep.Pt()*sin(lep.Phi()), lep.Pt()*sinh(lep.Eta()), lep.Energy(), px, py);
+		//dont correct pt neutrino
+		math::XYZTLorentzVector outP4(px,py,pz,sqrt(px*px+py*py+pz*pz));
+		return outP4;
+	}//end neutrinoP4
+
+	//------------------------------------
+	template<class Channel, class Logic>
+	TreeMakerCore<Channel, Logic>::TreeMakerCore(const edm::ParameterSet& iConfig)
+		:Logic(iConfig)
+	{
+		VertexToken_ =consumes<reco::VertexCollection> (iConfig.getParameter<edm::InputTag>( "vertex" ) ) ;
+		t1jetSrc_      = consumes<pat::JetCollection>(iConfig.getParameter<edm::InputTag>( "t1jetSrc") ) ;
+		t1muSrc_      = consumes<edm::View<pat::Muon>>(iConfig.getParameter<edm::InputTag>( "t1muSrc") ) ;
+		// the JetUserData module that made t1jetSrc, for its pfKeyOffsets/pfKeys products
+		t1jetUseKeys_ = iConfig.existsAs<edm::InputTag>("t1jetConstituents");
+		if (t1jetUseKeys_) {
+			const edm::InputTag constituents = iConfig.getParameter<edm::InputTag>("t1jetConstituents");
+			t1jetKeyOffsets_ = consumes<std::vector<unsigned int> >(edm::InputTag(constituents.label(), "pfKeyOffsets", constituents.process()));
+			t1jetKeys_       = consumes<std::vector<unsigned int> >(edm::InputTag(constituents.label(), "pfKeys", constituents.process()));
+		}
+		rhoToken_  = consumes<double>(iConfig.getParameter<edm::InputTag>("rho"));
+		checkpointTree_ = 0;
+		if (iConfig.existsAs<edm::ParameterSet>("checkpoint")) {
+			edm::Service<TFileService> fs;
+			checkpoint_ = pku::Checkpoint(iConfig.getParameter<edm::ParameterSet>("checkpoint"), fs->file().GetName());
+		}
+		/// the LumiSummary tree, next to the output tree
+		summaryGen_ = iConfig.getParameter<bool>("RunOnMC");
+		if (summaryGen_) summaryGenToken_ = consumes<GenEventInfoProduct>(iConfig.getParameter<edm::InputTag>("generator"));
+		summaryLhe_ = summaryGen_ && iConfig.existsAs<edm::InputTag>("lheWeights");
+		if (summaryLhe_) summaryLheToken_ = consumes<LHEEventProduct>(iConfig.getParameter<edm::InputTag>("lheWeights"));
+		sumLheWeights_ = this->summary_.vector("sumLHEWeights");
+		summaryTree_ = 0;
+		if (!iConfig.existsAs<bool>("lumiSummary") || iConfig.getParameter<bool>("lumiSummary")) {
+			edm::Service<TFileService> fs;
+			summaryTree_ = fs->make<TTree>(pku::LumiSummary::treeName(), pku::LumiSummary::treeTitle());
+		}
+		this->summary_.attach(summaryTree_);
+		/// HLT path groups, MET filters and pileup
+		hltToken_ = consumes<edm::TriggerResults>(iConfig.getParameter<edm::InputTag>("hltToken"));
+		for (unsigned i = 0; i < Channel::nElPaths + Channel::nMuPaths; i++) {
+			hltGroups_.push_back(i < Channel::nElPaths ? "elPaths" + std::to_string(i + 1)
+			                                           : "muPaths" + std::to_string(i + 1 - Channel::nElPaths));
+			hltPatterns_.push_back(iConfig.getParameter<std::vector<std::string> >(hltGroups_.back()));
+		}
+		hltPaths_.resize(hltGroups_.size());
+		noiseFilterToken_ = consumes<edm::TriggerResults>(iConfig.getParameter<edm::InputTag>("noiseFilter"));
+		metFilterNames_[MetFilters::HBHE]         = iConfig.getParameter<std::string>("noiseFilterSelection_HBHENoiseFilter");
+		metFilterNames_[MetFilters::HBHEIso]      = iConfig.getParameter<std::string>("noiseFilterSelection_HBHENoiseIsoFilter");
+		metFilterNames_[MetFilters::ECALDeadCell] = iConfig.getParameter<std::string>("noiseFilterSelection_EcalDeadCellTriggerPrimitiveFilter");
+		metFilterNames_[MetFilters::GoodVtx]      = iConfig.getParameter<std::string>("noiseFilterSelection_goodVertices");
+		metFilterNames_[MetFilters::EEBadSc]      = iConfig.getParameter<std::string>("noiseFilterSelection_eeBadScFilter");
+		// passFilter_globalTightHalo has always been the ECAL dead-cell decision,
+		// noiseFilterSelection_globalTightHaloFilter is not read
+		metFilterNames_[MetFilters::globalTightHalo] = metFilterNames_[MetFilters::ECALDeadCell];
+		if (Channel::muonMetFilters) {
+			metFilterNames_[MetFilters::MetbadMuon]    = iConfig.getParameter<std::string>("badMuonFilterSelection");
+			metFilterNames_[MetFilters::duplicateMuon] = iConfig.getParameter<std::string>("duplicateMuonFilterSelection");
+		}
+		badMuonToken_          = consumes<bool>(iConfig.getParameter<edm::InputTag>("noiseFilterSelection_badMuon"));
+		badChargedHadronToken_ = consumes<bool>(iConfig.getParameter<edm::InputTag>("noiseFilterSelection_badChargedHadron"));
+		if (summaryGen_) pileupToken_ = consumes<std::vector<PileupSummaryInfo> >(iConfig.getParameter<edm::InputTag>("pileup"));
+	}
+
+	//------------------------------------
+	template<class Channel, class Logic>
+	void TreeMakerCore<Channel, Logic>::beginRun(const edm::Run& run, const edm::EventSetup& setup) {
+		for (size_t g = 0; g < hltPaths_.size(); g++) hltPaths_[g].clear();
+		bool changed;
+		if ( !hltConfig_.init(run, setup, "HLT", changed) ) {
+			edm::LogError("HltAnalysis") << "Initialization of HLTConfigProvider failed!!";
+			return;
+		}
+		std::cout<<"\n************** HLT Information **************\n";
+		for (size_t g = 0; g < hltPaths_.size(); g++) {
+			for (size_t i = 0; i < hltPatterns_[g].size(); i++) {
+				std::vector<std::string> foundPaths = hltConfig_.matched( hltConfig_.triggerNames(), hltPatterns_[g][i] );
+				while ( !foundPaths.empty() ){
+					hltPaths_[g].push_back( foundPaths.back() );
+					foundPaths.pop_back();
+				}
+			}
+			for (size_t i = 0; i < hltPaths_[g].size(); i++) std::cout << "\n " << hltGroups_[g] << ": " << hltPaths_[g][i] << "\t" << std::endl;
+		}
+		std::cout<<"\n*********************************************\n\n";
+	}
+
+	//------------------------------------
+	template<class Channel, class Logic>
+	void TreeMakerCore<Channel, Logic>::readHltBits(const edm::Event& event, int* const bits[]) {
+		edm::Handle<edm::TriggerResults> trigRes;
+		event.getByToken(hltToken_, trigRes);
+		for (size_t g = 0; g < hltPaths_.size(); g++) {
+			for (size_t i = 0; i < hltPaths_[g].size(); i++) {
+				const int fired = (int)trigRes->accept(hltConfig_.triggerIndex(hltPaths_[g][i]));
+				if (*bits[g] < fired) *bits[g] = fired;
+			}
+		}
+	}
+
+	//------------------------------------
+	template<class Channel, class Logic>
+	void TreeMakerCore<Channel, Logic>::readMetFilters(const edm::Event& event, bool* const pass[MetFilters::nFlags]) {
+		edm::Handle<edm::TriggerResults> noiseFilterBits;
+		event.getByToken(noiseFilterToken_, noiseFilterBits);
+		const edm::TriggerNames &names = event.triggerNames(*noiseFilterBits);
+		for (unsigned int i = 0, n = noiseFilterBits->size(); i < n; ++i) {
+			const std::string& name = names.triggerName(i);
+			for (unsigned f = 0; f < MetFilters::badMuon; f++)
+				if (pass[f] && name == metFilterNames_[f]) *pass[f] = noiseFilterBits->accept(i);
+		}
+		edm::Handle<bool> badMuonResultHandle;
+		edm::Handle<bool> badChargedHadronResultHandle;
+		event.getByToken(badMuonToken_, badMuonResultHandle);
+		event.getByToken(badChargedHadronToken_, badChargedHadronResultHandle);
+		if (pass[MetFilters::badMuon]) *pass[MetFilters::badMuon] = *badMuonResultHandle;
+		if (pass[MetFilters::badChargedHadron]) *pass[MetFilters::badChargedHadron] = *badChargedHadronResultHandle;
+	}
+
+	//------------------------------------
+	template<class Channel, class Logic>
+	void TreeMakerCore<Channel, Logic>::readPileup(const edm::Event& event, int& nBX, double& npT, double& npIT) {
+		edm::Handle<std::vector<PileupSummaryInfo> > PupInfo;
+		event.getByToken(pileupToken_, PupInfo);
+		for (std::vector<PileupSummaryInfo>::const_iterator PVI = PupInfo->begin(); PVI != PupInfo->end(); ++PVI) {
+			nBX = PVI->getBunchCrossing();
+			if (nBX == 0) { // "0" is the in-time crossing, negative values are the early crossings, positive are late
+				npT = PVI->getTrueNumInteractions();
+				npIT = PVI->getPU_NumInteractions();
+			}
+		}
+	}
+
+	//------------------------------------
+	template<class Channel, class Logic>
+	void TreeMakerCore<Channel, Logic>::countEvent(const edm::Event& event) {
+		checkpoint_.event(event.id().run(), event.id().luminosityBlock(), event.id().event());
+		if (summaryGen_) {
+			edm::Handle<GenEventInfoProduct> genEvtInfo;
+			event.getByToken(summaryGenToken_, genEvtInfo);
+			this->addGenWeight(genEvtInfo->weight());
+		}
+		if (summaryLhe_) {
+			edm::Handle<LHEEventProduct> lheEvtInfo;
+			event.getByToken(summaryLheToken_, lheEvtInfo);
+			const std::vector<gen::WeightsInfo>& weights = lheEvtInfo->weights();
+			lheWeights_.resize(weights.size());
+			for (size_t i = 0; i < weights.size(); i++) lheWeights_[i] = weights[i].wgt;
+			this->summary_.add(sumLheWeights_, lheWeights_);
+		}
+	}
+
+	//------------------------------------
+	template<class Channel, class Logic>
+	void TreeMakerCore<Channel, Logic>::addTypeICorr( edm::Event const & event ){
+		event.getByToken(rhoToken_      , rho_     );
+		recordTypeIJets(event, typeIJets_);
+		this->typeICorrection(typeIJets_, event.id().run(), *(rho_.product()));
+	}
+	//------------------------------------
+	template<class Channel, class Logic>
+	void TreeMakerCore<Channel, Logic>::recordTypeIJets( edm::Event const & event, std::vector<pku::TypeIJet>& typeIJets ){
+		typeIJets.clear();
+		edm::Handle<pat::JetCollection> jets_;
+		event.getByToken(t1jetSrc_, jets_);
+		edm::Handle<edm::View<pat::Muon>> muons_;
+		event.getByToken(t1muSrc_,muons_);
+		bool skipEM_                    = true;
+		double skipEMfractionThreshold_ = 0.9;
+		bool skipMuons_                 = true;
+		std::string skipMuonSelection_string = "isGlobalMuon | isStandAloneMuon";
+		StringCutObjectSelector<reco::Candidate>* skipMuonSelection_ = new StringCutObjectSelector<reco::Candidate>(skipMuonSelection_string,true);
+
+		// with the constituent keys of the jets, the muons to subtract are the
+		// selected t1muSrc muons whose PF candidate is a constituent of the jet
+		std::unique_ptr<pku::JetConstituentKeys> constituents;
+		edm::Handle<std::vector<unsigned int> > keyOffsets, keys;
+		std::vector<std::pair<unsigned int, reco::Candidate::LorentzVector> > muonKeys;
+		if ( t1jetUseKeys_ ) {
+			event.getByToken(t1jetKeyOffsets_, keyOffsets);
+			event.getByToken(t1jetKeys_, keys);
+			constituents.reset(new pku::JetConstituentKeys(*keyOffsets, *keys));
+			if ( constituents->nJets() != jets_->size() )
+				throw cms::Exception("Configuration") << "t1jetConstituents: keys of " << constituents->nJets() << " jets for "
+					<< jets_->size() << " t1jetSrc jets; t1jetSrc must be the jets of the same JetUserData module";
+			for (const pat::Muon &muon : *muons_) {
+				if ( !(*skipMuonSelection_)(muon) || muon.numberOfSourceCandidatePtrs() == 0 ) continue;
+				const reco::CandidatePtr source = muon.sourceCandidatePtr(0);
+				if ( source.isNonnull() ) muonKeys.push_back(std::make_pair(unsigned(source.key()), muon.p4()));
+			}
+		}
+
+		for (size_t iJet = 0; iJet < jets_->size(); iJet++) {
+			const pat::Jet &jet = (*jets_)[iJet];
+			double emEnergyFraction = jet.chargedEmEnergyFraction() + jet.neutralEmEnergyFraction();
+			if ( skipEM_ && emEnergyFraction > skipEMfractionThreshold_ ) continue;
+			reco::Candidate::LorentzVector rawJetP4 = jet.correctedP4(0);
+
+			// the Z+gamma ntuples also remove reco muons within dR<0.5 of the jet;
+			// with the constituent keys one key lookup per muon replaces the cone
+			// and the constituent scan below
+			if ( !constituents && Channel::subtractMuonsInCone && skipMuons_ && jet.muonMultiplicity() != 0 ) {
+				for (const pat::Muon &muon : *muons_) {
+					if( !muon.isGlobalMuon() && !muon.isStandAloneMuon() ) continue;
+					TLorentzVector muonV; muonV.SetPtEtaPhiE(muon.p4().pt(),muon.p4().eta(),muon.p4().phi(),muon.p4().e());
+					TLorentzVector jetV; jetV.SetPtEtaPhiE(jet.p4().pt(),jet.p4().eta(),jet.p4().phi(),jet.p4().e());
+					if( muonV.DeltaR(jetV) < 0.5 ){
+						reco::Candidate::LorentzVector muonP4 = muon.p4();
+						rawJetP4 -= muonP4;
+					}
+				}
+			}
+
+			if ( skipMuons_ && (!constituents || jet.muonMultiplicity() != 0) ) {
+				rawJetP4 -= pku::typeIMuonP4(constituents.get(), iJet, muonKeys, [&jet, skipMuonSelection_]() {
+					reco::Candidate::LorentzVector muonsP4;
+					const std::vector<reco::CandidatePtr> & cands = jet.daughterPtrVector();
+					for ( std::vector<reco::CandidatePtr>::const_iterator cand = cands.begin();
+							cand != cands.end(); ++cand ) {
+						const reco::PFCandidate *pfcand = dynamic_cast<const reco::PFCandidate *>(cand->get());
+						const reco::Candidate *mu = (pfcand != 0 ? ( pfcand->muonRef().isNonnull() ? pfcand->muonRef().get() : 0) : cand->get());
+						if ( mu != 0 && (*skipMuonSelection_)(*mu) ) muonsP4 += (*cand)->p4();
+					}
+					return muonsP4;
+				});
+			}
+
+			pku::TypeIJet typeIJet;
+			typeIJet.uncorrected = jet.correctedP4(0);
+			typeIJet.subtracted  = rawJetP4;
+			typeIJet.area        = jet.jetArea();
+			typeIJets.push_back(typeIJet);
+		}
+		delete skipMuonSelection_;
+		skipMuonSelection_=0;
+	}
+	//------------------------------------
+	template<class Channel, class Logic>
+	bool TreeMakerCore<Channel, Logic>::hasMatchedPromptElectron(const reco::SuperClusterRef &sc, const edm::Handle<edm::View<pat::Electron> > &eleCol, const edm::Handle<reco::ConversionCollection> &convCol, const math::XYZPoint &beamspot,  float lxyMin, float probMin, unsigned int nHitsBeforeVtxMax) {
+		//check if a given SuperCluster matches to at least one GsfElectron having zero expected inner hits
+		//and not matching any conversion in the collection passing the quality cuts
+		if (sc.isNull()) return false;
+		for (edm::View<pat::Electron>::const_iterator it = eleCol->begin(); it!=eleCol->end(); ++it) {
+			//match electron to supercluster
+			if (it->superCluster()!=sc) continue;
+			//check expected inner hits
+			if (it->gsfTrack()->hitPattern().numberOfHits(reco::HitPattern::MISSING_INNER_HITS) > 0) continue;
+			//check if electron is matching to a conversion
+			if (ConversionTools::hasMatchedConversion(*it,convCol,beamspot)) continue;
+			return true;
+		}
+		return false;
+	}
+	//------------------------------------
+	template<class Channel, class Logic>
+	int TreeMakerCore<Channel, Logic>::matchToTruth(const reco::Photon &pho,
+			const edm::Handle<edm::View<reco::GenParticle>>
+			&genParticles, bool &ISRPho, double &dR, int &isprompt)
+	{
+		//
+		// Explicit loop and geometric matching method
+		// Find the closest status 1 gen photon to the reco photon
+		dR = 999;
+		const reco::Candidate *closestPhoton = 0;
+		int im=0;
+		for(size_t i=0; i<genParticles->size();i++){
+			const reco::Candidate *particle = &(*genParticles)[i];
+			if( abs(particle->pdgId()) != 22 || particle->status() != 1 )
+				continue;
+			double dRtmp = deltaR(pho.eta(),pho.phi(),particle->eta(),particle->phi());  
+			if( dRtmp < dR ){
+				dR = dRtmp;
+				im=i;    
+				closestPhoton = particle;
+			}
+		}
+		// See if the closest photon (if it exists) is close enough.
+		// If not, no match found.
+		if( !(closestPhoton != 0 && dR < 0.3) ) {
+			return UNMATCHED;
+			// ISRPho = false;
+		}
+		isprompt=(*genParticles)[im].isPromptFinalState();
+		// Find ID of the parent of the found generator level photon match
+		int ancestorPID = -999;
+		int ancestorStatus = -999;
+		findFirstNonPhotonMother(closestPhoton, ancestorPID, ancestorStatus);
+		// Allowed parens: quarks pdgId 1-5, or a gluon 21
+		std::vector<int> allowedParents { -1, 1, -2, 2, -3, 3, -4, 4, -5, 5, 21,-11,11,-13,13,-15,15,23,-24,24 };
+		if( !(std::find(allowedParents.begin(),
+						allowedParents.end(), ancestorPID)
+					!= allowedParents.end()) ){
+			// So it is not from g, u, d, s, c, b. Check if it is from pi0 or not.
+			if( abs(ancestorPID) == 111 )
+				return MATCHED_FROM_PI0;
+			// ISRPho =true;
+			else
+				//std::cout<<"Mother = "<<abs(ancestorPID)<<std::endl;
+				return MATCHED_FROM_OTHER_SOURCES;
+			//  ISRPho =true;
+		}
+		return MATCHED_FROM_GUDSCB;
+		//   ISRPho =true;
+	}
+	//------------------------------------
+	template<class Channel, class Logic>
+	void TreeMakerCore<Channel, Logic>::findFirstNonPhotonMother(const reco::Candidate *particle,
+			int &ancestorPID, int &ancestorStatus){
+		if( particle == 0 ){
+			printf("SimplePhotonNtupler: ERROR! null candidate pointer, this should never happen\n");
+			return;
+		}
+		// Is this the first non-photon parent? If yes, return, otherwise
+		// go deeper into recursion
+		if( abs(particle->pdgId()) == 22 ){
+			findFirstNonPhotonMother(particle->mother(0), ancestorPID, ancestorStatus);
+		}else{
+			ancestorPID = particle->pdgId();
+			ancestorStatus = particle->status();
+		}
+		return;
+	}
+
+}
+
+#endif
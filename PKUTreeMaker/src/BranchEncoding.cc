@@ -0,0 +1,52 @@
+#include "VAJets/PKUTreeMaker/interface/BranchEncoding.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace pku {
+
+	std::string Encoding::spec() const {
+		std::ostringstream ss;
+		ss.precision(17);
+		switch (kind) {
+			case Float32:   ss << "float32"; break;
+			case Truncated: ss << "trunc:" << mantissaBits; break;
+			case Fixed16:   ss << "fixed16:" << lo << ":" << hi; break;
+			case Int8:      ss << "int8"; break;
+			case Bits:      ss << "bits:" << group << ":" << offset << ":" << width; break;
+			default:        ss << "native"; break;
+		}
+		return ss.str();
+	}
+
+	Encoding Encoding::parse(const std::string& spec) {
+		std::vector<std::string> f;
+		std::string::size_type start = 0, colon;
+		while ((colon = spec.find(':', start)) != std::string::npos) {
+			f.push_back(spec.substr(start, colon - start));
+			start = colon + 1;
+		}
+		f.push_back(spec.substr(start));
+
+		Encoding e;
+		if (f[0] == "native" || f[0].empty()) return e;
+		if (f[0] == "float32" && f.size() == 1) return float32();
+		if (f[0] == "int8" && f.size() == 1) return int8();
+		if (f[0] == "trunc" && f.size() == 2) return truncated(std::atoi(f[1].c_str()));
+		if (f[0] == "fixed16" && f.size() == 3) {
+			e = fixed16(std::atof(f[1].c_str()), std::atof(f[2].c_str()));
+			if (!(e.hi > e.lo)) throw cms::Exception("Configuration") << "Encoding: empty fixed16 range in " << spec;
+			return e;
+		}
+		if (f[0] == "bits" && (f.size() == 2 || f.size() == 4)) {
+			e = bits(f[1]);
+			if (f.size() == 4) { e.offset = std::atoi(f[2].c_str()); e.width = std::atoi(f[3].c_str()); }
+			return e;
+		}
+		throw cms::Exception("Configuration") << "Encoding: cannot parse '" << spec << "'";
+	}
+
+}
@@ -0,0 +1,169 @@
+#include "VAJets/PKUTreeMaker/interface/Checkpoint.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+
+namespace pku {
+
+	namespace {
+		std::string quoted(const std::string& s) {
+			std::string out = "\"";
+			for (std::size_t i = 0; i < s.size(); i++) {
+				if (s[i] == '"' || s[i] == '\\') out += '\\';
+				if (static_cast<unsigned char>(s[i]) >= 0x20) out += s[i];
+			}
+			return out + "\"";
+		}
+
+		// the text after "key": in the JSON of a sidecar, empty if absent
+		std::string field(const std::string& json, const std::string& key) {
+			const std::string::size_type k = json.find("\"" + key + "\":");
+			if (k == std::string::npos) return "";
+			std::string::size_type p = k + key.size() + 3;
+			while (p < json.size() && json[p] == ' ') ++p;
+			return json.substr(p, json.find_first_of(",\n}", p) - p);
+		}
+
+		// the [[run, ls], ...] after "key": in the JSON of a sidecar
+		std::vector<std::pair<unsigned, unsigned> > lumiList(const std::string& json, const std::string& key) {
+			std::vector<std::pair<unsigned, unsigned> > lumis;
+			const std::string::size_type k = json.find("\"" + key + "\":");
+			if (k == std::string::npos) return lumis;
+			std::string::size_type p = json.find('[', k);
+			if (p == std::string::npos || json.compare(p, 2, "[]") == 0) return lumis;
+			const std::string::size_type end = json.find("]]", p);
+			if (end == std::string::npos) return lumis;
+			while ((p = json.find('[', p + 1)) != std::string::npos && p < end) {
+				char* next = 0;
+				const unsigned run = std::strtoul(json.c_str() + p + 1, &next, 10);
+				const unsigned ls = std::strtoul(next + 1, 0, 10);   // after the comma
+				lumis.push_back(std::make_pair(run, ls));
+			}
+			return lumis;
+		}
+	}
+
+	Checkpoint::Checkpoint()
+		: enabled_(false), segment_(0), everyLumis_(0), everySeconds_(0.),
+		  lastRun_(0), lastLs_(0), lastEvent_(0), fileEvents_(0), lumisSince_(0),
+		  checkpoints_(0), seconds_(0.), maxSeconds_(0.)
+	{
+	}
+
+	Checkpoint::Checkpoint(const edm::ParameterSet& pset, const std::string& output)
+		: enabled_(false), output_(output),
+		  sidecar_(pset.existsAs<std::string>("sidecar") ? pset.getParameter<std::string>("sidecar") : output + ".ckpt.json"),
+		  segment_(pset.existsAs<int>("segment") ? pset.getParameter<int>("segment") : 0),
+		  everyLumis_(pset.existsAs<int>("everyLumis") ? pset.getParameter<int>("everyLumis") : 0),
+		  everySeconds_(pset.existsAs<double>("everySeconds") ? pset.getParameter<double>("everySeconds") : 0.),
+		  lastRun_(0), lastLs_(0), lastEvent_(0), fileEvents_(0), lumisSince_(0),
+		  start_(Clock::now()), last_(start_), checkpoints_(0), seconds_(0.), maxSeconds_(0.)
+	{
+		if (pset.existsAs<int>("everyLumis") && pset.getParameter<int>("everyLumis") < 0)
+			throw cms::Exception("Configuration") << "Checkpoint: everyLumis must not be negative";
+		enabled_ = everyLumis_ > 0 || everySeconds_ > 0.;
+	}
+
+	void Checkpoint::openFile(const std::string& name) {
+		file_ = name;
+		fileEvents_ = 0;
+		fileLumis_.clear();
+	}
+
+	void Checkpoint::closeFile() {
+		if (!file_.empty()) closedFiles_.push_back(file_);
+		file_.clear();
+		fileEvents_ = 0;
+		fileLumis_.clear();
+	}
+
+	void Checkpoint::endLumi(unsigned run, unsigned ls, TTree* tree, TTree* summary) {
+		if (!enabled_) return;
+		fileLumis_.push_back(std::make_pair(run, ls));
+		++lumisSince_;
+		const Clock::time_point now = Clock::now();
+		const bool due = (everyLumis_ && lumisSince_ >= everyLumis_)
+			|| (everySeconds_ > 0. && std::chrono::duration<double>(now - last_).count() >= everySeconds_);
+		if (!due) return;
+
+		if (tree) tree->AutoSave("SaveSelf");
+		if (summary) summary->AutoSave("SaveSelf");
+		write(tree, summary, false);
+		last_ = Clock::now();
+		const double seconds = std::chrono::duration<double>(last_ - now).count();
+		++checkpoints_;
+		seconds_ += seconds;
+		if (seconds > maxSeconds_) maxSeconds_ = seconds;
+		lumisSince_ = 0;
+	}
+
+	void Checkpoint::finish(TTree* tree, TTree* summary) {
+		if (enabled_) write(tree, summary, true);
+	}
+
+	void Checkpoint::write(TTree* tree, TTree* summary, bool complete) {
+		const std::string tmp = sidecar_ + ".tmp";
+		{
+			std::ofstream out(tmp.c_str());
+			if (!out) throw cms::Exception("Checkpoint") << "cannot write " << tmp;
+			out << "{\n  \"output\": " << quoted(output_) << ",\n  \"segment\": " << segment_
+			    << ",\n  \"complete\": " << (complete ? "true" : "false")
+			    << ",\n  \"checkpoint\": " << checkpoints_ + (complete ? 0 : 1)
+			    << ",\n  \"entries\": " << (tree ? tree->GetEntries() : 0);
+			if (summary) out << ",\n  \"summaryEntries\": " << summary->GetEntries();
+			out
+			    << ",\n  \"last\": {\"run\": " << lastRun_ << ", \"ls\": " << lastLs_ << ", \"event\": " << lastEvent_ << "}"
+			    << ",\n  \"file\": " << quoted(file_) << ",\n  \"fileEvents\": " << fileEvents_
+			    << ",\n  \"closedFiles\": [";
+			for (std::size_t i = 0; i < closedFiles_.size(); i++) out << (i ? ", " : "") << quoted(closedFiles_[i]);
+			out << "],\n  \"lumis\": [";
+			for (std::size_t i = 0; i < fileLumis_.size(); i++) out << (i ? ", " : "") << "[" << fileLumis_[i].first << ", " << fileLumis_[i].second << "]";
+			out << "],\n  \"overhead\": {\"checkpoints\": " << checkpoints_ << ", \"total_s\": " << seconds_
+			    << ", \"max_s\": " << maxSeconds_
+			    << ", \"job_s\": " << std::chrono::duration<double>(Clock::now() - start_).count() << "}\n}\n";
+			if (!out) throw cms::Exception("Checkpoint") << "cannot write " << tmp;
+		}
+		if (std::rename(tmp.c_str(), sidecar_.c_str()) != 0)
+			throw cms::Exception("Checkpoint") << "cannot rename " << tmp << " to " << sidecar_;
+	}
+
+	void Checkpoint::printSummary(std::ostream& out) const {
+		if (!enabled_) return;
+		const double job = std::chrono::duration<double>(Clock::now() - start_).count();
+		out << "checkpoints=" << checkpoints_ << " in " << seconds_ << " s (max " << 1e3*maxSeconds_ << " ms, "
+		    << (job > 0. ? 100.*seconds_/job : 0.) << "% of " << job << " s), segment " << segment_
+		    << ", sidecar " << sidecar_ << "\n";
+	}
+
+	Checkpoint::State Checkpoint::read(const std::string& sidecar) {
+		State s;
+		s.found = false;
+		s.complete = false;
+		s.entries = -1;
+		s.summaryEntries = -1;
+		s.segment = 0;
+		std::ifstream in(sidecar.c_str());
+		if (!in) return s;
+		std::stringstream json;
+		json << in.rdbuf();
+		const std::string entries = field(json.str(), "entries");
+		if (entries.empty()) throw cms::Exception("Checkpoint") << sidecar << " has no entries";
+		s.found = true;
+		s.entries = std::atoll(entries.c_str());
+		s.complete = field(json.str(), "complete") == "true";
+		const std::string summaryEntries = field(json.str(), "summaryEntries");
+		if (!summaryEntries.empty()) s.summaryEntries = std::atoll(summaryEntries.c_str());
+		s.segment = std::atoi(field(json.str(), "segment").c_str());
+		s.lumis = lumiList(json.str(), "lumis");
+		return s;
+	}
+
+}
@@ -0,0 +1,289 @@
+#include "VAJets/PKUTreeMaker/interface/ColumnarFile.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef PKU_COLUMNAR_ZSTD
+#include <zstd.h>
+#endif
+
+namespace pku {
+
+	namespace {
+		const char kMagic[8] = { 'P', 'K', 'U', 'C', 'O', 'L', '1', 0 };
+
+		template<typename T> void put(std::vector<char>& out, T value) {
+			const char* p = reinterpret_cast<const char*>(&value);
+			out.insert(out.end(), p, p + sizeof(T));
+		}
+		void putString(std::vector<char>& out, const std::string& s) {
+			put<UShort_t>(out, s.size());
+			out.insert(out.end(), s.begin(), s.end());
+		}
+
+		struct Cursor {
+			const char* p;
+			const char* end;
+			template<typename T> T get() {
+				if (p + sizeof(T) > end) throw cms::Exception("ColumnarReader") << "truncated footer";
+				T value;
+				std::memcpy(&value, p, sizeof(T));
+				p += sizeof(T);
+				return value;
+			}
+			std::string getString() {
+				const UShort_t n = get<UShort_t>();
+				if (p + n > end) throw cms::Exception("ColumnarReader") << "truncated footer";
+				std::string s(p, n);
+				p += n;
+				return s;
+			}
+		};
+
+		template<typename T> void minMax(const char* data, std::size_t n, double& lo, double& hi) {
+			const T* v = reinterpret_cast<const T*>(data);
+			for (std::size_t i = 0; i < n; i++) {
+				const double x = v[i];
+				if (x < lo) lo = x;
+				if (x > hi) hi = x;
+			}
+		}
+
+		void statistics(char type, const std::vector<char>& data, double& lo, double& hi) {
+			lo =  std::numeric_limits<double>::infinity();
+			hi = -std::numeric_limits<double>::infinity();
+			const std::size_t n = data.size() / NtupleSchema::typeSize(type);
+			if (n == 0) return;
+			const char* p = &data[0];
+			switch (type) {
+				case 'D': minMax<double>(p, n, lo, hi); break;
+				case 'F': minMax<float>(p, n, lo, hi); break;
+				case 'I': minMax<Int_t>(p, n, lo, hi); break;
+				case 'i': minMax<UInt_t>(p, n, lo, hi); break;
+				case 'S': minMax<Short_t>(p, n, lo, hi); break;
+				case 's': minMax<UShort_t>(p, n, lo, hi); break;
+				case 'B': minMax<Char_t>(p, n, lo, hi); break;
+				case 'b': minMax<UChar_t>(p, n, lo, hi); break;
+				case 'L': minMax<Long64_t>(p, n, lo, hi); break;
+				case 'l': minMax<ULong64_t>(p, n, lo, hi); break;
+				case 'O': minMax<bool>(p, n, lo, hi); break;
+			}
+		}
+	}
+
+	//------------------------------------
+	ColumnarWriter::ColumnarWriter(const std::string& path, const NtupleSchema& schema,
+	                               std::size_t rowsPerGroup, columnar::Codec codec, int level)
+		: out_(path.c_str(), std::ios::binary | std::ios::trunc),
+		  specs_(schema.booked()), rowsPerGroup_(std::max<std::size_t>(1, rowsPerGroup)),
+		  codec_(codec), level_(level), groupRows_(0), rows_(0), offset_(0), closed_(false)
+	{
+		if (!out_) throw cms::Exception("ColumnarWriter") << "cannot open " << path;
+#ifndef PKU_COLUMNAR_ZSTD
+		if (codec_ == columnar::Zstd)
+			throw cms::Exception("Configuration") << "ColumnarWriter: zstd chunks need a build with PKU_COLUMNAR_ZSTD";
+#endif
+		for (size_t i = 0; i < specs_.size(); i++) {
+			columnar::Column c;
+			c.name   = specs_[i]->name;
+			c.type   = specs_[i]->type;
+			c.length = specs_[i]->length;
+			columns_.push_back(c);
+		}
+		buffers_.resize(specs_.size());
+		for (size_t i = 0; i < specs_.size(); i++)
+			buffers_[i].reserve(rowsPerGroup_ * NtupleSchema::typeSize(columns_[i].type) * std::max(1, columns_[i].length));
+		write(kMagic, sizeof(kMagic));
+	}
+
+	ColumnarWriter::~ColumnarWriter() {
+		try { close(); } catch (...) {}
+	}
+
+	void ColumnarWriter::write(const void* data, std::size_t size) {
+		out_.write(static_cast<const char*>(data), size);
+		if (!out_) throw cms::Exception("ColumnarWriter") << "write error after " << offset_ << " bytes";
+		offset_ += size;
+	}
+
+	void ColumnarWriter::fill() {
+		for (size_t i = 0; i < specs_.size(); i++) {
+			const char* p = static_cast<const char*>(specs_[i]->address);
+			buffers_[i].insert(buffers_[i].end(), p, p + NtupleSchema::typeSize(columns_[i].type) * std::max(1, columns_[i].length));
+		}
+		++rows_;
+		if (++groupRows_ == rowsPerGroup_) flushGroup();
+	}
+
+	void ColumnarWriter::flushGroup() {
+		if (groupRows_ == 0) return;
+		columnar::RowGroup group;
+		group.rows = groupRows_;
+		static const char padding[8] = { 0 };
+		for (size_t i = 0; i < buffers_.size(); i++) {
+			std::vector<char>& raw = buffers_[i];
+			columnar::Chunk c;
+			statistics(columns_[i].type, raw, c.min, c.max);
+			c.offset   = offset_;
+			c.rawBytes = raw.size();
+			c.codec    = columnar::None;
+#ifdef PKU_COLUMNAR_ZSTD
+			if (codec_ == columnar::Zstd && !raw.empty()) {
+				std::vector<char> packed(ZSTD_compressBound(raw.size()));
+				const std::size_t n = ZSTD_compress(&packed[0], packed.size(), &raw[0], raw.size(), level_);
+				if (ZSTD_isError(n)) throw cms::Exception("ColumnarWriter") << "zstd: " << ZSTD_getErrorName(n);
+				if (n < raw.size()) {
+					c.codec = columnar::Zstd;
+					c.storedBytes = n;
+					write(&packed[0], n);
+				}
+			}
+#endif
+			if (c.codec == columnar::None) {
+				c.storedBytes = raw.size();
+				if (!raw.empty()) write(&raw[0], raw.size());
+			}
+			if (offset_ % 8) write(padding, 8 - offset_ % 8);
+			group.chunks.push_back(c);
+			raw.clear();
+		}
+		groups_.push_back(group);
+		groupRows_ = 0;
+	}
+
+	void ColumnarWriter::close() {
+		if (closed_) return;
+		closed_ = true;
+		flushGroup();
+		std::vector<char> footer;
+		put<UInt_t>(footer, columns_.size());
+		for (size_t i = 0; i < columns_.size(); i++) {
+			putString(footer, columns_[i].name);
+			put<char>(footer, columns_[i].type);
+			put<Int_t>(footer, columns_[i].length);
+		}
+		put<UInt_t>(footer, groups_.size());
+		for (size_t g = 0; g < groups_.size(); g++) {
+			put<ULong64_t>(footer, groups_[g].rows);
+			for (size_t i = 0; i < groups_[g].chunks.size(); i++) {
+				const columnar::Chunk& c = groups_[g].chunks[i];
+				put<ULong64_t>(footer, c.offset);
+				put<ULong64_t>(footer, c.storedBytes);
+				put<ULong64_t>(footer, c.rawBytes);
+				put<UChar_t>(footer, c.codec);
+				put<double>(footer, c.min);
+				put<double>(footer, c.max);
+			}
+		}
+		put<ULong64_t>(footer, footer.size());
+		footer.insert(footer.end(), kMagic, kMagic + sizeof(kMagic));
+		write(&footer[0], footer.size());
+		out_.close();
+	}
+
+	//------------------------------------
+	ColumnarReader::ColumnarReader(const std::string& path) : fd_(-1), map_(0), size_(0) {
+		fd_ = ::open(path.c_str(), O_RDONLY);
+		if (fd_ < 0) throw cms::Exception("ColumnarReader") << "cannot open " << path;
+		struct stat st;
+		if (::fstat(fd_, &st) != 0 || st.st_size < 2 * 8 + 8) {
+			::close(fd_);
+			throw cms::Exception("ColumnarReader") << path << " is not a columnar ntuple";
+		}
+		size_ = st.st_size;
+		void* map = ::mmap(0, size_, PROT_READ, MAP_SHARED, fd_, 0);
+		if (map == MAP_FAILED) {
+			::close(fd_);
+			throw cms::Exception("ColumnarReader") << "cannot map " << path;
+		}
+		map_ = static_cast<const char*>(map);
+
+		const char* tail = map_ + size_ - sizeof(kMagic);
+		ULong64_t footerSize;
+		std::memcpy(&footerSize, tail - sizeof(ULong64_t), sizeof(ULong64_t));
+		if (std::memcmp(map_, kMagic, sizeof(kMagic)) != 0 || std::memcmp(tail, kMagic, sizeof(kMagic)) != 0
+		    || footerSize > size_ - 2 * sizeof(kMagic) - sizeof(ULong64_t)) {
+			::munmap(const_cast<char*>(map_), size_);
+			::close(fd_);
+			throw cms::Exception("ColumnarReader") << path << " is not a columnar ntuple";
+		}
+		Cursor cur = { tail - sizeof(ULong64_t) - footerSize, tail - sizeof(ULong64_t) };
+		const UInt_t nColumns = cur.get<UInt_t>();
+		for (UInt_t i = 0; i < nColumns; i++) {
+			columnar::Column c;
+			c.name   = cur.getString();
+			c.type   = cur.get<char>();
+			c.length = cur.get<Int_t>();
+			columns_.push_back(c);
+		}
+		const UInt_t nGroups = cur.get<UInt_t>();
+		for (UInt_t g = 0; g < nGroups; g++) {
+			columnar::RowGroup group;
+			group.rows = cur.get<ULong64_t>();
+			for (UInt_t i = 0; i < nColumns; i++) {
+				columnar::Chunk c;
+				c.offset      = cur.get<ULong64_t>();
+				c.storedBytes = cur.get<ULong64_t>();
+				c.rawBytes    = cur.get<ULong64_t>();
+				c.codec       = cur.get<UChar_t>();
+				c.min         = cur.get<double>();
+				c.max         = cur.get<double>();
+				if (c.offset + c.storedBytes > size_) throw cms::Exception("ColumnarReader") << "chunk beyond end of file";
+				group.chunks.push_back(c);
+			}
+			groups_.push_back(group);
+		}
+		inflated_.resize(columns_.size() * groups_.size());
+	}
+
+	ColumnarReader::~ColumnarReader() {
+		if (map_) ::munmap(const_cast<char*>(map_), size_);
+		if (fd_ >= 0) ::close(fd_);
+	}
+
+	ULong64_t ColumnarReader::rows() const {
+		ULong64_t n = 0;
+		for (size_t g = 0; g < groups_.size(); g++) n += groups_[g].rows;
+		return n;
+	}
+
+	int ColumnarReader::columnIndex(const std::string& name) const {
+		for (size_t i = 0; i < columns_.size(); i++) if (columns_[i].name == name) return i;
+		return -1;
+	}
+
+	int ColumnarReader::checkedIndex(const std::string& name, char type) const {
+		const int i = columnIndex(name);
+		if (i < 0) throw cms::Exception("ColumnarReader") << "no column " << name;
+		if (columns_[i].type != type)
+			throw cms::Exception("ColumnarReader") << "column " << name << " has type " << columns_[i].type << ", requested " << type;
+		return i;
+	}
+
+	const void* ColumnarReader::chunk(int column, std::size_t group) {
+		if (column < 0 || column >= int(columns_.size()) || group >= groups_.size())
+			throw cms::Exception("ColumnarReader") << "no chunk " << column << "/" << group;
+		const columnar::Chunk& c = groups_[group].chunks[column];
+		if (c.codec == columnar::None) return map_ + c.offset;
+		std::vector<char>& out = inflated_[group * columns_.size() + column];
+		if (out.empty() && c.rawBytes > 0) {
+#ifdef PKU_COLUMNAR_ZSTD
+			out.resize(c.rawBytes);
+			const std::size_t n = ZSTD_decompress(&out[0], out.size(), map_ + c.offset, c.storedBytes);
+			if (ZSTD_isError(n) || n != c.rawBytes)
+				throw cms::Exception("ColumnarReader") << "corrupt zstd chunk of " << columns_[column].name;
+#else
+			throw cms::Exception("ColumnarReader") << "zstd chunk of " << columns_[column].name << " needs a build with PKU_COLUMNAR_ZSTD";
+#endif
+		}
+		return out.empty() ? 0 : &out[0];
+	}
+
+}
@@ -0,0 +1,83 @@
+#include "VAJets/PKUTreeMaker/interface/EffectiveAreaTable.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace pku {
+
+	const unsigned EffectiveAreaTable::maxComponents;
+
+	EffectiveAreaTable::EffectiveAreaTable(const std::vector<std::string>& files) : nComponents_(files.size()), absEtaMax_(0.f) {
+		if (files.empty() || files.size() > maxComponents)
+			throw cms::Exception("Configuration") << "EffectiveAreaTable: " << files.size() << " files, 1 to " << maxComponents << " expected";
+		std::vector<float> areas[maxComponents];
+		for (unsigned c = 0; c < files.size(); c++) {
+			std::vector<float> lowEdges;
+			float absEtaMax = 0.f;
+			read(files[c], c, lowEdges, absEtaMax, areas[c]);
+			if (c == 0) {
+				lowEdges_ = lowEdges;
+				absEtaMax_ = absEtaMax;
+			} else if (lowEdges != lowEdges_ || absEtaMax != absEtaMax_) {
+				throw cms::Exception("Configuration") << "EffectiveAreaTable: the bins of " << files[c] << " differ from those of " << files[0];
+			}
+		}
+		areas_.assign((lowEdges_.size() + 1)*maxComponents, 0.f);
+		for (std::size_t b = 0; b < lowEdges_.size(); b++)
+			for (unsigned c = 0; c < nComponents_; c++) areas_[b*maxComponents + c] = areas[c][b];
+	}
+
+	EffectiveAreaTable::EffectiveAreaTable(const std::string& file) : EffectiveAreaTable(std::vector<std::string>(1, file)) {}
+
+	EffectiveAreaTable::EffectiveAreaTable(const std::vector<float>& lowEdges, const std::vector<float>& areas, unsigned nComponents, float absEtaMax)
+		: nComponents_(nComponents), lowEdges_(lowEdges), absEtaMax_(absEtaMax) {
+		if (nComponents == 0 || nComponents > maxComponents || areas.size() != lowEdges.size()*nComponents)
+			throw cms::Exception("Configuration") << "EffectiveAreaTable: " << areas.size() << " areas for " << lowEdges.size()
+				<< " bins of " << nComponents << " components";
+		areas_.assign((lowEdges_.size() + 1)*maxComponents, 0.f);
+		for (std::size_t b = 0; b < lowEdges_.size(); b++)
+			for (unsigned c = 0; c < nComponents_; c++) areas_[b*maxComponents + c] = areas[b*nComponents + c];
+	}
+
+	EffectiveAreaTable EffectiveAreaTable::photonSpring16() {
+		static const float lowEdges[] = { 0.0, 1.0, 1.479, 2.0, 2.2, 2.3, 2.4 };
+		//                              charged  neutral  photons
+		static const float areas[] = { 0.0360,  0.0597,  0.1210,
+		                               0.0377,  0.0807,  0.1107,
+		                               0.0306,  0.0629,  0.0699,
+		                               0.0283,  0.0197,  0.1056,
+		                               0.0254,  0.0184,  0.1457,
+		                               0.0217,  0.0284,  0.1719,
+		                               0.0167,  0.0591,  0.1998 };
+		const std::size_t nBins = sizeof(lowEdges)/sizeof(lowEdges[0]);
+		return EffectiveAreaTable(std::vector<float>(lowEdges, lowEdges + nBins), std::vector<float>(areas, areas + 3*nBins),
+		                          3, std::numeric_limits<float>::infinity());
+	}
+
+	void EffectiveAreaTable::read(const std::string& file, unsigned component, std::vector<float>& lowEdges, float& absEtaMax, std::vector<float>& areas) {
+		std::ifstream in(file.c_str());
+		if (!in) throw cms::Exception("Configuration") << "EffectiveAreaTable: cannot open " << file;
+		std::string line;
+		while (std::getline(in, line)) {
+			const std::string::size_type hash = line.find('#');
+			if (hash != std::string::npos) line.erase(hash);
+			std::istringstream fields(line);
+			float lo, hi, area;
+			if (!(fields >> lo)) continue;
+			if (!(fields >> hi >> area) || hi <= lo)
+				throw cms::Exception("Configuration") << "EffectiveAreaTable: bad line \"" << line << "\" in " << file;
+			// the bins must be contiguous, as EffectiveAreas requires
+			if (!lowEdges.empty() && std::fabs(lo - absEtaMax) > 1e-6)
+				throw cms::Exception("Configuration") << "EffectiveAreaTable: gap or overlap at |eta| = " << lo << " in " << file;
+			lowEdges.push_back(lo);
+			absEtaMax = hi;
+			areas.push_back(area);
+		}
+		if (lowEdges.empty()) throw cms::Exception("Configuration") << "EffectiveAreaTable: no bins in " << file;
+	}
+
+}
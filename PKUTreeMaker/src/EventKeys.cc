@@ -0,0 +1,95 @@
+#include "VAJets/PKUTreeMaker/interface/EventKeys.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TTree.h"
+
+#include <string>
+
+namespace pku {
+
+	unsigned long long EventKeySet::mix(unsigned long long x) {
+		// splitmix64 finalizer
+		x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+		x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+		return x ^ (x >> 31);
+	}
+
+	void EventKeySet::grow(Table& t) {
+		std::vector<unsigned long long> words(t.words.empty() ? 64 : 2*t.words.size(), 0ULL);
+		std::vector<unsigned char> owners(words.size(), 0);
+		const std::size_t mask = words.size() - 1;
+		for (std::size_t i = 0; i < t.words.size(); i++) {
+			if (!t.words[i]) continue;
+			std::size_t j = mix(t.words[i]) & mask;
+			while (words[j]) j = (j + 1) & mask;
+			words[j] = t.words[i];
+			owners[j] = t.owners[i];
+		}
+		t.words.swap(words);
+		t.owners.swap(owners);
+	}
+
+	int EventKeySet::insert(unsigned run, unsigned ls, unsigned long long event, unsigned char owner) {
+		if (ls >= (1U << 24) || event >= (1ULL << 40)) {
+			const std::pair<std::map<std::tuple<unsigned, unsigned, unsigned long long>, unsigned char>::iterator, bool> in =
+				overflow_.insert(std::make_pair(std::make_tuple(run, ls, event), owner));
+			if (!in.second) return in.first->second;
+			++size_;
+			return -1;
+		}
+		Table& t = runs_[run];
+		if (2*(t.used + 1) > t.words.size()) grow(t);
+		const unsigned long long word = ((static_cast<unsigned long long>(ls) << 40) | event) + 1;
+		const std::size_t mask = t.words.size() - 1;
+		std::size_t j = mix(word) & mask;
+		while (t.words[j]) {
+			if (t.words[j] == word) return t.owners[j];
+			j = (j + 1) & mask;
+		}
+		t.words[j] = word;
+		t.owners[j] = owner;
+		++t.used;
+		++size_;
+		return -1;
+	}
+
+	std::size_t EventKeySet::memoryBytes() const {
+		std::size_t bytes = 0;
+		for (std::unordered_map<unsigned, Table>::const_iterator r = runs_.begin(); r != runs_.end(); ++r)
+			bytes += sizeof(Table) + r->second.words.capacity()*(sizeof(unsigned long long) + 1);
+		return bytes + overflow_.size()*64;
+	}
+
+	void EventKeySet::clear() {
+		std::unordered_map<unsigned, Table>().swap(runs_);
+		overflow_.clear();
+		size_ = 0;
+	}
+
+	EventKeyReader::EventKeyReader(TTree* tree) {
+		const char* names[3] = { "run", "ls", "event" };
+		for (int i = 0; i < 3; i++) {
+			branches_[i] = tree->GetBranch(names[i]);
+			leaves_[i] = tree->GetLeaf(names[i]);
+			if (!branches_[i] || !leaves_[i])
+				throw cms::Exception("EventKeyReader") << "no branch " << names[i] << " in tree " << tree->GetName();
+		}
+	}
+
+	unsigned EventKeyReader::run(Long64_t entry) {
+		branches_[0]->GetEntry(entry);
+		return static_cast<unsigned>(leaves_[0]->GetValue());
+	}
+
+	void EventKeyReader::key(Long64_t entry, unsigned& run, unsigned& ls, unsigned long long& event) {
+		for (int i = 0; i < 3; i++) branches_[i]->GetEntry(entry);
+		run = static_cast<unsigned>(leaves_[0]->GetValue());
+		ls = static_cast<unsigned>(leaves_[1]->GetValue());
+		// the tree makers write event/I: undo the sign of the event numbers above 2^31
+		event = static_cast<unsigned long long>(static_cast<Long64_t>(leaves_[2]->GetValue()));
+		if (std::string(leaves_[2]->GetTypeName()) == "Int_t") event &= 0xffffffffULL;
+	}
+
+}
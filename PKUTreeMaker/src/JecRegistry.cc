@@ -0,0 +1,95 @@
+#include "VAJets/PKUTreeMaker/interface/JecRegistry.h"
+
+#include "CondFormats/JetMETObjects/interface/FactorizedJetCorrector.h"
+#include "CondFormats/JetMETObjects/interface/JetCorrectorParameters.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <algorithm>
+#include <limits>
+#include <ostream>
+
+namespace pku {
+
+	JecRegistry::JecRegistry(const edm::ParameterSet& iConfig, const std::string& payloadName, const std::string& eraKey)
+		: name_(payloadName), hasFallback_(false), current_(-1), cacheFirst_(0), cacheLast_(0), switches_(0)
+	{
+		const std::string key = eraKey.empty() ? payloadName : eraKey;
+		if (iConfig.existsAs<std::vector<edm::ParameterSet>>("jecEras")) {
+			const std::vector<edm::ParameterSet> eras = iConfig.getParameter<std::vector<edm::ParameterSet>>("jecEras");
+			for (size_t i = 0; i < eras.size(); i++) {
+				Era era;
+				era.firstRun = eras[i].getParameter<unsigned>("firstRun");
+				era.lastRun  = eras[i].getParameter<unsigned>("lastRun");
+				era.payloads = eras[i].getParameter<std::vector<std::string>>(key);
+				era.calls    = 0;
+				if (era.lastRun < era.firstRun || era.payloads.empty())
+					throw cms::Exception("Configuration") << "JecRegistry: invalid jecEras entry " << i << " for " << key;
+				eras_.push_back(std::move(era));
+			}
+			std::sort(eras_.begin(), eras_.end(), [](const Era& a, const Era& b) { return a.firstRun < b.firstRun; });
+			for (size_t i = 1; i < eras_.size(); i++) {
+				if (eras_[i].firstRun <= eras_[i-1].lastRun)
+					throw cms::Exception("Configuration") << "JecRegistry: jecEras runs " << eras_[i-1].firstRun << "-" << eras_[i-1].lastRun
+						<< " and " << eras_[i].firstRun << "-" << eras_[i].lastRun << " overlap";
+			}
+		}
+		std::vector<std::string> flat;
+		if (iConfig.existsAs<std::vector<std::string>>(payloadName)) flat = iConfig.getParameter<std::vector<std::string>>(payloadName);
+		if (!flat.empty()) {
+			Era era;
+			era.firstRun = 0;
+			era.lastRun  = std::numeric_limits<unsigned>::max();
+			era.payloads = flat;
+			era.calls    = 0;
+			eras_.push_back(std::move(era));
+			hasFallback_ = true;
+		}
+		if (eras_.empty())
+			throw cms::Exception("Configuration") << "JecRegistry: neither " << payloadName << " nor jecEras gives JEC payloads";
+	}
+
+	JecRegistry::~JecRegistry() {}
+
+	void JecRegistry::lookup(unsigned run) {
+		const size_t n = eras_.size() - (hasFallback_ ? 1 : 0);
+		size_t lo = 0, hi = n;
+		while (lo < hi) {
+			const size_t mid = (lo + hi) / 2;
+			if (eras_[mid].lastRun < run) lo = mid + 1;
+			else hi = mid;
+		}
+		if (lo < n && eras_[lo].firstRun <= run) {
+			current_ = lo;
+			cacheFirst_ = eras_[lo].firstRun;
+			cacheLast_  = eras_[lo].lastRun;
+		} else if (hasFallback_) {
+			current_ = n;
+			cacheFirst_ = cacheLast_ = run;
+		} else {
+			throw cms::Exception("Configuration") << "JecRegistry: run " << run << " is not covered by any jecEras entry of " << name_;
+		}
+		++switches_;
+	}
+
+	void JecRegistry::compile(Era& era) {
+		std::vector<JetCorrectorParameters> vPar;
+		for (size_t i = 0; i < era.payloads.size(); i++) vPar.push_back(JetCorrectorParameters(era.payloads[i]));
+		era.full.reset(new FactorizedJetCorrector(vPar));
+		vPar.erase(vPar.begin() + 1, vPar.end());
+		era.offset.reset(new FactorizedJetCorrector(vPar));
+	}
+
+	void JecRegistry::printSummary(std::ostream& out) const {
+		out << name_ << ": " << eras_.size() << " payload set(s), " << switches_ << " run-range switch(es)\n";
+		for (size_t i = 0; i < eras_.size(); i++) {
+			const Era& era = eras_[i];
+			out << "  ";
+			if (hasFallback_ && i + 1 == eras_.size()) out << "default";
+			else out << era.firstRun << "-" << era.lastRun;
+			out << "  " << era.payloads.front() << (era.payloads.size() > 1 ? " ..." : "")
+			    << "  " << era.calls << " calls" << (era.full ? "" : " (never loaded)") << "\n";
+		}
+	}
+
+}
@@ -0,0 +1,16 @@
+#include "VAJets/PKUTreeMaker/interface/JetConstituentKeys.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+namespace pku {
+
+	JetConstituentKeys::JetConstituentKeys(const std::vector<unsigned int>& offsets, const std::vector<unsigned int>& keys)
+		: offsets_(offsets.empty() ? 0 : &offsets[0]), keys_(keys.empty() ? 0 : &keys[0]), nJets_(offsets.empty() ? 0 : offsets.size() - 1) {
+		if (offsets.empty() || offsets.front() != 0 || offsets.back() != keys.size())
+			throw cms::Exception("LogicError") << "JetConstituentKeys: " << offsets.size() << " offsets do not describe " << keys.size() << " keys";
+		for (std::size_t i = 0; i < nJets_; i++)
+			if (offsets[i] > offsets[i + 1])
+				throw cms::Exception("LogicError") << "JetConstituentKeys: decreasing offsets at jet " << i;
+	}
+
+}
@@ -0,0 +1,151 @@
+#include "VAJets/PKUTreeMaker/interface/LumiMask.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+namespace pku {
+
+	namespace {
+		// minimal reader for the {"run": [[a, b], ...], ...} certification format
+		class JsonCursor {
+			public:
+				explicit JsonCursor(const std::string& text) : text_(text), pos_(0) {}
+
+				bool peek(char c) { skip(); return pos_ < text_.size() && text_[pos_] == c; }
+				bool accept(char c) { if (!peek(c)) return false; ++pos_; return true; }
+				void expect(char c) {
+					if (!peek(c)) fail(std::string("expected '") + c + "'");
+					++pos_;
+				}
+				unsigned number() {
+					skip();
+					const std::string::size_type start = pos_;
+					while (pos_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+					if (pos_ == start) fail("expected a number");
+					return std::strtoul(text_.c_str() + start, 0, 10);
+				}
+				unsigned quotedNumber() {
+					expect('"');
+					const unsigned n = number();
+					expect('"');
+					return n;
+				}
+				void end() { skip(); if (pos_ != text_.size()) fail("trailing characters"); }
+
+			private:
+				void skip() { while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) ++pos_; }
+				void fail(const std::string& what) const {
+					throw cms::Exception("Configuration") << "LumiMask: " << what << " at character " << pos_ << " of the JSON";
+				}
+
+				const std::string& text_;
+				std::string::size_type pos_;
+		};
+	}
+
+	LumiMask::LumiMask() : offset_(1, 0), cacheRun_(0), cacheLo_(1), cacheHi_(0), cacheIn_(false) {}
+
+	LumiMask::LumiMask(const std::string& jsonFile) : LumiMask() {
+		std::ifstream in(jsonFile.c_str());
+		if (!in) throw cms::Exception("Configuration") << "LumiMask: cannot open " << jsonFile;
+		std::stringstream ss;
+		ss << in.rdbuf();
+		parse(ss.str());
+	}
+
+	void LumiMask::parse(const std::string& json) {
+		std::map<unsigned, std::vector<std::pair<unsigned, unsigned> > > table;
+		JsonCursor cur(json);
+		cur.expect('{');
+		if (!cur.peek('}')) {
+			do {
+				std::vector<std::pair<unsigned, unsigned> >& ranges = table[cur.quotedNumber()];
+				cur.expect(':');
+				cur.expect('[');
+				if (!cur.peek(']')) {
+					do {
+						cur.expect('[');
+						const unsigned first = cur.number();
+						cur.expect(',');
+						const unsigned last = cur.number();
+						cur.expect(']');
+						if (last < first) throw cms::Exception("Configuration") << "LumiMask: empty lumi range [" << first << ", " << last << "]";
+						ranges.push_back(std::make_pair(first, last));
+					} while (cur.accept(','));
+				}
+				cur.expect(']');
+			} while (cur.accept(','));
+		}
+		cur.expect('}');
+		cur.end();
+
+		runs_.clear();
+		offset_.assign(1, 0);
+		lumis_.clear();
+		for (std::map<unsigned, std::vector<std::pair<unsigned, unsigned> > >::iterator it = table.begin(); it != table.end(); ++it) {
+			std::vector<std::pair<unsigned, unsigned> >& ranges = it->second;
+			if (ranges.empty()) continue;
+			std::sort(ranges.begin(), ranges.end());
+			runs_.push_back(it->first);
+			lumis_.push_back(ranges[0]);
+			for (size_t i = 1; i < ranges.size(); i++) {
+				// merge overlapping and adjacent intervals
+				if (ranges[i].first <= lumis_.back().second + 1) lumis_.back().second = std::max(lumis_.back().second, ranges[i].second);
+				else lumis_.push_back(ranges[i]);
+			}
+			offset_.push_back(lumis_.size());
+		}
+		cacheRun_ = 0; cacheLo_ = 1; cacheHi_ = 0;
+	}
+
+	int LumiMask::runIndex(unsigned run) const {
+		std::vector<unsigned>::const_iterator it = std::lower_bound(runs_.begin(), runs_.end(), run);
+		return (it != runs_.end() && *it == run) ? int(it - runs_.begin()) : -1;
+	}
+
+	bool LumiMask::hasRun(unsigned run) const { return runIndex(run) >= 0; }
+
+	bool LumiMask::lookup(unsigned run, unsigned lumi) {
+		cacheRun_ = run;
+		const int r = runIndex(run);
+		if (r < 0) {
+			cacheLo_ = 0;
+			cacheHi_ = std::numeric_limits<unsigned>::max();
+			return cacheIn_ = false;
+		}
+		std::vector<std::pair<unsigned, unsigned> >::const_iterator begin = lumis_.begin() + offset_[r], end = lumis_.begin() + offset_[r+1];
+		// first interval ending at or after lumi
+		std::vector<std::pair<unsigned, unsigned> >::const_iterator it = std::lower_bound(begin, end, lumi,
+			[](const std::pair<unsigned, unsigned>& range, unsigned l) { return range.second < l; });
+		if (it != end && it->first <= lumi) {
+			cacheLo_ = it->first;
+			cacheHi_ = it->second;
+			return cacheIn_ = true;
+		}
+		cacheLo_ = (it == begin) ? 0 : (it - 1)->second + 1;
+		cacheHi_ = (it == end) ? std::numeric_limits<unsigned>::max() : it->first - 1;
+		return cacheIn_ = false;
+	}
+
+	unsigned long long LumiMask::nLumis(unsigned run) const {
+		const int r = runIndex(run);
+		if (r < 0) return 0;
+		unsigned long long n = 0;
+		for (unsigned i = offset_[r]; i < offset_[r+1]; i++) n += lumis_[i].second - lumis_[i].first + 1;
+		return n;
+	}
+
+	unsigned long long LumiMask::nLumis() const {
+		unsigned long long n = 0;
+		for (size_t i = 0; i < lumis_.size(); i++) n += lumis_[i].second - lumis_[i].first + 1;
+		return n;
+	}
+
+}
@@ -0,0 +1,91 @@
+#include "VAJets/PKUTreeMaker/interface/LumiSummary.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <ostream>
+
+namespace pku {
+
+	LumiSummary::LumiSummary()
+		: tree_(0), filled_(false), run_(0), ls_(0), events_(0), totalEvents_(0), lumis_(0)
+	{
+	}
+
+	void LumiSummary::attach(TTree* tree) {
+		if (filled_) throw cms::Exception("LumiSummary") << "attach() after the first entry";
+		tree_ = tree;
+		if (!tree_) return;
+		tree_->Branch("run", &run_, "run/i");
+		tree_->Branch("ls", &ls_, "ls/i");
+		tree_->Branch("events", &events_, "events/l");
+		for (std::size_t i = 0; i < names_.size(); i++) book(i);
+		for (std::size_t i = 0; i < vectorNames_.size(); i++) bookVector(i);
+	}
+
+	std::size_t LumiSummary::counter(const std::string& name) {
+		if (filled_) throw cms::Exception("LumiSummary") << "counter " << name << " booked after the first entry";
+		names_.push_back(name);
+		values_.push_back(0.);
+		totals_.push_back(0.);
+		if (tree_) book(names_.size() - 1);
+		return names_.size() - 1;
+	}
+
+	std::size_t LumiSummary::vector(const std::string& name) {
+		if (filled_) throw cms::Exception("LumiSummary") << "vector " << name << " booked after the first entry";
+		vectorNames_.push_back(name);
+		vectors_.push_back(std::vector<double>());
+		vectorAddresses_.push_back(&vectors_.back());
+		vectorTotals_.push_back(std::vector<double>());
+		if (tree_) bookVector(vectorNames_.size() - 1);
+		return vectorNames_.size() - 1;
+	}
+
+	void LumiSummary::book(std::size_t i) {
+		tree_->Branch(names_[i].c_str(), &values_[i], (names_[i] + "/D").c_str());
+	}
+
+	void LumiSummary::bookVector(std::size_t i) {
+		tree_->Branch(vectorNames_[i].c_str(), &vectorAddresses_[i]);
+	}
+
+	void LumiSummary::add(std::size_t i, const std::vector<double>& values) {
+		std::vector<double>& sums = vectors_[i];
+		if (sums.size() < values.size()) sums.resize(values.size(), 0.);
+		for (std::size_t j = 0; j < values.size(); j++) sums[j] += values[j];
+	}
+
+	void LumiSummary::endLumi(unsigned run, unsigned ls) {
+		run_ = run;
+		ls_ = ls;
+		if (tree_) {
+			tree_->Fill();
+			filled_ = true;
+		}
+		++lumis_;
+		totalEvents_ += events_;
+		events_ = 0;
+		for (std::size_t i = 0; i < values_.size(); i++) {
+			totals_[i] += values_[i];
+			values_[i] = 0.;
+		}
+		for (std::size_t i = 0; i < vectors_.size(); i++) {
+			std::vector<double>& total = vectorTotals_[i];
+			if (total.size() < vectors_[i].size()) total.resize(vectors_[i].size(), 0.);
+			for (std::size_t j = 0; j < vectors_[i].size(); j++) total[j] += vectors_[i][j];
+			vectors_[i].clear();
+		}
+	}
+
+	void LumiSummary::printSummary(std::ostream& out) const {
+		// the totals include the block still open, e.g. in a replay without blocks
+		out << "lumi summary: " << lumis_ << " lumis" << (tree_ ? "" : " (no tree)") << ", events=" << totalEvents_ + events_;
+		for (std::size_t i = 0; i < names_.size(); i++) out << " " << names_[i] << "=" << totals_[i] + values_[i];
+		for (std::size_t i = 0; i < vectorNames_.size(); i++)
+			out << " " << vectorNames_[i] << "[" << std::max(vectorTotals_[i].size(), vectors_[i].size()) << "]";
+		out << "\n";
+	}
+
+}
@@ -0,0 +1,62 @@
+#include "VAJets/PKUTreeMaker/interface/NeutrinoPzSolver.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+namespace pku {
+
+	namespace {
+		// sin(theta*) of the lepton in the W frame is 2 |p_l x p_W| / (|p_W| mW);
+		// returns cos^2(theta*), negative when unphysical
+		inline double cos2ThetaStar(double pxl, double pyl, double pzl, double pxw, double pyw, double pzw, double mW) {
+			const double w2 = pxw*pxw + pyw*pyw + pzw*pzw;
+			const double l2 = pxl*pxl + pyl*pyl + pzl*pzl;
+			const double dot = pxl*pxw + pyl*pyw + pzl*pzw;
+			const double perp2 = w2 > 0. ? l2 - dot*dot/w2 : l2;
+			return 1. - 4.*perp2/(mW*mW);
+		}
+	}
+
+	template<NeutrinoPzSolver::RootChoice C>
+	void NeutrinoPzSolver::solveAll(std::size_t n, const double* pxl, const double* pyl, const double* pzl, const double* El,
+	                                double metPx, double metPy, double* pz, unsigned char* complex) const {
+		const double met2 = metPx*metPx + metPy*metPy;
+		for (std::size_t i = 0; i < n; i++) {
+			const double a = mW_*mW_ + 2.*(pxl[i]*metPx + pyl[i]*metPy);
+			const double A = 4.*(El[i]*El[i] - pzl[i]*pzl[i]);
+			const double B = -4.*a*pzl[i];
+			const double Cq = 4.*El[i]*El[i]*met2 - a*a;
+			const double disc = B*B - 4.*A*Cq;
+			const double root = std::sqrt(disc > 0. ? disc : 0.);
+			const double sol1 = (-B + root)/(2.*A);
+			const double sol2 = (-B - root)/(2.*A);
+
+			double chosen;
+			if (C == ClosestThenCentral || C == ClosestToLepton) {
+				chosen = std::fabs(sol2 - pzl[i]) < std::fabs(sol1 - pzl[i]) ? sol2 : sol1;
+				if (C == ClosestThenCentral)
+					chosen = std::fabs(chosen) > 300. ? (std::fabs(sol1) < std::fabs(sol2) ? sol1 : sol2) : chosen;
+			} else if (C == MostCentral) {
+				chosen = std::fabs(sol1) < std::fabs(sol2) ? sol1 : sol2;
+			} else {
+				const double c1 = cos2ThetaStar(pxl[i], pyl[i], pzl[i], pxl[i] + metPx, pyl[i] + metPy, pzl[i] + sol1, mW_);
+				const double c2 = cos2ThetaStar(pxl[i], pyl[i], pzl[i], pxl[i] + metPx, pyl[i] + metPy, pzl[i] + sol2, mW_);
+				// the original compared sqrt(c): an unphysical c (NaN) never wins
+				chosen = (c1 >= 0. && (c2 < 0. || c1 > c2)) ? sol1 : sol2;
+			}
+			pz[i] = disc < 0. ? -B/(2.*A) : chosen;
+			if (complex) complex[i] = disc < 0.;
+		}
+	}
+
+	void NeutrinoPzSolver::solve(std::size_t n, const double* pxl, const double* pyl, const double* pzl, const double* El,
+	                             double metPx, double metPy, double* pz, unsigned char* complex) const {
+		switch (choice_) {
+			case ClosestThenCentral: solveAll<ClosestThenCentral>(n, pxl, pyl, pzl, El, metPx, metPy, pz, complex); break;
+			case ClosestToLepton:    solveAll<ClosestToLepton>(n, pxl, pyl, pzl, El, metPx, metPy, pz, complex); break;
+			case MostCentral:        solveAll<MostCentral>(n, pxl, pyl, pzl, El, metPx, metPy, pz, complex); break;
+			case MaxCosTheta:        solveAll<MaxCosTheta>(n, pxl, pyl, pzl, El, metPx, metPy, pz, complex); break;
+			default: throw cms::Exception("Configuration") << "NeutrinoPzSolver: unknown root choice " << int(choice_);
+		}
+	}
+
+}
@@ -0,0 +1,205 @@
+#include "VAJets/PKUTreeMaker/interface/NtupleReader.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TList.h"
+#include "TNamed.h"
+#include "TObjArray.h"
+#include "TTree.h"
+
+#include <cstring>
+
+namespace pku {
+
+	namespace {
+		char leafCode(const std::string& typeName) {
+			if (typeName == "Double_t")  return 'D';
+			if (typeName == "Float_t")   return 'F';
+			if (typeName == "Int_t")     return 'I';
+			if (typeName == "UInt_t")    return 'i';
+			if (typeName == "Short_t")   return 'S';
+			if (typeName == "UShort_t")  return 's';
+			if (typeName == "Char_t")    return 'B';
+			if (typeName == "UChar_t")   return 'b';
+			if (typeName == "Long64_t")  return 'L';
+			if (typeName == "ULong64_t") return 'l';
+			if (typeName == "Bool_t")    return 'O';
+			return 0;
+		}
+	}
+
+	double NtupleColumn::value(int i) const {
+		const char* p = &buffer[0];
+		switch (type) {
+			case 'D': return reinterpret_cast<const double*>(p)[i];
+			case 'F': return reinterpret_cast<const float*>(p)[i];
+			case 'I': return reinterpret_cast<const Int_t*>(p)[i];
+			case 'i': return reinterpret_cast<const UInt_t*>(p)[i];
+			case 'S': return reinterpret_cast<const Short_t*>(p)[i];
+			case 's': return reinterpret_cast<const UShort_t*>(p)[i];
+			case 'B': return reinterpret_cast<const Char_t*>(p)[i];
+			case 'b': return reinterpret_cast<const UChar_t*>(p)[i];
+			case 'L': return reinterpret_cast<const Long64_t*>(p)[i];
+			case 'l': return reinterpret_cast<const ULong64_t*>(p)[i];
+			default:  return reinterpret_cast<const bool*>(p)[i];
+		}
+	}
+
+	NtupleReader::NtupleReader(TTree* tree) : tree_(tree) {
+		if (!tree_) throw cms::Exception("NtupleReader") << "null tree";
+	}
+
+	Encoding NtupleReader::encoding(const std::string& name) const {
+		TList* info = tree_->GetUserInfo();
+		const TObject* spec = info ? info->FindObject(name.c_str()) : 0;
+		return spec ? Encoding::parse(spec->GetTitle()) : Encoding();
+	}
+
+	void NtupleReader::attach(const std::string& name, void* address, char type, int length) {
+		Encoding enc = encoding(name);
+		if (enc.kind == Encoding::Native) {
+			tree_->SetBranchAddress(name.c_str(), address);
+			return;
+		}
+		Binding b;
+		b.name     = name;
+		b.encoding = enc;
+		b.address  = address;
+		b.type     = type;
+		b.length   = length;
+		b.group    = -1;
+		if (enc.kind == Encoding::Bits) {
+			if (type != 'O') throw cms::Exception("NtupleReader") << name << " is bit packed and must be bound to bool";
+			size_t g = 0;
+			while (g < groups_.size() && groups_[g].name != enc.group) ++g;
+			if (g == groups_.size()) {
+				TList* info = tree_->GetUserInfo();
+				const TObject* word = info ? info->FindObject(enc.group.c_str()) : 0;
+				const std::string title = word ? word->GetTitle() : "";
+				if (title.size() != 6 || title.compare(0, 5, "word:") != 0)
+					throw cms::Exception("NtupleReader") << "no bit group " << enc.group << " for " << name;
+				Group group;
+				group.name = enc.group;
+				group.type = title[5];
+				group.buffer.assign(NtupleSchema::typeSize(group.type), 0);
+				groups_.push_back(group);
+				tree_->SetBranchAddress(enc.group.c_str(), &groups_.back().buffer[0]);
+			}
+			b.group = g;
+		} else {
+			b.buffer.assign(NtupleSchema::typeSize(enc.storedType(type)) * (length > 0 ? length : 1), 0);
+		}
+		bindings_.push_back(b);
+		if (b.group < 0) tree_->SetBranchAddress(name.c_str(), &bindings_.back().buffer[0]);
+	}
+
+	void NtupleReader::store(void* address, char type, int i, double value) {
+		switch (type) {
+			case 'D': static_cast<double*>(address)[i] = value; break;
+			case 'F': static_cast<float*>(address)[i] = static_cast<float>(value); break;
+			case 'I': static_cast<int*>(address)[i] = static_cast<int>(value); break;
+			case 'i': static_cast<unsigned int*>(address)[i] = static_cast<unsigned int>(value); break;
+			case 'S': static_cast<short*>(address)[i] = static_cast<short>(value); break;
+			default:
+				throw cms::Exception("NtupleReader") << "cannot decode into leaf type " << type;
+		}
+	}
+
+	void NtupleReader::bind(NtupleColumn& c) {
+		c.buffer.assign(NtupleSchema::typeSize(c.type) * c.size(), 0);
+		void* p = &c.buffer[0];
+		switch (c.type) {
+			case 'D': bind(c.name, static_cast<double*>(p), c.length); break;
+			case 'F': bind(c.name, static_cast<float*>(p), c.length); break;
+			case 'I': bind(c.name, static_cast<int*>(p), c.length); break;
+			case 'i': bind(c.name, static_cast<unsigned int*>(p), c.length); break;
+			case 'S': bind(c.name, static_cast<short*>(p), c.length); break;
+			case 's': bind(c.name, static_cast<unsigned short*>(p), c.length); break;
+			case 'B': bind(c.name, static_cast<char*>(p), c.length); break;
+			case 'b': bind(c.name, static_cast<unsigned char*>(p), c.length); break;
+			case 'L': bind(c.name, static_cast<Long64_t*>(p), c.length); break;
+			case 'l': bind(c.name, static_cast<ULong64_t*>(p), c.length); break;
+			default:  bind(c.name, static_cast<bool*>(p), c.length); break;
+		}
+	}
+
+	std::vector<NtupleColumn> NtupleReader::bindColumns(const BranchSelector& selector, std::vector<std::string>& skipped) {
+		std::vector<NtupleColumn> out;
+		TList* info = tree_->GetUserInfo();
+		TObjArray* branches = tree_->GetListOfBranches();
+		for (int i = 0; i < branches->GetEntriesFast(); i++) {
+			TBranch* branch = static_cast<TBranch*>(branches->At(i));
+			const std::string name = branch->GetName();
+			const TObject* spec = info ? info->FindObject(name.c_str()) : 0;
+			if (spec && std::strncmp(spec->GetTitle(), "word:", 5) == 0) continue;   // bit group, bound per member
+			if (!selector.selected(name)) { tree_->SetBranchStatus(name.c_str(), false); continue; }
+			TLeaf* leaf = static_cast<TLeaf*>(branch->GetListOfLeaves()->At(0));
+			const char type = leaf ? leafCode(leaf->GetTypeName()) : 0;
+			if (!leaf || branch->GetListOfLeaves()->GetEntriesFast() != 1 || leaf->GetLeafCount() || !type) {
+				skipped.push_back(name);
+				tree_->SetBranchStatus(name.c_str(), false);
+				continue;
+			}
+			NtupleColumn c;
+			c.name = name;
+			c.length = leaf->GetLenStatic() > 1 ? leaf->GetLenStatic() : 0;
+			c.type = encoding(name).kind == Encoding::Native ? type : 'D';
+			out.push_back(c);
+		}
+		if (info) {
+			TIter next(info);
+			while (TObject* spec = next()) {
+				if (std::strncmp(spec->GetTitle(), "bits:", 5) != 0 || !selector.selected(spec->GetName())) continue;
+				const Encoding enc = Encoding::parse(spec->GetTitle());
+				NtupleColumn c;
+				c.name = spec->GetName();
+				c.type = 'O';
+				c.length = enc.width > 1 ? enc.width : 0;
+				out.push_back(c);
+			}
+		}
+		// bound once the vector no longer grows: the reader keeps the buffer addresses
+		for (std::size_t i = 0; i < out.size(); i++) bind(out[i]);
+		return out;
+	}
+
+	Int_t NtupleReader::getEntry(Long64_t entry) {
+		const Int_t nbytes = tree_->GetEntry(entry);
+		for (size_t i = 0; i < bindings_.size(); i++) {
+			const Binding& b = bindings_[i];
+			const int n = b.length > 0 ? b.length : 1;
+			const char* in = b.buffer.empty() ? 0 : &b.buffer[0];
+			switch (b.encoding.kind) {
+				case Encoding::Float32:
+				case Encoding::Truncated:
+					for (int k = 0; k < n; k++) store(b.address, b.type, k, reinterpret_cast<const float*>(in)[k]);
+					break;
+				case Encoding::Fixed16:
+					for (int k = 0; k < n; k++)
+						store(b.address, b.type, k, decodeFixed16(reinterpret_cast<const UShort_t*>(in)[k], b.encoding.lo, b.encoding.hi));
+					break;
+				case Encoding::Int8:
+					for (int k = 0; k < n; k++) store(b.address, b.type, k, reinterpret_cast<const Char_t*>(in)[k]);
+					break;
+				case Encoding::Bits: {
+					const Group& g = groups_[b.group];
+					ULong64_t word = 0;
+					switch (g.type) {
+						case 'b': word = *reinterpret_cast<const UChar_t*>(&g.buffer[0]); break;
+						case 's': word = *reinterpret_cast<const UShort_t*>(&g.buffer[0]); break;
+						case 'i': word = *reinterpret_cast<const UInt_t*>(&g.buffer[0]); break;
+						default:  word = *reinterpret_cast<const ULong64_t*>(&g.buffer[0]); break;
+					}
+					bool* out = static_cast<bool*>(b.address);
+					for (int k = 0; k < n && k < b.encoding.width; k++) out[k] = (word >> (b.encoding.offset + k)) & 1;
+					break;
+				}
+				default:
+					break;
+			}
+		}
+		return nbytes;
+	}
+
+}
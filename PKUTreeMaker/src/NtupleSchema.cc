@@ -0,0 +1,262 @@
+#include "VAJets/PKUTreeMaker/interface/NtupleSchema.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+#include "TList.h"
+#include "TNamed.h"
+#include "TTree.h"
+
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+namespace pku {
+
+	namespace {
+		double load(const BranchSpec& spec, int i) {
+			switch (spec.type) {
+				case 'D': return static_cast<const double*>(spec.address)[i];
+				case 'F': return static_cast<const float*>(spec.address)[i];
+				case 'I': return static_cast<const int*>(spec.address)[i];
+				case 'i': return static_cast<const unsigned int*>(spec.address)[i];
+				case 'S': return static_cast<const short*>(spec.address)[i];
+				default:  return 0.;
+			}
+		}
+
+		bool accepts(const Encoding& encoding, char type) {
+			switch (encoding.kind) {
+				case Encoding::Float32: case Encoding::Truncated: case Encoding::Fixed16:
+					return type == 'D' || type == 'F';
+				case Encoding::Int8: return type == 'I' || type == 'i' || type == 'S';
+				case Encoding::Bits: return type == 'O';
+				default: return true;
+			}
+		}
+	}
+
+	const char* stageName(Stage stage) {
+		static const char* names[] = { "Event", "Weights", "Pileup", "Gen", "GenMuonMatch", "HLT", "Filters",
+			"Lepton", "Station2", "Photon", "FakePhoton", "Jets", "VBS", "VBSFake", "MET" };
+		unsigned i = static_cast<unsigned>(stage);
+		return i < static_cast<unsigned>(Stage::NStages) ? names[i] : "Unknown";
+	}
+
+	//------------------------------------
+	BranchSelector::BranchSelector() : keep_(1, "*") {}
+
+	BranchSelector::BranchSelector(const std::vector<std::string>& keep, const std::vector<std::string>& drop)
+		: keep_(keep), drop_(drop)
+	{
+		if (keep_.empty()) keep_.push_back("*");
+	}
+
+	bool BranchSelector::selected(const std::string& name) const {
+		bool keep = false;
+		for (size_t i = 0; i < keep_.size() && !keep; i++) keep = match(keep_[i].c_str(), name.c_str());
+		if (!keep) return false;
+		for (size_t i = 0; i < drop_.size(); i++) if (match(drop_[i].c_str(), name.c_str())) return false;
+		return true;
+	}
+
+	bool BranchSelector::match(const char* pattern, const char* name) {
+		// iterative glob matching with single-star backtracking
+		const char* star = 0;
+		const char* resume = 0;
+		while (*name) {
+			if (*pattern == '?' || *pattern == *name) { ++pattern; ++name; continue; }
+			if (*pattern == '*') { star = pattern++; resume = name; continue; }
+			if (star) { pattern = star + 1; name = ++resume; continue; }
+			return false;
+		}
+		while (*pattern == '*') ++pattern;
+		return *pattern == 0;
+	}
+
+	//------------------------------------
+	NtupleSchema::NtupleSchema() : requires_(static_cast<unsigned>(Stage::NStages)) {}
+
+	void NtupleSchema::declare(const std::string& name, const std::string& leaf, void* address, char type, int length, Stage stage) {
+		for (size_t i = 0; i < branches_.size(); i++) {
+			if (branches_[i].name == name)
+				throw cms::Exception("Configuration") << "NtupleSchema: branch " << name << " declared twice";
+		}
+		BranchSpec spec;
+		spec.name    = name;
+		spec.leaf    = leaf.empty() ? name : leaf;
+		spec.address = address;
+		spec.type    = type;
+		spec.length  = length;
+		spec.stage   = stage;
+		branches_.push_back(spec);
+	}
+
+	void NtupleSchema::setEncoding(const std::string& pattern, const Encoding& encoding) {
+		unsigned matched = 0;
+		for (size_t i = 0; i < branches_.size(); i++) {
+			BranchSpec& spec = branches_[i];
+			if (!BranchSelector::match(pattern.c_str(), spec.name.c_str()) || !accepts(encoding, spec.type)) continue;
+			spec.encoding = encoding;
+			++matched;
+		}
+		if (matched == 0)
+			throw cms::Exception("Configuration") << "NtupleSchema: encoding " << encoding.spec()
+				<< " does not apply to any branch matching " << pattern;
+	}
+
+	void NtupleSchema::dependsOn(Stage stage, Stage requirement) {
+		requires_[static_cast<unsigned>(stage)].set(static_cast<unsigned>(requirement));
+	}
+
+	void NtupleSchema::book(TTree* tree, const BranchSelector& selector) {
+		booked_.clear();
+		slots_.clear();
+		groups_.clear();
+		active_.reset();
+		active_.set(static_cast<unsigned>(Stage::Event));
+		for (size_t i = 0; i < branches_.size(); i++) {
+			BranchSpec& spec = branches_[i];
+			if (!selector.selected(spec.name)) continue;
+			booked_.push_back(&spec);
+			active_.set(static_cast<unsigned>(spec.stage));
+
+			if (spec.encoding.kind == Encoding::Bits) {
+				size_t g = 0;
+				while (g < groups_.size() && groups_[g].name != spec.encoding.group) ++g;
+				if (g == groups_.size()) {
+					groups_.push_back(BitGroup());
+					groups_.back().name = spec.encoding.group;
+					groups_.back().width = 0;
+				}
+				spec.encoding.offset = groups_[g].width;
+				spec.encoding.width  = spec.length > 0 ? spec.length : 1;
+				groups_[g].width += spec.encoding.width;
+				groups_[g].members.push_back(&spec);
+			} else if (spec.encoding.kind == Encoding::Native) {
+				if (tree) tree->Branch(spec.name.c_str(), spec.address, leafList(spec).c_str());
+			} else {
+				slots_.push_back(Slot());
+				slots_.back().spec = &spec;
+				slots_.back().buffer.assign(typeSize(spec.encoding.storedType(spec.type)) * (spec.length > 0 ? spec.length : 1), 0);
+			}
+		}
+		for (size_t i = 0; i < slots_.size(); i++) {
+			const BranchSpec& spec = *slots_[i].spec;
+			if (tree) tree->Branch(spec.name.c_str(), &slots_[i].buffer[0], leafList(spec).c_str());
+		}
+		for (size_t g = 0; g < groups_.size(); g++) {
+			BitGroup& group = groups_[g];
+			for (size_t i = 0; i < branches_.size(); i++) {
+				if (branches_[i].name == group.name)
+					throw cms::Exception("Configuration") << "NtupleSchema: bit group " << group.name << " clashes with a branch";
+			}
+			if (group.width > 64)
+				throw cms::Exception("Configuration") << "NtupleSchema: bit group " << group.name << " needs " << group.width << " > 64 bits";
+			group.type = group.width <= 8 ? 'b' : group.width <= 16 ? 's' : group.width <= 32 ? 'i' : 'l';
+			group.buffer.assign(typeSize(group.type), 0);
+			if (tree) tree->Branch(group.name.c_str(), &group.buffer[0], (group.name + "/" + group.type).c_str());
+		}
+		if (tree) {
+			for (size_t i = 0; i < booked_.size(); i++) {
+				const BranchSpec& spec = *booked_[i];
+				if (spec.encoding.kind != Encoding::Native)
+					tree->GetUserInfo()->Add(new TNamed(spec.name.c_str(), spec.encoding.spec().c_str()));
+			}
+			for (size_t g = 0; g < groups_.size(); g++)
+				tree->GetUserInfo()->Add(new TNamed(groups_[g].name.c_str(), (std::string("word:") + groups_[g].type).c_str()));
+		}
+		// transitive closure of the stage requirements
+		bool changed = true;
+		while (changed) {
+			StageSet before = active_;
+			for (unsigned s = 0; s < requires_.size(); s++) if (active_.test(s)) active_ |= requires_[s];
+			changed = (before != active_);
+		}
+	}
+
+	void NtupleSchema::encode() {
+		for (size_t i = 0; i < slots_.size(); i++) {
+			const BranchSpec& spec = *slots_[i].spec;
+			const Encoding& enc = spec.encoding;
+			const int n = spec.length > 0 ? spec.length : 1;
+			char* out = &slots_[i].buffer[0];
+			switch (enc.kind) {
+				case Encoding::Float32:
+					for (int k = 0; k < n; k++) reinterpret_cast<float*>(out)[k] = static_cast<float>(load(spec, k));
+					break;
+				case Encoding::Truncated:
+					for (int k = 0; k < n; k++) reinterpret_cast<float*>(out)[k] = truncateMantissa(static_cast<float>(load(spec, k)), enc.mantissaBits);
+					break;
+				case Encoding::Fixed16:
+					for (int k = 0; k < n; k++) reinterpret_cast<UShort_t*>(out)[k] = encodeFixed16(load(spec, k), enc.lo, enc.hi);
+					break;
+				case Encoding::Int8:
+					for (int k = 0; k < n; k++) reinterpret_cast<Char_t*>(out)[k] = encodeInt8(static_cast<int>(load(spec, k)));
+					break;
+				default:
+					break;
+			}
+		}
+		for (size_t g = 0; g < groups_.size(); g++) {
+			BitGroup& group = groups_[g];
+			ULong64_t word = 0;
+			for (size_t m = 0; m < group.members.size(); m++) {
+				const BranchSpec& spec = *group.members[m];
+				const bool* bits = static_cast<const bool*>(spec.address);
+				for (int k = 0; k < spec.encoding.width; k++)
+					if (bits[k]) word |= ULong64_t(1) << (spec.encoding.offset + k);
+			}
+			char* out = &group.buffer[0];
+			switch (group.type) {
+				case 'b': *reinterpret_cast<UChar_t*>(out)   = static_cast<UChar_t>(word); break;
+				case 's': *reinterpret_cast<UShort_t*>(out)  = static_cast<UShort_t>(word); break;
+				case 'i': *reinterpret_cast<UInt_t*>(out)    = static_cast<UInt_t>(word); break;
+				default:  *reinterpret_cast<ULong64_t*>(out) = word; break;
+			}
+		}
+	}
+
+	bool NtupleSchema::written(const std::string& name) const {
+		for (size_t i = 0; i < booked_.size(); i++) if (booked_[i]->name == name) return true;
+		return false;
+	}
+
+	std::string NtupleSchema::leafList(const BranchSpec& spec) {
+		std::ostringstream ss;
+		ss << spec.leaf;
+		if (spec.length > 0) ss << "[" << spec.length << "]";
+		ss << "/" << spec.encoding.storedType(spec.type);
+		return ss.str();
+	}
+
+	std::size_t NtupleSchema::typeSize(char type) {
+		switch (type) {
+			case 'B': case 'b': case 'O': return 1;
+			case 'S': case 's': return 2;
+			case 'I': case 'i': case 'F': return 4;
+			case 'D': case 'L': case 'l': return 8;
+			default: return 0;
+		}
+	}
+
+	std::size_t NtupleSchema::bookedBytesPerEntry() const {
+		std::size_t bytes = 0;
+		for (size_t i = 0; i < booked_.size(); i++)
+			bytes += typeSize(booked_[i]->encoding.storedType(booked_[i]->type)) * (booked_[i]->length > 0 ? booked_[i]->length : 1);
+		for (size_t g = 0; g < groups_.size(); g++) bytes += groups_[g].buffer.size();
+		return bytes;
+	}
+
+	void NtupleSchema::printSummary(std::ostream& out) const {
+		out << "booked " << booked_.size() << "/" << branches_.size() << " branches ("
+		    << slots_.size() << " encoded, " << groups_.size() << " bit groups), "
+		    << bookedBytesPerEntry() << " bytes/entry before compression\n";
+		for (unsigned s = 0; s < static_cast<unsigned>(Stage::NStages); s++) {
+			unsigned declared = 0, kept = 0;
+			for (size_t i = 0; i < branches_.size(); i++) if (static_cast<unsigned>(branches_[i].stage) == s) ++declared;
+			for (size_t i = 0; i < booked_.size(); i++) if (static_cast<unsigned>(booked_[i]->stage) == s) ++kept;
+			out << "  " << std::setw(14) << std::left << stageName(static_cast<Stage>(s))
+			    << (active_.test(s) ? " on " : " off") << "  " << kept << "/" << declared << "\n";
+		}
+	}
+
+}
@@ -0,0 +1,99 @@
+#include "VAJets/PKUTreeMaker/interface/PhotonCategory.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <algorithm>
+
+namespace pku {
+
+	namespace photon {
+
+		namespace {
+			// Spring16 cut-based photon ID; isolations are cut at c0 + c1 pt (+ c2 pt^2)
+			struct Cuts {
+				double hoe, sieie, chiso;
+				double nhiso0, nhiso1, nhiso2;
+				double phoiso0, phoiso1;
+			};
+			//                              H/E     sieie    chiso  neutral hadrons            photons
+			const Cuts medium[2] = { { 0.0396, 0.01022, 0.441,  2.725, 0.0148, 0.000017,  2.571, 0.0047 },    // barrel
+			                         { 0.0219, 0.03001, 0.442,  1.715, 0.0163, 0.000014,  3.863, 0.0034 } };  // endcap
+			const Cuts loose[2]  = { { 0.0597, 0.01031, 1.295, 10.910, 0.0148, 0.000017,  3.630, 0.0047 },
+			                         { 0.0481, 0.03013, 1.011,  5.931, 0.0163, 0.000014,  6.641, 0.0034 } };
+
+			const double minDRLepton = 0.7;
+
+			struct Named { const char* name; unsigned bit; };
+			const Named names[] = {
+				{ "eleVeto", EleVeto }, { "leptonDR", LeptonDR },
+				{ "medium", Medium }, { "mediumNoSieie", MediumNoSieie }, { "mediumNoChIso", MediumNoChIso },
+				{ "loose", Loose }, { "fakePreselection", FakePreselection }
+			};
+
+			unsigned bits(const std::vector<std::string>& labels, const std::string& suffix) {
+				unsigned mask = 0;
+				for (const std::string& label : labels) {
+					const unsigned bit = categoryBit(label);
+					if (!bit) throw cms::Exception("Configuration") << "photonSelections: unknown photon category \"" << label << "\" in selection \"" << suffix << "\"";
+					mask |= bit;
+				}
+				return mask;
+			}
+		}
+
+		unsigned categoryBit(const std::string& name) {
+			for (const Named& n : names)
+				if (name == n.name) return n.bit;
+			return 0;
+		}
+
+		unsigned classify(const Variables& v) {
+			unsigned mask = (v.eleVeto ? EleVeto : 0) | (v.drLepton > minDRLepton ? LeptonDR : 0);
+			if (!v.isEB && !v.isEE) return mask;
+			const Cuts& m = medium[v.isEB ? 0 : 1];
+			const Cuts& l = loose[v.isEB ? 0 : 1];
+			const double pt = v.pt;
+
+			const double nhMedium = m.nhiso0 + (m.nhiso1*pt + m.nhiso2*pt*pt);
+			const double nhLoose = l.nhiso0 + (l.nhiso1*pt + l.nhiso2*pt*pt);
+			const double phMedium = m.phoiso0 + m.phoiso1*pt;
+			const double phLoose = l.phoiso0 + l.phoiso1*pt;
+
+			const bool hoeM = v.hoe < m.hoe, sieieM = v.sieie < m.sieie, chM = v.chiso < m.chiso;
+			const bool isoM = v.nhiso < nhMedium && v.phoiso < phMedium;
+			if (hoeM && sieieM && chM && isoM) mask |= Medium;
+			if (hoeM && chM && isoM)           mask |= MediumNoSieie;
+			if (hoeM && sieieM && isoM)        mask |= MediumNoChIso;
+
+			if (v.sieie < l.sieie && v.chiso < l.chiso && v.nhiso < nhLoose && v.phoiso < phLoose) mask |= Loose;
+			if (v.hoe < l.hoe && v.chiso < std::min(0.2*pt, 5.*l.chiso)
+			    && v.nhiso < std::min(0.2*pt, 5.*nhLoose) && v.phoiso < std::min(0.2*pt, 5.*phLoose))
+				mask |= FakePreselection;
+			return mask;
+		}
+
+		std::vector<Selection> selections(const edm::ParameterSet& iConfig) {
+			std::vector<Selection> result;
+			const Selection nominal = { "", EleVeto | LeptonDR | Medium, 0 };
+			const Selection fake = { "_f", EleVeto | LeptonDR | FakePreselection, Loose };
+			result.push_back(nominal);
+			result.push_back(fake);
+			if (!iConfig.existsAs<std::vector<edm::ParameterSet> >("photonSelections")) return result;
+
+			for (const edm::ParameterSet& pset : iConfig.getParameter<std::vector<edm::ParameterSet> >("photonSelections")) {
+				Selection s;
+				s.suffix = pset.getParameter<std::string>("suffix");
+				s.require = bits(pset.getParameter<std::vector<std::string> >("require"), s.suffix);
+				s.veto = pset.existsAs<std::vector<std::string> >("veto") ? bits(pset.getParameter<std::vector<std::string> >("veto"), s.suffix) : 0;
+				std::vector<Selection>::iterator it = result.begin();
+				while (it != result.end() && it->suffix != s.suffix) ++it;
+				if (it != result.end()) *it = s;
+				else result.push_back(s);
+			}
+			return result;
+		}
+
+	}
+
+}
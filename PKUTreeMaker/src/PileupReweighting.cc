@@ -0,0 +1,122 @@
+#include "VAJets/PKUTreeMaker/interface/PileupReweighting.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "TAxis.h"
+#include "TFile.h"
+#include "TH1.h"
+
+#include <algorithm>
+#include <memory>
+#include <ostream>
+
+namespace pku {
+
+	namespace {
+		// the profile values[k] over [low + k*width, low + (k+1)*width) integrated over n bins of 'width' from 'to'
+		std::vector<double> rebin(const std::vector<double>& values, double low, double width,
+		                          std::size_t n, double to, double toWidth) {
+			std::vector<double> out(n, 0.);
+			for (std::size_t i = 0; i < n; i++) {
+				const double a = to + i*toWidth, b = a + toWidth;
+				for (std::size_t k = 0; k < values.size(); k++) {
+					const double lo = std::max(a, low + k*width), hi = std::min(b, low + (k + 1)*width);
+					if (hi > lo) out[i] += values[k]*(hi - lo)/width;
+				}
+			}
+			return out;
+		}
+
+		double sum(const std::vector<double>& v) {
+			double s = 0.;
+			for (std::size_t i = 0; i < v.size(); i++) s += v[i];
+			return s;
+		}
+	}
+
+	PileupReweighting::PileupReweighting()
+		: nBins_(0), low_(0.), high_(0.), invWidth_(0.), maxWeight_(0.), emptyMcBins_(0), capped_(0)
+	{
+	}
+
+	PileupReweighting::PileupReweighting(const edm::ParameterSet& pset)
+		: nBins_(0), low_(0.), high_(0.), invWidth_(0.),
+		  dataFiles_(pset.getParameter<std::vector<std::string>>("data")),
+		  maxWeight_(pset.existsAs<double>("maxWeight") ? pset.getParameter<double>("maxWeight") : 0.),
+		  emptyMcBins_(0), capped_(0)
+	{
+		if (dataFiles_.size() != 1 && dataFiles_.size() != 3)
+			throw cms::Exception("Configuration") << "PileupReweighting: data needs the nominal file, or nominal, up and down";
+		const std::string dataHist = pset.existsAs<std::string>("dataHist") ? pset.getParameter<std::string>("dataHist") : "pileup";
+
+		std::vector<std::vector<double>> data;
+		for (std::size_t v = 0; v < dataFiles_.size(); v++) {
+			std::size_t n;
+			double low, high;
+			data.push_back(readHist(dataFiles_[v], dataHist, n, low, high));
+			if (v == 0) { nBins_ = n; low_ = low; high_ = high; }
+			else if (n != nBins_ || low != low_ || high != high_)
+				throw cms::Exception("Configuration") << "PileupReweighting: " << dataFiles_[v] << " is not binned as " << dataFiles_[0];
+		}
+		while (data.size() < 3) data.push_back(data.front());
+		const double width = (high_ - low_)/nBins_;
+		invWidth_ = 1./width;
+
+		std::vector<double> mc;
+		if (pset.existsAs<std::vector<double>>("mc")) {
+			mc = rebin(pset.getParameter<std::vector<double>>("mc"), 0., 1., nBins_, low_, width);
+			mcSource_ = "mc profile";
+		} else if (pset.existsAs<std::string>("mcFile")) {
+			const std::string file = pset.getParameter<std::string>("mcFile");
+			const std::string hist = pset.existsAs<std::string>("mcHist") ? pset.getParameter<std::string>("mcHist") : "pileup";
+			std::size_t n;
+			double low, high;
+			const std::vector<double> values = readHist(file, hist, n, low, high);
+			mc = rebin(values, low, (high - low)/n, nBins_, low_, width);
+			mcSource_ = file + ":" + hist;
+		} else {
+			throw cms::Exception("Configuration") << "PileupReweighting: give the MC profile, mc or mcFile";
+		}
+		const double mcSum = sum(mc);
+		if (mcSum <= 0.) throw cms::Exception("Configuration") << "PileupReweighting: the MC profile is empty over the data range";
+
+		table_.assign(3*nBins_, 0.);
+		for (std::size_t v = 0; v < 3; v++) {
+			const double dataSum = sum(data[v]);
+			if (dataSum <= 0.) throw cms::Exception("Configuration") << "PileupReweighting: empty data histogram";
+			for (std::size_t i = 0; i < nBins_; i++) {
+				double w = mc[i] > 0. ? (data[v][i]/dataSum)/(mc[i]/mcSum) : 0.;
+				if (maxWeight_ > 0. && w > maxWeight_) { w = maxWeight_; ++capped_; }
+				table_[3*i + v] = w;
+			}
+		}
+		for (std::size_t i = 0; i < nBins_; i++) if (mc[i] <= 0.) ++emptyMcBins_;
+	}
+
+	std::vector<double> PileupReweighting::readHist(const std::string& file, const std::string& name,
+	                                                std::size_t& nBins, double& low, double& high) {
+		std::unique_ptr<TFile> f(TFile::Open(file.c_str(), "READ"));
+		if (!f || f->IsZombie()) throw cms::Exception("Configuration") << "PileupReweighting: cannot open " << file;
+		TH1* h = dynamic_cast<TH1*>(f->Get(name.c_str()));
+		if (!h) throw cms::Exception("Configuration") << "PileupReweighting: no histogram " << name << " in " << file;
+		const TAxis* axis = h->GetXaxis();
+		if (axis->IsVariableBinSize())
+			throw cms::Exception("Configuration") << "PileupReweighting: " << file << ":" << name << " has variable bins";
+		nBins = axis->GetNbins();
+		low = axis->GetXmin();
+		high = axis->GetXmax();
+		std::vector<double> values(nBins);
+		for (std::size_t i = 0; i < nBins; i++) values[i] = h->GetBinContent(i + 1);
+		return values;
+	}
+
+	void PileupReweighting::printSummary(std::ostream& out) const {
+		if (!enabled()) return;
+		double maxW = 0.;
+		for (std::size_t i = 0; i < table_.size(); i++) maxW = std::max(maxW, table_[i]);
+		out << "pileup reweighting: " << nBins_ << " bins in [" << low_ << ", " << high_ << "), data " << dataFiles_[0]
+		    << (dataFiles_.size() == 3 ? " (+up/down)" : " (no up/down)") << ", " << mcSource_
+		    << ", max weight " << maxW << ", " << emptyMcBins_ << " bins without MC, " << capped_ << " weights capped\n";
+	}
+
+}
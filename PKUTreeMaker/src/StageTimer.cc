@@ -0,0 +1,149 @@
+#include "VAJets/PKUTreeMaker/interface/StageTimer.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TH1D.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <ostream>
+
+namespace pku {
+
+	namespace {
+		// names are identifiers chosen in the code, but keep the JSON valid anyway
+		std::string quoted(const std::string& s) {
+			std::string out = "\"";
+			for (std::size_t i = 0; i < s.size(); i++) {
+				if (s[i] == '"' || s[i] == '\\') out += '\\';
+				if (static_cast<unsigned char>(s[i]) >= 0x20) out += s[i];
+			}
+			return out + "\"";
+		}
+	}
+
+	const std::size_t StageTimer::npos;
+
+	StageTimer::StageTimer() : enabled_(false), current_(npos) {}
+
+	StageTimer::StageTimer(const std::string& module, const edm::ParameterSet& pset)
+		: enabled_(pset.existsAs<bool>("enabled") ? pset.getParameter<bool>("enabled") : true),
+		  module_(module),
+		  report_(pset.existsAs<std::string>("report") ? pset.getParameter<std::string>("report") : module + "_timing.json"),
+		  histograms_(pset.existsAs<std::string>("histograms") ? pset.getParameter<std::string>("histograms") : ""),
+		  current_(npos)
+	{
+	}
+
+	std::size_t StageTimer::stage(const std::string& name) {
+		for (std::size_t i = 0; i < stages_.size(); i++)
+			if (stages_[i].name == name) return i;
+		Stage s;
+		s.name = name;
+		s.calls = 0;
+		s.seconds = 0.;
+		s.min = 0.;
+		s.max = 0.;
+		s.bins.assign(nBins, 0);
+		stages_.push_back(s);
+		return stages_.size() - 1;
+	}
+
+	std::size_t StageTimer::counter(const std::string& name) {
+		for (std::size_t i = 0; i < counters_.size(); i++)
+			if (counters_[i].name == name) return i;
+		const Counter c = { name, 0 };
+		counters_.push_back(c);
+		return counters_.size() - 1;
+	}
+
+	void StageTimer::record(std::size_t stage, Clock::duration elapsed) {
+		Stage& s = stages_[stage];
+		const long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+		const double seconds = 1e-9*ns;
+		if (s.calls == 0 || seconds < s.min) s.min = seconds;
+		if (s.calls == 0 || seconds > s.max) s.max = seconds;
+		++s.calls;
+		s.seconds += seconds;
+		const int bin = ns > 1 ? 63 - __builtin_clzll(static_cast<unsigned long long>(ns)) : 0;
+		++s.bins[std::min(bin, nBins - 1)];
+	}
+
+	double StageTimer::quantile(const Stage& s, double q) const {
+		if (s.calls == 0) return 0.;
+		const double target = q*s.calls;
+		double below = 0.;
+		for (int b = 0; b < nBins; b++) {
+			if (s.bins[b] == 0 || below + s.bins[b] < target) { below += s.bins[b]; continue; }
+			const double lo = 1e-9*std::ldexp(1., b), hi = 2.*lo;
+			const double x = lo + (hi - lo)*(target - below)/s.bins[b];
+			return std::min(std::max(x, s.min), s.max);
+		}
+		return s.max;
+	}
+
+	void StageTimer::writeJson(std::ostream& out) const {
+		out << "{\n  \"module\": " << quoted(module_) << ",\n  \"stages\": [";
+		for (std::size_t i = 0; i < stages_.size(); i++) {
+			const Stage& s = stages_[i];
+			out << (i ? ",\n" : "\n")
+			    << "    {\"name\": " << quoted(s.name) << ", \"calls\": " << s.calls
+			    << ", \"total_s\": " << s.seconds
+			    << ", \"mean_us\": " << (s.calls ? 1e6*s.seconds/s.calls : 0.)
+			    << ", \"min_us\": " << 1e6*s.min << ", \"max_us\": " << 1e6*s.max
+			    << ", \"p50_us\": " << 1e6*quantile(s, 0.5)
+			    << ", \"p90_us\": " << 1e6*quantile(s, 0.9)
+			    << ", \"p99_us\": " << 1e6*quantile(s, 0.99) << "}";
+		}
+		out << "\n  ],\n  \"counters\": {";
+		for (std::size_t i = 0; i < counters_.size(); i++)
+			out << (i ? ",\n" : "\n") << "    " << quoted(counters_[i].name) << ": " << counters_[i].value;
+		out << "\n  }\n}\n";
+	}
+
+	void StageTimer::writeHistograms() const {
+		TDirectory* previous = gDirectory;
+		std::unique_ptr<TFile> file(TFile::Open(histograms_.c_str(), "UPDATE"));
+		if (!file || file->IsZombie())
+			throw cms::Exception("Configuration") << "StageTimer: cannot open " << histograms_ << " for " << module_;
+		TDirectory* dir = file->GetDirectory(module_.c_str());
+		if (!dir) dir = file->mkdir(module_.c_str());
+		dir->cd();
+		std::vector<double> edges(nBins + 1);
+		for (int b = 0; b <= nBins; b++) edges[b] = 1e-3*std::ldexp(1., b);   // us
+		for (std::size_t i = 0; i < stages_.size(); i++) {
+			const Stage& s = stages_[i];
+			TH1D h(s.name.c_str(), (module_ + " " + s.name + ";latency [#mus];calls").c_str(), nBins, &edges[0]);
+			for (int b = 0; b < nBins; b++) h.SetBinContent(b + 1, s.bins[b]);
+			h.SetEntries(s.calls);
+			h.Write(0, TObject::kOverwrite);
+		}
+		file->Close();
+		if (previous) previous->cd();
+	}
+
+	void StageTimer::writeReport() const {
+		if (!enabled_) return;
+		std::ofstream out(report_.c_str());
+		if (!out)
+			throw cms::Exception("Configuration") << "StageTimer: cannot write " << report_ << " for " << module_;
+		writeJson(out);
+		if (!histograms_.empty()) writeHistograms();
+	}
+
+	void StageTimer::printSummary(std::ostream& out) const {
+		if (!enabled_) return;
+		for (std::size_t i = 0; i < stages_.size(); i++) {
+			const Stage& s = stages_[i];
+			out << "stage " << s.name << ": " << s.calls << " calls, "
+			    << (s.calls ? 1e6*s.seconds/s.calls : 0.) << " us/call, p99 " << 1e6*quantile(s, 0.99) << " us\n";
+		}
+		for (std::size_t i = 0; i < counters_.size(); i++)
+			out << "counter " << counters_[i].name << ": " << counters_[i].value << "\n";
+	}
+
+}
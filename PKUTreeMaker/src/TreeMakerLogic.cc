@@ -0,0 +1,128 @@
+#include "VAJets/PKUTreeMaker/interface/TreeMakerLogic.h"
+#include "VAJets/PKUTreeMaker/interface/JetKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "CondFormats/JetMETObjects/interface/FactorizedJetCorrector.h"
+#include "FWCore/ParameterSet/interface/FileInPath.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+namespace pku {
+
+	TreeMakerLogic::TreeMakerLogic(const edm::ParameterSet& iConfig)
+		:nVtx(0)
+		 ,genWeight_(0)
+		 ,jecAK4chs_(iConfig, "jecAK4chsPayloadNames")
+		 ,jecAK4_(0)
+		 ,jecOffset_(0)
+		 ,photonEA_(photonEffectiveAreas(iConfig))
+		 ,photonSelections_(pku::photon::selections(iConfig))
+		 ,photonBlocks_(photonSelections_.size())
+	{
+		if (iConfig.existsAs<edm::ParameterSet>("timing"))
+			timer_ = pku::StageTimer(iConfig.getParameter<std::string>("@module_label"), iConfig.getParameter<edm::ParameterSet>("timing"));
+		stages_.event    = timer_.stage("event");
+		stages_.weights  = timer_.stage("weights");
+		stages_.hlt      = timer_.stage("hlt");
+		stages_.gen      = timer_.stage("gen");
+		stages_.filters  = timer_.stage("filters");
+		stages_.vertices = timer_.stage("vertices");
+		stages_.typeI    = timer_.stage("typeI");
+		stages_.met      = timer_.stage("met");
+		stages_.photons  = timer_.stage("photons");
+		stages_.jets     = timer_.stage("jets");
+		stages_.matching = timer_.stage("matching");
+		stages_.fill     = timer_.stage("fill");
+		stages_.record   = pku::StageTimer::npos;
+		stages_.nEvents  = timer_.counter("events");
+		stages_.nPhotons = timer_.counter("photons");
+		stages_.nJets    = timer_.counter("jets");
+		cuts_.leptonicV  = summary_.counter("pass_leptonicV");
+		cuts_.vertex     = summary_.counter("pass_vertex");
+		cuts_.goodVertex = summary_.counter("pass_goodVertex");
+		cuts_.sumGenWeight  = summary_.counter("sumGenWeight");
+		cuts_.sumGenWeight2 = summary_.counter("sumGenWeight2");
+		cuts_.sumGenSign    = summary_.counter("sumGenSign");
+	}
+
+	//------------------------------------
+	pku::EffectiveAreaTable TreeMakerLogic::photonEffectiveAreas(const edm::ParameterSet& iConfig){
+		if (!(iConfig.existsAs<bool>("useEffAreaFiles") && iConfig.getParameter<bool>("useEffAreaFiles")))
+			return pku::EffectiveAreaTable::photonSpring16();
+		std::vector<std::string> files;
+		files.push_back(iConfig.getParameter<edm::FileInPath>("effAreaChHadFile").fullPath());
+		files.push_back(iConfig.getParameter<edm::FileInPath>("effAreaNeuHadFile").fullPath());
+		files.push_back(iConfig.getParameter<edm::FileInPath>("effAreaPhoFile").fullPath());
+		return pku::EffectiveAreaTable(files);
+	}
+	//------------------------------------
+	void TreeMakerLogic::selectPhotons(std::size_t nSelections){
+		photonOrder_.resize(photonVars_.size());
+		for (std::size_t ip = 0; ip < photonOrder_.size(); ip++) photonOrder_[ip] = ip;
+		// on equal pt the first photon wins, as with the original running maximum
+		std::stable_sort(photonOrder_.begin(), photonOrder_.end(),
+		                 [this](unsigned a, unsigned b) { return photonVars_[a].pt > photonVars_[b].pt; });
+
+		for (std::size_t s = 0; s < nSelections; s++) {
+			SelectedPhoton& block = photonBlocks_[s];
+			block.index = -1;
+			block.et = -100.;
+			for (unsigned ip : photonOrder_) {
+				if (!photonSelections_[s].pass(photonMasks_[ip])) continue;
+				const pku::photon::Variables& v = photonVars_[ip];
+				block.index = ip;
+				block.et = v.pt;
+				block.eta = v.eta;
+				block.phi = v.phi;
+				block.e = v.energy;
+				block.sieie = v.sieie;
+				block.phoiso = v.phoiso;
+				block.chiso = v.chiso;
+				block.nhiso = v.nhiso;
+				break;
+			}
+		}
+	}
+	//------------------------------------
+	double TreeMakerLogic::jecFactor(FactorizedJetCorrector* corrector, const math::XYZTLorentzVector& p4, double area, double rho, int npv){
+		const double jetCorrEtaMax = 9.9;
+		double jetCorrFactor = 1.;
+		if ( fabs(p4.eta()) < jetCorrEtaMax ){
+			corrector->setJetEta( p4.eta()    );
+			corrector->setJetPt ( p4.pt()     );
+			corrector->setJetE  ( p4.energy() );
+			corrector->setJetPhi( p4.phi()    );
+			corrector->setJetA  ( area        );
+			corrector->setRho   ( rho         );
+			corrector->setNPV   ( npv         );
+			jetCorrFactor = corrector->getCorrection();
+		}
+		return jetCorrFactor;
+	}
+	//------------------------------------
+	void TreeMakerLogic::typeICorrection(const std::vector<TypeIJet>& jets, unsigned run, double rho){
+		TypeICorrMap_.clear();
+		jecAK4_    = jecAK4chs_.corrector(run);
+		jecOffset_ = jecAK4chs_.offset(run);
+
+		pku::TypeISums sums;
+		for (std::size_t iJet = 0; iJet < jets.size(); iJet++) {
+			const TypeIJet& jet = jets[iJet];
+			pku::addTypeIJet(sums, jet.subtracted, jecFactor(jecAK4_, jet.uncorrected, jet.area, rho, nVtx),
+			                 [&]() { return jecFactor(jecOffset_, jet.uncorrected, jet.area, rho, nVtx); });
+		}
+		TypeICorrMap_["corrEx"]    = sums.corrEx;
+		TypeICorrMap_["corrEy"]    = sums.corrEy;
+		TypeICorrMap_["corrSumEt"] = sums.corrSumEt;
+	}
+	//------------------------------------
+	double TreeMakerLogic::getDR(double eta1, double phi1, double eta2, double phi2)
+	{
+		double DR = -1e1;
+		if (fabs(phi1-phi2)>3.1415926) DR=sqrt((eta1-eta2)*(eta1-eta2)+(2*3.1415926-fabs(phi1-phi2))*(2*3.1415926-fabs(phi1-phi2)));
+		else DR=sqrt((eta1-eta2)*(eta1-eta2)+(fabs(phi1-phi2))*(fabs(phi1-phi2)));
+		return DR;
+	}
+
+}
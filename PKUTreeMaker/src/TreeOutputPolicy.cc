@@ -0,0 +1,91 @@
+#include "VAJets/PKUTreeMaker/interface/TreeOutputPolicy.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+
+namespace pku {
+
+	TreeOutputPolicy::TreeOutputPolicy()
+		: compression_(-1), autoFlush_(-30000000), basketSize_(32000), entriesPerBasket_(0),
+		  minBasketSize_(1024), maxBasketSize_(1024000), calibrationEntries_(1000),
+		  filled_(0), bytesFilled_(0), fillSeconds_(0.), resized_(false)
+	{
+	}
+
+	TreeOutputPolicy::TreeOutputPolicy(const edm::ParameterSet& pset) : TreeOutputPolicy() {
+		std::string algorithm = pset.existsAs<std::string>("compressionAlgorithm") ? pset.getParameter<std::string>("compressionAlgorithm") : "";
+		int level = pset.existsAs<int>("compressionLevel") ? pset.getParameter<int>("compressionLevel") : 4;
+		if (!algorithm.empty()) compression_ = compressionSettings(algorithm, level);
+		if (pset.existsAs<long long>("autoFlush")) autoFlush_ = pset.getParameter<long long>("autoFlush");
+		if (pset.existsAs<int>("basketSize")) basketSize_ = pset.getParameter<int>("basketSize");
+		if (pset.existsAs<int>("entriesPerBasket")) entriesPerBasket_ = pset.getParameter<int>("entriesPerBasket");
+		if (pset.existsAs<int>("minBasketSize")) minBasketSize_ = pset.getParameter<int>("minBasketSize");
+		if (pset.existsAs<int>("maxBasketSize")) maxBasketSize_ = pset.getParameter<int>("maxBasketSize");
+		if (pset.existsAs<long long>("calibrationEntries")) calibrationEntries_ = pset.getParameter<long long>("calibrationEntries");
+		if (minBasketSize_ <= 0 || maxBasketSize_ < minBasketSize_)
+			throw cms::Exception("Configuration") << "TreeOutputPolicy: invalid basket size range [" << minBasketSize_ << ", " << maxBasketSize_ << "]";
+	}
+
+	int TreeOutputPolicy::compressionSettings(const std::string& algorithm, int level) {
+		if (level < 0 || level > 9)
+			throw cms::Exception("Configuration") << "TreeOutputPolicy: compression level " << level << " out of [0,9]";
+		int code = 0;
+		if      (algorithm == "ZLIB") code = 1;
+		else if (algorithm == "LZMA") code = 2;
+		else if (algorithm == "LZ4")  code = 4;
+		else if (algorithm == "ZSTD") code = 5;
+		else throw cms::Exception("Configuration") << "TreeOutputPolicy: unknown compression algorithm " << algorithm;
+		return code * 100 + level;
+	}
+
+	void TreeOutputPolicy::apply(TTree* tree) {
+		tree->SetAutoFlush(autoFlush_);
+		TObjArray* branches = tree->GetListOfBranches();
+		for (int i = 0; branches && i < branches->GetEntriesFast(); i++) {
+			TBranch* branch = static_cast<TBranch*>(branches->At(i));
+			branch->SetBasketSize(basketSize_);
+			if (compression_ >= 0) branch->SetCompressionSettings(compression_);
+		}
+	}
+
+	void TreeOutputPolicy::resizeBaskets(TTree* tree) {
+		TObjArray* branches = tree->GetListOfBranches();
+		for (int i = 0; branches && i < branches->GetEntriesFast(); i++) {
+			TBranch* branch = static_cast<TBranch*>(branches->At(i));
+			const double perEntry = double(branch->GetTotBytes()) / std::max<Long64_t>(1, branch->GetEntries());
+			int size = static_cast<int>(perEntry * entriesPerBasket_);
+			size = (size + 511) / 512 * 512;
+			branch->SetBasketSize(std::min(maxBasketSize_, std::max(minBasketSize_, size)));
+		}
+		resized_ = true;
+	}
+
+	Int_t TreeOutputPolicy::fill(TTree* tree) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		const Int_t nbytes = tree->Fill();
+		fillSeconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (nbytes > 0) bytesFilled_ += nbytes;
+		++filled_;
+		if (!resized_ && entriesPerBasket_ > 0 && filled_ == calibrationEntries_) resizeBaskets(tree);
+		return nbytes;
+	}
+
+	void TreeOutputPolicy::printSummary(std::ostream& out, const TTree* tree) const {
+		const double zip = tree->GetZipBytes();
+		const double tot = tree->GetTotBytes();
+		out << "compression " << (compression_ < 0 ? std::string("file default") : std::to_string(compression_))
+		    << ", autoFlush " << autoFlush_
+		    << ", baskets " << (resized_ ? "resized after " + std::to_string(calibrationEntries_) + " entries" : "fixed at " + std::to_string(basketSize_))
+		    << "\n";
+		out << "entries " << tree->GetEntries() << ", " << tot << " bytes -> " << zip << " on disk"
+		    << " (factor " << (zip > 0 ? tot/zip : 0.) << ")\n";
+		out << "fill " << (filled_ > 0 ? 1e6*fillSeconds_/filled_ : 0.) << " us/entry, "
+		    << (fillSeconds_ > 0 ? bytesFilled_/fillSeconds_/1048576. : 0.) << " MB/s uncompressed\n";
+	}
+
+}
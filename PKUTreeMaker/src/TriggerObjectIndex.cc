@@ -0,0 +1,136 @@
+#include "VAJets/PKUTreeMaker/interface/TriggerObjectIndex.h"
+
+#include "DataFormats/PatCandidates/interface/TriggerObjectStandAlone.h"
+#include "FWCore/Common/interface/TriggerNames.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace pku {
+
+	namespace {
+		const float twoPi = 2.f*M_PI;
+
+		inline float deltaR2(float eta1, float phi1, float eta2, float phi2) {
+			const float dEta = eta1 - eta2;
+			const float dPhi = std::remainder(phi1 - phi2, twoPi);
+			return dEta*dEta + dPhi*dPhi;
+		}
+
+		struct Nearest {
+			float best;
+			int key;
+			void operator()(float dR2, unsigned k) {
+				if (dR2 < best || (dR2 == best && key >= 0 && int(k) < key)) { best = dR2; key = k; }
+			}
+		};
+
+		// 'name' is 'path' or one of its versions path_v<N>
+		inline bool samePath(const std::string& name, const std::string& path) {
+			if (name.compare(0, path.size(), path) != 0) return false;
+			if (name.size() == path.size()) return true;
+			if (name.compare(path.size(), 2, "_v") != 0 || name.size() == path.size() + 2) return false;
+			return name.find_first_not_of("0123456789", path.size() + 2) == std::string::npos;
+		}
+
+		struct Within {
+			float dRmax2;
+			std::vector<unsigned>* keys;
+			void operator()(float dR2, unsigned k) { if (dR2 < dRmax2) keys->push_back(k); }
+		};
+	}
+
+	TriggerObjectIndex::TriggerObjectIndex(float cellSize, float etaMax) : cellSize_(cellSize), etaMax_(etaMax) {
+		if (!(cellSize > 0.f) || !(etaMax > 0.f))
+			throw cms::Exception("Configuration") << "TriggerObjectIndex: cell size " << cellSize << " and etaMax " << etaMax << " must be positive";
+		nEta_ = std::max(1, int(std::ceil(2.f*etaMax/cellSize)));
+		nPhi_ = std::max(1, int(twoPi/cellSize));
+		phiCellSize_ = twoPi/nPhi_;
+		cellStart_.assign(nEta_*nPhi_ + 1, 0);
+	}
+
+	void TriggerObjectIndex::clear() {
+		pending_.clear();
+		entries_.clear();
+		std::fill(cellStart_.begin(), cellStart_.end(), 0);
+	}
+
+	void TriggerObjectIndex::add(float eta, float phi, unsigned key) {
+		const Entry e = { eta, phi, key };
+		pending_.push_back(e);
+	}
+
+	void TriggerObjectIndex::add(const std::vector<pat::TriggerObjectStandAlone>& objects, const edm::TriggerNames& names,
+	                             const std::string& filter, const std::string& path) {
+		for (std::size_t i = 0; i < objects.size(); i++) {
+			if (!filter.empty() && !objects[i].hasFilterLabel(filter)) continue;
+			if (!path.empty()) {
+				// the path names are packed in MiniAOD; unpack a copy, only for the objects of the filter
+				pat::TriggerObjectStandAlone object = objects[i];
+				object.unpackPathNames(names);
+				const std::vector<std::string>& paths = object.pathNames();
+				bool fired = false;
+				for (std::size_t p = 0; p < paths.size() && !fired; p++) fired = samePath(paths[p], path);
+				if (!fired) continue;
+			}
+			add(objects[i].eta(), objects[i].phi(), i);
+		}
+	}
+
+	int TriggerObjectIndex::etaCell(float eta) const {
+		const int i = int(std::floor((eta + etaMax_)/cellSize_));
+		return std::min(std::max(i, 0), nEta_ - 1);
+	}
+
+	int TriggerObjectIndex::phiCell(float phi) const {
+		const int i = int(std::floor((phi + float(M_PI))/phiCellSize_)) % nPhi_;
+		return i < 0 ? i + nPhi_ : i;
+	}
+
+	void TriggerObjectIndex::build() {
+		// counting sort of the pending objects by cell
+		std::fill(cellStart_.begin(), cellStart_.end(), 0);
+		std::vector<unsigned> cells(pending_.size());
+		for (std::size_t i = 0; i < pending_.size(); i++) {
+			cells[i] = etaCell(pending_[i].eta)*nPhi_ + phiCell(pending_[i].phi);
+			cellStart_[cells[i] + 1]++;
+		}
+		for (std::size_t c = 1; c < cellStart_.size(); c++) cellStart_[c] += cellStart_[c - 1];
+		entries_.resize(pending_.size());
+		std::vector<unsigned> fill(cellStart_.begin(), cellStart_.end() - 1);
+		for (std::size_t i = 0; i < pending_.size(); i++) entries_[fill[cells[i]]++] = pending_[i];
+	}
+
+	template<class Visit>
+	void TriggerObjectIndex::visit(float eta, float phi, float dRmax, Visit& v) const {
+		if (entries_.empty()) return;
+		const int eta0 = etaCell(eta - dRmax), eta1 = etaCell(eta + dRmax);
+		// the cells touched in phi, all of them when the cone wraps around
+		const int span = int(std::floor((phi + dRmax + float(M_PI))/phiCellSize_)) - int(std::floor((phi - dRmax + float(M_PI))/phiCellSize_));
+		const int nPhi = std::min(span + 1, nPhi_);
+		const int phi0 = span + 1 >= nPhi_ ? 0 : phiCell(phi - dRmax);
+		for (int ie = eta0; ie <= eta1; ie++) {
+			for (int k = 0; k < nPhi; k++) {
+				const unsigned c = ie*nPhi_ + (phi0 + k) % nPhi_;
+				for (unsigned i = cellStart_[c]; i < cellStart_[c + 1]; i++)
+					v(deltaR2(eta, phi, entries_[i].eta, entries_[i].phi), entries_[i].key);
+			}
+		}
+	}
+
+	int TriggerObjectIndex::nearest(float eta, float phi, float dRmax, float* dR) const {
+		Nearest n = { dRmax*dRmax, -1 };
+		visit(eta, phi, dRmax, n);
+		if (dR) *dR = n.key >= 0 ? std::sqrt(n.best) : -1.f;
+		return n.key;
+	}
+
+	void TriggerObjectIndex::within(float eta, float phi, float dRmax, std::vector<unsigned>& keys) const {
+		keys.clear();
+		Within w = { dRmax*dRmax, &keys };
+		visit(eta, phi, dRmax, w);
+		std::sort(keys.begin(), keys.end());
+	}
+
+}
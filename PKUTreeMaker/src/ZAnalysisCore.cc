@@ -0,0 +1,881 @@
+#include "VAJets/PKUTreeMaker/interface/ZAnalysisCore.h"
+#include "VAJets/PKUTreeMaker/interface/JetKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ostream>
+
+#include "TTree.h"
+#include "TVector2.h"
+#include "CondFormats/JetMETObjects/interface/FactorizedJetCorrector.h"
+#include "DataFormats/Math/interface/deltaR.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+namespace pku {
+
+	ZAnalysisCore::ZAnalysisCore(const edm::ParameterSet& iConfig)
+		:TreeMakerLogic(iConfig)
+		 ,outTree_(0)
+		 ,jecAK4Jets_(iConfig, "jecAK4PayloadNames")
+	{
+		originalNEvents_ = iConfig.getParameter<int>("originalNEvents");
+		crossSectionPb_  = iConfig.getParameter<double>("crossSectionPb");
+		targetLumiInvPb_ = iConfig.getParameter<double>("targetLumiInvPb");
+		RunOnMC_           = iConfig.getParameter<bool>("RunOnMC");
+		if (RunOnMC_ && iConfig.existsAs<edm::ParameterSet>("pileupReweighting"))
+			pileup_ = pku::PileupReweighting(iConfig.getParameter<edm::ParameterSet>("pileupReweighting"));
+		sumGenWeightPU_     = summary_.counter("sumGenWeightPU");
+		sumGenWeightPUUp_   = summary_.counter("sumGenWeightPUUp");
+		sumGenWeightPUDown_ = summary_.counter("sumGenWeightPUDown");
+		sumGenSignPU_       = summary_.counter("sumGenSignPU");
+		outputFormat_ = iConfig.existsAs<std::string>("outputFormat") ? iConfig.getParameter<std::string>("outputFormat") : "root";
+		if (outputFormat_ != "root" && outputFormat_ != "columnar" && outputFormat_ != "both")
+			throw cms::Exception("Configuration") << "ZPKUTreeMaker: unknown outputFormat " << outputFormat_;
+		columnarFile_ = iConfig.existsAs<std::string>("columnarFile") ? iConfig.getParameter<std::string>("columnarFile") : "ZtreePKU.pkucol";
+		columnarRowGroup_ = iConfig.existsAs<int>("columnarRowGroup") ? iConfig.getParameter<int>("columnarRowGroup") : 10000;
+		columnarCodec_ = iConfig.existsAs<std::string>("columnarCodec") ? iConfig.getParameter<std::string>("columnarCodec") : "none";
+
+		/// The branch set is declared as data; only the branches selected by
+		/// keepBranches/dropBranches are booked, and the stages left without
+		/// any booked branch are not computed in process().
+		/// Basic event quantities
+		schema_.add("run", &run, pku::Stage::Event);
+		schema_.add("ls", &ls, pku::Stage::Event);
+		schema_.add("event", &nevent, pku::Stage::Event);
+		schema_.add("nVtx", &nVtx, pku::Stage::Event);
+		schema_.add("theWeight", &theWeight, pku::Stage::Weights);
+		schema_.add("nump", &nump, pku::Stage::Weights);
+		schema_.add("numm", &numm, pku::Stage::Weights);
+		schema_.add("pweight", pweight, pku::Stage::Weights);
+		schema_.add("npT", &npT, pku::Stage::Pileup);
+		schema_.add("lep", &lep, pku::Stage::Event);
+		schema_.add("ptVlep", &ptVlep, pku::Stage::Event);
+		schema_.add("yVlep", &yVlep, pku::Stage::Event);
+		schema_.add("phiVlep", &phiVlep, pku::Stage::Event);
+		schema_.add("massVlep", &massVlep, pku::Stage::Event);
+		schema_.add("nlooseeles", &nlooseeles, pku::Stage::Lepton);
+		schema_.add("nloosemus", &nloosemus, pku::Stage::Lepton);
+		schema_.add("ngoodmus", &ngoodmus, pku::Stage::Lepton);
+		schema_.add("genphoton_pt", genphoton_pt, pku::Stage::Gen);
+		schema_.add("genphoton_eta", genphoton_eta, pku::Stage::Gen);
+		schema_.add("genphoton_phi", genphoton_phi, pku::Stage::Gen);
+		schema_.add("genjet_pt", genjet_pt, pku::Stage::Gen);
+		schema_.add("genjet_eta", genjet_eta, pku::Stage::Gen);
+		schema_.add("genjet_phi", genjet_phi, pku::Stage::Gen);
+		schema_.add("genjet_e", genjet_e, pku::Stage::Gen);
+		schema_.add("genmuon_pt", genmuon_pt, pku::Stage::Gen);
+		schema_.add("genmuon_eta", genmuon_eta, pku::Stage::Gen);
+		schema_.add("genmuon_phi", genmuon_phi, pku::Stage::Gen);
+		schema_.add("genmuon_pid", genmuon_pid, pku::Stage::Gen);
+		schema_.add("genelectron_pt", genelectron_pt, pku::Stage::Gen);
+		schema_.add("genelectron_eta", genelectron_eta, pku::Stage::Gen);
+		schema_.add("genelectron_phi", genelectron_phi, pku::Stage::Gen);
+		/// Photon
+		schema_.add("photon_pt", photon_pt, pku::Stage::Photon);
+		schema_.add("photon_eta", photon_eta, pku::Stage::Photon);
+		schema_.add("photon_phi", photon_phi, pku::Stage::Photon);
+		schema_.add("photon_e", photon_e, pku::Stage::Photon);
+		schema_.add("photon_pev", photon_pev, pku::Stage::Photon);
+		schema_.add("photon_pevnew", photon_pevnew, pku::Stage::Photon);
+		schema_.add("photon_ppsv", photon_ppsv, pku::Stage::Photon);
+		schema_.add("photon_iseb", photon_iseb, pku::Stage::Photon);
+		schema_.add("photon_isee", photon_isee, pku::Stage::Photon);
+		schema_.add("photon_hoe", photon_hoe, pku::Stage::Photon);
+		schema_.add("photon_sieie", photon_sieie, pku::Stage::Photon);
+		schema_.add("photon_sieie2", photon_sieie2, pku::Stage::Photon);
+		schema_.add("photon_chiso", photon_chiso, pku::Stage::Photon);
+		schema_.add("photon_nhiso", photon_nhiso, pku::Stage::Photon);
+		schema_.add("photon_phoiso", photon_phoiso, pku::Stage::Photon);
+		schema_.add("photon_istrue", photon_istrue, pku::Stage::Photon);
+		schema_.add("photon_isprompt", photon_isprompt, pku::Stage::Photon);
+		schema_.add("photon_drla", photon_drla, pku::Stage::Photon);
+		schema_.add("photon_drla2", photon_drla2, pku::Stage::Photon);
+		schema_.add("photon_mla", photon_mla, pku::Stage::Photon);
+		schema_.add("photon_mla2", photon_mla2, pku::Stage::Photon);
+		schema_.add("photon_mva", photon_mva, pku::Stage::Photon);
+		// one block per photon selection: "" (medium) in the Photon stage, "_f" (fake
+		// template) and the configured control regions in the FakePhoton stage
+		for (size_t s = 0; s < photonBlocks_.size(); s++) {
+			pku::SelectedPhoton& block = photonBlocks_[s];
+			const std::string& sfx = photonSelections_[s].suffix;
+			const pku::Stage stage = s == 0 ? pku::Stage::Photon : pku::Stage::FakePhoton;
+			schema_.add("photonet" + sfx, &block.et, stage);
+			schema_.add("photoneta" + sfx, &block.eta, stage);
+			schema_.add("photonphi" + sfx, &block.phi, stage);
+			schema_.add("photone" + sfx, &block.e, stage);
+			schema_.add("photonsieie" + sfx, &block.sieie, stage);
+			schema_.add("photonphoiso" + sfx, &block.phoiso, stage);
+			schema_.add("photonchiso" + sfx, &block.chiso, stage);
+			schema_.add("photonnhiso" + sfx, &block.nhiso, stage);
+			schema_.add("iphoton" + sfx, &block.index, stage);
+			schema_.add("drla" + sfx, &block.drla, stage);
+			schema_.add("drla2" + sfx, &block.drla2, stage);
+			schema_.add("Mla" + sfx, &block.Mla, stage);
+			schema_.add("Mla2" + sfx, &block.Mla2, stage);
+			schema_.add("Mva" + sfx, &block.Mva, stage);
+		}
+		schema_.add("passEleVeto", &passEleVeto, pku::Stage::Photon);
+		schema_.add("passEleVetonew", &passEleVetonew, pku::Stage::Photon);
+		schema_.add("passPixelSeedVeto", &passPixelSeedVeto, pku::Stage::Photon);
+		schema_.add("isTrue", &isTrue_, pku::Stage::Photon);
+		schema_.add("isprompt", &isprompt_, pku::Stage::Photon);
+		//jets
+		schema_.add("ak4jet_pt", ak4jet_pt, pku::Stage::Jets);
+		schema_.add("ak4jet_eta", ak4jet_eta, pku::Stage::Jets);
+		schema_.add("ak4jet_phi", ak4jet_phi, pku::Stage::Jets);
+		schema_.add("ak4jet_e", ak4jet_e, pku::Stage::Jets);
+		schema_.add("ak4jet_csv", ak4jet_csv, pku::Stage::Jets);
+		schema_.add("ak4jet_icsv", ak4jet_icsv, pku::Stage::Jets);
+		schema_.add("jet1pt", &jet1pt, pku::Stage::VBS);
+		schema_.add("jet1pt_f", &jet1pt_f, pku::Stage::VBSFake);
+		schema_.add("jet1eta", &jet1eta, pku::Stage::VBS);
+		schema_.add("jet1eta_f", &jet1eta_f, pku::Stage::VBSFake);
+		schema_.add("jet1phi", &jet1phi, pku::Stage::VBS);
+		schema_.add("jet1phi_f", &jet1phi_f, pku::Stage::VBSFake);
+		schema_.add("jet1e", &jet1e, pku::Stage::VBS);
+		schema_.add("jet1e_f", &jet1e_f, pku::Stage::VBSFake);
+		schema_.add("jet1csv", &jet1csv, pku::Stage::VBS);
+		schema_.add("jet1csv_f", &jet1csv_f, pku::Stage::VBSFake);
+		schema_.add("jet1icsv", &jet1icsv, pku::Stage::VBS);
+		schema_.add("jet1icsv_f", &jet1icsv_f, pku::Stage::VBSFake);
+		schema_.add("jet2pt", &jet2pt, pku::Stage::VBS);
+		schema_.add("jet2pt_f", &jet2pt_f, pku::Stage::VBSFake);
+		schema_.add("jet2eta", &jet2eta, pku::Stage::VBS);
+		schema_.add("jet2eta_f", &jet2eta_f, pku::Stage::VBSFake);
+		schema_.add("jet2phi", &jet2phi, pku::Stage::VBS);
+		schema_.add("jet2phi_f", &jet2phi_f, pku::Stage::VBSFake);
+		schema_.add("jet2e", &jet2e, pku::Stage::VBS);
+		schema_.add("jet2e_f", &jet2e_f, pku::Stage::VBSFake);
+		schema_.add("jet2csv", &jet2csv, pku::Stage::VBS);
+		schema_.add("jet2csv_f", &jet2csv_f, pku::Stage::VBSFake);
+		schema_.add("jet2icsv", &jet2icsv, pku::Stage::VBS);
+		schema_.add("jet2icsv_f", &jet2icsv_f, pku::Stage::VBSFake);
+		schema_.add("drj1a", &drj1a, pku::Stage::VBS);
+		schema_.add("drj1a_f", &drj1a_f, pku::Stage::VBSFake);
+		schema_.add("drj2a", &drj2a, pku::Stage::VBS);
+		schema_.add("drj2a_f", &drj2a_f, pku::Stage::VBSFake);
+		schema_.add("drj1l", &drj1l, pku::Stage::VBS);
+		schema_.add("drj1l_f", &drj1l_f, pku::Stage::VBSFake);
+		schema_.add("drj2l", &drj2l, pku::Stage::VBS);
+		schema_.add("drj2l_f", &drj2l_f, pku::Stage::VBSFake);
+		schema_.add("drj1l2", &drj1l2, pku::Stage::VBS);
+		schema_.add("drj1l2_f", &drj1l2_f, pku::Stage::VBSFake);
+		schema_.add("drj2l2", &drj2l2, pku::Stage::VBS);
+		schema_.add("drj2l2_f", &drj2l2_f, pku::Stage::VBSFake);
+		schema_.add("Mjj", &Mjj, pku::Stage::VBS);
+		schema_.add("Mjj_f", &Mjj_f, pku::Stage::VBSFake);
+		schema_.add("deltaetajj", &deltaetajj, pku::Stage::VBS);
+		schema_.add("deltaetajj_f", &deltaetajj_f, pku::Stage::VBSFake);
+		schema_.add("zepp", &zepp, pku::Stage::VBS);
+		schema_.add("zepp_f", &zepp_f, pku::Stage::VBSFake);
+		schema_.add("ptlep1", &ptlep1, pku::Stage::Lepton);
+		schema_.add("etalep1", &etalep1, pku::Stage::Lepton);
+		schema_.add("philep1", &philep1, pku::Stage::Lepton);
+		schema_.add("ptlep2", &ptlep2, pku::Stage::Lepton);
+		schema_.add("etalep2", &etalep2, pku::Stage::Lepton);
+		schema_.add("philep2", &philep2, pku::Stage::Lepton);
+		//for muon rochester correction
+		schema_.add("muon1_trackerLayers", &muon1_trackerLayers, pku::Stage::Lepton);
+		schema_.add("matchedgenMu1_pt", &matchedgenMu1_pt, pku::Stage::GenMuonMatch);
+		schema_.add("muon2_trackerLayers", &muon2_trackerLayers, pku::Stage::Lepton);
+		schema_.add("matchedgenMu2_pt", &matchedgenMu2_pt, pku::Stage::GenMuonMatch);
+		//for muon rochester correction
+		schema_.add("j1metPhi", &j1metPhi, pku::Stage::VBS);
+		schema_.add("j1metPhi_f", &j1metPhi_f, pku::Stage::VBSFake);
+		schema_.add("j2metPhi", &j2metPhi, pku::Stage::VBS);
+		schema_.add("j2metPhi_f", &j2metPhi_f, pku::Stage::VBSFake);
+		// MET
+		schema_.add("MET_et", &MET_et, pku::Stage::MET);
+		schema_.add("MET_phi", &MET_phi, pku::Stage::MET);
+		//HLT bits
+		schema_.add("HLT_Ele1", &HLT_Ele1, pku::Stage::HLT);
+		schema_.add("HLT_Ele2", &HLT_Ele2, pku::Stage::HLT);
+		schema_.add("HLT_Mu1", &HLT_Mu1, pku::Stage::HLT);
+		schema_.add("HLT_Mu2", &HLT_Mu2, pku::Stage::HLT);
+		schema_.add("HLT_Mu3", &HLT_Mu3, pku::Stage::HLT);
+		schema_.add("HLT_Mu4", &HLT_Mu4, pku::Stage::HLT);
+		schema_.add("HLT_Mu5", &HLT_Mu5, pku::Stage::HLT);
+		schema_.add("HLT_Mu6", &HLT_Mu6, pku::Stage::HLT);
+		schema_.add("HLT_Mu7", &HLT_Mu7, pku::Stage::HLT);
+		schema_.add("HLT_Mu8", &HLT_Mu8, pku::Stage::HLT);
+		// filter
+		schema_.add("passFilter_HBHE", &passFilter_HBHE_, pku::Stage::Filters, "passFilter_HBHE_");
+		schema_.add("passFilter_HBHEIso", &passFilter_HBHEIso_, pku::Stage::Filters, "passFilter_HBHEIso_");
+		schema_.add("passFilter_globalTightHalo", &passFilter_globalTightHalo_, pku::Stage::Filters, "passFilter_globalTightHalo_");
+		schema_.add("passFilter_ECALDeadCell", &passFilter_ECALDeadCell_, pku::Stage::Filters, "passFilter_ECALDeadCell_");
+		schema_.add("passFilter_GoodVtx", &passFilter_GoodVtx_, pku::Stage::Filters, "passFilter_GoodVtx_");
+		schema_.add("passFilter_EEBadSc", &passFilter_EEBadSc_, pku::Stage::Filters, "passFilter_EEBadSc_");
+		schema_.add("passFilter_badMuon", &passFilter_badMuon_, pku::Stage::Filters, "passFilter_badMuon_");
+		schema_.add("passFilter_badChargedHadron", &passFilter_badChargedHadron_, pku::Stage::Filters, "passFilter_badChargedHadron_");
+
+		// Meng, badmuon, duplicate muon
+		schema_.add("passFilter_MetbadMuon", &passFilter_MetbadMuon_, pku::Stage::Filters, "passFilter_MetbadMuon_");
+		schema_.add("passFilter_duplicateMuon", &passFilter_duplicateMuon_, pku::Stage::Filters, "passFilter_duplicateMuon_");
+		schema_.add("lumiWeight", &lumiWeight, pku::Stage::Weights);
+		schema_.add("pileupWeight", &pileupWeight, pku::Stage::Weights);
+		schema_.add("pileupWeightUp", &pileupWeightUp, pku::Stage::Weights);
+		schema_.add("pileupWeightDown", &pileupWeightDown, pku::Stage::Weights);
+
+		// muon station2 retrieve, L1 issue, Meng 2017/3/26
+		schema_.add("lep1_eta_station2", &lep1_eta_station2, pku::Stage::Station2);
+		schema_.add("lep1_phi_station2", &lep1_phi_station2, pku::Stage::Station2);
+		schema_.add("lep1_sign", &lep1_sign, pku::Stage::Station2);
+		schema_.add("lep2_eta_station2", &lep2_eta_station2, pku::Stage::Station2);
+		schema_.add("lep2_phi_station2", &lep2_phi_station2, pku::Stage::Station2);
+		schema_.add("lep2_sign", &lep2_sign, pku::Stage::Station2);
+		//Lu
+
+		schema_.dependsOn(pku::Stage::GenMuonMatch, pku::Stage::Gen);
+		schema_.dependsOn(pku::Stage::FakePhoton,   pku::Stage::Photon);
+		schema_.dependsOn(pku::Stage::VBS,          pku::Stage::Photon);
+		schema_.dependsOn(pku::Stage::VBS,          pku::Stage::Jets);
+		schema_.dependsOn(pku::Stage::VBS,          pku::Stage::MET);
+		schema_.dependsOn(pku::Stage::VBSFake,      pku::Stage::FakePhoton);
+		schema_.dependsOn(pku::Stage::VBSFake,      pku::Stage::Jets);
+		schema_.dependsOn(pku::Stage::VBSFake,      pku::Stage::MET);
+		if (pileup_.enabled()) schema_.dependsOn(pku::Stage::Weights, pku::Stage::Pileup);
+		keepBranches_ = iConfig.existsAs<std::vector<std::string>>("keepBranches") ? iConfig.getParameter<std::vector<std::string>>("keepBranches") : std::vector<std::string>(1, "*");
+		dropBranches_ = iConfig.existsAs<std::vector<std::string>>("dropBranches") ? iConfig.getParameter<std::vector<std::string>>("dropBranches") : std::vector<std::string>();
+		/// On-disk encodings, e.g. cms.PSet(branches = cms.vstring("photon_eta"), encoding = cms.string("trunc:10"))
+		std::vector<edm::ParameterSet> branchEncodings = iConfig.existsAs<std::vector<edm::ParameterSet>>("branchEncodings") ? iConfig.getParameter<std::vector<edm::ParameterSet>>("branchEncodings") : std::vector<edm::ParameterSet>();
+		for (size_t i = 0; i < branchEncodings.size(); i++) {
+			pku::Encoding encoding = pku::Encoding::parse(branchEncodings[i].getParameter<std::string>("encoding"));
+			std::vector<std::string> patterns = branchEncodings[i].getParameter<std::vector<std::string>>("branches");
+			for (size_t j = 0; j < patterns.size(); j++) schema_.setEncoding(patterns[j], encoding);
+		}
+		if (iConfig.existsAs<edm::ParameterSet>("outputPolicy")) outputPolicy_ = pku::TreeOutputPolicy(iConfig.getParameter<edm::ParameterSet>("outputPolicy"));
+	}
+
+	//------------------------------------
+	void ZAnalysisCore::book(TTree* tree, bool columnar) {
+		outTree_ = tree;
+		schema_.book(outTree_, pku::BranchSelector(keepBranches_, dropBranches_));
+		if (outTree_) outputPolicy_.apply(outTree_);
+		if (columnar)
+			columnar_.reset(new pku::ColumnarWriter(columnarFile_, schema_, columnarRowGroup_, columnarCodec_ == "zstd" ? pku::columnar::Zstd : pku::columnar::None));
+	}
+
+	//------------------------------------
+	void ZAnalysisCore::finish(std::ostream& ss) {
+		schema_.printSummary(ss);
+		if (outTree_) {
+			ss << "entries=" << outTree_->GetEntries()
+			   << " totBytes=" << outTree_->GetTotBytes()
+			   << " zipBytes=" << outTree_->GetZipBytes() << "\n";
+			outputPolicy_.printSummary(ss, outTree_);
+		}
+		jecAK4chs_.printSummary(ss);
+		jecAK4Jets_.printSummary(ss);
+		pileup_.printSummary(ss);
+		summary_.printSummary(ss);
+		timer_.printSummary(ss);
+		if (columnar_) {
+			columnar_->close();
+			ss << "columnar rows=" << columnar_->rows() << " bytes=" << columnar_->bytesWritten() << "\n";
+		}
+	}
+
+	//------------------------------------
+	void ZAnalysisCore::process(const ZEventRecord& record)
+	{
+		pku::StageTimer::Scope eventTimer(timer_, stages_.event);
+		timer_.count(stages_.nEvents);
+		summary_.event();
+		timer_.enter(stages_.weights);
+		setDummyValues(); //Initalize variables with dummy values
+		nevent = record.event;
+		run    = record.run;
+		ls     = record.ls;
+		//events weight
+		if (RunOnMC_ && schema_.active(pku::Stage::Weights)){
+			theWeight = record.theWeight;
+			if(theWeight>0) nump = nump+1;
+			if(theWeight<0) numm = numm+1;
+		}
+		if (RunOnMC_ && schema_.active(pku::Stage::Pileup)){
+			nBX  = record.nBX;
+			npT  = record.npT;
+			npIT = record.npIT;
+		}
+		/// pileup weights from the table of pileupReweighting (1 without it),
+		/// and their sums with the generator weight over every MC event: the
+		/// record carries theWeight and npT of MC events whatever the stages
+		pileupWeight = pileupWeightUp = pileupWeightDown = 1.0;
+		if (RunOnMC_) {
+			pileup_.weights(record.npT, pileupWeight, pileupWeightUp, pileupWeightDown);
+			const double sign = record.theWeight > 0 ? 1. : (record.theWeight < 0 ? -1. : 0.);
+			summary_.add(sumGenWeightPU_,     record.theWeight*pileupWeight);
+			summary_.add(sumGenWeightPUUp_,   record.theWeight*pileupWeightUp);
+			summary_.add(sumGenWeightPUDown_, record.theWeight*pileupWeightDown);
+			summary_.add(sumGenSignPU_,       sign*pileupWeight);
+		}
+
+		timer_.enter(stages_.hlt);
+		if (schema_.active(pku::Stage::HLT)) {
+			HLT_Ele1 = record.HLT_Ele1;
+			HLT_Ele2 = record.HLT_Ele2;
+			HLT_Mu1  = record.HLT_Mu1;
+			HLT_Mu2  = record.HLT_Mu2;
+			HLT_Mu3  = record.HLT_Mu3;
+			HLT_Mu4  = record.HLT_Mu4;
+			HLT_Mu5  = record.HLT_Mu5;
+			HLT_Mu6  = record.HLT_Mu6;
+			HLT_Mu7  = record.HLT_Mu7;
+			HLT_Mu8  = record.HLT_Mu8;
+		}
+		if (record.status == ZEventRecord::NoLeptonicV) {  fillTree(); return;  }
+		summary_.add(cuts_.leptonicV);
+
+		double fastJetRho = record.rho;
+		useless = fastJetRho;
+
+		timer_.enter(stages_.gen);
+		if (RunOnMC_ && schema_.active(pku::Stage::Gen)){
+			int ipp=0, imm=0, iee=0;
+			for(size_t i=0; i<record.genParticles.size();i++){
+				const ZEventRecord::GenParticle& particle = record.genParticles[i];
+				if( abs(particle.pdgId)== 22 && ipp<6 ) {
+					genphoton_pt[ipp]=particle.pt;
+					genphoton_eta[ipp]=particle.eta;
+					genphoton_phi[ipp]=particle.phi;
+					ipp++;
+				}
+				if( abs(particle.pdgId)== 13 && imm<6 ) {
+					genmuon_pt[imm]=particle.pt;
+					genmuon_eta[imm]=particle.eta;
+					genmuon_phi[imm]=particle.phi;
+					genmuon_pid[imm]=particle.pdgId;
+					imm++;
+				}
+				if( abs(particle.pdgId)== 11 && iee<6 ) {
+					genelectron_pt[iee]=particle.pt;
+					genelectron_eta[iee]=particle.eta;
+					genelectron_phi[iee]=particle.phi;
+					iee++;
+				}
+			}
+			for(size_t ijj=0; ijj<record.genJets.size() && ijj<6; ijj++){
+				genjet_e[ijj] = record.genJets[ijj].e;
+				genjet_pt[ijj]= record.genJets[ijj].pt;
+				genjet_eta[ijj]= record.genJets[ijj].eta;
+				genjet_phi[ijj]=record.genJets[ijj].phi;
+			}
+		}
+
+		//filter
+		timer_.enter(stages_.filters);
+		if (schema_.active(pku::Stage::Filters)) {
+			passFilter_HBHE_             = record.passFilter_HBHE;
+			passFilter_HBHEIso_          = record.passFilter_HBHEIso;
+			passFilter_globalTightHalo_  = record.passFilter_globalTightHalo;
+			passFilter_ECALDeadCell_     = record.passFilter_ECALDeadCell;
+			passFilter_GoodVtx_          = record.passFilter_GoodVtx;
+			passFilter_EEBadSc_          = record.passFilter_EEBadSc;
+			passFilter_MetbadMuon_       = record.passFilter_MetbadMuon;
+			passFilter_duplicateMuon_    = record.passFilter_duplicateMuon;
+			passFilter_badMuon_          = record.passFilter_badMuon;
+			passFilter_badChargedHadron_ = record.passFilter_badChargedHadron;
+		}
+
+		timer_.enter(stages_.vertices);
+		if (record.vertices.empty()) { fillTree(); return;} // skip the event if no PV found
+		summary_.add(cuts_.vertex);
+		nVtx = record.vertices.size();
+		bool goodVertex = false;
+		for (size_t iv = 0; iv < record.vertices.size() && !goodVertex; iv++) {
+			const ZEventRecord::Vertex& vtx = record.vertices[iv];
+			// Replace isFake() for miniAOD because it requires tracks and miniAOD vertices don't have tracks:
+			// Vertex.h: bool isFake() const {return (chi2_==0 && ndof_==0 && tracks_.empty());}
+			goodVertex = !(vtx.chi2==0 && vtx.ndof==0)
+				&& vtx.ndof>=4. && vtx.rho<=2.0
+				&& fabs(vtx.z)<=24.0;
+		}
+		if (!goodVertex) {fillTree();  return;} // skip event if there are no good PVs
+		summary_.add(cuts_.goodVertex);
+
+
+		// ************************* MET ********************** //
+		timer_.enter(stages_.met);
+		if(record.hasMET && schema_.active(pku::Stage::MET)){
+			timer_.enter(stages_.typeI);
+			record.getTypeIJets(typeIJets_);
+			typeICorrection(typeIJets_, run, fastJetRho);
+			timer_.enter(stages_.met);
+			for (size_t im = 0; im < record.mets.size(); im++) {
+				const float rawPt = record.mets[im].uncorPt;
+				const float rawPhi = record.mets[im].uncorPhi;
+				const float rawSumEt = record.mets[im].uncorSumEt;
+				TVector2 rawMET_;
+				rawMET_.SetMagPhi (rawPt, rawPhi );
+				Double_t rawPx = rawMET_.Px();
+				Double_t rawPy = rawMET_.Py();
+				Double_t rawEt = std::hypot(rawPx,rawPy);
+				METraw_et = rawEt;
+				METraw_phi = rawPhi;
+				METraw_sumEt = rawSumEt;
+
+				double pxcorr = rawPx+TypeICorrMap_["corrEx"];
+				double pycorr = rawPy+TypeICorrMap_["corrEy"];
+				double et     = std::hypot(pxcorr,pycorr);
+				double sumEtcorr = rawSumEt+TypeICorrMap_["corrSumEt"];
+				TLorentzVector corrmet;
+				corrmet.SetPxPyPzE(pxcorr,pycorr,0.,et);
+				useless = sumEtcorr;
+				useless = rawEt;
+				MET_et = et;
+				MET_phi = corrmet.Phi();
+				MET_sumEt = sumEtcorr;
+				MET_corrPx = TypeICorrMap_["corrEx"];
+				MET_corrPy = TypeICorrMap_["corrEy"];
+			}
+		}
+		//------------------------------------
+		/// For the time being, set this to 1
+		triggerWeight=1.0;
+		double targetEvents = targetLumiInvPb_*crossSectionPb_;
+		lumiWeight = targetEvents/originalNEvents_;
+		lep          = std::max(abs(record.lepton1.pdgId), abs(record.lepton2.pdgId));
+		ptVlep       = record.ptV;
+		yVlep        = record.etaV;
+		phiVlep      = record.phiV;
+		massVlep     = record.massV;
+		// muon station2 retrieve, L1 issue, Meng 2017/3/26
+		if(record.ngoodmus>1){
+			lep1_sign = record.lepton1.pdgId;
+			lep2_sign = record.lepton2.pdgId;
+		}
+		if(record.ngoodmus>1 && schema_.active(pku::Stage::Station2)){
+			lep1_eta_station2 = record.lep1_eta_station2;
+			lep1_phi_station2 = record.lep1_phi_station2;
+			lep2_eta_station2 = record.lep2_eta_station2;
+			lep2_phi_station2 = record.lep2_phi_station2;
+		}
+		// Lu
+		ptlep1       = record.lepton1.pt;
+		etalep1      = record.lepton1.eta;
+		philep1      = record.lepton1.phi;
+		ptlep2       = record.lepton2.pt;
+		etalep2      = record.lepton2.eta;
+		philep2      = record.lepton2.phi;
+		// for muon rochester correction
+		if(record.ngoodmus>1){
+			muon1_trackerLayers      = record.muon1_trackerLayers;
+			muon2_trackerLayers      = record.muon2_trackerLayers;
+		}
+		if(lep==13 && schema_.active(pku::Stage::GenMuonMatch))
+		{
+			double dr_temp=1e2;
+			double matchmuon_pt = -1e2;
+			for (int i=0;i<6;i++)
+			{
+				if(lep1_sign==genmuon_pid[i])
+				{
+					double dr_mugenmu=getDR(etalep1,philep1,genmuon_eta[i],genmuon_phi[i]);
+					if(dr_mugenmu<dr_temp) {matchmuon_pt=genmuon_pt[i];dr_temp=dr_mugenmu;}
+				}
+			}
+			if(dr_temp<0.3) matchedgenMu1_pt=matchmuon_pt;
+		}
+		if(lep==13 && schema_.active(pku::Stage::GenMuonMatch))
+		{
+			double dr_temp=1e2;
+			double matchmuon_pt = -1e2;
+			for (int i=0;i<6;i++)
+			{
+				if(lep2_sign==genmuon_pid[i])
+				{
+					double dr_mugenmu=getDR(etalep2,philep2,genmuon_eta[i],genmuon_phi[i]);
+					if(dr_mugenmu<dr_temp) {matchmuon_pt=genmuon_pt[i];dr_temp=dr_mugenmu;}
+				}
+			}
+			if(dr_temp<0.3) matchedgenMu2_pt=matchmuon_pt;
+		}
+		// for muon rochester correction
+		double energylep1     = record.lepton1.energy;
+		double energylep2     = record.lepton2.energy;
+		met          = record.met;
+		metPhi       = record.metPhi;
+		nlooseeles = record.nlooseeles;
+		nloosemus = record.nloosemus;
+		ngoodmus = record.ngoodmus;
+		TLorentzVector  glepton;
+		glepton.SetPtEtaPhiE(ptlep1, etalep1, philep1, energylep1);
+		TLorentzVector  glepton2;
+		glepton2.SetPtEtaPhiE(ptlep2, etalep2, philep2, energylep2);
+
+		// ************************* Photon Jets Information****************** //
+		// *************************************************************//
+		timer_.enter(stages_.photons);
+		double rhoVal_;
+		rhoVal_=-99.;
+		rhoVal_ = record.rho;
+
+		const bool doFakePhoton = schema_.active(pku::Stage::FakePhoton);
+		size_t nPhotons = schema_.active(pku::Stage::Photon) ? record.photons.size() : 0;
+		timer_.count(stages_.nPhotons, nPhotons);
+		TLorentzVector zp4;
+		zp4.SetPtEtaPhiE(record.ptV, record.etaV, record.phiV, record.energyV);
+
+		photonVars_.clear();
+		photonMasks_.clear();
+		for (size_t ip=0; ip<nPhotons;ip++)
+		{
+			const ZEventRecord::Photon& photon = record.photons[ip];
+			const float* EA = photonEA_.areas(fabs(photon.eta));
+
+			pku::photon::Variables v;
+			v.pt = photon.pt;
+			v.eta = photon.scEta;
+			v.phi = photon.scPhi;
+			v.energy = photon.energy;
+			v.hoe = photon.hoe;
+			v.sieie = photon.sieie;
+			v.chiso = std::max(0.0, photon.chIso - rhoVal_*EA[pku::EffectiveAreaTable::ChargedHadron]);
+			v.nhiso = std::max(0.0, photon.nhIso - rhoVal_*EA[pku::EffectiveAreaTable::NeutralHadron]);
+			v.phoiso = std::max(0.0, photon.phoIso - rhoVal_*EA[pku::EffectiveAreaTable::Photon]);
+			const double drla1 = reco::deltaR(v.eta, v.phi, etalep1, philep1);
+			const double drla2 = reco::deltaR(v.eta, v.phi, etalep2, philep2);
+			v.drLepton = std::min(drla1, drla2);
+			v.isEB = photon.isEB;
+			v.isEE = photon.isEE;
+			v.eleVeto = photon.eleVeto;
+			photonVars_.push_back(v);
+			photonMasks_.push_back(pku::photon::classify(v));
+
+			passEleVeto = photon.passEleVeto;
+
+			passEleVetonew=v.eleVeto;
+			passPixelSeedVeto=photon.hasPixelSeed;
+
+
+			if(ip<6)  {
+				photon_pt[ip] = v.pt;
+				photon_eta[ip] = v.eta;
+				photon_phi[ip] = v.phi;
+				photon_e[ip] = v.energy;
+				photon_pev[ip]=passEleVeto;
+				photon_pevnew[ip]=passEleVetonew;
+				photon_ppsv[ip]=passPixelSeedVeto;
+				photon_iseb[ip]=v.isEB;
+				photon_isee[ip]=v.isEE;
+				photon_hoe[ip]=v.hoe;
+				photon_sieie[ip]=v.sieie;
+				photon_sieie2[ip]=photon.sieie;
+				photon_chiso[ip]=v.chiso;
+				photon_nhiso[ip]=v.nhiso;
+				photon_phoiso[ip]=v.phoiso;
+				if(RunOnMC_ && photon_pt[ip]>0){
+					photon_istrue[ip]=photon.istrue;
+					photon_isprompt[ip]=photon.isprompt;
+				}
+				photon_drla[ip]=drla1;
+				photon_drla2[ip]=drla2;
+				TLorentzVector tp4;
+				tp4.SetPtEtaPhiE(photon_pt[ip],photon_eta[ip],photon_phi[ip],photon_e[ip]);
+				photon_mla[ip]=(tp4+glepton).M();
+				photon_mla2[ip]=(tp4+glepton2).M();
+				photon_mva[ip]=(tp4+glepton+glepton2).M();
+			}
+		}
+
+		// nominal (medium) photon, and with the FakePhoton stage the fake-rate ("_f")
+		// one and the configured control regions, all from one ranking
+		selectPhotons(doFakePhoton ? photonBlocks_.size() : 1);
+		for (size_t s=0; s<photonBlocks_.size(); s++) {
+			pku::SelectedPhoton& block = photonBlocks_[s];
+			if(block.index<0) continue;
+			block.drla=reco::deltaR(block.eta,block.phi,etalep1,philep1);
+			block.drla2=reco::deltaR(block.eta,block.phi,etalep2,philep2);
+			TLorentzVector photonp4;
+			photonp4.SetPtEtaPhiE(block.et, block.eta, block.phi, block.e);
+			block.Mla=(photonp4+glepton).M();
+			block.Mla2=(photonp4+glepton2).M();
+			block.Mva=(photonp4+zp4).M();
+		}
+		const pku::SelectedPhoton& nominalPhoton = photonBlocks_[0];
+		const pku::SelectedPhoton& fakePhoton = photonBlocks_[1];
+
+		//Gen photon matching
+		if(RunOnMC_ && nominalPhoton.index>-1){
+			isTrue_= record.photons[nominalPhoton.index].istrue;
+			isprompt_= record.photons[nominalPhoton.index].isprompt;
+		}
+
+		// ************************* AK4 Jets Information****************** //
+		// ***********************************************************//
+		timer_.enter(stages_.jets);
+		Int_t jetindexphoton12[2] = {-1,-1};
+		Int_t jetindexphoton12_f[2] = {-1,-1};
+
+		size_t nAK4Jets = schema_.active(pku::Stage::Jets) ? record.jets.size() : 0;
+		if (nAK4Jets>0) jecAK4_ = jecAK4Jets_.corrector(run);
+		timer_.count(stages_.nJets, nAK4Jets);
+
+		int nujets=0 ;
+		double tmpjetptcut=20.0;
+		jets_.clear();
+
+		//################Jet Correction##########################
+		for (size_t ik=0; ik<nAK4Jets;ik++)
+		{
+			const ZEventRecord::Jet& ak4jet = record.jets[ik];
+			math::XYZTLorentzVector uncorrJet(ak4jet.px, ak4jet.py, ak4jet.pz, ak4jet.e);
+			jecAK4_->setJetEta( uncorrJet.eta() );
+			jecAK4_->setJetPt ( uncorrJet.pt() );
+			jecAK4_->setJetE ( uncorrJet.energy() );
+			jecAK4_->setRho ( rhoVal_ );
+			jecAK4_->setNPV ( record.vertices.size() );
+			jecAK4_->setJetA ( ak4jet.area );
+			double corr = jecAK4_->getCorrection();
+			if(corr*uncorrJet.pt()>tmpjetptcut) {
+				TLorentzVector dummy(0,0,0,0);
+				dummy.SetPtEtaPhiE(corr*uncorrJet.pt(), uncorrJet.eta(), uncorrJet.phi(), corr*uncorrJet.energy());
+				jets_.push_back(dummy);
+				++nujets;
+			}
+			if(ik<6)  {
+				ak4jet_pt[ik] =  corr*uncorrJet.pt();
+				ak4jet_eta[ik] = ak4jet.eta;
+				ak4jet_phi[ik] = ak4jet.phi;
+				ak4jet_e[ik] =   corr*uncorrJet.energy();
+				ak4jet_csv[ik] = ak4jet.csv;
+				ak4jet_icsv[ik] = ak4jet.icsv;   }
+		}
+		timer_.enter(stages_.matching);
+		pku::rankByPt(jets_);
+		if(nominalPhoton.index>-1 && schema_.active(pku::Stage::VBS))
+			pku::taggingJets(jets_, nominalPhoton.eta, nominalPhoton.phi, jetindexphoton12);
+		if(fakePhoton.index>-1 && schema_.active(pku::Stage::VBSFake))
+			pku::taggingJets(jets_, fakePhoton.eta, fakePhoton.phi, jetindexphoton12_f);
+
+		// the b-tag values are taken from ak4jetsSrc at the pt-ranked index, as always
+		if(jetindexphoton12[0]>-1 && jetindexphoton12[1]>-1) {
+			jet1pt=jets_[jetindexphoton12[0]].Pt();
+			jet1eta=jets_[jetindexphoton12[0]].Eta();
+			jet1phi=jets_[jetindexphoton12[0]].Phi();
+			jet1e=jets_[jetindexphoton12[0]].E();
+			jet2pt=jets_[jetindexphoton12[1]].Pt();
+			jet2eta=jets_[jetindexphoton12[1]].Eta();
+			jet2phi=jets_[jetindexphoton12[1]].Phi();
+			jet2e=jets_[jetindexphoton12[1]].E();
+			jet1csv =record.jets[jetindexphoton12[0]].csv;
+			jet2csv =record.jets[jetindexphoton12[1]].csv;
+			jet1icsv =record.jets[jetindexphoton12[0]].icsv;
+			jet2icsv =record.jets[jetindexphoton12[1]].icsv;
+			drj1a=reco::deltaR(jet1eta,jet1phi,nominalPhoton.eta,nominalPhoton.phi);
+			drj2a=reco::deltaR(jet2eta,jet2phi,nominalPhoton.eta,nominalPhoton.phi);
+			drj1l=reco::deltaR(jet1eta,jet1phi,etalep1,philep1);
+			drj2l=reco::deltaR(jet2eta,jet2phi,etalep1,philep1);
+			drj1l2=reco::deltaR(jet1eta,jet1phi,etalep2,philep2);
+			drj2l2=reco::deltaR(jet2eta,jet2phi,etalep2,philep2);
+			TLorentzVector photonp42;
+			photonp42.SetPtEtaPhiE(nominalPhoton.et, nominalPhoton.eta, nominalPhoton.phi, nominalPhoton.e);
+			TLorentzVector vp4;
+			vp4.SetPtEtaPhiE(record.ptV, record.etaV, record.phiV, record.energyV);
+			const pku::VbsObservables vbs(jets_[jetindexphoton12[0]], jets_[jetindexphoton12[1]], photonp42, vp4, MET_phi);
+			j1metPhi=vbs.j1metPhi;
+			j2metPhi=vbs.j2metPhi;
+			Mjj=vbs.Mjj;
+			deltaetajj = vbs.deltaetajj;
+			zepp = vbs.zepp;
+		}
+
+
+		if(jetindexphoton12_f[0]>-1 && jetindexphoton12_f[1]>-1) {
+			jet1pt_f=jets_[jetindexphoton12_f[0]].Pt();
+			jet1eta_f=jets_[jetindexphoton12_f[0]].Eta();
+			jet1phi_f=jets_[jetindexphoton12_f[0]].Phi();
+			jet1e_f=jets_[jetindexphoton12_f[0]].E();
+			jet2pt_f=jets_[jetindexphoton12_f[1]].Pt();
+			jet2eta_f=jets_[jetindexphoton12_f[1]].Eta();
+			jet2phi_f=jets_[jetindexphoton12_f[1]].Phi();
+			jet2e_f=jets_[jetindexphoton12_f[1]].E();
+			jet1csv_f =record.jets[jetindexphoton12_f[0]].csv;
+			jet2csv_f =record.jets[jetindexphoton12_f[1]].csv;
+			jet1icsv_f =record.jets[jetindexphoton12_f[0]].icsv;
+			jet2icsv_f =record.jets[jetindexphoton12_f[1]].icsv;
+			drj1a_f=reco::deltaR(jet1eta_f,jet1phi_f,fakePhoton.eta,fakePhoton.phi);
+			drj2a_f=reco::deltaR(jet2eta_f,jet2phi_f,fakePhoton.eta,fakePhoton.phi);
+			drj1l_f=reco::deltaR(jet1eta_f,jet1phi_f,etalep1,philep1);
+			drj2l_f=reco::deltaR(jet2eta_f,jet2phi_f,etalep1,philep1);
+			drj1l2_f=reco::deltaR(jet1eta_f,jet1phi_f,etalep2,philep2);
+			drj2l2_f=reco::deltaR(jet2eta_f,jet2phi_f,etalep2,philep2);
+			TLorentzVector photonp42_f;
+			photonp42_f.SetPtEtaPhiE(fakePhoton.et, fakePhoton.eta, fakePhoton.phi, fakePhoton.e);
+			TLorentzVector vp4_f;
+			vp4_f.SetPtEtaPhiE(record.ptV, record.etaV, record.phiV, record.energyV);
+			const pku::VbsObservables vbs_f(jets_[jetindexphoton12_f[0]], jets_[jetindexphoton12_f[1]], photonp42_f, vp4_f, MET_phi);
+			j1metPhi_f=vbs_f.j1metPhi;
+			j2metPhi_f=vbs_f.j2metPhi;
+			Mjj_f=vbs_f.Mjj;
+			deltaetajj_f = vbs_f.deltaetajj;
+			zepp_f = vbs_f.zepp;
+
+		}
+
+		fillTree();
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------------------------//
+
+	void ZAnalysisCore::setDummyValues() {
+		// muon station2 retrieve, L1 issue, Meng 2017/3/26
+		lep1_sign = -1e2;
+		lep2_sign = -1e2;
+		lep1_eta_station2 = -99.;
+		lep1_phi_station2 = -99.;
+		lep2_eta_station2 = -99.;
+		lep2_phi_station2 = -99.;
+		//Lu
+		npT=-1.;
+		npIT=-1.;
+		nBX=-1;
+		nVtx           = -1e1;
+		triggerWeight  = -1e1;
+		pileupWeight   = -1e1;
+		pileupWeightUp   = -1e1;
+		pileupWeightDown = -1e1;
+		lumiWeight     = -1e1;
+		theWeight = -99;
+		lep            = -1e1;
+		nlooseeles=-1e1;
+		nloosemus=-1e1;
+		ngoodmus = -1e1;
+		ptVlep         = -1e1;
+		yVlep          = -1e1;
+		phiVlep        = -1e1;
+		massVlep       = -1e1;
+		ptlep1         = -1e1;
+		etalep1        = -1e1;
+		philep1        = -1e1;
+		ptlep2         = -1e1;
+		etalep2        = -1e1;
+		philep2        = -1e1;
+		// for muon rochester correction
+		muon1_trackerLayers =-1e1;
+		muon2_trackerLayers =-1e1;
+		matchedgenMu1_pt =-1e2;
+		matchedgenMu2_pt =-1e2;
+		// for muon rochester correction
+		met            = -1e1;
+		metPhi         = -1e1;
+		j1metPhi         = -1e1; j1metPhi_f         = -1e1;
+		j2metPhi         = -1e1; j2metPhi_f         = -1e1;
+		METraw_et = -99;
+		METraw_phi = -99;
+		METraw_sumEt = -99;
+		genMET=-99;
+		MET_et = -99;
+		MET_phi = -99;
+		MET_sumEt = -99;
+		for(int j=0; j<703; j++){
+			pweight[j]=0.0;
+		}
+		for(int i=0; i<6;i++){
+			genjet_pt[i]  = -1e1;
+			genjet_eta[i]  = -1e1;
+			genjet_phi[i]  = -1e1;
+			genjet_e[i]  = -1e1;
+		}      
+		for(int i=0; i<6; i++) {
+			genphoton_pt[i] = -1e1;
+			genphoton_eta[i] = -1e1;
+			genphoton_phi[i] = -1e1;
+			genmuon_pt[i] = -1e1;
+			genmuon_eta[i] = -1e1;
+			genmuon_phi[i] = -1e1;
+			genmuon_pid[i] = -1e2;
+			genelectron_pt[i] = -1e1;
+			genelectron_eta[i] = -1e1;
+			genelectron_phi[i] = -1e1;
+			photon_pt[i] = -1e1;
+			photon_eta[i] = -1e1;
+			photon_phi[i] = -1e1;
+			photon_e[i] = -1e1;
+			photon_pev[i] = false;
+			photon_pevnew[i] = false;
+			photon_ppsv[i] = false;
+			photon_iseb[i] = false;
+			photon_isee[i] = false;
+			photon_hoe[i] = -1e1;
+			photon_sieie[i] = -1e1;
+			photon_sieie2[i] = -1e1;
+			photon_chiso[i] = -1e1;
+			photon_nhiso[i] = -1e1;
+			photon_phoiso[i] = -1e1;
+			photon_istrue[i] = -1;
+			photon_isprompt[i] = -1;
+			photon_drla[i] = 1e1;
+			photon_drla2[i] = 1e1;
+			photon_mla[i]=-1e1;
+			photon_mla2[i]=-1e1;
+			photon_mva[i]=-1e1;
+			ak4jet_pt[i]=-1e1;
+			ak4jet_eta[i]=-1e1;
+			ak4jet_phi[i]=-1e1;
+			ak4jet_e[i]=-1e1;
+			ak4jet_csv[i]=-1e1;
+			ak4jet_icsv[i]=-1e1;
+		}
+
+		for (size_t s=0; s<photonBlocks_.size(); s++) photonBlocks_[s].reset();
+		passEleVeto=false;
+		passEleVetonew=false;
+		passPixelSeedVeto=false;
+
+
+		ISRPho = false;
+		dR_ = 999;
+		isTrue_=-1;
+		isprompt_=-1; 
+		jet1pt=-1e1;  jet1pt_f=-1e1;
+		jet1eta=-1e1;  jet1eta_f=-1e1;
+		jet1phi=-1e1;  jet1phi_f=-1e1;
+		jet1e=-1e1;  jet1e_f=-1e1;
+		jet1csv=-1e1;  jet1csv_f=-1e1;
+		jet1icsv=-1e1;  jet1icsv_f=-1e1;
+		jet2pt=-1e1;  jet2pt_f=-1e1;
+		jet2eta=-1e1;  jet2eta_f=-1e1;
+		jet2phi=-1e1;  jet2phi_f=-1e1;
+		jet2e=-1e1;  jet2e_f=-1e1;
+		jet2csv=-1e1;  jet2csv_f=-1e1;
+		jet2icsv=-1e1;  jet2icsv_f=-1e1;
+		drj1a=1e1;  drj1a_f=1e1;
+		drj2a=1e1;  drj2a_f=1e1;
+		drj1l=1e1;  drj1l_f=1e1;
+		drj2l=1e1;  drj2l_f=1e1;
+		drj1l2=1e1;  drj1l2_f=1e1;
+		drj2l2=1e1;  drj2l2_f=1e1;
+		Mjj=-1e1;   Mjj_f=-1e1;
+		deltaetajj=-1e1;   deltaetajj_f=-1e1;
+		zepp=-1e1;   zepp_f=-1e1;
+	
+
+		HLT_Ele1=-99;
+		HLT_Ele2=-99;
+		HLT_Mu1=-99;
+		HLT_Mu2=-99;
+		HLT_Mu3=-99;
+		HLT_Mu4=-99;
+		HLT_Mu5=-99;
+		HLT_Mu6=-99;
+		HLT_Mu7=-99;
+		HLT_Mu8=-99;
+
+
+		passFilter_HBHE_                  = false;
+		passFilter_HBHEIso_               = false;
+		passFilter_globalTightHalo_       = false;
+		passFilter_ECALDeadCell_          = false;
+		passFilter_GoodVtx_               = false;
+		passFilter_EEBadSc_               = false;
+		passFilter_badMuon_               = false;
+		passFilter_badChargedHadron_      = false; 
+		// Meng
+		passFilter_MetbadMuon_	       = false;
+		passFilter_duplicateMuon_ 	       = false;
+	}
+
+}
@@ -0,0 +1,204 @@
+#include "VAJets/PKUTreeMaker/interface/ZEventRecord.h"
+
+#include <cstring>
+#include <type_traits>
+
+#include "Rtypes.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+namespace pku {
+
+	namespace {
+		const char kMagic[8] = { 'P', 'K', 'U', 'Z', 'R', 'E', 'C', '1' };
+		const UInt_t kVersion = 1;
+
+		// appends the fields of a record to a buffer
+		class OutArchive {
+			public:
+				explicit OutArchive(std::string& buffer) : buffer_(buffer) {}
+
+				template<class T>
+				typename std::enable_if<std::is_arithmetic<T>::value, OutArchive&>::type operator&(const T& x) {
+					buffer_.append(reinterpret_cast<const char*>(&x), sizeof(T));
+					return *this;
+				}
+				template<class T>
+				typename std::enable_if<std::is_class<T>::value, OutArchive&>::type operator&(T& x) {
+					x.io(*this);
+					return *this;
+				}
+				template<class T> OutArchive& operator&(std::vector<T>& v) {
+					const UInt_t n = v.size();
+					*this & n;
+					for (std::size_t i = 0; i < v.size(); i++) *this & v[i];
+					return *this;
+				}
+
+			private:
+				std::string& buffer_;
+		};
+
+		// reads the fields of a record back from a buffer
+		class InArchive {
+			public:
+				InArchive(const std::string& buffer, unsigned long event) : p_(buffer.data()), end_(buffer.data() + buffer.size()), event_(event) {}
+
+				template<class T>
+				typename std::enable_if<std::is_arithmetic<T>::value, InArchive&>::type operator&(T& x) {
+					if (p_ + sizeof(T) > end_) throw cms::Exception("ZRecordReader") << "truncated record " << event_;
+					std::memcpy(&x, p_, sizeof(T));
+					p_ += sizeof(T);
+					return *this;
+				}
+				template<class T>
+				typename std::enable_if<std::is_class<T>::value, InArchive&>::type operator&(T& x) {
+					x.io(*this);
+					return *this;
+				}
+				template<class T> InArchive& operator&(std::vector<T>& v) {
+					UInt_t n = 0;
+					*this & n;
+					if (n > std::size_t(end_ - p_)) throw cms::Exception("ZRecordReader") << "corrupt record " << event_;
+					v.resize(n);
+					for (std::size_t i = 0; i < v.size(); i++) *this & v[i];
+					return *this;
+				}
+				bool done() const { return p_ == end_; }
+
+			private:
+				const char* p_;
+				const char* end_;
+				unsigned long event_;
+		};
+	}
+
+	//------------------------------------
+	void ZEventRecord::clear() {
+		status = NoLeptonicV;
+		run = ls = event = 0;
+		theWeight = -99;
+		nBX = -1;
+		npT = npIT = -1.;
+		HLT_Ele1 = HLT_Ele2 = -99;
+		HLT_Mu1 = HLT_Mu2 = HLT_Mu3 = HLT_Mu4 = HLT_Mu5 = HLT_Mu6 = HLT_Mu7 = HLT_Mu8 = -99;
+		passFilter_HBHE = passFilter_HBHEIso = passFilter_globalTightHalo = passFilter_ECALDeadCell = false;
+		passFilter_GoodVtx = passFilter_EEBadSc = passFilter_badMuon = passFilter_badChargedHadron = false;
+		passFilter_MetbadMuon = passFilter_duplicateMuon = false;
+		rho = 0.;
+		genParticles.clear();
+		genJets.clear();
+		nlooseeles = nloosemus = ngoodmus = -1e1;
+		muon1_trackerLayers = muon2_trackerLayers = -1e1;
+		lep1_eta_station2 = lep1_phi_station2 = lep2_eta_station2 = lep2_phi_station2 = -99.;
+		ptV = etaV = phiV = massV = energyV = 0.;
+		lepton1 = lepton2 = Lepton();
+		met = metPhi = 0.;
+		vertices.clear();
+		hasMET = false;
+		mets.clear();
+		typeIJets.clear();
+		photons.clear();
+		jets.clear();
+	}
+
+	void ZEventRecord::setTypeIJets(const std::vector<pku::TypeIJet>& in) {
+		typeIJets.resize(in.size());
+		for (std::size_t i = 0; i < in.size(); i++) {
+			TypeIJet& j = typeIJets[i];
+			j.px = in[i].uncorrected.px(); j.py = in[i].uncorrected.py(); j.pz = in[i].uncorrected.pz(); j.e = in[i].uncorrected.e();
+			j.subPx = in[i].subtracted.px(); j.subPy = in[i].subtracted.py(); j.subPz = in[i].subtracted.pz(); j.subE = in[i].subtracted.e();
+			j.area = in[i].area;
+		}
+	}
+
+	void ZEventRecord::getTypeIJets(std::vector<pku::TypeIJet>& out) const {
+		out.resize(typeIJets.size());
+		for (std::size_t i = 0; i < typeIJets.size(); i++) {
+			const TypeIJet& j = typeIJets[i];
+			out[i].uncorrected = math::XYZTLorentzVector(j.px, j.py, j.pz, j.e);
+			out[i].subtracted  = math::XYZTLorentzVector(j.subPx, j.subPy, j.subPz, j.subE);
+			out[i].area = j.area;
+		}
+	}
+
+	//------------------------------------
+	ZRecordWriter::ZRecordWriter(const std::string& path, const std::string& configuration)
+		: out_(path.c_str(), std::ios::binary | std::ios::trunc), events_(0), bytes_(0)
+	{
+		if (!out_) throw cms::Exception("ZRecordWriter") << "cannot open " << path;
+		write(kMagic, sizeof(kMagic));
+		write(&kVersion, sizeof(kVersion));
+		const UInt_t length = configuration.size();
+		write(&length, sizeof(length));
+		write(configuration.data(), configuration.size());
+	}
+
+	ZRecordWriter::~ZRecordWriter() {
+		try { close(); } catch (...) {}
+	}
+
+	void ZRecordWriter::write(const void* data, std::size_t size) {
+		out_.write(static_cast<const char*>(data), size);
+		if (!out_) throw cms::Exception("ZRecordWriter") << "write error after " << bytes_ << " bytes";
+		bytes_ += size;
+	}
+
+	void ZRecordWriter::write(ZEventRecord& record) {
+		buffer_.clear();
+		OutArchive ar(buffer_);
+		record.io(ar);
+		const UInt_t length = buffer_.size();
+		write(&length, sizeof(length));
+		write(buffer_.data(), buffer_.size());
+		++events_;
+	}
+
+	void ZRecordWriter::close() {
+		if (out_.is_open()) out_.close();
+	}
+
+	//------------------------------------
+	ZRecordReader::ZRecordReader(const std::string& path)
+		: path_(path), in_(path.c_str(), std::ios::binary), events_(0)
+	{
+		if (!in_) throw cms::Exception("ZRecordReader") << "cannot open " << path;
+		char magic[sizeof(kMagic)];
+		UInt_t version = 0, length = 0;
+		if (!read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+			throw cms::Exception("ZRecordReader") << path << " is not a ZPKUTreeMaker record file";
+		if (!read(&version, sizeof(version)))
+			throw cms::Exception("ZRecordReader") << path << ": truncated header";
+		if (version == __builtin_bswap32(kVersion))
+			throw cms::Exception("ZRecordReader") << path << " was written on a host of the other byte order";
+		if (version != kVersion)
+			throw cms::Exception("ZRecordReader") << path << ": record version " << version << ", expected " << kVersion;
+		if (!read(&length, sizeof(length)))
+			throw cms::Exception("ZRecordReader") << path << ": truncated header";
+		configuration_.resize(length);
+		if (length && !read(&configuration_[0], length))
+			throw cms::Exception("ZRecordReader") << path << ": truncated header";
+	}
+
+	bool ZRecordReader::read(void* data, std::size_t size) {
+		in_.read(static_cast<char*>(data), size);
+		return std::size_t(in_.gcount()) == size;
+	}
+
+	bool ZRecordReader::next(ZEventRecord& record) {
+		UInt_t length = 0;
+		in_.read(reinterpret_cast<char*>(&length), sizeof(length));
+		if (in_.gcount() == 0) return false;
+		if (std::size_t(in_.gcount()) != sizeof(length))
+			throw cms::Exception("ZRecordReader") << path_ << ": truncated record " << events_;
+		buffer_.resize(length);
+		if (length && !read(&buffer_[0], length))
+			throw cms::Exception("ZRecordReader") << path_ << ": truncated record " << events_;
+		InArchive ar(buffer_, events_);
+		record.io(ar);
+		if (!ar.done())
+			throw cms::Exception("ZRecordReader") << path_ << ": record " << events_ << " longer than its fields";
+		++events_;
+		return true;
+	}
+
+}
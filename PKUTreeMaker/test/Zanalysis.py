@@ -57,10 +57,10 @@ process.calibratedPatPhotons.isMC = cms.bool(runOnMC)
 #for egamma smearing
 
 # If Update
-process.goodMuons.src = "slimmedMuons"
-#process.goodElectrons.src = "slimmedElectrons"
+process.muonIds.src = "slimmedMuons"
+#process.electronIds.src = "slimmedElectrons"
 #process.goodPhotons.src = "slimmedPhotons"
-process.goodElectrons.src = "calibratedPatElectrons"
+process.electronIds.src = "calibratedPatElectrons"
 process.goodPhotons.src = "calibratedPatPhotons"
 
 process.load("VAJets.PKUCommon.goodJets_cff") 
@@ -151,6 +151,12 @@ process.treeDumper = cms.EDAnalyzer("ZPKUTreeMaker",
                                     generator =  cms.InputTag("generator"),
 				    genJet =  cms.InputTag("slimmedGenJets"),
                                     pileup  =   cms.InputTag("slimmedAddPileupInfo"),
+                                    # pileup weights (nominal, up, down) from pileupCalc.py histograms, see
+                                    # PileupReweighting.h; the MC profile of the mixing module, e.g.
+                                    # from SimGeneral.MixingModule.mix_2016_25ns_Moriond17MC_PoissonOOTPU_cfi import mix
+                                    # pileupReweighting = cms.PSet(
+                                    #     data = cms.vstring("PileupData_69200.root", "PileupData_72383.root", "PileupData_66017.root"),
+                                    #     mc = mix.input.nbPileupEvents.probValue),
                                     leptonicVSrc = cms.InputTag("leptonicV"),
                                     rho = cms.InputTag("fixedGridRhoFastjetAll"),   
                                     ak4jetsSrc = cms.InputTag("cleanAK4Jets"),      
@@ -200,7 +206,53 @@ process.treeDumper = cms.EDAnalyzer("ZPKUTreeMaker",
                                     phoPhotonIsolation = cms.InputTag("photonIDValueMapProducer:phoPhotonIsolation"),
                                     effAreaChHadFile = cms.FileInPath("RecoEgamma/PhotonIdentification/data/Spring15/effAreaPhotons_cone03_pfChargedHadrons_25ns_NULLcorrection.txt"),
                                     effAreaNeuHadFile= cms.FileInPath("RecoEgamma/PhotonIdentification/data/Spring15/effAreaPhotons_cone03_pfNeutralHadrons_25ns_90percentBased.txt"),
-                                    effAreaPhoFile   = cms.FileInPath("RecoEgamma/PhotonIdentification/data/Spring15/effAreaPhotons_cone03_pfPhotons_25ns_90percentBased.txt")
+                                    effAreaPhoFile   = cms.FileInPath("RecoEgamma/PhotonIdentification/data/Spring15/effAreaPhotons_cone03_pfPhotons_25ns_90percentBased.txt"),
+                                    # ZPKUCandidates branches to write (wildcards allowed); producer stages left
+                                    # without any written branch are not computed. Minimal schema example:
+                                    # dropBranches = cms.vstring("*_f", "*_station2", "lep?_sign", "gen*", "matchedgen*")
+                                    keepBranches = cms.vstring("*"),
+                                    dropBranches = cms.vstring(),
+                                    # on-disk encodings (native, float32, trunc:N, fixed16:lo:hi, int8, bits:GROUP),
+                                    # read back with pku::NtupleReader. Compact example:
+                                    # branchEncodings = cms.VPSet(
+                                    #     cms.PSet(branches = cms.vstring("*eta*", "*phi*"), encoding = cms.string("trunc:12")),
+                                    #     cms.PSet(branches = cms.vstring("*pt*", "*e", "*mass*"), encoding = cms.string("trunc:14")),
+                                    #     cms.PSet(branches = cms.vstring("drla*", "drj*"), encoding = cms.string("fixed16:0:10")),
+                                    #     cms.PSet(branches = cms.vstring("HLT_*"), encoding = cms.string("int8")),
+                                    #     cms.PSet(branches = cms.vstring("passFilter_*"), encoding = cms.string("bits:passFilter_bits")),
+                                    #     cms.PSet(branches = cms.vstring("photon_pev", "photon_pevnew", "photon_ppsv",
+                                    #                                     "photon_iseb", "photon_isee"), encoding = cms.string("bits:photon_flags")),
+                                    # ),
+                                    branchEncodings = cms.VPSet(),
+                                    # compression and basket layout of ZPKUCandidates, see TreeOutputPolicy.h
+                                    outputPolicy = cms.PSet(
+                                        compressionAlgorithm = cms.string("LZMA"),
+                                        compressionLevel = cms.int32(4),
+                                        autoFlush = cms.int64(10000),
+                                        entriesPerBasket = cms.int32(10000),
+                                        calibrationEntries = cms.int64(1000)
+                                        ),
+                                    # "root", "columnar" or "both"; the columnar file holds the same branches
+                                    outputFormat = cms.string("root"),
+                                    columnarFile = cms.string("ZtreePKU.pkucol"),
+                                    columnarRowGroup = cms.int32(10000),
+                                    columnarCodec = cms.string("none"),
+                                    # write the inputs of every event for bin/replayZTreeMaker.cc, see ZEventRecord.h
+                                    # recordFile = cms.string("ZtreePKU.zrec"),
+                                    # checkpoint the tree and write ZtreePKU.root.ckpt.json so that a failed job
+                                    # resumes (test/resumeCheckpoint.py), see Checkpoint.h
+                                    # checkpoint = cms.PSet(everyLumis = cms.int32(20), everySeconds = cms.double(600)),
+                                    # treeDumper/LumiSummary: per-lumi events, sums of the generator weights and
+                                    # cut flow, merged with hadd (LumiSummary.h); lumiSummary = cms.bool(False) drops it,
+                                    # lheWeights also sums every LHE weight
+                                    # lheWeights = cms.InputTag("externalLHEProducer"),
+                                    # per-stage latency and counters of analyze(), see StageTimer.h; the same
+                                    # PSet works on JetUserData, the ID selectors and the lepton producers
+                                    timing = cms.PSet(
+                                        enabled = cms.bool(False),
+                                        report = cms.string("treeDumper_timing.json"),
+                                        histograms = cms.string("")
+                                        )
                                     )
 
 
@@ -57,10 +57,10 @@ process.calibratedPatPhotons.isMC = cms.bool(runOnMC)
 #for egamma smearing
 
 # If Update
-process.goodMuons.src = "slimmedMuons"
-#process.goodElectrons.src = "slimmedElectrons"
+process.muonIds.src = "slimmedMuons"
+#process.electronIds.src = "slimmedElectrons"
 #process.goodPhotons.src = "slimmedPhotons"
-process.goodElectrons.src = "calibratedPatElectrons"
+process.electronIds.src = "calibratedPatElectrons"
 process.goodPhotons.src = "calibratedPatPhotons"
 
 process.load("VAJets.PKUCommon.goodJets_cff") 
@@ -120,18 +120,9 @@ if runOnMC:
           'Summer16_23Sep2016V3_MC_L3Absolute_AK4PFPuppi.txt'
     ]
 else:
-   jecLevelsAK4chs = [
-          'Summer16_23Sep2016BCDV3_DATA_L1FastJet_AK4PFchs.txt',
-          'Summer16_23Sep2016BCDV3_DATA_L2Relative_AK4PFchs.txt',
-          'Summer16_23Sep2016BCDV3_DATA_L3Absolute_AK4PFchs.txt',
-	  'Summer16_23Sep2016BCDV3_DATA_L2L3Residual_AK4PFchs.txt'
-    ]
-   jecLevelsAK4puppi = [
-          'Summer16_23Sep2016BCDV3_DATA_L1FastJet_AK4PFPuppi.txt',
-          'Summer16_23Sep2016BCDV3_DATA_L2Relative_AK4PFPuppi.txt',
-          'Summer16_23Sep2016BCDV3_DATA_L3Absolute_AK4PFPuppi.txt',
-	  'Summer16_23Sep2016BCDV3_DATA_L2L3Residual_AK4PFPuppi.txt'
-    ]
+   # data: one payload set per run range (jecEras below), no default
+   jecLevelsAK4chs = []
+   jecLevelsAK4puppi = []
 #end------------JEC on the fly--------
 
 if chsorpuppi:
@@ -139,6 +130,13 @@ if chsorpuppi:
 else:
       ak4jecsrc = jecLevelsAK4puppi
 
+# run range -> Summer16_23Sep2016 payload set, so that one job covers Run2016B-H;
+# the tree makers pick the correctors by run number
+from VAJets.PKUCommon.jecEras_cff import jecEras2016
+jecEras = cms.VPSet()
+if not runOnMC:
+   jecEras = jecEras2016(jecAK4chsPayloadNames = 'PFchs', jecAK4PayloadNames = 'PFchs' if chsorpuppi else 'PFpuppi')
+
 process.load("RecoEgamma/PhotonIdentification/PhotonIDValueMapProducer_cfi")
    
 process.treeDumper = cms.EDAnalyzer("ZPKUTreeMaker",
@@ -160,6 +158,7 @@ process.treeDumper = cms.EDAnalyzer("ZPKUTreeMaker",
                                     genSrc =  cms.InputTag("prunedGenParticles"),       
                                     jecAK4chsPayloadNames = cms.vstring( jecLevelsAK4chs ),
                                     jecAK4PayloadNames = cms.vstring( ak4jecsrc ),
+                                    jecEras = jecEras,
                                     metSrc = cms.InputTag("slimmedMETs"),
                                     vertex = cms.InputTag("offlineSlimmedPrimaryVertices"),  
                                     t1jetSrc = cms.InputTag("slimmedJets"),      
@@ -205,7 +204,14 @@ process.treeDumper = cms.EDAnalyzer("ZPKUTreeMaker",
                                     )
 
 
+# golden JSON selection before any producer runs; simulated events pass through
+process.lumiMask = cms.EDFilter("CertifiedLumiFilter",
+                                jsonFile = cms.string("Cert_271036-284044_13TeV_23Sep2016ReReco_Collisions16_JSON.txt"),
+                                lumiByLS = cms.string("")   # optional brilcalc --byls csv for the recorded-lumi fraction
+                               )
+
 process.analysis = cms.Path(
+                            process.lumiMask +
 #                            process.goodOfflinePrimaryVertex +
                             process.leptonSequence +
                             process.jetSequence +
@@ -57,10 +57,10 @@ process.calibratedPatPhotons.isMC = cms.bool(runOnMC)
 #for egamma smearing
 
 # If Update
-process.goodMuons.src = "slimmedMuons"
-#process.goodElectrons.src = "slimmedElectrons"
+process.muonIds.src = "slimmedMuons"
+#process.electronIds.src = "slimmedElectrons"
 #process.goodPhotons.src = "slimmedPhotons"
-process.goodElectrons.src = "calibratedPatElectrons"
+process.electronIds.src = "calibratedPatElectrons"
 process.goodPhotons.src = "calibratedPatPhotons"
 
 process.load("VAJets.PKUCommon.goodJets_cff") 
@@ -205,7 +205,14 @@ process.treeDumper = cms.EDAnalyzer("ZPKUTreeMaker",
                                     )
 
 
+# golden JSON selection before any producer runs; simulated events pass through
+process.lumiMask = cms.EDFilter("CertifiedLumiFilter",
+                                jsonFile = cms.string("Cert_271036-284044_13TeV_23Sep2016ReReco_Collisions16_JSON.txt"),
+                                lumiByLS = cms.string("")   # optional brilcalc --byls csv for the recorded-lumi fraction
+                               )
+
 process.analysis = cms.Path(
+                            process.lumiMask +
 #                            process.goodOfflinePrimaryVertex +
                             process.leptonSequence +
                             process.jetSequence +
@@ -57,8 +57,8 @@ process.calibratedPatPhotons.isMC = cms.bool(runOnMC)
 #for egamma smearing
 
 # If Update
-process.goodMuons.src = "slimmedMuons"
-process.goodElectrons.src = "calibratedPatElectrons"
+process.muonIds.src = "slimmedMuons"
+process.electronIds.src = "calibratedPatElectrons"
 process.goodPhotons.src = "calibratedPatPhotons"
 
 process.load("VAJets.PKUCommon.goodJets_cff") 
@@ -57,10 +57,10 @@ process.load("VAJets.PKUCommon.leptonicZ_cff")
 #for egamma smearing
 
 # If Update
-process.goodMuons.src = "slimmedMuons"
-process.goodElectrons.src = "slimmedElectrons"
+process.muonIds.src = "slimmedMuons"
+process.electronIds.src = "slimmedElectrons"
 process.goodPhotons.src = "slimmedPhotons"
-#process.goodElectrons.src = "calibratedPatElectrons"
+#process.electronIds.src = "calibratedPatElectrons"
 #process.goodPhotons.src = "calibratedPatPhotons"
 
 process.load("VAJets.PKUCommon.goodJets_cff") 
@@ -33,8 +33,8 @@ process.load("VAJets.PKUCommon.goodPhotons_cff")
 process.load("VAJets.PKUCommon.leptonicZ_cff")
 
 # If Update
-process.goodMuons.src = "slimmedMuons"
-process.goodElectrons.src = "slimmedElectrons"
+process.muonIds.src = "slimmedMuons"
+process.electronIds.src = "slimmedElectrons"
 process.goodPhotons.src = "slimmedPhotons"
 
 # jerc uncer 2017/5/7
@@ -47,7 +47,7 @@ else:
 
 jer_era = "Summer16_23Sep2016V3_MC"
 triggerResultsLabel      = "TriggerResults"
-triggerSummaryLabel      = "hltTriggerSummaryAOD"
+triggerObjectsLabel      = "slimmedPatTrigger"
 hltProcess = "HLT"
 
 #begin------------JEC on the fly--------
@@ -89,7 +89,7 @@ process.JetUserData = cms.EDProducer(
    scaleFactorsFile  = cms.string(jer_era+'_SF_'+jetAlgo+'.txt'),
    ### TTRIGGER ###
    triggerResults = cms.InputTag(triggerResultsLabel,"",hltProcess),
-   triggerSummary = cms.InputTag(triggerSummaryLabel,"",hltProcess),
+   triggerObjects = cms.InputTag(triggerObjectsLabel),
    hltJetFilter       = cms.InputTag("hltPFHT"),
    hltPath            = cms.string("HLT_PFHT800"),
    hlt2reco_deltaRmax = cms.double(0.2),
@@ -100,12 +100,9 @@ process.JetUserData = cms.EDProducer(
 #jerc uncer Meng
 
 process.load("VAJets.PKUCommon.goodJets_cff") 
-if chsorpuppi:
-#      process.goodAK4Jets.src = "slimmedJets"
-	process.goodAK4Jets.src = "JetUserData"
-	# jerc uncer Meng
-else:
-      process.goodAK4Jets.src = "slimmedJetsPuppi"
+# the JetUserData jets (jLabel), cleaned by constituent key before the jet ID;
+# jerc uncer Meng
+process.keyCleanAK4Jets.src = "JetUserData"
 
 #process.goodOfflinePrimaryVertex = cms.EDFilter("VertexSelector",
 #                                       src = cms.InputTag("offlineSlimmedPrimaryVertices"),
@@ -134,7 +131,7 @@ process.leptonSequence = cms.Sequence(process.muSequence +
                                       process.leptonicVSelector +
                                       process.leptonicVFilter )
 
-process.jetSequence = cms.Sequence(process.NJetsSequence)
+process.jetSequence = cms.Sequence(process.NJetsKeyCleanSequence)
 
 process.load('RecoMET.METFilters.BadPFMuonFilter_cfi')
 process.load("RecoMET.METFilters.BadChargedCandidateFilter_cfi")
@@ -163,7 +160,7 @@ process.treeDumper = cms.EDAnalyzer("ZPKUTreeMaker",
                                     pileup  =   cms.InputTag("slimmedAddPileupInfo"),
                                     leptonicVSrc = cms.InputTag("leptonicV"),
                                     rho = cms.InputTag("fixedGridRhoFastjetAll"),   
-                                    ak4jetsSrc = cms.InputTag("cleanAK4Jets"),      
+                                    ak4jetsSrc = cms.InputTag("goodKeyCleanAK4Jets"),      
 #                                    photonSrc = cms.InputTag("goodPhotons"),
                                     photonSrc = cms.InputTag("slimmedPhotons"),
                                     genSrc =  cms.InputTag("prunedGenParticles"),       
@@ -29,8 +29,8 @@ process.load("VAJets.PKUCommon.goodPhotons_cff")
 process.load("VAJets.PKUCommon.leptonicW_cff")
 
 # If Update
-process.goodMuons.src = "slimmedMuons"
-process.goodElectrons.src = "slimmedElectrons"
+process.muonIds.src = "slimmedMuons"
+process.electronIds.src = "slimmedElectrons"
 process.goodPhotons.src = "slimmedPhotons"
 process.Wtoenu.MET  = "slimmedMETs"
 process.Wtomunu.MET = "slimmedMETs"
@@ -15,7 +15,7 @@ elif not(runOnMC):
 option = 'RECO'
 process.load("VAJets.PKUCommon.goodElectrons_cff")
 if option == 'RECO':
-    process.goodElectrons.src = "slimmedElectrons"
+    process.electronIds.src = "slimmedElectrons"
     process.mediumElectrons.src = "slimmedElectrons"
 
 from PhysicsTools.SelectorUtils.tools.vid_id_tools import *
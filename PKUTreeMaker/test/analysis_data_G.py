@@ -31,8 +31,8 @@ process.load("VAJets.PKUCommon.goodPhotons_cff")
 process.load("VAJets.PKUCommon.leptonicW_cff")
 
 # If Update
-process.goodMuons.src = "slimmedMuons"
-process.goodElectrons.src = "slimmedElectrons"
+process.muonIds.src = "slimmedMuons"
+process.electronIds.src = "slimmedElectrons"
 process.goodPhotons.src = "slimmedPhotons"
 process.Wtoenu.MET  = "slimmedMETs"
 process.Wtomunu.MET = "slimmedMETs"
@@ -167,7 +167,14 @@ process.treeDumper = cms.EDAnalyzer("PKUTreeMaker",
                                     )
 
 
+# golden JSON selection before any producer runs; simulated events pass through
+process.lumiMask = cms.EDFilter("CertifiedLumiFilter",
+                                jsonFile = cms.string("Cert_271036-284044_13TeV_23Sep2016ReReco_Collisions16_JSON.txt"),
+                                lumiByLS = cms.string("")   # optional brilcalc --byls csv for the recorded-lumi fraction
+                               )
+
 process.analysis = cms.Path(
+                            process.lumiMask +
 #                            process.goodOfflinePrimaryVertex +
                             process.leptonSequence +
                             process.jetSequence +
@@ -0,0 +1,104 @@
+#!/usr/bin/env python
+"""Checks that pkuReplayZTreeMaker reproduces the ntuple of cmsRun.
+
+cmsRun runs a Z tree maker configuration once with recordFile set, then
+pkuReplayZTreeMaker replays the records with every --threads count (the
+N-thread outputs are merged with hadd), and pkuDiffNtuples compares every
+replayed ntuple with the one of cmsRun, without tolerance: every branch of
+every event must be bitwise equal.
+
+    ./checkReplay.py Zanalysis.py --events 2000 --threads 1,8
+    ./checkReplay.py Zanalysis_data.py --files files.txt --events 5000
+
+  * The configuration is run from its directory, as the crab jobs are, so
+    that the JEC payload names resolve; the replay runs there too.
+  * outputFormat is forced to "root", the only output the replay writes.
+  * --files replaces the input files of the configuration, one per line.
+  * The exit status is 0 when every replay matches, 1 otherwise.
+"""
+
+import optparse
+import os
+import subprocess
+import sys
+
+RECORD_CFG = """import os, sys
+sys.path.insert(0, %(configDir)r)
+exec(open(%(config)r).read())
+if %(files)r:
+    process.source.fileNames = cms.untracked.vstring(%(files)r)
+process.maxEvents.input = %(events)d
+process.TFileService.fileName = cms.string(%(output)r)
+process.treeDumper.outputFormat = cms.string("root")
+process.treeDumper.recordFile = cms.string(%(records)r)
+"""
+
+
+def run(command, log, cwd):
+    with open(log, "w") as out:
+        status = subprocess.call(command, cwd=cwd, stdout=out, stderr=subprocess.STDOUT)
+    if status != 0:
+        print("%s exited with %s, see %s" % (command[0], status, log))
+    return status == 0
+
+
+def main():
+    parser = optparse.OptionParser(usage="%prog [config.py] [options]")
+    parser.add_option("--files", help="text file with the input files, one per line [those of the config]")
+    parser.add_option("--events", type="int", default=1000, help="events of the cmsRun job [%default]")
+    parser.add_option("--threads", default="1,4", help="thread counts of the replay [%default]")
+    parser.add_option("--workdir", help="configs, logs and outputs [replay_<config>]")
+    opts, args = parser.parse_args()
+
+    config = os.path.abspath(args[0] if args else "Zanalysis.py")
+    if len(args) > 1 or not os.path.exists(config):
+        parser.error("give one existing config")
+    configDir = os.path.dirname(config)
+    name = os.path.splitext(os.path.basename(config))[0]
+    workdir = os.path.abspath(opts.workdir or "replay_" + name)
+    if not os.path.isdir(workdir):
+        os.makedirs(workdir)
+    files = []
+    if opts.files:
+        files = [l.strip() for l in open(opts.files) if l.strip() and not l.startswith("#")]
+    threads = [int(t) for t in opts.threads.split(",") if t]
+
+    reference = os.path.join(workdir, "cmssw.root")
+    records = os.path.join(workdir, "cmssw.zrec")
+    cfg = os.path.join(workdir, "record_cfg.py")
+    with open(cfg, "w") as out:
+        out.write(RECORD_CFG % dict(configDir=configDir, config=config, files=files, events=opts.events,
+                                    output=reference, records=records))
+    if not run(["cmsRun", cfg], os.path.join(workdir, "cmsRun.log"), configDir):
+        return 1
+
+    results = []
+    for n in threads:
+        output = os.path.join(workdir, "replay_t%d.root" % n)
+        if not run(["pkuReplayZTreeMaker", records, "--threads", str(n), "--output", output],
+                   os.path.join(workdir, "replay_t%d.log" % n), configDir):
+            results.append((n, "replay failed"))
+            continue
+        if n > 1:
+            parts = [os.path.join(workdir, "replay_t%d_%d.root" % (n, i)) for i in range(n)]
+            merged = os.path.join(workdir, "replay_t%d_merged.root" % n)
+            if not run(["hadd", "-f", merged] + parts, os.path.join(workdir, "hadd_t%d.log" % n), workdir):
+                results.append((n, "hadd failed"))
+                continue
+            output = merged
+        same = run(["pkuDiffNtuples", reference, output, "--list", "10"],
+                   os.path.join(workdir, "diff_t%d.log" % n), workdir)
+        results.append((n, "identical" if same else "DIFFERENT, see diff_t%d.log" % n))
+
+    print("++++++++++++++++++++++++++++++++++++++++++++++++++")
+    print("checkReplay SUMMARY: %s, %d events, records %.1f MB" % (
+        name, opts.events, os.path.getsize(records) / 1e6 if os.path.exists(records) else 0.))
+    for n, result in results:
+        print("  %d thread(s): %s" % (n, result))
+    print("  logs and outputs in %s" % workdir)
+    print("++++++++++++++++++++++++++++++++++++++++++++++++++")
+    return 0 if results and all(r == "identical" for n, r in results) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -33,8 +33,8 @@ process.load("VAJets.PKUCommon.goodPhotons_cff")
 process.load("VAJets.PKUCommon.leptonicZ_cff")
 
 # If Update
-process.goodMuons.src = "slimmedMuons"
-process.goodElectrons.src = "slimmedElectrons"
+process.muonIds.src = "slimmedMuons"
+process.electronIds.src = "slimmedElectrons"
 process.goodPhotons.src = "slimmedPhotons"
 
 # jerc uncer 2017/5/7
@@ -0,0 +1,107 @@
+#!/usr/bin/env python
+"""Resumes a checkpointed tree maker job from its sidecars.
+
+A job with the "checkpoint" PSet of treeDumper (see interface/Checkpoint.h)
+writes <output>.ckpt.json next to its TFileService file.  When the job dies,
+the same configuration with
+
+    from resumeCheckpoint import resume
+    resume(process)
+
+at its end runs the next segment: the output goes to <output>_seg<k>.root
+and the input files closed in every earlier segment are dropped.  The file
+that was open at the checkpoint is read again from its start; no
+luminosity block is skipped, since lumisToSkip would apply to every file
+and lose the events of a block split across files.  pkuMergeNtuples then
+joins the segments, cutting each at its last checkpoint, dropping the
+events already taken (by run, ls and event) and the summary rows written
+again for the blocks that had ended in the open file:
+
+    pkuMergeNtuples ZtreePKU_all.root ZtreePKU.root ZtreePKU_seg1.root
+
+Run as a script, it prints the state of the segments of an output:
+
+    ./resumeCheckpoint.py ZtreePKU.root
+"""
+
+import glob
+import json
+import os
+import re
+import sys
+
+
+def segmentName(output, k):
+    base, ext = os.path.splitext(output)
+    return output if k == 0 else "%s_seg%d%s" % (base, k, ext)
+
+
+def segments(output):
+    """(k, sidecar) of every segment of output with a sidecar, in order"""
+    base, ext = os.path.splitext(output)
+    found = []
+    if os.path.exists(output + ".ckpt.json"):
+        found.append((0, json.load(open(output + ".ckpt.json"))))
+    for path in glob.glob("%s_seg*%s.ckpt.json" % (base, ext)):
+        m = re.match(re.escape(base) + r"_seg(\d+)" + re.escape(ext) + r"\.ckpt\.json$", path)
+        if m:
+            found.append((int(m.group(1)), json.load(open(path))))
+    return sorted(found, key=lambda s: s[0])
+
+
+def lfn(name):
+    """the part of a file name that is the same in the config and in the job"""
+    i = name.find("/store/")
+    if i >= 0:
+        return name[i:]
+    return name[len("file:"):] if name.startswith("file:") else name
+
+
+def resume(process, output=None, module="treeDumper"):
+    """points process at the next segment of output (the TFileService file by default)"""
+    import FWCore.ParameterSet.Config as cms
+
+    output = output or process.TFileService.fileName.value()
+    done = segments(output)
+    if not done:
+        print("resumeCheckpoint: no sidecar of %s, the job starts over" % output)
+        return process
+    k, last = done[-1]
+    if last.get("complete"):
+        raise RuntimeError("%s is complete, nothing to resume" % segmentName(output, k))
+
+    closed = set(lfn(f) for _, s in done for f in s.get("closedFiles", []))
+    files = [f for f in process.source.fileNames.value() if lfn(f) not in closed]
+    process.source.fileNames = cms.untracked.vstring(files)
+    nextOutput = segmentName(output, k + 1)
+    process.TFileService.fileName = cms.string(nextOutput)
+    dumper = getattr(process, module)
+    if not hasattr(dumper, "checkpoint"):
+        dumper.checkpoint = cms.PSet(everyLumis=cms.int32(20))
+    dumper.checkpoint.segment = cms.int32(k + 1)
+    if hasattr(dumper.checkpoint, "sidecar"):
+        dumper.checkpoint.sidecar = cms.string(nextOutput + ".ckpt.json")
+    print("resumeCheckpoint: segment %d into %s, %d files closed, %d files left, %d lumis of %s read again, %d entries kept of %s" % (
+        k + 1, nextOutput, len(closed), len(files), len(last.get("lumis", [])), last.get("file") or "-",
+        last.get("entries", 0), segmentName(output, k)))
+    return process
+
+
+def main():
+    if len(sys.argv) != 2:
+        print("usage: %s output.root" % sys.argv[0])
+        return 2
+    output = sys.argv[1]
+    done = segments(output)
+    for k, s in done:
+        print("%s: %s, %d entries at checkpoint %d, last %d:%d:%d, %d closed files, open %s (%d events), overhead %.1f s" % (
+            segmentName(output, k), "complete" if s.get("complete") else "incomplete", s.get("entries", 0),
+            s.get("checkpoint", 0), s["last"]["run"], s["last"]["ls"], s["last"]["event"],
+            len(s.get("closedFiles", [])), s.get("file") or "-", s.get("fileEvents", 0), s["overhead"]["total_s"]))
+    if not done:
+        print("no sidecar of %s" % output)
+    return 0 if done and done[-1][1].get("complete") else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,381 @@
+#!/usr/bin/env python
+"""Runs a tree maker configuration over a list of files on the local cores.
+
+The local counterpart of the crab configs in Zcrab/ and Wcrab/: the input
+files are split into shards that N cmsRun processes run with one of the
+Zanalysis*.py / analysis*.py configurations, and the outputs are merged into
+one file as the shards finish.
+
+    ./runLocal.py Zanalysis.py --files files.txt --jobs 32 --output ZtreePKU_DY.root
+    ./runLocal.py --crab Zcrab/crab3_analysisDY.py --jobs 32
+
+  * --files is a text file with one file per line (LFN, xrootd URL or local
+    path); with --crab the psetName, the inputDataset (through dasgoclient)
+    and the requestName of a crab config are taken instead.
+  * Load balancing: the files are handed out largest first.  Until a shard
+    has finished every shard is one file; then the measured throughput
+    (bytes/s of a process) sizes the shards to about --shard-seconds, and
+    smaller towards the end so that the processes finish together.  Files
+    whose size is unknown (remote without dasgoclient sizes) count as the
+    median size.
+  * A failed shard is rerun, one file per shard, up to --retries times; the
+    log of every attempt stays in the work directory.
+  * With --checkpoint-lumis N treeDumper checkpoints its output every N
+    luminosity blocks (Checkpoint.h); a failed shard that left a sidecar is
+    resumed from it as a whole (resumeCheckpoint.py) instead of split, and
+    its segments are joined with pkuMergeNtuples before the merge.
+  * Merging: a merger thread appends every finished shard to the output with
+    "hadd -a -fk", which copies the compressed baskets without
+    recompressing them.  The entries are in the order the shards finished;
+    pkuDiffNtuples aligns events by (run, ls, event) when comparing.
+  * The report gives the events per second of the whole run and per core.
+
+Every shard writes its TFileService file, and the columnar, timing and
+record files of treeDumper when the configuration uses them, under
+--workdir.  The configuration is run from its own directory, where the JEC
+payload files are.
+"""
+
+import glob
+import optparse
+import os
+import re
+import subprocess
+import sys
+import threading
+import time
+
+try:
+    from multiprocessing import cpu_count
+except ImportError:
+    def cpu_count():
+        return 1
+
+SHARD_CFG = """import os, sys
+sys.path.insert(0, %(configDir)r)
+exec(open(%(config)r).read())
+process.source.fileNames = cms.untracked.vstring(%(files)r)
+process.maxEvents.input = -1
+process.TFileService.fileName = cms.string(%(output)r)
+if hasattr(process, "treeDumper"):
+    dumper = process.treeDumper
+    if hasattr(dumper, "columnarFile"): dumper.columnarFile = cms.string(%(prefix)r + ".pkucol")
+    if hasattr(dumper, "recordFile"): dumper.recordFile = cms.string(%(prefix)r + ".zrec")
+    if hasattr(dumper, "timing") and hasattr(dumper.timing, "report"):
+        dumper.timing.report = cms.string(%(prefix)r + "_timing.json")
+    if hasattr(dumper, "timing") and hasattr(dumper.timing, "histograms") and dumper.timing.histograms.value():
+        dumper.timing.histograms = cms.string(%(prefix)r + "_timing.root")
+    if %(checkpointLumis)d > 0:
+        dumper.checkpoint = cms.PSet(everyLumis = cms.int32(%(checkpointLumis)d))
+if %(resume)r:
+    sys.path.insert(0, %(testDir)r)
+    from resumeCheckpoint import resume
+    resume(process, %(output)r)
+"""
+
+
+class Shard(object):
+    def __init__(self, index, files, attempt, resumes=0):
+        self.index = index
+        self.files = files
+        self.attempt = attempt
+        self.resumes = resumes
+        self.bytes = sum(f[1] for f in files)
+        self.proc = None
+        self.log = None
+        self.start = 0.
+        self.seconds = 0.
+        self.events = 0
+
+    def name(self):
+        return "shard_%04d_%d" % (self.index, self.attempt)
+
+
+def readCrab(path):
+    """psetName, inputDataset and requestName of a crab config, without WMCore."""
+    values = {}
+    for line in open(path):
+        line = line.split("#")[0]
+        m = re.match(r"\s*config\.\w+\.(psetName|inputDataset|requestName)\s*=\s*['\"]([^'\"]+)['\"]", line)
+        if m:
+            values[m.group(1)] = m.group(2)
+    for key in ("psetName", "inputDataset"):
+        if key not in values:
+            raise RuntimeError("%s has no %s" % (path, key))
+    return values
+
+
+def listDataset(dataset):
+    out = subprocess.check_output(["dasgoclient", "--query", "file dataset=%s | grep file.name, file.size" % dataset])
+    files = []
+    for line in out.decode().splitlines():
+        fields = line.split()
+        if len(fields) == 2:
+            files.append((fields[0], int(fields[1])))
+        elif len(fields) == 1:
+            files.append((fields[0], -1))
+    return files
+
+
+def readFileList(path):
+    files = []
+    for line in open(path):
+        name = line.split("#")[0].strip()
+        if not name:
+            continue
+        size = os.path.getsize(name) if os.path.exists(name) else -1
+        files.append((name, size))
+    return files
+
+
+def withSizes(files):
+    """unknown sizes become the median of the known ones (1 if none is known)"""
+    known = sorted(f[1] for f in files if f[1] >= 0)
+    median = known[len(known) // 2] if known else 1
+    return [(f[0], f[1] if f[1] >= 0 else median) for f in files]
+
+
+class Merger(threading.Thread):
+    """appends the finished shards to the output, several at a time when they pile up"""
+
+    def __init__(self, output, workdir):
+        threading.Thread.__init__(self)
+        self.output = output
+        self.log = os.path.join(workdir, "merge.log")
+        self.pending = []
+        self.merged = 0
+        self.error = None
+        self.done = False
+        self.cond = threading.Condition()
+        if os.path.exists(output):
+            os.remove(output)
+
+    def add(self, path):
+        with self.cond:
+            self.pending.append(path)
+            self.cond.notify()
+
+    def finish(self):
+        with self.cond:
+            self.done = True
+            self.cond.notify()
+        self.join()
+
+    def run(self):
+        while True:
+            with self.cond:
+                while not self.pending and not self.done:
+                    self.cond.wait()
+                if not self.pending:
+                    return
+                batch, self.pending = self.pending, []
+            with open(self.log, "a") as log:
+                status = subprocess.call(["hadd", "-a", "-fk", self.output] + batch, stdout=log, stderr=subprocess.STDOUT)
+            if status != 0:
+                self.error = "hadd exited with %d, see %s" % (status, self.log)
+                return
+            self.merged += len(batch)
+            for path in batch:
+                os.remove(path)
+
+
+def segmentsOf(prefix):
+    """the output segments of a shard, as resumeCheckpoint.py names them"""
+    found = glob.glob(prefix + "_seg*.root")
+    found.sort(key=lambda p: int(re.search(r"_seg(\d+)\.root$", p).group(1)))
+    return [prefix + ".root"] + found
+
+
+def joinSegments(prefix, log):
+    """one file of the segments of a resumed shard, or None if pkuMergeNtuples fails"""
+    parts = segmentsOf(prefix)
+    if len(parts) == 1:
+        return parts[0]
+    joined = prefix + "_joined.root"
+    with open(log, "a") as out:
+        status = subprocess.call(["pkuMergeNtuples", joined] + parts, stdout=out, stderr=subprocess.STDOUT)
+    if status != 0:
+        return None
+    for part in parts:
+        os.remove(part)
+    return joined
+
+
+def eventsOf(logPath):
+    """events processed by cmsRun, from the TrigReport of wantSummary"""
+    events = 0
+    for line in open(logPath):
+        m = re.search(r"TrigReport Events total = (\d+)", line)
+        if m:
+            events = int(m.group(1))
+    return events
+
+
+def tail(path, n=15):
+    return "".join(open(path).readlines()[-n:])
+
+
+def main():
+    parser = optparse.OptionParser(usage="%prog [config.py] (--files list.txt | --crab crab3_x.py) [options]")
+    parser.add_option("--files", help="text file with the input files, one per line")
+    parser.add_option("--crab", help="take the config, the dataset and the name from this crab config")
+    parser.add_option("--jobs", type="int", default=cpu_count(), help="cmsRun processes [%default]")
+    parser.add_option("--output", help="merged output [<requestName or config>.root]")
+    parser.add_option("--workdir", help="shard configs, logs and outputs [local_<name>]")
+    parser.add_option("--shard-seconds", dest="shardSeconds", type="float", default=600., help="target duration of a shard [%default]")
+    parser.add_option("--retries", type="int", default=2, help="reruns of a failed file [%default]")
+    parser.add_option("--checkpoint-lumis", dest="checkpointLumis", type="int", default=0,
+                      help="checkpoint treeDumper every N lumis and resume failed shards [off]")
+    parser.add_option("--poll", type="float", default=2., help="seconds between checks of the processes [%default]")
+    opts, args = parser.parse_args()
+
+    name = None
+    if opts.crab:
+        crab = readCrab(opts.crab)
+        config = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(opts.crab))), crab["psetName"])
+        name = crab.get("requestName")
+        files = listDataset(crab["inputDataset"]) if not opts.files else readFileList(opts.files)
+    elif len(args) == 1 and opts.files:
+        config = os.path.abspath(args[0])
+        files = readFileList(opts.files)
+    else:
+        parser.error("give a config and --files, or --crab")
+    if not os.path.exists(config):
+        parser.error("no config %s" % config)
+    if not files:
+        parser.error("no input files")
+    if opts.jobs < 1:
+        parser.error("--jobs must be positive")
+    name = name or os.path.splitext(os.path.basename(config))[0]
+    output = os.path.abspath(opts.output or name + ".root")
+    workdir = os.path.abspath(opts.workdir or "local_" + name)
+    if not os.path.isdir(workdir):
+        os.makedirs(workdir)
+    for old in glob.glob(os.path.join(workdir, "shard_*.root")) + glob.glob(os.path.join(workdir, "shard_*.ckpt.json")):
+        os.remove(old)
+
+    files = sorted(withSizes(files), key=lambda f: -f[1])
+    totalBytes = sum(f[1] for f in files)
+    queue = list(files)           # largest first
+    retry = []                    # (file, attempt) of failed shards
+    attempts = {}                 # failures per file
+    reruns = [0]
+    resumed = []                  # failed shards to resume from their checkpoint
+    running = []
+    done, failed = [], []
+    throughput = None             # bytes/s of one process, from the finished shards
+    nextIndex = [0]
+    merger = Merger(output, workdir)
+    merger.start()
+    start = time.time()
+
+    def launch(shardFiles, attempt, resumeOf=None):
+        if resumeOf is None:
+            shard = Shard(nextIndex[0], shardFiles, attempt)
+            nextIndex[0] += 1
+        else:
+            shard = Shard(resumeOf.index, resumeOf.files, resumeOf.attempt, resumeOf.resumes + 1)
+        prefix = os.path.join(workdir, shard.name())
+        suffix = "_resume%d" % shard.resumes if shard.resumes else ""
+        cfg = prefix + suffix + "_cfg.py"
+        with open(cfg, "w") as out:
+            out.write(SHARD_CFG % {"configDir": os.path.dirname(config), "config": config,
+                                   "files": [f[0] for f in shard.files], "output": prefix + ".root", "prefix": prefix,
+                                   "checkpointLumis": opts.checkpointLumis, "resume": bool(shard.resumes),
+                                   "testDir": os.path.dirname(os.path.abspath(__file__))})
+        shard.log = prefix + suffix + ".log"
+        with open(shard.log, "w") as log:
+            shard.proc = subprocess.Popen(["cmsRun", cfg], cwd=os.path.dirname(config), stdout=log, stderr=subprocess.STDOUT)
+        shard.start = time.time()
+        running.append(shard)
+
+    def nextShard():
+        """a shard to resume first, then a failed file, else the next files up to the target duration"""
+        if resumed:
+            return resumed.pop(0), 0
+        if retry:
+            f, attempt = retry.pop(0)
+            return [f], attempt
+        if not queue:
+            return None, 0
+        if throughput is None:
+            return [queue.pop(0)], 0
+        remaining = sum(f[1] for f in queue)
+        # no shard longer than an even split of what is left, so that the tail is short
+        target = min(opts.shardSeconds * throughput, remaining / float(opts.jobs))
+        shardFiles = [queue.pop(0)]
+        while queue and sum(f[1] for f in shardFiles) + queue[-1][1] <= target:
+            shardFiles.append(queue.pop())
+        return shardFiles, 0
+
+    while queue or retry or resumed or running:
+        while len(running) < opts.jobs:
+            shardFiles, attempt = nextShard()
+            if shardFiles is None:
+                break
+            if isinstance(shardFiles, Shard):
+                launch(None, 0, resumeOf=shardFiles)
+            else:
+                launch(shardFiles, attempt)
+        time.sleep(opts.poll)
+        for shard in list(running):
+            status = shard.proc.poll()
+            if status is None:
+                continue
+            running.remove(shard)
+            shard.seconds = time.time() - shard.start
+            prefix = os.path.join(workdir, shard.name())
+            if status == 0 and os.path.exists(segmentsOf(prefix)[-1]):
+                joined = joinSegments(prefix, shard.log)
+                if joined is None:
+                    print("%s: pkuMergeNtuples failed, see %s" % (shard.name(), shard.log))
+                    failed.extend(shard.files)
+                    continue
+                shard.events = eventsOf(shard.log)
+                done.append(shard)
+                merger.add(joined)
+                rate = shard.bytes / max(shard.seconds, 1.)
+                throughput = rate if throughput is None else 0.7 * throughput + 0.3 * rate
+                print("%s: %d file(s), %d events in %.0f s" % (shard.name(), len(shard.files), shard.events, shard.seconds))
+                continue
+            print("%s: cmsRun exited with %s, see %s\n%s" % (shard.name(), status, shard.log, tail(shard.log)))
+            sidecars = [p + ".ckpt.json" for p in segmentsOf(prefix) if os.path.exists(p + ".ckpt.json")]
+            if opts.checkpointLumis > 0 and sidecars and shard.resumes < opts.retries:
+                print("%s: resuming from %s" % (shard.name(), sidecars[-1]))
+                resumed.append(shard)
+                reruns[0] += 1
+                continue
+            for f in shard.files:
+                attempts[f[0]] = attempts.get(f[0], 0) + 1
+                if attempts[f[0]] <= opts.retries:
+                    retry.append((f, attempts[f[0]]))
+                    reruns[0] += 1
+                else:
+                    failed.append(f)
+        if merger.error:
+            break
+
+    for shard in running:
+        shard.proc.kill()
+    merger.finish()
+    wall = time.time() - start
+    events = sum(s.events for s in done)
+    cpuSeconds = sum(s.seconds for s in done)
+
+    print("++++++++++++++++++++++++++++++++++++++++++++++++++")
+    print("runLocal SUMMARY: %s on %d processes" % (name, opts.jobs))
+    print("  %d files, %.1f GB, %d shards, %d reruns, %d files failed" % (
+        len(files), totalBytes / 1e9, len(done), reruns[0], len(failed)))
+    print("  %d events in %.0f s: %.1f events/s, %.2f events/s per core (%.2f per busy core)" % (
+        events, wall, events / max(wall, 1.), events / max(wall, 1.) / opts.jobs, events / max(cpuSeconds, 1.)))
+    print("  output: %s (%d shards merged)" % (output, merger.merged))
+    for f in failed:
+        print("  failed: %s" % f[0])
+    if merger.error:
+        print("  merge failed: %s" % merger.error)
+    print("++++++++++++++++++++++++++++++++++++++++++++++++++")
+    return 0 if not failed and not merger.error else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
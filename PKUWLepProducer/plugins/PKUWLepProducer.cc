@@ -5,10 +5,14 @@
 // 
 /**\class PKUWLepProducer PKUWLepProducer.cc VAJets/PKUWLepProducer/plugins/PKUWLepProducer.cc
 
- Description: [one line class summary]
+ Description: leptonic W candidates, one per lepton, from the leptons and the MET.
 
  Implementation:
-     [Notes on implementation]
+     The neutrino pz of all leptons is solved in one call of
+     pku::NeutrinoPzSolver (root choice "rootChoice", type 0 by default).
+     The candidates are a shallow clone of the lepton and of the MET with
+     the solved p4, the W p4 being set directly.  The cut is parsed once in
+     the constructor and skipped when empty.
 */
 //
 //
@@ -25,14 +29,20 @@
 #include "FWCore/Framework/interface/MakerMacros.h"
 
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
 #include "DataFormats/Candidate/interface/Candidate.h"
 #include "DataFormats/Candidate/interface/ShallowCloneCandidate.h"
 #include "DataFormats/Candidate/interface/CompositeCandidate.h"
 #include "DataFormats/Candidate/interface/CandidateFwd.h"
 #include "DataFormats/Candidate/interface/CompositeCandidateFwd.h"
-#include "CommonTools/CandUtils/interface/AddFourMomenta.h"
 #include "CommonTools/Utils/interface/StringCutObjectSelector.h"
-#include "TMath.h"
+#include "VAJets/PKUTreeMaker/interface/NeutrinoPzSolver.h"
+#include "VAJets/PKUTreeMaker/interface/StageTimer.h"
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <vector>
 
 //
 // class declaration
@@ -52,8 +62,13 @@ private:
   edm::EDGetTokenT<edm::View<reco::Candidate> > leptonToken_;
   edm::EDGetTokenT<edm::View<reco::Candidate> > metToken_;
   StringCutObjectSelector<reco::CompositeCandidate> select_;
+  bool hasCut_;
   double MW_;
-  math::XYZTLorentzVector getNeutrinoP4(const reco::Candidate& met, const reco::Candidate& lep, int lepType);
+  pku::NeutrinoPzSolver solver_;
+  // lepton kinematics and solutions, reused between events
+  std::vector<double> pxl_, pyl_, pzl_, El_, pzNu_;
+  pku::StageTimer timer_;   // "timing" PSet, see StageTimer.h
+  size_t stageRead_, stageSolve_, stageBuild_;
   //virtual void beginRun(edm::Run const&, edm::EventSetup const&) override;
   //virtual void endRun(edm::Run const&, edm::EventSetup const&) override;
   //virtual void beginLuminosityBlock(edm::LuminosityBlock const&, edm::EventSetup const&) override;
@@ -77,13 +92,19 @@ private:
 PKUWLepProducer::PKUWLepProducer(const edm::ParameterSet& iConfig):
   leptonToken_ (consumes<edm::View<reco::Candidate> > (iConfig.getParameter<edm::InputTag>( "leptons" ) ) ),
   metToken_    (consumes<edm::View<reco::Candidate> > (iConfig.getParameter<edm::InputTag>( "MET" ) ) ),
-  select_ (iConfig.getParameter<std::string>("cut") )
+  select_ (iConfig.getParameter<std::string>("cut") ),
+  hasCut_ (!iConfig.getParameter<std::string>("cut").empty() ),
+  MW_ (80.385),
+  solver_ (pku::NeutrinoPzSolver::RootChoice(iConfig.existsAs<int>("rootChoice") ? iConfig.getParameter<int>("rootChoice") : 0), MW_)
 {
   //register your products
   produces<reco::CompositeCandidateCollection>();
 
-  //now do what ever other initialization is needed
-  MW_=80.385;
+  if (iConfig.existsAs<edm::ParameterSet>("timing"))
+    timer_ = pku::StageTimer(iConfig.getParameter<std::string>("@module_label"), iConfig.getParameter<edm::ParameterSet>("timing"));
+  stageRead_  = timer_.stage("read");
+  stageSolve_ = timer_.stage("solve");
+  stageBuild_ = timer_.stage("build");
 }
 
 
@@ -106,6 +127,7 @@ PKUWLepProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 {
    using namespace edm;
 
+   timer_.enter(stageRead_);
    Handle<View<reco::Candidate> > lepton_h;
    Handle<View<reco::Candidate> > MET_h;
 
@@ -118,21 +140,34 @@ PKUWLepProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 
    std::auto_ptr<reco::CompositeCandidateCollection> outCollection(new reco::CompositeCandidateCollection);
 
-   /// Loop on the leptons and combine them with the MET
-   for(size_t i = 0; i != lepton_h->size(); ++i) {
+   /// Solve the neutrino pz of all the leptons at once
+   const size_t n = lepton_h->size();
+   pxl_.resize(n); pyl_.resize(n); pzl_.resize(n); El_.resize(n); pzNu_.resize(n);
+   for(size_t i = 0; i != n; ++i) {
      const reco::Candidate& lepton = lepton_h->at(i);
-     math::XYZTLorentzVector neutrinoP4 = getNeutrinoP4(METcand, lepton, 1);
-     reco::ShallowCloneCandidate neutrino(METBaseRef, 0 , neutrinoP4);
+     pxl_[i] = lepton.px(); pyl_[i] = lepton.py(); pzl_[i] = lepton.pz(); El_[i] = lepton.energy();
+   }
+   const double metPx = METcand.px(), metPy = METcand.py();
+   timer_.enter(stageSolve_);
+   solver_.solve(n, pxl_.data(), pyl_.data(), pzl_.data(), El_.data(), metPx, metPy, pzNu_.data());
+
+   /// Combine each lepton with its neutrino
+   timer_.enter(stageBuild_);
+   outCollection->reserve(n);
+   for(size_t i = 0; i != n; ++i) {
+     const double ENu = std::sqrt(metPx*metPx + metPy*metPy + pzNu_[i]*pzNu_[i]);
+     reco::ShallowCloneCandidate neutrino(METBaseRef, 0 , math::XYZTLorentzVector(metPx, metPy, pzNu_[i], ENu));
      reco::CompositeCandidate WLeptonic;
-     WLeptonic.addDaughter(lepton);
+     WLeptonic.addDaughter(reco::ShallowCloneCandidate(lepton_h->refAt(i)));
      WLeptonic.addDaughter(neutrino);
-     AddFourMomenta addP4;
-     addP4.set(WLeptonic);
-     bool pass = select_(WLeptonic);
-     if(pass) outCollection->push_back(WLeptonic);
+     WLeptonic.setP4(math::XYZTLorentzVector(pxl_[i] + metPx, pyl_[i] + metPy, pzl_[i] + pzNu_[i], El_[i] + ENu));
+     WLeptonic.setCharge(lepton_h->at(i).charge());
+     WLeptonic.setVertex(lepton_h->at(i).vertex());
+     if(!hasCut_ || select_(WLeptonic)) outCollection->push_back(WLeptonic);
    }
 
    iEvent.put(outCollection);
+   timer_.stop();
 }
 
 // ------------ method called once each job just before starting event loop  ------------
@@ -144,6 +179,10 @@ PKUWLepProducer::beginJob()
 // ------------ method called once each job just after ending the event loop  ------------
 void 
 PKUWLepProducer::endJob() {
+  std::stringstream ss;
+  timer_.printSummary(ss);
+  if (timer_.enabled()) edm::LogInfo("PKUWLepProducer") << "SUMMARY:\n" << ss.str();
+  timer_.writeReport();
 }
 
 // ------------ method called when starting to processes a run  ------------
@@ -188,102 +227,5 @@ PKUWLepProducer::fillDescriptions(edm::ConfigurationDescriptions& descriptions)
   descriptions.addDefault(desc);
 }
 
-math::XYZTLorentzVector
-PKUWLepProducer::getNeutrinoP4(const reco::Candidate& met, const reco::Candidate& lep, int lepType){//lepType 0 ele, 1 mu
-
-  double leppt = lep.pt();
-  double lepphi = lep.phi();
-  double lepeta = lep.eta();
-  double lepenergy = lep.energy();
-
-  double metpt = met.pt();
-  double metphi = met.phi();
-
-  double  px = metpt*cos(metphi);
-  double  py = metpt*sin(metphi);
-  double  pz = 0;
-  double  pxl= leppt*cos(lepphi);
-  double  pyl= leppt*sin(lepphi);
-  double  pzl= leppt*sinh(lepeta);
-  double  El = lepenergy;
-  double  a = pow(MW_,2) + pow(px+pxl,2) + pow(py+pyl,2) - px*px - py*py - El*El + pzl*pzl;
-  double  b = 2.*pzl;   
-  double  A = b*b -4.*El*El;
-  double  B = 2.*a*b;
-  double  C = a*a-4.*(px*px+py*py)*El*El;
-
-  ///////////////////////////pz for fnal
-  double M_mu =  0; 
-
-  //if(lepType==1)M_mu=0.105658367;//mu
-  //if(lepType==0)M_mu=0.00051099891;//electron
-
-  int type=0; // use the small abs real root
-
-  a = MW_*MW_ - M_mu*M_mu + 2.0*pxl*px + 2.0*pyl*py;
-  A = 4.0*(El*El - pzl*pzl);
-  B = -4.0*a*pzl;
-  C = 4.0*El*El*(px*px + py*py) - a*a;
-
-
-  double tmproot = B*B - 4.0*A*C;
-  
-  if (tmproot<0) {
-    //std::cout << "Complex root detected, taking real part..." << std::endl;
-    pz = - B/(2*A); // take real part of complex roots
-  }
-  else {
-
-    double tmpsol1 = (-B + sqrt(tmproot))/(2.0*A);
-    double tmpsol2 = (-B - sqrt(tmproot))/(2.0*A);
-
-    //std::cout << " Neutrino Solutions: " << tmpsol1 << ", " << tmpsol2 << std::endl;
-
-    if (type == 0 ) {
-      // two real roots, pick the one closest to pz of muon
-      if (TMath::Abs(tmpsol2-pzl) < TMath::Abs(tmpsol1-pzl)) { pz = tmpsol2; }
-      else { pz = tmpsol1; }
-      // if pz is > 300 pick the most central root
-      if ( abs(pz) > 300. ) {
-	if (TMath::Abs(tmpsol1)<TMath::Abs(tmpsol2) ) { pz = tmpsol1; }
-	else { pz = tmpsol2; }
-      }
-    }
-    if (type == 1 ) {
-      // two real roots, pick the one closest to pz of muon
-      if (TMath::Abs(tmpsol2-pzl) < TMath::Abs(tmpsol1-pzl)) { pz = tmpsol2; }
-      else {pz = tmpsol1; }
-    }
-    if (type == 2 ) {
-      // pick the most central root.
-      if (TMath::Abs(tmpsol1)<TMath::Abs(tmpsol2) ) { pz = tmpsol1; }
-      else { pz = tmpsol2; }
-    }
-    /*if (type == 3 ) {
-      // pick the largest value of the cosine
-      TVector3 p3w, p3mu;
-      p3w.SetXYZ(pxl+px, pyl+py, pzl+ tmpsol1);
-      p3mu.SetXYZ(pxl, pyl, pzl );
-
-      double sinthcm1 = 2.*(p3mu.Perp(p3w))/MW_;
-      p3w.SetXYZ(pxl+px, pyl+py, pzl+ tmpsol2);
-      double sinthcm2 = 2.*(p3mu.Perp(p3w))/MW_;
-
-      double costhcm1 = sqrt(1. - sinthcm1*sinthcm1);
-      double costhcm2 = sqrt(1. - sinthcm2*sinthcm2);
-
-      if ( costhcm1 > costhcm2 ) { pz = tmpsol1; otherSol_ = tmpsol2; }
-      else { pz = tmpsol2;otherSol_ = tmpsol1; }
-
-      }*///end of type3
-
-  }//endl of if real root
-
-  //dont correct pt neutrino
-  math::XYZTLorentzVector outP4(px,py,pz,sqrt(px*px+py*py+pz*pz));
-  return outP4;
-
-}//end neutrinoP4
-
 //define this as a plug-in
 DEFINE_FWK_MODULE(PKUWLepProducer);
@@ -0,0 +1,178 @@
+// -*- C++ -*-
+//
+// Package:    VAJets/PKUZLepProducer
+// Class:      PKUZLepProducer
+//
+/**\class PKUZLepProducer PKUZLepProducer.cc VAJets/PKUZLepProducer/plugins/PKUZLepProducer.cc
+
+ Description: best opposite-sign dielectron and dimuon candidate of the event.
+
+ Implementation:
+     Replaces the CandViewCombiner ("goodX@+ goodX@-") + CandViewMerger chain
+     of leptonicZ_cff.py.  The lepton four-momenta and charges are read once
+     into flat arrays, every opposite-sign pair is scored with plain
+     arithmetic (pku::dilepton::Pairing, DileptonKernels.h), and only the
+     chosen pair of each flavour becomes a CompositeCandidate, its
+     daughters being shallow clones that point back to the input leptons
+     in collection order, as the combiner added them.  The output keeps the
+     order of the old merger (ee before mumu) so that leptonicVs->at(0) and
+     its daughter(0)/daughter(1) are unchanged.
+
+       selection = "leadingPt"   first opposite-sign pair of the (pt-ordered)
+                                 input, the pair the combiner used to put first
+                   "massWindow"  pair closest to targetMass
+       minMass, maxMass          pairs outside are not considered
+*/
+//
+
+// system include files
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+// user include files
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/EDProducer.h"
+
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "VAJets/PKUCommon/interface/DileptonKernels.h"
+#include "VAJets/PKUTreeMaker/interface/StageTimer.h"
+#include "DataFormats/Candidate/interface/Candidate.h"
+#include "DataFormats/Candidate/interface/ShallowCloneCandidate.h"
+#include "DataFormats/Candidate/interface/CompositeCandidate.h"
+#include "DataFormats/Candidate/interface/CandidateFwd.h"
+#include "DataFormats/Candidate/interface/CompositeCandidateFwd.h"
+
+//
+// class declaration
+//
+
+class PKUZLepProducer : public edm::EDProducer {
+public:
+  explicit PKUZLepProducer(const edm::ParameterSet&);
+  ~PKUZLepProducer();
+
+private:
+  virtual void produce(edm::Event&, const edm::EventSetup&) override;
+  virtual void endJob() override;
+  // flat copy of the lepton kinematics used to score the pairs
+  static void fill(const edm::View<reco::Candidate>& leptons, pku::dilepton::Leptons& flat);
+  // the candidate of the leptons first < second, daughters in that order
+  void addCandidate(const edm::Handle<edm::View<reco::Candidate> >& leptons, size_t first, size_t second,
+                    const pku::dilepton::Leptons& flat, reco::CompositeCandidateCollection& out) const;
+
+  edm::EDGetTokenT<edm::View<reco::Candidate> > electronToken_;
+  edm::EDGetTokenT<edm::View<reco::Candidate> > muonToken_;
+  pku::dilepton::Pairing pairing_;
+
+  pku::dilepton::Leptons electrons_, muons_;   // reused between events
+  unsigned long long nEvents_, nEE_, nMuMu_;
+  pku::StageTimer timer_;   // "timing" PSet, see StageTimer.h
+  size_t stageEE_, stageMuMu_, stagePut_;
+};
+
+//
+// constructors and destructor
+//
+PKUZLepProducer::PKUZLepProducer(const edm::ParameterSet& iConfig):
+  electronToken_ (consumes<edm::View<reco::Candidate> > (iConfig.getParameter<edm::InputTag>( "electrons" ) ) ),
+  muonToken_     (consumes<edm::View<reco::Candidate> > (iConfig.getParameter<edm::InputTag>( "muons" ) ) ),
+  nEvents_(0), nEE_(0), nMuMu_(0)
+{
+  std::string selection = iConfig.existsAs<std::string>("selection") ? iConfig.getParameter<std::string>("selection") : "leadingPt";
+  if (selection == "massWindow") pairing_.selection = pku::dilepton::MassWindow;
+  else if (selection != "leadingPt")
+    throw cms::Exception("Configuration") << "PKUZLepProducer: unknown selection " << selection;
+  if (iConfig.existsAs<double>("targetMass")) pairing_.targetMass = iConfig.getParameter<double>("targetMass");
+  if (iConfig.existsAs<double>("minMass")) pairing_.minMass = iConfig.getParameter<double>("minMass");
+  if (iConfig.existsAs<double>("maxMass")) pairing_.maxMass = iConfig.getParameter<double>("maxMass");
+
+  produces<reco::CompositeCandidateCollection>();
+
+  if (iConfig.existsAs<edm::ParameterSet>("timing"))
+    timer_ = pku::StageTimer(iConfig.getParameter<std::string>("@module_label"), iConfig.getParameter<edm::ParameterSet>("timing"));
+  stageEE_   = timer_.stage("ee");
+  stageMuMu_ = timer_.stage("mumu");
+  stagePut_  = timer_.stage("put");
+}
+
+
+PKUZLepProducer::~PKUZLepProducer()
+{
+}
+
+
+//
+// member functions
+//
+
+void
+PKUZLepProducer::fill(const edm::View<reco::Candidate>& leptons, pku::dilepton::Leptons& flat)
+{
+  const size_t n = leptons.size();
+  flat.resize(n);
+  for (size_t i = 0; i != n; ++i) {
+    const reco::Candidate::LorentzVector& p4 = leptons[i].p4();
+    flat.px[i] = p4.px(); flat.py[i] = p4.py(); flat.pz[i] = p4.pz(); flat.e[i] = p4.energy();
+    flat.charge[i] = leptons[i].charge();
+  }
+}
+
+void
+PKUZLepProducer::addCandidate(const edm::Handle<edm::View<reco::Candidate> >& leptons, size_t first, size_t second,
+                              const pku::dilepton::Leptons& flat, reco::CompositeCandidateCollection& out) const
+{
+  reco::CompositeCandidate Z;
+  Z.addDaughter(reco::ShallowCloneCandidate(leptons->refAt(first)));
+  Z.addDaughter(reco::ShallowCloneCandidate(leptons->refAt(second)));
+  Z.setP4(reco::Candidate::LorentzVector(flat.px[first] + flat.px[second], flat.py[first] + flat.py[second],
+                                         flat.pz[first] + flat.pz[second], flat.e[first] + flat.e[second]));
+  Z.setCharge(0);
+  Z.setVertex(leptons->at(first).vertex());
+  out.push_back(Z);
+}
+
+// ------------ method called to produce the data  ------------
+void
+PKUZLepProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
+{
+  edm::Handle<edm::View<reco::Candidate> > electron_h, muon_h;
+  iEvent.getByToken(electronToken_, electron_h);
+  iEvent.getByToken(muonToken_, muon_h);
+
+  std::auto_ptr<reco::CompositeCandidateCollection> outCollection(new reco::CompositeCandidateCollection);
+  outCollection->reserve(2);
+  size_t first = 0, second = 0;
+
+  timer_.enter(stageEE_);
+  fill(*electron_h, electrons_);
+  if (pairing_.bestPair(electrons_, first, second)) { addCandidate(electron_h, first, second, electrons_, *outCollection); ++nEE_; }
+  timer_.enter(stageMuMu_);
+  fill(*muon_h, muons_);
+  if (pairing_.bestPair(muons_, first, second)) { addCandidate(muon_h, first, second, muons_, *outCollection); ++nMuMu_; }
+
+  timer_.enter(stagePut_);
+  iEvent.put(outCollection);
+  timer_.stop();
+
+  ++nEvents_;
+}
+
+// ------------ method called once each job just after ending the event loop  ------------
+void
+PKUZLepProducer::endJob() {
+  std::stringstream ss;
+  ss << "events=" << nEvents_ << " ee=" << nEE_ << " mumu=" << nMuMu_ << "\n";
+  timer_.printSummary(ss);
+  edm::LogInfo("PKUZLepProducer") << "SUMMARY:\n" << ss.str();
+  timer_.writeReport();
+}
+
+//define this as a plug-in
+DEFINE_FWK_MODULE(PKUZLepProducer);